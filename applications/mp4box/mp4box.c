@@ -220,7 +220,7 @@ Double interleaving_time, split_duration, split_start, dash_duration, dash_subdu
 Bool arg_parse_res, dash_duration_strict, dvbhdemux, keep_sys_tracks, align_cat;
 Bool do_hint, do_save, full_interleave, do_frag, hint_interleave, dump_rtp, regular_iod, remove_sys_tracks, remove_hint, remove_root_od;
 Bool print_sdp, open_edit, dump_cr, force_ocr, encode, do_scene_log, dump_srt, dump_ttxt, do_saf, dump_m2ts, dump_cart, dump_chunk, dump_check_xml, fuzz_chk;
-Bool do_hash, verbose, force_cat, pack_wgt, single_group, clean_groups, dash_live, no_fragments_defaults, single_traf_per_moof, tfdt_per_traf;
+Bool do_hash, do_hidx, do_hidx_check, verbose, force_cat, pack_wgt, single_group, clean_groups, dash_live, no_fragments_defaults, single_traf_per_moof, tfdt_per_traf;
 Bool hls_clock, do_mpd_rip, merge_vtt_cues, get_nb_tracks, no_inplace, merge_last_seg, freeze_box_order, no_odf_conf;
 Bool insert_utc, chunk_mode, HintCopy, hint_no_offset, do_bin_xml, frag_real_time, force_co64, live_scene, use_mfra, dump_iod, samplegroups_in_traf;
 Bool mvex_after_traks, daisy_chain_sidx, use_ssix, single_segment, single_file, segment_timeline, has_add_image;
@@ -281,7 +281,7 @@ static void init_global_vars()
 	dash_duration_strict = dvbhdemux = keep_sys_tracks = do_hint = do_save = full_interleave = do_frag = hint_interleave = GF_FALSE;
 	dump_rtp = regular_iod = remove_sys_tracks = remove_hint = remove_root_od = print_sdp = open_edit = GF_FALSE;
 	dump_cr = force_ocr = encode = do_scene_log = dump_srt = dump_ttxt = do_saf = dump_m2ts = dump_cart = dump_chunk = GF_FALSE;
-	dump_check_xml = do_hash = verbose = force_cat = pack_wgt = single_group = clean_groups = dash_live = no_fragments_defaults = fuzz_chk = GF_FALSE;
+	dump_check_xml = do_hash = do_hidx = do_hidx_check = verbose = force_cat = pack_wgt = single_group = clean_groups = dash_live = no_fragments_defaults = fuzz_chk = GF_FALSE;
 	single_traf_per_moof = tfdt_per_traf = hls_clock = do_mpd_rip = merge_vtt_cues = get_nb_tracks = GF_FALSE;
 	no_inplace = merge_last_seg = freeze_box_order = no_odf_conf = GF_FALSE;
 	insert_utc = chunk_mode = HintCopy = hint_no_offset = do_bin_xml = frag_real_time = force_co64 = live_scene = GF_FALSE;
@@ -1352,6 +1352,8 @@ MP4BoxArg m4b_dump_args[] =
  	MP4BOX_ARG("nstats", "generate node/field statistics per Access Unit", GF_ARG_BOOL, 0, &stat_level, 2, 0),
  	MP4BOX_ARG("nstatx", "generate node/field statistics for scene after each AU", GF_ARG_BOOL, 0, &stat_level, 3, 0),
  	MP4BOX_ARG("hash", "generate SHA-1 Hash of the input file", GF_ARG_BOOL, 0, &do_hash, 0, 0),
+ 	MP4BOX_ARG("hidx", "generate sample hash index `FILE.hidx` of the output file, or of the input file if not modified, storing CRC32 of each chunk", GF_ARG_BOOL, 0, &do_hidx, 0, 0),
+ 	MP4BOX_ARG("hidx-check", "check input file against its sample hash index `FILE.hidx`", GF_ARG_BOOL, 0, &do_hidx_check, 0, 0),
  	MP4BOX_ARG("comp", "replace with compressed version all top level box types given as parameter, formatted as `orig_4cc_1=comp_4cc_1[,orig_4cc_2=comp_4cc_2]`", GF_ARG_STRING, 0, parse_comp_box, 0, ARG_IS_FUN),
  	MP4BOX_ARG("topcount", "print to stdout the number of top-level boxes matching box types given as parameter, formatted as `4cc_1,4cc_2N`", GF_ARG_STRING, 0, parse_comp_box, 2, ARG_IS_FUN),
  	MP4BOX_ARG("topsize", "print to stdout the number of bytes of top-level boxes matching types given as parameter, formatted as `4cc_1,4cc_2N` or `all` for all boxes", GF_ARG_STRING, 0, parse_comp_box, 1, ARG_IS_FUN),
@@ -4269,6 +4271,36 @@ static GF_Err do_compress_top_boxes(char *inName, char *outName)
 	return GF_OK;
 }
 
+static GF_Err hash_index(char *name, Bool check)
+{
+	u32 nb_errors = 0;
+	GF_Err e;
+	char szIdx[GF_MAX_PATH];
+	snprintf(szIdx, GF_MAX_PATH, "%s.hidx", name);
+	szIdx[GF_MAX_PATH-1] = 0;
+
+	if (!check) {
+		e = gf_isom_make_sample_hash_index(name, szIdx, NULL, 0);
+		if (e) {
+			M4_LOG(GF_LOG_ERROR, ("Failed to create sample hash index %s: %s\n", szIdx, gf_error_to_string(e)));
+		} else {
+			M4_LOG(GF_LOG_INFO, ("Sample hash index written to %s\n", szIdx));
+		}
+		return e;
+	}
+	e = gf_isom_check_sample_hash_index(name, szIdx, NULL, 0, &nb_errors);
+	if (e) {
+		M4_LOG(GF_LOG_ERROR, ("Failed to check sample hash index %s: %s\n", szIdx, gf_error_to_string(e)));
+		return e;
+	}
+	if (nb_errors) {
+		M4_LOG(GF_LOG_ERROR, ("%s: %d sample ranges do not match sample hash index\n", name, nb_errors));
+		return GF_CORRUPTED_DATA;
+	}
+	M4_LOG(GF_LOG_INFO, ("%s: sample hash index OK\n", name));
+	return GF_OK;
+}
+
 static GF_Err hash_file(char *name, u32 dump_std)
 {
 	u32 i;
@@ -6728,6 +6760,10 @@ int mp4box_main(int argc, char **argv)
 		e = hash_file(inName, dump_std);
 		if (e) goto err_exit;
 	}
+	if (do_hidx_check) {
+		e = hash_index(inName, GF_TRUE);
+		if (e) goto err_exit;
+	}
 	if (do_bin_xml) {
 		e = xml_bs_to_bin(inName, outName, dump_std);
 		if (e) goto err_exit;
@@ -7121,6 +7157,10 @@ err_exit:
 	return mp4box_cleanup(1);
 
 exit:
+	if (do_hidx) {
+		e = hash_index((outName && gf_file_exists(outName)) ? outName : inName, GF_FALSE);
+		if (e) return mp4box_cleanup(1);
+	}
 	return mp4box_cleanup(0);
 }
 
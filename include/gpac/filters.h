@@ -200,7 +200,9 @@ typedef enum
 	/*! In this mode, the scheduler uses locks for packet and property queues even if single-threaded (test mode) */
 	GF_FS_SCHEDULER_LOCK_FORCE,
 	/*! In this mode, the scheduler uses direct dispatch and no threads, trying to nest task calls within task calls */
-	GF_FS_SCHEDULER_DIRECT
+	GF_FS_SCHEDULER_DIRECT,
+	/*! In this mode, the scheduler does not use locks for packet and property queues, and each thread uses a local task queue. Tasks of a filter are posted to the local queue of the thread that last processed the filter, and idle threads steal tasks from other threads. Defaults to lock-free if no threads are used */
+	GF_FS_SCHEDULER_WORK_STEAL
 } GF_FilterSchedulerType;
 
 /*! Filter session flags */
@@ -241,7 +243,10 @@ typedef enum
 	GF_FS_FLAG_FORCE_DEFER_LINK = 1<<13,
 	/*! Flag set to ignore all PLAY events from sinks - use \ref gf_fs_send_deferred_play to start playback
 	*/
-	GF_FS_FLAG_PREVENT_PLAY = 1<<14
+	GF_FS_FLAG_PREVENT_PLAY = 1<<14,
+	/*! Flag set to enable NUMA-aware session threads on multi-node hosts: packet pool blocks are kept per node, work-stealing scheduler steals from threads of the same node first, and threads not bound by \ref gf_fs_set_thread_cpus are bound to all CPUs of a node, nodes round-robin
+	*/
+	GF_FS_FLAG_NUMA = 1<<15
 } GF_FilterSessionFlags;
 
 /*! Creates a new filter session. This will also load all available filter registers not blacklisted.
@@ -250,6 +255,7 @@ typedef enum
 \param flags set of above flags for the session. Modes set by flags cannot be changed at runtime
 \param blacklist string containing comma-separated names of filters to disable. If first character is '-', this describes a whitelist, i.e. only filters listed in this string will be allowed
 \return the created filter session
+\note NUMA placement is also enabled by the core option `th-numa`, and CPU affinity of the extra threads is set from the core option `th-cpus`, see \ref gf_fs_set_thread_cpus
 */
 GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType type, GF_FilterSessionFlags flags, const char *blacklist);
 
@@ -370,6 +376,14 @@ Setting the value to 0 disables dynamic link resolution. You will have to specif
 */
 GF_Err gf_fs_set_max_resolution_chain_length(GF_FilterSession *session, u32 max_chain_length);
 
+/*! Sets the CPUs the extra threads of the session are bound to, one CPU per thread in round-robin. The main thread is not bound.
+This must be called before running the session, or once a blocking session is done running.
+\param session filter session
+\param cpu_list comma-separated list of CPU indexes or ranges, eg "0-3,8", or NULL to remove CPU binding (threads are still bound to NUMA nodes if \ref GF_FS_FLAG_NUMA is set)
+\return error if any
+*/
+GF_Err gf_fs_set_thread_cpus(GF_FilterSession *session, const char *cpu_list);
+
 /*! Sets the maximum sleep time when postponing tasks.
 \param session filter session
 \param  max_sleep maximum sleep time in milliseconds. 0 means yield only.
@@ -492,6 +506,17 @@ GF_Err gf_fs_post_user_task_delay(GF_FilterSession *session, Bool (*task_execute
 */
 GF_Err gf_fs_post_user_task_main(GF_FilterSession *session, Bool (*task_execute) (GF_FilterSession *fsess, void *callback, u32 *reschedule_ms), void *udta_callback, const char *log_name);
 
+/*! Runs a set of independent jobs on the session worker threads, blocking until all jobs are done.
+The calling thread processes jobs as well, and worker threads pick jobs through user tasks as they become idle. The calling thread never waits for a job no thread has started, so this can safely be called from a filter callback or a user task, and from a session not yet running.
+\param session filter session, may be NULL in which case all jobs are run in the calling thread
+\param nb_jobs number of jobs to run
+\param max_threads maximum number of threads working on the jobs including the calling thread, 0 means all session threads
+\param job_run the callback function running a job, called exactly once per job index, possibly concurrently
+\param udta user data passed back to the job_run function
+\return the last error returned by a job, GF_OK otherwise
+*/
+GF_Err gf_fs_run_jobs(GF_FilterSession *session, u32 nb_jobs, u32 max_threads, GF_Err (*job_run)(void *udta, u32 job_idx), void *udta);
+
 /*! Session flush types*/
 typedef enum
 {
@@ -643,6 +668,29 @@ typedef enum
 	GF_FS_STATS_FILTER_MEDIA_SOURCE,
 } GF_FSFilterType;
 
+/*! number of buckets in latency histograms: 8 linear buckets then 8 sub-buckets per power of 2, up to 2^40 microseconds*/
+#define GF_FILTER_HIST_BUCKETS	304
+
+/*! Latency histogram, with values in microseconds. Buckets have a relative precision of 12.5%*/
+typedef struct
+{
+	/*! number of samples in each bucket*/
+	u32 counts[GF_FILTER_HIST_BUCKETS];
+	/*! total number of samples*/
+	u64 nb_samples;
+	/*! sum of all samples*/
+	u64 total;
+	/*! max sample value*/
+	u64 max;
+} GF_FilterHistogram;
+
+/*! Gets a percentile value from a latency histogram
+\param hist the target histogram
+\param percentile the percentile to query, between 0 and 100 (eg 99.9)
+
+\return highest value equivalent to the given percentile, or 0 if no samples*/
+u64 gf_filter_hist_percentile(const GF_FilterHistogram *hist, Double percentile);
+
 /*! Filter statistics object*/
 typedef struct
 {
@@ -706,6 +754,12 @@ typedef struct
 	GF_Fraction64 last_ts_drop;
 	/*! time spent in last task in microseconds*/
 	u32 last_task_time;
+	/*! number of tasks requeued by this filter*/
+	u64 nb_tasks_requeued;
+	/*! histogram of process() durations, NULL if latency histograms are disabled*/
+	const GF_FilterHistogram *process_hist;
+	/*! histogram of time between packet dispatch and packet drop on input PIDs, NULL if latency histograms are disabled*/
+	const GF_FilterHistogram *queue_hist;
 } GF_FilterStats;
 
 /*! Gets statistics for a given filter index in the session
@@ -2893,6 +2947,16 @@ immediately or after reschedule_ms.
 */
 GF_Err gf_filter_post_task(GF_Filter *filter, Bool (*task_execute) (GF_Filter *filter, void *callback, u32 *reschedule_ms), void *udta, const char *task_name);
 
+/*! Runs a set of independent jobs on the worker threads of the filter session, blocking until all jobs are done - see \ref gf_fs_run_jobs
+\param filter target filter, may be NULL in which case all jobs are run in the calling thread
+\param nb_jobs number of jobs to run
+\param max_threads maximum number of threads working on the jobs including the calling thread, 0 means all session threads
+\param job_run the callback function running a job, called exactly once per job index, possibly concurrently
+\param udta user data passed back to the job_run function
+\return the last error returned by a job, GF_OK otherwise
+*/
+GF_Err gf_filter_run_jobs(GF_Filter *filter, u32 nb_jobs, u32 max_threads, GF_Err (*job_run)(void *udta, u32 job_idx), void *udta);
+
 
 /*! Sets callback function on source filter setup failure
 
@@ -4320,6 +4384,19 @@ Subsequent calls will return the pending packet if any.
 */
 GF_FilterPacket * gf_filter_pid_get_packet(GF_FilterPid *PID);
 
+/*! Fetches several packets from the input PID buffer, without removing them.
+
+The first packet is fetched as with \ref gf_filter_pid_get_packet. The following packets are the next ones in the buffer, stopping at the first packet carrying a PID property or info change, a clock reference, an end of stream or any other internal command, so that all returned packets share the same PID configuration.
+
+Returned packets shall be dropped in order using \ref gf_filter_pid_drop_packet, once per packet. The same validity rules as \ref gf_filter_pid_get_packet apply.
+
+\param PID the target filter PID
+\param pcks array receiving the packets
+\param max_pcks maximum number of packets to fetch
+\return number of packets fetched, 0 if no packet is available
+*/
+u32 gf_filter_pid_get_packets(GF_FilterPid *PID, GF_FilterPacket **pcks, u32 max_pcks);
+
 /*! Fetches the CTS of the first packet in the input PID buffer.
 \param PID the target filter PID
 \param cts set to the composition time of the first packet, in PID timescale
@@ -4771,6 +4848,17 @@ Packet shall not be modified after this call, as it may be discarded during the
 */
 GF_Err gf_filter_pck_send(GF_FilterPacket *pck);
 
+/*! Sends a set of packets on their output PID, as if calling \ref gf_filter_pck_send for each packet in order.
+The PID buffer level and blocking state are updated and a process task is posted to each destination only once for the whole set, which reduces dispatch overhead for filters producing many small packets.
+
+All packets must belong to the same output PID. Packets shall not be modified after this call.
+
+\param pcks the packets to send, in processing order
+\param nb_pcks the number of packets to send
+\return error if any
+*/
+GF_Err gf_filter_pck_send_batch(GF_FilterPacket **pcks, u32 nb_pcks);
+
 /*! Destructs a packet allocated but that cannot be sent. Shall not be used on packet references.
 \param pck the target output packet to send
 */
@@ -635,6 +635,7 @@ enum
 #define GF_ISOM_BS_COOKIE_IN_UDTA		(1<<4)
 #define GF_ISOM_BS_COOKIE_NO_DECOMP		(1<<5)
 #define GF_ISOM_BS_COOKIE_NO_MABR_PATCH	(1<<6)
+#define GF_ISOM_BS_COOKIE_LAZY_STBL		(1<<7)
 
 
 #ifndef GPAC_DISABLE_ISOM
@@ -651,6 +652,8 @@ enum
 #define GF_ISOM_BOX_COMPRESSED 2
 //if flag is set, box dump will skip size info
 #define GF_ISOM_DUMP_SKIP_SIZE 4
+//if flag is set, box memory is owned by a box arena
+#define GF_ISOM_BOX_IN_ARENA 8
 
 	/*the default size is 64, cause we need to handle large boxes...
 
@@ -700,6 +703,32 @@ typedef struct
 	if (tmp==NULL) return NULL;	\
 	tmp->type = __4cc;
 
+/*same as ISOM_DECL_BOX_ALLOC but allocates the box in the box arena of the calling thread, if any. Box destructor must use gf_isom_box_arena_del_box*/
+#define ISOM_DECL_BOX_ALLOC_ARENA(__TYPE, __4cc)	__TYPE *tmp = (__TYPE *) gf_isom_box_arena_new_box(sizeof(__TYPE)); \
+	if (tmp==NULL) return NULL;	\
+	tmp->type = __4cc;
+
+/*arena for short-lived boxes (moof, mfhd, traf, tfhd, tfdt, trun) and their entry arrays, allocated in large blocks
+and recycled in bulk once all boxes allocated from the arena are destroyed.
+An arena is not thread-safe: it must be owned by a single thread at a time, and all boxes allocated in it must be created and destroyed by that owner*/
+typedef struct __isom_box_arena GF_ISOBoxArena;
+
+GF_ISOBoxArena *gf_isom_box_arena_new();
+/*destroys the arena - if boxes are still allocated in the arena, destruction is delayed until the last one is destroyed*/
+void gf_isom_box_arena_del(GF_ISOBoxArena *arena);
+/*releases arena blocks if no box is allocated in the arena*/
+void gf_isom_box_arena_trim(GF_ISOBoxArena *arena);
+/*sets the arena used for box allocation by the calling thread, returns the previous one*/
+GF_ISOBoxArena *gf_isom_box_arena_set_current(GF_ISOBoxArena *arena);
+/*allocates a zeroed box of given size in the current arena of the calling thread, or on the heap if none*/
+void *gf_isom_box_arena_new_box(u32 size);
+/*destroys a box allocated with gf_isom_box_arena_new_box*/
+void gf_isom_box_arena_del_box(GF_Box *s);
+/*allocates memory owned by the given box, in the arena of the box if any, or on the heap*/
+void *gf_isom_box_arena_alloc(GF_Box *owner, u32 size);
+/*frees memory allocated with gf_isom_box_arena_alloc*/
+void gf_isom_box_arena_free(GF_Box *owner, void *ptr);
+
 #define ISOM_DECREASE_SIZE(__ptr, bytes)	if (__ptr->size < (bytes) ) {\
 			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[isom] not enough bytes in box %s: %d left, reading %d (file %s, line %d) - try specifying -no-check (might crash)\n", gf_4cc_to_str(__ptr->type), (u32) __ptr->size, (bytes), __FILE__, __LINE__ )); \
 			return GF_ISOM_INVALID_FILE; \
@@ -755,6 +784,8 @@ void gf_isom_check_position(GF_Box *s, GF_Box *child, u32 *pos);
 void gf_isom_check_position_list(GF_Box *s, GF_List *childlist, u32 *pos);
 
 Bool gf_box_valid_in_parent(GF_Box *a, const char *parent_4cc);
+//builds the sorted box registry index, called by gf_sys_init - thread-safe, only the first call builds the index
+void gf_isom_registry_init();
 
 void gf_isom_box_array_del_parent(GF_List **child_boxes, GF_List *boxlist);
 void gf_isom_box_array_reset_parent(GF_List **child_boxes, GF_List *boxlist);
@@ -989,6 +1020,30 @@ typedef struct {
 } GF_ExternalTrackLocationBox;
 
 
+/*sample hash index entry: CRC32 of the data of nb_samples consecutive samples*/
+typedef struct
+{
+	u32 first_sample;
+	u32 nb_samples;
+	u32 crc;
+} GF_ISOSampleHashEntry;
+
+/*sample hash index of a track*/
+typedef struct
+{
+	GF_ISOTrackID track_id;
+	GF_ISOSampleHashEntry *entries;
+	u32 nb_entries, nb_alloc;
+	/*write mode only: number of samples added and size of the current entry*/
+	u32 nb_samples, entry_size;
+	/*write mode only: set when a sample was inserted in the middle of the track, the track is not indexed*/
+	Bool disabled;
+} GF_ISOSampleHashTrack;
+
+/*writes a sample hash index - tracks is a list of GF_ISOSampleHashTrack*/
+GF_Err gf_isom_sample_hash_index_save(const char *index_path, GF_List *tracks);
+/*deletes a sample hash track*/
+void gf_isom_sample_hash_track_del(GF_ISOSampleHashTrack *sht);
 
 typedef struct
 {
@@ -1036,6 +1091,8 @@ typedef struct
 	u32 chunk_stsd_idx;
 	u32 chunk_cache_size;
 	GF_BitStream *chunk_cache;
+	//sample hash index, see gf_isom_set_sample_hash_index
+	GF_ISOSampleHashTrack *sample_hash;
 #endif
 
 	u32 sample_count_at_seg_start;
@@ -1050,6 +1107,10 @@ typedef struct
 	u64 last_tfxd_value;
 	struct __traf_mss_timeref_box *tfrf;
 	u64 dts_at_next_frag_start;
+
+	//fragment index, kept across table resets and segment switches
+	GF_ISOFragmentIndexEntry *frag_index;
+	u32 frag_index_count, frag_index_alloc;
 #endif
 } GF_TrackBox;
 
@@ -1223,6 +1284,14 @@ typedef struct
 	u32 sampleDelta;
 } GF_SttsEntry;
 
+/*random access checkpoint in stts, giving first sample and DTS of an entry*/
+typedef struct
+{
+	u32 entry_index;
+	u32 first_sample;
+	u64 dts;
+} GF_SttsCheckpoint;
+
 typedef struct
 {
 	GF_ISOM_FULL_BOX
@@ -1243,6 +1312,10 @@ typedef struct
 
 	//stats for read
 	u32 max_ts_delta;
+
+	/*sparse checkpoint index for random access in READ, only valid while nb_entries is r_index_nb_entries*/
+	GF_SttsCheckpoint *r_index;
+	u32 r_index_count, r_index_nb_entries;
 } GF_TimeToSampleBox;
 
 
@@ -1253,6 +1326,25 @@ typedef struct
 	s32 decodingOffset;
 } GF_DttsEntry;
 
+/*number of entries decoded at once in lazy sample tables*/
+#define GF_ISOM_LAZY_WINDOW	4096
+
+/*sample table kept in file and decoded on demand by windows of GF_ISOM_LAZY_WINDOW entries, see core option isom-lazy*/
+typedef struct
+{
+	GF_BitStream *bs;
+	//position of first entry in bs
+	u64 offset;
+	//entry size in bits: 4, 8, 16, 32 or 64
+	u32 nb_bits;
+	u32 nb_entries;
+	//decoded windows, most recently used first
+	GF_List *windows;
+	u32 max_windows;
+	//set when entries could not be read from file, the table is then corrupted and all entries are 0
+	GF_Err error;
+} GF_ISOLazyTable;
+
 typedef struct
 {
 	GF_ISOM_FULL_BOX
@@ -1271,6 +1363,9 @@ typedef struct
 	s32 max_cts_delta;
 	s32 min_neg_cts_offset;
 	//u32 sample_num_max_cts_delta;
+
+	/*if set, entries is NULL and sampleCount/decodingOffset pairs are read from file*/
+	GF_ISOLazyTable *lazy;
 } GF_CompositionOffsetBox;
 
 
@@ -2037,6 +2132,8 @@ typedef struct
 	u32 max_size;
 	u64 total_size;
 	u32 total_samples;
+	/*if set, sizes is NULL and sizes are read from file*/
+	GF_ISOLazyTable *lazy;
 } GF_SampleSizeBox;
 
 typedef struct
@@ -2045,6 +2142,8 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u32 *offsets;
+	/*if set, offsets is NULL and offsets are read from file*/
+	GF_ISOLazyTable *lazy;
 } GF_ChunkOffsetBox;
 
 typedef struct
@@ -2053,6 +2152,8 @@ typedef struct
 	u32 nb_entries;
 	u32 alloc_size;
 	u64 *offsets;
+	/*if set, offsets is NULL and offsets are read from file*/
+	GF_ISOLazyTable *lazy;
 } GF_ChunkLargeOffsetBox;
 
 typedef struct
@@ -2064,6 +2165,13 @@ typedef struct
 	u8 isEdited;
 } GF_StscEntry;
 
+/*random access checkpoint in stsc, giving first sample of an entry*/
+typedef struct
+{
+	u32 entry_index;
+	u32 first_sample;
+} GF_StscCheckpoint;
+
 typedef struct
 {
 	GF_ISOM_FULL_BOX
@@ -2077,6 +2185,10 @@ typedef struct
 	u32 currentChunk;
 	u32 ghostNumber;
 
+	/*sparse checkpoint index for random access in READ, only valid while nb_entries is r_index_nb_entries*/
+	GF_StscCheckpoint *r_index;
+	u32 r_index_count, r_index_nb_entries;
+
 	u32 w_lastSampleNumber;
 	u32 w_lastChunkNumber;
 } GF_SampleToChunkBox;
@@ -4238,6 +4350,8 @@ typedef struct
 
 /*regular file IO*/
 #define GF_ISOM_DATA_FILE         0x01
+/*File Mapping object, read-only mode on complete files (no download)*/
+#define GF_ISOM_DATA_FILE_MAPPING 0x02
 /*External file object. Needs implementation*/
 #define GF_ISOM_DATA_FILE_EXTERN  0x03
 /*regular memory IO*/
@@ -4258,6 +4372,9 @@ enum
 	GF_ISOM_DATA_MAP_READ_ONLY = 4,
 	/*write-only access at the end of the movie - only used for movie fragments concatenation*/
 	GF_ISOM_DATA_MAP_CAT = 5,
+	/*read-only access to a complete local file through a memory mapping, falls back to regular file access if mapping fails
+	mode is set to GF_ISOM_DATA_MAP_READ afterwards*/
+	GF_ISOM_DATA_MAP_READ_MAPPED = 6,
 };
 
 /*this is the DataHandler structure each data handler has its own bitstream*/
@@ -4294,10 +4411,9 @@ typedef struct
 typedef struct
 {
 	GF_ISOM_BASE_DATA_HANDLER
-	char *name;
+	GF_FileMap *fmap;
 	u64 file_size;
-	u8 *byte_map;
-	u64 byte_pos;
+	const u8 *byte_map;
 } GF_FileMappingDataMap;
 
 GF_Err gf_isom_datamap_new(const char *location, const char *parentPath, u8 mode, GF_DataMap **outDataMap);
@@ -4311,6 +4427,11 @@ GF_DataMap *gf_isom_fdm_new(const char *sPath, u8 mode);
 void gf_isom_fdm_del(GF_FileDataMap *ptr);
 u32 gf_isom_fdm_get_data(GF_FileDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *range_status);
 
+/*File-mapping data map*/
+GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode);
+void gf_isom_fmo_del(GF_FileMappingDataMap *ptr);
+u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *range_status);
+
 #ifndef GPAC_DISABLE_ISOM_WRITE
 GF_DataMap *gf_isom_fdm_new_temp(const char *sTempPath);
 #endif
@@ -4401,6 +4522,10 @@ struct __tag_isom {
 	s64 read_byte_offset;
 	u64 bytes_removed;
 
+	/*external read cache for sample data of the movie file*/
+	gf_isom_read_cache_cbk read_cache_cbk;
+	void *read_cache_udta;
+
 	u32 tracks_use_mux_index;
 	Bool auto_reorder_tracks;
 
@@ -4414,6 +4539,10 @@ struct __tag_isom {
 	void *progress_cbk_udta;
 
 	char *override_dref_url;
+#ifndef GPAC_DISABLE_ISOM_WRITE
+	//path of the sample hash index to write on close, see gf_isom_set_sample_hash_index
+	char *sample_hash_index;
+#endif
 	
 	/*in WRITE mode, this is the current MDAT where data is written*/
 	/*in READ mode this is the last valid file position before a gf_isom_box_read failed*/
@@ -4425,12 +4554,23 @@ struct __tag_isom {
 
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
 	u32 NextMoofNumber;
+	//number of segments opened, used by fragment index
+	u32 segment_idx;
 	/*active fragment*/
 	GF_MovieFragmentBox *moof;
 	u64 segment_start;
 
 	GF_List *moof_list;
 	Bool use_segments, moof_first, append_segment, force_moof_base_offset;
+	//disables fast moof serializer
+	Bool moof_generic_write;
+	//serialization buffer of fast moof serializer
+	u8 *moof_buffer;
+	u32 moof_buffer_alloc;
+	//number of moof boxes written by the fast serializer
+	u32 nb_fast_moofs;
+	//arena for fragment boxes when reading, see core option isom-arena
+	GF_ISOBoxArena *box_arena;
 	//0: don' write, 1: write and modif, 2: write as is
 	u32 write_styp;
 
@@ -4498,6 +4638,10 @@ struct __tag_isom {
 
 	Bool no_inplace_rewrite;
 	u32 padding;
+	//space reserved for moov before mdat in fast-start capture mode, and offset of the reserved free box
+	u32 moov_reserve;
+	u64 moov_reserve_offset;
+	Bool moov_reserve_fit;
 	u64 original_moov_offset, original_meta_offset, first_data_toplevel_offset, first_data_toplevel_size;
 };
 
@@ -4576,6 +4720,22 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 GF_Err stbl_GetSampleShadow(GF_ShadowSyncBox *stsh, u32 *sampleNumber, u32 *syncNum);
 GF_Err stbl_GetPaddingBits(GF_PaddingBitsBox *padb, u32 SampleNumber, u8 *PadBits);
 GF_Err stbl_GetSampleDepType(GF_SampleDependencyTypeBox *stbl, u32 SampleNumber, u32 *isLeading, u32 *dependsOn, u32 *dependedOn, u32 *redundant);
+/*gets offset of a chunk (1-based) in stco or co64, fails if the chunk offset table is lazy and could not be read*/
+GF_Err stbl_GetChunkOffset(GF_Box *stco, u32 chunkNumber, u64 *offset);
+/*gets entry (0-based) of ctts, fails if the table is lazy and could not be read*/
+GF_Err stbl_GetCompositionEntry(GF_CompositionOffsetBox *ctts, u32 entryIndex, u32 *sampleCount, s32 *decodingOffset);
+
+/*lazy sample tables - returns NULL if lazy loading is not enabled on bs or if table is small, otherwise records current bs position as table start*/
+GF_ISOLazyTable *gf_isom_lazy_table_new(GF_BitStream *bs, u32 nb_entries, u32 nb_bits);
+void gf_isom_lazy_table_del(GF_ISOLazyTable *lt);
+/*returns 0 if the entry cannot be read from the file, in which case the table error is set*/
+u64 gf_isom_lazy_table_get(GF_ISOLazyTable *lt, u32 entryIndex);
+/*loads lazy stsz, stz2, stco, co64 or ctts box in memory, does nothing for other boxes*/
+GF_Err gf_isom_box_unlazy(GF_Box *a);
+/*loads all lazy tables of a sample table in memory, must be called before any modification of the tables or of the file map*/
+GF_Err stbl_unlazy(GF_SampleTableBox *stbl);
+GF_Err gf_isom_unlazy_tables(GF_ISOFile *mov);
+GF_Err stbl_build_index(GF_SampleTableBox *stbl, u32 interval);
 
 
 /*unpack sample2chunk and chunk offset so that we have 1 sample per chunk (edition mode only)*/
@@ -4600,6 +4760,12 @@ GF_Err gf_isom_set_sample_group_description_internal(GF_ISOFile *movie, u32 trac
 GF_Err isom_on_block_out(void *cbk, u8 *data, u32 block_size);
 
 GF_Err FlushCaptureMode(GF_ISOFile *movie);
+/*creates the sample hash index of a track, samples already in the track are not indexed*/
+GF_Err gf_isom_sample_hash_track_new(GF_TrackBox *trak);
+/*updates the sample hash index of the track, if enabled, with data of nb_new_samples new samples, or data appended to the last sample if nb_new_samples is 0 - must be called once the samples are successfully added at the end of the track*/
+void gf_isom_sample_hash_add(GF_ISOFile *movie, GF_TrackBox *trak, const u8 *data, u32 size, u32 nb_new_samples);
+/*removes the track from the sample hash index, if enabled, when samples are inserted before the last sample*/
+void gf_isom_sample_hash_disable(GF_ISOFile *movie, GF_TrackBox *trak);
 GF_ISOFile *gf_isom_create_movie(const char *fileName, GF_ISOOpenMode OpenMode, const char *tmp_dir);
 GF_Err gf_isom_insert_moov(GF_ISOFile *file);
 
@@ -5046,6 +5212,7 @@ GF_Err gf_isom_box_dump_ex(void *ptr, FILE * trace, Bool subtree_root);
 GF_Err gf_isom_box_array_dump(GF_List *list, FILE * trace, u16 parent_internal_flags);
 
 void gf_isom_registry_disable(u32 boxCode, Bool disable);
+Bool gf_isom_box_is_disabled(GF_Box *a);
 
 /*Apple extensions
 type 0: itunes
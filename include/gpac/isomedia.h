@@ -575,6 +575,9 @@ typedef struct __tag_isom GF_ISOFile;
 /*! a track ID value - just a 32 bit value but typedefed for API safety*/
 typedef u32 GF_ISOTrackID;
 
+/*! filter session used to run jobs, see \ref GF_FilterSession*/
+struct __gf_filter_session;
+
 /*! @} */
 
 /*!
@@ -797,6 +800,14 @@ Bool gf_isom_moov_first(GF_ISOFile *isom_file);
 */
 GF_Err gf_isom_set_byte_offset(GF_ISOFile *isom_file, s64 byte_offset);
 
+/*! builds a sparse random access index on the sample tables of all tracks, speeding up non-sequential sample lookups by number or time.
+The index is automatically built when opening a file for reading if the `-isom-index` option is set. This is only supported for non-fragmented files opened for reading
+\param isom_file the target ISO file
+\param interval number of table entries between two index checkpoints, 0 removes the index
+\return error if any
+*/
+GF_Err gf_isom_set_sample_index(GF_ISOFile *isom_file, u32 interval);
+
 
 /*! opens a movie that can be uncomplete in READ_ONLY mode
 to use for http streaming & co
@@ -834,6 +845,18 @@ If the movie is successfully loaded (isom_file non-NULL), BytesMissing is zero
 */
 GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_templates, GF_ISOFile **isom_file, u64 *BytesMissing, u32 *topBoxType);
 
+/*! same as  \ref gf_isom_open_progressive_ex but uses a read-only memory mapping of the file if possible. The file must be a complete local file. If the mapping cannot be created, regular file access is used.
+
+Sample data can then be accessed without copy through \ref gf_isom_get_sample_mapped
+\param fileName the name of the local file to open
+\param enable_frag_templates loads fragment and segment boundaries in an internal table
+\param isom_file pointer set to the opened file if success
+\param BytesMissing is set to the predicted number of bytes missing for the file to be loaded
+\param topBoxType is set to the 4CC of the incomplete top-level box found - may be NULL
+\return error if any
+*/
+GF_Err gf_isom_open_mapped(const char *fileName, Bool enable_frag_templates, GF_ISOFile **isom_file, u64 *BytesMissing, u32 *topBoxType);
+
 /*! retrieves number of bytes missing.
 if requesting a sample fails with error GF_ISOM_INCOMPLETE_FILE, use this function
 to get the number of bytes missing to retrieve the sample
@@ -1139,6 +1162,36 @@ GF_ISOSample *gf_isom_get_sample_info(GF_ISOFile *isom_file, u32 trackNumber, u3
 */
 GF_ISOSample *gf_isom_get_sample_info_ex(GF_ISOFile *isom_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, u64 *data_offset, GF_ISOSample *static_sample);
 
+/*! gets sample information and a pointer to its payload in the memory-mapped file, without copy. This only works for files opened with \ref gf_isom_open_mapped, and for samples stored in the movie file which are not modified when fetched (no NALU rewriting, no padding, ...). Other samples must be fetched using \ref gf_isom_get_sample_ex
+\param isom_file the target ISO file
+\param trackNumber the target track
+\param sampleNumber the desired sample number (1-based index)
+\param sampleDescriptionIndex set to the sample description index corresponding to this sample (optional, can be NULL)
+\param static_sample a caller-allocated ISO sample to use as the returned sample. Its data and allocation size are not modified
+\param data_offset set to the sample start offset in file (optional, can be NULL)
+\param data set to the sample payload in the mapped file. The payload shall not be modified
+\param file_map set to the file mapping holding the payload. The caller must reference it with \ref gf_file_map_ref as long as the payload is used after the ISO file is closed
+\return the ISO sample without data or NULL if the sample cannot be accessed through the mapping
+*/
+GF_ISOSample *gf_isom_get_sample_mapped(GF_ISOFile *isom_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, GF_ISOSample *static_sample, u64 *data_offset, const u8 **data, GF_FileMap **file_map);
+
+/*! callback for sample data read cache
+\param udta opaque data passed to \ref gf_isom_set_read_cache
+\param offset offset of the data in the movie file
+\param buffer destination buffer
+\param size number of bytes to copy
+\return GF_TRUE if data was copied in buffer, GF_FALSE if data is not available in the cache
+*/
+typedef Bool (*gf_isom_read_cache_cbk)(void *udta, u64 offset, u8 *buffer, u32 size);
+
+/*! sets a read cache for sample data stored in the movie file. The cache is queried before reading sample data from the movie file, and data is read from the file if not present in the cache
+\param isom_file the target ISO file
+\param cache_cbk the cache callback, NULL to remove the cache
+\param udta opaque data passed to the callback
+\return error if any
+*/
+GF_Err gf_isom_set_read_cache(GF_ISOFile *isom_file, gf_isom_read_cache_cbk cache_cbk, void *udta);
+
 /*! get sample decoding time
 \param isom_file the target ISO file
 \param trackNumber the target track
@@ -1894,6 +1947,26 @@ u64 gf_isom_get_first_mdat_start(GF_ISOFile *isom_file);
 */
 u64 gf_isom_get_unused_box_bytes(GF_ISOFile *isom_file);
 
+/*! creates a sample hash index sidecar for a file. The index stores, for each chunk of each track, the CRC32 of the chunk samples data. Sample data is read using large sequential reads, without going through sample fetching.
+Samples using an external data reference are not indexed.
+\param file_path path of the source file
+\param index_path path of the sample hash index to create
+\param session filter session whose threads compute checksums, see \ref gf_fs_run_jobs. If NULL, checksums are computed in the calling thread
+\param max_threads maximum number of session threads used including the calling thread, 0 means all session threads
+\return error if any
+*/
+GF_Err gf_isom_make_sample_hash_index(const char *file_path, const char *index_path, struct __gf_filter_session *session, u32 max_threads);
+
+/*! checks a file against its sample hash index sidecar, as created by \ref gf_isom_make_sample_hash_index or \ref gf_isom_set_sample_hash_index. Corrupted entries are logged.
+\param file_path path of the file to check
+\param index_path path of the sample hash index
+\param session filter session whose threads verify checksums, see \ref gf_fs_run_jobs. If NULL, checksums are verified in the calling thread
+\param max_threads maximum number of session threads used including the calling thread, 0 means all session threads
+\param nb_errors set to the number of index entries not matching file content
+\return error if any
+*/
+GF_Err gf_isom_check_sample_hash_index(const char *file_path, const char *index_path, struct __gf_filter_session *session, u32 max_threads, u32 *nb_errors);
+
 /*! @} */
 
 
@@ -2317,6 +2390,22 @@ GF_Err gf_isom_set_final_name(GF_ISOFile *isom_file, char *filename);
 */
 GF_Err gf_isom_set_storage_mode(GF_ISOFile *isom_file, GF_ISOStorageMode storage_mode);
 
+/*! enables computing a sample hash index while samples are added to a file open in write mode, in regular or fragmented mode. The index is written to the given path when the file is successfully closed, and uses the same format as \ref gf_isom_make_sample_hash_index, grouping samples in runs of about 1 MByte instead of chunks.
+This must be called before any sample is added to the file. Tracks where a sample is inserted before the last sample, for example a shadow sample, are not indexed.
+\param isom_file the target ISO file
+\param index_path path of the sample hash index to write, or NULL to disable
+\return error if any
+*/
+GF_Err gf_isom_set_sample_hash_index(GF_ISOFile *isom_file, const char *index_path);
+
+/*! reserves space for the moov box before the mdat box in fast-start mode for files open in write mode. The reserved space is written as a free box before any sample data. If the final moov fits in the reserved space, it is written in place and sample data is not moved; otherwise the moov is inserted before the reserved space.
+This must be called before any sample is added to the file.
+\param isom_file the target ISO file
+\param size number of bytes to reserve, 0 disables reservation. Values less than 8 bytes are rounded up to 8
+\return error if any
+*/
+GF_Err gf_isom_set_moov_reserve(GF_ISOFile *isom_file, u32 size);
+
 /*! sets the interleaving time of media data (INTERLEAVED mode only)
 \param isom_file the target ISO file
 \param InterleaveTime the target interleaving time in movie timescale
@@ -4572,6 +4661,57 @@ Only use this function if \ref gf_isom_enable_traf_map_templates has been called
 \return GF_TRUE if this sample was the first sample of a traf in the fragmented source file, GF_FALSE otherwise*/
 Bool gf_isom_sample_is_fragment_start(GF_ISOFile *isom_file, u32 trackNumber, u32 sampleNum, GF_ISOFragmentBoundaryInfo *frag_info);
 
+/*! Fragment index entry
+
+The fragment index of a track records every track fragment parsed when reading a fragmented file or its segments. It is not modified by \ref gf_isom_reset_tables, \ref gf_isom_release_segment or \ref gf_isom_purge_samples, so that fragments already seen can be located without parsing them again*/
+typedef struct
+{
+	/*! decode time of the first sample of the fragment, in media timescale*/
+	u64 tfdt;
+	/*! duration of the fragment, in media timescale*/
+	u64 duration;
+	/*! start offset of the moof box in the file or segment it was parsed from*/
+	u64 moof_start;
+	/*! end offset of the sample data of the fragment in the file or segment it was parsed from*/
+	u64 data_end;
+	/*! number of samples in the fragment*/
+	u32 nb_samples;
+	/*! index of the segment the fragment was parsed from, incremented at each \ref gf_isom_open_segment call (0 for the initial file)*/
+	u32 segment_idx;
+	/*! set if the first sample of the fragment is a sync sample*/
+	Bool first_is_sync;
+} GF_ISOFragmentIndexEntry;
+
+/*! gets the number of entries in the fragment index of a track
+\param isom_file the target ISO file
+\param trackNumber the target track
+\return the number of fragments indexed for this track*/
+u32 gf_isom_get_fragment_index_count(GF_ISOFile *isom_file, u32 trackNumber);
+
+/*! gets an entry of the fragment index of a track. Entries are sorted by increasing decode time
+\param isom_file the target ISO file
+\param trackNumber the target track
+\param index 1-based index of the entry
+\param entry filled with the fragment information
+\return error if any*/
+GF_Err gf_isom_get_fragment_index_entry(GF_ISOFile *isom_file, u32 trackNumber, u32 index, GF_ISOFragmentIndexEntry *entry);
+
+/*! locates the fragment containing a given decode time in the fragment index of a track
+\param isom_file the target ISO file
+\param trackNumber the target track
+\param dts the decode time in media timescale
+\param sync_start if set, returns the closest previous fragment starting with a sync sample
+\param index set to the 1-based index of the fragment
+\return error if any, GF_NOT_FOUND if the time is not covered by the index*/
+GF_Err gf_isom_find_fragment_index(GF_ISOFile *isom_file, u32 trackNumber, u64 dts, Bool sync_start, u32 *index);
+
+/*! gets closest file offset for the given time using the fragment index of all tracks. Only fragments parsed from the current file or segment are inspected
+\param isom_file the target ISO file
+\param start_time the start time in seconds
+\param offset set to the offset of the moof of the earliest fragment to start parsing from
+\return error if any, GF_NOT_FOUND if the time is not covered by the index*/
+GF_Err gf_isom_get_fragment_offset_for_time(GF_ISOFile *isom_file, Double start_time, u64 *offset);
+
 /*! releases current movie segment. This closes the associated file IO object.
 \note seeking in the file is no longer possible when tables are rested
 \warning The sample count is not reseted after the release of tables. use \ref gf_isom_reset_tables for this
@@ -5066,7 +5206,10 @@ typedef enum
 	param: on/off (0/1)*/
 	GF_ISOM_TRAF_TRUN_V1,
 	/*force usage of 64 bits in tfdt and in per-segment sidx*/
-	GF_ISOM_TRAF_USE_LARGE_TFDT
+	GF_ISOM_TRAF_USE_LARGE_TFDT,
+	/*! disables fast serialization of moof boxes made only of tfhd, tfdt and trun boxes, and always use generic box writing. This is a movie-level option, track ID is ignored
+	param: on/off (0/1)*/
+	GF_ISOM_MOOF_GENERIC_WRITE
 } GF_ISOTrackFragmentOption;
 
 /*! sets a track fragment option. Options can be set at the beginning of each new fragment only, and for the
@@ -6451,6 +6594,35 @@ GF_Err gf_isom_extract_meta_item(GF_ISOFile *isom_file, Bool root_meta, u32 trac
 */
 GF_Err gf_isom_extract_meta_item_mem(GF_ISOFile *isom_file, Bool root_meta, u32 track_num, u32 item_id, u8 **out_data, u32 *out_size, u32 *out_alloc_size, const char **mime_type, Bool use_annex_b);
 
+/*! item data for batch extraction*/
+typedef struct
+{
+	/*! ID of the item to extract*/
+	u32 item_id;
+	/*! set to allocated buffer containing the item, shall be freed by user - may be an existing buffer of alloc_size bytes*/
+	u8 *data;
+	/*! set to the size of the item*/
+	u32 size;
+	/*! allocated size of the data buffer*/
+	u32 alloc_size;
+	/*! set to the mime type of the item*/
+	const char *mime;
+	/*! set to the extraction error of the item, GF_OK with no data if item is stored outside the file*/
+	GF_Err e;
+} GF_ISOItemData;
+
+/*! extracts several items from given meta in memory
+Extents of all items are sorted by file offset and nearby extents are read in a single operation, which is faster than extracting items one by one for many small items such as tiles of a grid image.
+\param isom_file the target ISO file
+\param root_meta if GF_TRUE uses meta at the file, otherwise uses meta at the movie level if track number is 0
+\param track_num if GF_TRUE and root_meta is GF_FALSE, uses meta at the track level
+\param items array of items to extract, with item_id set and data/alloc_size set to existing buffers or NULL/0
+\param nb_items number of items in the array
+\param use_annex_b for image items based on NALU formats (AVC, HEVC) indicates to extract the data as Annex B format (with start codes)
+\return error if any, errors specific to an item are set in the item
+*/
+GF_Err gf_isom_extract_meta_items_mem(GF_ISOFile *isom_file, Bool root_meta, u32 track_num, GF_ISOItemData *items, u32 nb_items, Bool use_annex_b);
+
 
 /*! fetch CENC info for an item
 \param isom_file the target ISO file
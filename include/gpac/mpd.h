@@ -170,6 +170,8 @@ typedef struct
 {
 	/*! list of entries*/
 	GF_List *entries;
+	/*! serialization cache, created when the timeline producer signals modifications (private)*/
+	struct __mpd_stl_cache *cache;
 } GF_MPD_SegmentTimeline;
 
 /*! Byte range info*/
@@ -698,6 +700,10 @@ typedef struct {
 	char *m3u8_var_name;
 	/*! temp file for m3u8 generation*/
 	FILE *m3u8_var_file;
+	/*! modification counter of the HLS state, 0 if modifications are not signaled - see \ref gf_mpd_representation_m3u8_modified*/
+	u32 m3u8_var_version;
+	/*! modification counter and MPD state of the last variant playlist generated in temp file, for regular and LL-HLS second pass playlists*/
+	u32 m3u8_var_gen_version[2], m3u8_var_gen_state[2];
 
 	/*! for m3u8: 0: not encrypted, 1: full segment, 2: CENC CBC, 2: CENC CTR*/
 	u8 crypto_type;
@@ -973,6 +979,10 @@ typedef struct {
 	GF_List *base_URLs;
 	/*! list of strings */
 	GF_List *locations;
+	/*! MPD patch location URL, NULL if none */
+	char *patch_location;
+	/*! validity of the patch location in seconds, 0 if not set */
+	u32 patch_location_ttl;
 	/*! list of Metrics */
 	GF_List *metrics;
 	/*! list of GF_MPD_Period */
@@ -1027,6 +1037,10 @@ typedef struct {
 	GF_DashAbsoluteURLMode hls_abs_url;
 	Bool m3u8_use_repid;
 	Bool hls_audio_primary;
+	/*! maximum number of threads used to generate variant playlists, 0 or 1 generates them in the calling thread*/
+	u32 hls_nb_threads;
+	/*! filter owning the MPD, whose session worker threads are used when hls_nb_threads is greater than 1 - may be NULL*/
+	GF_Filter *hls_filter;
 
 	/*! number of past discontinuities */
 	u32 nb_past_discont;
@@ -1035,6 +1049,11 @@ typedef struct {
 	u32 segment_duration;
 	char *segment_template;
 	Bool allow_empty_reps;
+
+	/*! segment timelines built while parsing the XML - GPAC internal*/
+	struct __mpd_sax_parse *sax_parse;
+	/*! state of the last generated MPD patch - GPAC internal*/
+	struct __mpd_patch_state *patch_state;
 } GF_MPD;
 
 /*! parses an MPD Element (and subtree) from DOM
@@ -1044,6 +1063,23 @@ typedef struct {
 \return error if any
 */
 GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *base_url);
+
+/*! parses an MPD file
+
+SegmentTimeline entries are created directly while parsing the XML, without building DOM nodes for them
+\param mpd MPD structure to fill
+\param file the MPD file to parse
+\param base_url base URL of the MPD document
+\param entry_pool list of segment timeline entries to reuse, as filled by \ref gf_mpd_recycle_timeline_entries - may be NULL
+\return error if any
+*/
+GF_Err gf_mpd_init_from_file(GF_MPD *mpd, const char *file, const char *base_url, GF_List *entry_pool);
+
+/*! moves all segment timeline entries of an MPD to a pool, for reuse when parsing the next version of the MPD
+\param mpd the MPD, usually about to be destroyed
+\param entry_pool the list of entries to fill
+*/
+void gf_mpd_recycle_timeline_entries(GF_MPD *mpd, GF_List *entry_pool);
 /*! parses an MPD Period element (and subtree) from DOM
 \param root root of DOM parsing result
 \param mpd MPD structure to fill
@@ -1101,6 +1137,44 @@ GF_Err gf_mpd_write(GF_MPD const * const mpd, FILE *out, Bool compact);
 \return error if any
 */
 GF_Err gf_mpd_write_file(GF_MPD const * const mpd, const char *file_name);
+/*! writes an MPD context to a binary state file stream
+
+The state holds timelines and segment states in binary form, followed by the MPD context as XML without these, so that reloading does not depend on the session length
+\param mpd the target MPD to write
+\param out the target file object
+\param compact if set, removes all new line and indentation in the XML part
+\return error if any
+*/
+GF_Err gf_mpd_write_binary_state(GF_MPD *mpd, FILE *out, Bool compact);
+/*! checks if a file is a binary state file
+\param file_name the file to check
+\param next_gen_ntp_ms set to the next generation time of the state, as NTP in ms - may be NULL
+\return GF_TRUE if binary state file, GF_FALSE otherwise
+*/
+Bool gf_mpd_is_binary_state(const char *file_name, u64 *next_gen_ntp_ms);
+/*! loads an MPD context from a binary state file written by \ref gf_mpd_write_binary_state
+\param mpd the target MPD to fill
+\param file_name the binary state file
+\return error if any
+*/
+GF_Err gf_mpd_load_binary_state(GF_MPD *mpd, const char *file_name);
+/*! writes an MPD patch against the MPD version described by the previous call
+
+Only segment timelines changes and publish time are described by the patch; if anything else changed in the MPD, or for the first call, the patch has no operation and originalPublishTime equal to publishTime, forcing clients to fetch the full MPD
+\param mpd the target MPD, must have an ID
+\param out the target file object
+\param compact if set, removes all new line and indentation
+\return error if any
+*/
+GF_Err gf_mpd_write_patch(GF_MPD *mpd, FILE *out, Bool compact);
+/*! applies an MPD patch to an MPD
+
+The MPD is left unchanged if any operation cannot be applied. Supported operations are add, replace and remove on S elements and SegmentTimeline elements, and replace of MPD duration attributes
+\param mpd the target MPD
+\param patch_file the patch file
+\return error if any, GF_EOS if the patch was already applied, GF_BAD_PARAM if the patch does not apply to this MPD version
+*/
+GF_Err gf_mpd_apply_patch(GF_MPD *mpd, const char *patch_file);
 
 /*! write mode for M3U8 */
 typedef enum
@@ -1358,6 +1432,27 @@ void gf_mpd_representation_free(void *_item);
 \return the new segment timeline*/
 GF_MPD_SegmentTimeline *gf_mpd_segmentimeline_new();
 
+/*! signals that entries of a segment timeline are about to be modified, inserted or removed, starting from the given entry index.
+
+The first call enables caching of the serialized timeline: entries before the first modified one are not serialized again by \ref gf_mpd_write. A producer calling this function must signal all subsequent modifications of the timeline, using this function or \ref gf_mpd_segment_timeline_head_removed
+\param timeline the target segment timeline
+\param first_entry 0-based index of the first modified entry
+*/
+void gf_mpd_segment_timeline_modified(GF_MPD_SegmentTimeline *timeline, u32 first_entry);
+
+/*! signals that entries have been removed from the head of a segment timeline. The new first entry may have been modified, as long as its duration and end time are unchanged
+\param timeline the target segment timeline
+\param nb_removed number of entries removed from the head of the timeline
+*/
+void gf_mpd_segment_timeline_head_removed(GF_MPD_SegmentTimeline *timeline, u32 nb_removed);
+
+/*! signals that the HLS state of a representation (segment list, parts, target duration) was modified since its variant playlist was last generated.
+
+The first call enables tracking of modifications: variant playlists generated in temp files (see \ref GF_MPD_Representation.m3u8_var_file) are then only generated again if the representation was modified or if the MPD state changed. A producer calling this function must signal all subsequent modifications of the representation
+\param rep the target representation
+*/
+void gf_mpd_representation_m3u8_modified(GF_MPD_Representation *rep);
+
 /*! DASHer cues information*/
 typedef struct
 {
@@ -111,9 +111,13 @@ https://docs.microsoft.com/en-us/windows/win32/api/winnt/nf-winnt-interlockedexc
 #ifdef GPAC_64_BITS
 #define safe_int64_add(__v, inc_val) InterlockedExchangeAdd64((LONGLONG *) (__v), inc_val)
 #define safe_int64_sub(__v, dec_val) InterlockedExchangeAdd64((LONGLONG *) (__v), -dec_val)
+/*! atomic large integer add and gets the value *before* the add */
+#define safe_int64_fetch_add(__v, inc_val) InterlockedExchangeAdd64((LONGLONG *) (__v), inc_val)
 #else
 #define safe_int64_add(__v, inc_val) InterlockedExchangeAdd64xp((LONGLONG *) (__v), inc_val)
 #define safe_int64_sub(__v, dec_val) InterlockedExchangeAdd64xp((LONGLONG *) (__v), -dec_val)
+/*! atomic large integer add and gets the value *before* the add */
+#define safe_int64_fetch_add(__v, inc_val) InterlockedExchangeAdd64xp((LONGLONG *) (__v), inc_val)
 #endif
 /* End of modification by M. Lackner */
 
@@ -133,6 +137,8 @@ https://docs.microsoft.com/en-us/windows/win32/api/winnt/nf-winnt-interlockedexc
 #define safe_int64_sub(__v, dec_val) InterlockedAdd64((LONG64 *) (__v), -dec_val)
 /*! atomic add and gets the value *before* the add */
 #define safe_int_fetch_add(__v, inc_val) InterlockedExchangeAdd((int *) (__v), inc_val)
+/*! atomic large integer add and gets the value *before* the add */
+#define safe_int64_fetch_add(__v, inc_val) InterlockedExchangeAdd64((LONG64 *) (__v), inc_val)
 #endif //winxp
 
 #else //not windows
@@ -153,6 +159,8 @@ https://docs.microsoft.com/en-us/windows/win32/api/winnt/nf-winnt-interlockedexc
 #define safe_int64_sub(__v, dec_val) __atomic_sub_fetch((int64_t *) (__v), dec_val, __ATOMIC_SEQ_CST)
 /*! atomic add and gets the value *before* the add */
 #define safe_int_fetch_add(__v, inc_val) __atomic_fetch_add((int *) (__v), inc_val, __ATOMIC_SEQ_CST)
+/*! atomic large integer add and gets the value *before* the add */
+#define safe_int64_fetch_add(__v, inc_val) __atomic_fetch_add((int64_t *) (__v), inc_val, __ATOMIC_SEQ_CST)
 
 #else
 
@@ -170,6 +178,8 @@ https://docs.microsoft.com/en-us/windows/win32/api/winnt/nf-winnt-interlockedexc
 #define safe_int64_sub(__v, dec_val) __sync_sub_and_fetch((int64_t *) (__v), dec_val)
 /*! atomic add and gets the value *before* the add */
 #define safe_int_fetch_add(__v, inc_val) __sync_fetch_and_add((int *) (__v), inc_val)
+/*! atomic large integer add and gets the value *before* the add */
+#define safe_int64_fetch_add(__v, inc_val) __sync_fetch_and_add((int64_t *) (__v), inc_val)
 
 #endif //GPAC_NEED_LIBATOMIC
 
@@ -292,6 +302,47 @@ Gets the ID of the current thread the caller is in.
 */
 u32 gf_th_id();
 
+/*!
+\brief thread CPU affinity
+
+Restricts execution of a thread to a set of CPUs. This is currently only supported on Linux and Windows.
+\param th the thread object, which must be running, or NULL for the calling thread
+\param cpus list of CPU indexes the thread may run on
+\param nb_cpus number of CPU indexes in the list
+\return error if any, GF_NOT_SUPPORTED if not supported on this platform
+*/
+GF_Err gf_th_set_cpu_affinity(GF_Thread *th, const u32 *cpus, u32 nb_cpus);
+
+/*!
+\brief current CPU
+
+Gets the CPU the calling thread is currently running on
+\return CPU index, or -1 if unknown
+*/
+s32 gf_th_current_cpu();
+
+/*!
+\brief CPU list parsing
+
+Parses a CPU list formatted as comma-separated CPU indexes or ranges, eg "0-3,8,10-11"
+\param list the CPU list string
+\param cpus array filled with the parsed CPU indexes
+\param max_cpus maximum number of entries in the array
+\return number of CPU indexes parsed, 0 if error
+*/
+u32 gf_th_parse_cpu_list(const char *list, u32 *cpus, u32 max_cpus);
+
+/*!
+\brief NUMA node CPUs
+
+Gets the CPUs of a NUMA node. If the system does not expose NUMA information, a single node 0 is assumed holding all cores.
+\param node the NUMA node index
+\param cpus array filled with the CPU indexes of the node
+\param max_cpus maximum number of entries in the array
+\return number of CPUs of the node, 0 if no such node
+*/
+u32 gf_th_get_numa_cpus(u32 node, u32 *cpus, u32 max_cpus);
+
 #ifdef GPAC_CONFIG_ANDROID
 /*! Register a function that will be called before pthread_exist is called */
 GF_Err gf_register_before_exit_function(GF_Thread *t, u32 (*toRunBeforePthreadExit)(void *param));
@@ -440,6 +491,10 @@ typedef void * GF_Thread;
 #define gf_th_status(_th) GF_THREAD_STATUS_DEAD
 #define gf_th_set_priority(_th, _priority)
 #define gf_th_id() 0
+#define gf_th_set_cpu_affinity(_th, _cpus, _nb_cpus) GF_NOT_SUPPORTED
+#define gf_th_current_cpu() -1
+#define gf_th_parse_cpu_list(_list, _cpus, _max_cpus) 0
+#define gf_th_get_numa_cpus(_node, _cpus, _max_cpus) 0
 
 #ifdef GPAC_CONFIG_ANDROID
 #define gf_register_before_exit_function(_t, _fun)
@@ -2028,6 +2028,42 @@ Opens a file descriptor - this is simply a wrapper aroun open taking care of UTF
 \return file descriptor, -1 if error*/
 s32 gf_fd_open(const char *file_name, u32 oflags, u32 pflags);
 
+/*! read-only memory mapping of a file*/
+typedef struct __gf_file_map GF_FileMap;
+
+/*!
+\brief Memory-map a file
+
+Creates a read-only memory mapping of a complete local file. The returned object has a reference count of 1.
+\param file_name path of the file to map
+\return the file mapping object, or NULL if error or if memory mapping is not supported on this platform or for this file (empty file, File IO wrapper, ...)*/
+GF_FileMap *gf_file_map_new(const char *file_name);
+
+/*!
+\brief Reference a file mapping
+
+Increases the reference count of a file mapping object. This function is thread-safe.
+\param fmap the file mapping object
+*/
+void gf_file_map_ref(GF_FileMap *fmap);
+
+/*!
+\brief Release a file mapping
+
+Decreases the reference count of a file mapping object, destroying the mapping when no more references are held. This function is thread-safe.
+\param fmap the file mapping object
+\return the number of references left, 0 if the object was destroyed*/
+u32 gf_file_map_unref(GF_FileMap *fmap);
+
+/*!
+\brief Get mapped data
+
+Gets the mapped memory of a file mapping object. The memory shall not be modified.
+\param fmap the file mapping object
+\param size set to the size of the mapped file - may be NULL
+\return the mapped memory*/
+const u8 *gf_file_map_get_data(GF_FileMap *fmap, u64 *size);
+
 /*! File IO wrapper object*/
 typedef struct __gf_file_io GF_FileIO;
 
@@ -2284,6 +2320,17 @@ Computes the CRC32 value of a buffer.
  */
 u32 gf_crc_32(const u8 *data, u32 size);
 
+/*!
+\brief CRC32 update
+
+Updates a CRC32 value with the content of a buffer. Calling this function with an initial CRC of 0xFFFFFFFF is equivalent to \ref gf_crc_32, and calling it again on the result continues the checksum over the next buffer.
+\param crc current CRC32 value
+\param data buffer
+\param size buffer size
+\return updated CRC32
+ */
+u32 gf_crc_32_update(u32 crc, const u8 *data, u32 size);
+
 
 /**
 Compresses a data buffer in place using zlib/deflate. Buffer may be reallocated in the process.
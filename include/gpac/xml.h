@@ -291,6 +291,25 @@ u32 gf_xml_dom_get_line(GF_DOMParser *parser);
  */
 GF_Err gf_xml_dom_enable_passthrough(GF_DOMParser *dom);
 
+/*! Callback function used to filter elements while building the DOM
+\param udta opaque user data
+\param parent the parent node of the element
+\param node_name the element name
+\param name_space the element namespace prefix, NULL if none
+\param attributes the element attributes
+\param nb_attributes the number of attributes
+\return GF_TRUE if the element is consumed by the callback, in which case the element and its children are not added to the DOM
+*/
+typedef Bool (*gf_xml_dom_node_filter)(void *udta, GF_XMLNode *parent, const char *node_name, const char *name_space, const GF_XMLAttribute *attributes, u32 nb_attributes);
+
+/*! Sets a filter for elements below the root element, allowing large element lists to be processed directly from the SAX events without building DOM nodes
+\param dom the dom parser
+\param node_filter the filter callback, NULL to disable filtering
+\param udta opaque user data passed to the filter
+\return error if any
+ */
+GF_Err gf_xml_dom_set_node_filter(GF_DOMParser *dom, gf_xml_dom_node_filter node_filter, void *udta);
+
 /*! Gets the number of root nodes in the document (not XML compliant, but used in DASH for remote periods)
 \param parser the DOM parser to use
 \return the number of root elements in the document
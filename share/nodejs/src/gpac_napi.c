@@ -5548,6 +5548,7 @@ static napi_status InitConstants(napi_env env, napi_value exports)
 	DEF_CONST(GF_FS_SCHEDULER_LOCK_FREE_X)
 	DEF_CONST(GF_FS_SCHEDULER_LOCK_FORCE)
 	DEF_CONST(GF_FS_SCHEDULER_DIRECT)
+	DEF_CONST(GF_FS_SCHEDULER_WORK_STEAL)
 
 	DEF_CONST(GF_FS_FLAG_LOAD_META)
 	DEF_CONST(GF_FS_FLAG_NON_BLOCKING)
@@ -5563,6 +5564,7 @@ static napi_status InitConstants(napi_env env, napi_value exports)
 	DEF_CONST(GF_FS_FLAG_REQUIRE_SOURCE_ID)
 	DEF_CONST(GF_FS_FLAG_FORCE_DEFER_LINK)
 	DEF_CONST(GF_FS_FLAG_PREVENT_PLAY)
+	DEF_CONST(GF_FS_FLAG_NUMA)
 
 	DEF_CONST(GF_FS_ARG_HINT_NORMAL)
 	DEF_CONST(GF_FS_ARG_HINT_ADVANCED)
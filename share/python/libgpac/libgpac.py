@@ -630,7 +630,10 @@ class FilterStats(Structure):
 		("codecid", c_int),
 		("last_ts_sent", Fraction64),
 		("last_ts_drop", Fraction64),
-		("last_task_time", c_uint)
+		("last_task_time", c_uint),
+		("nb_tasks_requeued", c_ulonglong),
+		("process_hist", c_void_p),
+		("queue_hist", c_void_p)
 	]
     ## \endcond
 
@@ -1184,6 +1187,9 @@ GF_FS_SCHEDULER_LOCK_FORCE=3
 ##\hideinitializer
 ##see \ref GF_FS_SCHEDULER_DIRECT
 GF_FS_SCHEDULER_DIRECT=4
+##\hideinitializer
+##see \ref GF_FS_SCHEDULER_WORK_STEAL
+GF_FS_SCHEDULER_WORK_STEAL=5
 
 #session flags
 ##\hideinitializer
@@ -1228,6 +1234,9 @@ GF_FS_FLAG_FORCE_DEFER_LINK = 1<<13
 ##\hideinitializer
 #see \ref GF_FS_FLAG_PREVENT_PLAY
 GF_FS_FLAG_PREVENT_PLAY = 1<<14
+##\hideinitializer
+#see \ref GF_FS_FLAG_NUMA
+GF_FS_FLAG_NUMA = 1<<15
 
 ##\hideinitializer
 #see \ref GF_PROP_FORBIDDEN
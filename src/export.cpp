@@ -193,6 +193,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_prompt_get_size) )
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_crc_32) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_crc_32_update) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_gz_compress_payload) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_gz_compress_payload_ex) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_gz_decompress_payload) )
@@ -538,6 +539,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_get_line) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_serialize) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_serialize_root) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_set_node_filter) )
 
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_node_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_xml_dom_node_reset) )
@@ -846,6 +848,8 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_probe_file) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_open) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_close) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_make_sample_hash_index) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_check_sample_hash_index) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_delete) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_write_callback) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_can_access_movie))
@@ -991,6 +995,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_extract_meta_xml) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_extract_meta_item) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_extract_meta_item_mem) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_extract_meta_items_mem) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_get_meta_image_props) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_has_movie) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_has_segment) )
@@ -1138,6 +1143,7 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_remove_sample) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_final_name) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_storage_mode) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_sample_hash_index) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_enable_compression) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_force_64bit_chunk_offset) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_isom_set_interleave_time) )
@@ -2225,6 +2231,8 @@
 /* M3U8 & MPD related functions */
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_new) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_init_from_dom) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_init_from_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_recycle_timeline_entries) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_del) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_m3u8_to_mpd) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_smooth_to_mpd) )
@@ -2235,6 +2243,14 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_m3u8_parse_master_playlist) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write_file) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_segment_timeline_modified) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_segment_timeline_head_removed) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_representation_m3u8_modified) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write_binary_state) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_is_binary_state) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_load_binary_state) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_write_patch) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_mpd_apply_patch) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_get_base_url_count) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_resolve_url) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_mpd_get_duration) )
@@ -2569,6 +2585,9 @@
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_load_destination) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_post_user_task ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_post_user_task_main ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_run_jobs ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_fs_set_thread_cpus ) )
+#pragma comment (linker, EXPORT_SYMBOL(gf_filter_run_jobs ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_post_user_task_delay ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_abort ) )
 #pragma comment (linker, EXPORT_SYMBOL(gf_fs_is_last_task ) )
@@ -319,6 +319,10 @@ GF_Filter *gf_filter_new(GF_FilterSession *fsess, const GF_FilterRegister *freg,
 	filter->max_extra_pids = freg->max_extra_pids;
 	filter->dynamic_filter = is_dynamic_filter ? 1 : 0;
 	filter->require_source_id = (fsess->flags & GF_FS_FLAG_REQUIRE_SOURCE_ID) ? GF_TRUE : GF_FALSE;
+	if (fsess->lat_hist) {
+		GF_SAFEALLOC(filter->process_hist, GF_FilterHistogram);
+		GF_SAFEALLOC(filter->queue_hist, GF_FilterHistogram);
+	}
 
 #ifdef GPAC_HAS_QJS
 	filter->jsval = JS_UNDEFINED;
@@ -801,6 +805,8 @@ void gf_filter_del(GF_Filter *filter)
 		gf_free( (char *) filter->freg->name);
 		gf_free( (void *) filter->freg);
 	}
+	if (filter->process_hist) gf_free(filter->process_hist);
+	if (filter->queue_hist) gf_free(filter->queue_hist);
 	gf_free(filter);
 }
 
@@ -3135,6 +3141,7 @@ static GFINLINE void check_filter_error(GF_Filter *filter, GF_Err e, Bool for_re
 static void gf_filter_process_task(GF_FSTask *task)
 {
 	GF_Err e;
+	u64 process_start;
 	Bool skip_block_mode = GF_FALSE;
 	GF_Filter *filter = task->filter;
 	Bool force_block_state_check=GF_FALSE;
@@ -3248,6 +3255,7 @@ static void gf_filter_process_task(GF_FSTask *task)
 	filter->in_process_callback = GF_TRUE;
 
 	gf_logs_thread_tag(filter, GF_LOG_TAG_FILTER);
+	process_start = filter->process_hist ? gf_sys_clock_high_res() : 0;
 
 #ifdef GPAC_MEMORY_TRACKING
 	if (filter->session->check_allocs)
@@ -3256,6 +3264,8 @@ static void gf_filter_process_task(GF_FSTask *task)
 #endif
 		e = filter->freg->process(filter);
 
+	if (process_start)
+		gf_filter_hist_add(filter->process_hist, gf_sys_clock_high_res() - process_start);
 	gf_logs_thread_untag(filter);
 	filter->in_process_callback = GF_FALSE;
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter %s process done\n", filter->name));
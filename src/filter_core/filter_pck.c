@@ -36,6 +36,26 @@ static void gf_filter_pck_reset_props(GF_FilterPacket *pck, GF_FilterPid *pid)
 	pck->session = pid->filter->session;
 }
 
+//packet property maps are shared when inherited and copied on write: get a private copy before modifying a shared map
+static GF_Err gf_filter_pck_detach_props(GF_FilterPacket *pck, GF_Filter *filter)
+{
+	GF_Err e;
+	GF_PropertyMap *map = pck->props;
+	if (!map || (map->reference_count==1)) return GF_OK;
+
+	pck->props = gf_props_new(filter);
+	if (!pck->props) {
+		pck->props = map;
+		return GF_OUT_OF_MEM;
+	}
+	e = gf_props_merge_property(pck->props, map, NULL, NULL);
+	gf_assert(map->reference_count);
+	if (safe_int_dec(&map->reference_count) == 0) {
+		gf_props_del(map);
+	}
+	return e;
+}
+
 GF_EXPORT
 GF_Err gf_filter_pck_merge_properties_filter(GF_FilterPacket *pck_src, GF_FilterPacket *pck_dst, gf_filter_prop_filter filter_prop, void *cbk)
 {
@@ -59,10 +79,19 @@ GF_Err gf_filter_pck_merge_properties_filter(GF_FilterPacket *pck_src, GF_Filter
 	if (!pck_src->props || (!pck_dst->pid && !pck_src->pid)) {
 		return GF_OK;
 	}
+	//inherit all properties: share the source map
+	if (!pck_dst->props && !filter_prop) {
+		pck_dst->props = pck_src->props;
+		safe_int_inc(&pck_dst->props->reference_count);
+		return GF_OK;
+	}
 	if (!pck_dst->props) {
 		pck_dst->props = gf_props_new(pck_dst->pid ? pck_dst->pid->filter : pck_src->pid->filter);
 
 		if (!pck_dst->props) return GF_OUT_OF_MEM;
+	} else {
+		GF_Err e = gf_filter_pck_detach_props(pck_dst, pck_dst->pid ? pck_dst->pid->filter : pck_src->pid->filter);
+		if (e) return e;
 	}
 	return gf_props_merge_property(pck_dst->props, pck_src->props, filter_prop, cbk);
 }
@@ -99,6 +128,259 @@ static void pck_queue_enum(void *udta, void *item)
 	else if (enum_state->closest->alloc_size < cur->alloc_size) enum_state->closest = cur;
 }
 
+//size class for an allocation request, rounded up - returns -1 if too large
+static s32 pck_pool_alloc_class(u32 size)
+{
+	u32 p, base, sub;
+	if (size<=GF_PCK_POOL_MIN_SIZE) return 0;
+	p = gf_get_bit_size(size) - 1;
+	base = 1<<p;
+	sub = (size - base + (base/4) - 1) / (base/4);
+	if (sub==4) {
+		p++;
+		sub = 0;
+	}
+	p = (p-8)*4 + sub;
+	if (p>=GF_PCK_POOL_NB_CLASSES) return -1;
+	return (s32) p;
+}
+//size class of an allocated block, rounded down - returns -1 if not poolable
+static s32 pck_pool_block_class(u32 size)
+{
+	u32 p, base;
+	if (size<GF_PCK_POOL_MIN_SIZE) return -1;
+	p = gf_get_bit_size(size) - 1;
+	base = 1<<p;
+	p = (p-8)*4 + (size - base) / (base/4);
+	if (p>=GF_PCK_POOL_NB_CLASSES) return -1;
+	return (s32) p;
+}
+static u32 pck_pool_class_size(u32 c)
+{
+	u32 base = GF_PCK_POOL_MIN_SIZE << (c>>2);
+	return base + (base/4) * (c&3);
+}
+
+GF_PckPool *gf_fs_pck_pool_new(GF_FilterSession *fsess, u64 max_bytes)
+{
+	u32 i;
+	GF_PckPool *pool;
+	GF_SAFEALLOC(pool, GF_PckPool);
+	if (!pool) return NULL;
+	pool->max_bytes = max_bytes;
+	//blocks are kept on the node of the thread which allocated them
+	pool->nb_nodes = fsess->numa_aware ? fsess->nb_numa_nodes : 1;
+	pool->free_blocks = gf_malloc(sizeof(pool->free_blocks[0]) * pool->nb_nodes);
+	pool->nb_caches = 1 + gf_list_count(fsess->threads);
+	pool->caches = gf_malloc(sizeof(GF_PckPoolCache) * pool->nb_caches);
+	pool->mx = gf_mx_new("PacketPool");
+	if (!pool->free_blocks || !pool->caches || !pool->mx) {
+		gf_fs_pck_pool_del(pool);
+		return NULL;
+	}
+	memset(pool->free_blocks, 0, sizeof(pool->free_blocks[0]) * pool->nb_nodes);
+	memset(pool->caches, 0, sizeof(GF_PckPoolCache) * pool->nb_caches);
+	fsess->main_th.pck_cache_idx = 0;
+	for (i=1; i<pool->nb_caches; i++) {
+		GF_SessionThread *sess_th = gf_list_get(fsess->threads, i-1);
+		sess_th->pck_cache_idx = i;
+	}
+	gf_fs_pck_pool_set_nodes(pool, fsess);
+	return pool;
+}
+
+void gf_fs_pck_pool_set_nodes(GF_PckPool *pool, GF_FilterSession *fsess)
+{
+	u32 i;
+	if (pool->nb_nodes<=1) return;
+	pool->caches[0].node = fsess->main_th.numa_node;
+	for (i=1; i<pool->nb_caches; i++) {
+		GF_SessionThread *sess_th = gf_list_get(fsess->threads, i-1);
+		pool->caches[i].node = sess_th->numa_node;
+	}
+}
+
+void gf_fs_pck_pool_del(GF_PckPool *pool)
+{
+	u32 i, j;
+	if (!pool) return;
+	for (i=0; i<GF_PCK_POOL_NB_CLASSES; i++) {
+		for (j=0; pool->free_blocks && (j<pool->nb_nodes); j++) {
+			while (pool->free_blocks[j][i]) {
+				void *next = *(void **) pool->free_blocks[j][i];
+				gf_free(pool->free_blocks[j][i]);
+				pool->free_blocks[j][i] = next;
+			}
+		}
+		for (j=0; pool->caches && (j<pool->nb_caches); j++) {
+			while (pool->caches[j].nb_blocks[i]) {
+				pool->caches[j].nb_blocks[i]--;
+				gf_free(pool->caches[j].blocks[i][pool->caches[j].nb_blocks[i]]);
+			}
+		}
+	}
+	if (pool->free_blocks) gf_free(pool->free_blocks);
+	if (pool->caches) gf_free(pool->caches);
+	if (pool->mx) gf_mx_del(pool->mx);
+	gf_free(pool);
+}
+
+//get cache for calling thread, NULL if not a session thread
+static GF_PckPoolCache *pck_pool_get_cache(GF_FilterSession *fsess)
+{
+	GF_SessionThread *sess_th = gf_fs_get_current_thread(fsess);
+	if (!sess_th) return NULL;
+	return &fsess->pck_pool->caches[sess_th->pck_cache_idx];
+}
+
+static u8 *pck_pool_alloc(GF_FilterSession *fsess, u32 size, u32 *alloc_size, u8 *node, Bool *is_hit)
+{
+	u8 *block = NULL;
+	GF_PckPool *pool = fsess->pck_pool;
+	GF_PckPoolCache *cache;
+	s32 c = pck_pool_alloc_class(size);
+
+	*is_hit = GF_FALSE;
+	*node = 0;
+	if (c<0) {
+		*alloc_size = size;
+		return gf_malloc(size);
+	}
+	*alloc_size = pck_pool_class_size(c);
+	cache = pck_pool_get_cache(fsess);
+	if (cache) {
+		*node = cache->node;
+		cache->stats.nb_requests++;
+		if (cache->nb_blocks[c]) {
+			cache->nb_blocks[c]--;
+			block = cache->blocks[c][cache->nb_blocks[c]];
+			cache->stats.nb_hits++;
+		}
+	}
+	if (!block) {
+		gf_mx_p(pool->mx);
+		if (!cache) pool->stats.nb_requests++;
+		block = pool->free_blocks[*node][c];
+		if (block) {
+			pool->free_blocks[*node][c] = *(void **) block;
+			pool->stats.nb_hits++;
+		}
+		gf_mx_v(pool->mx);
+	}
+	if (!block) return gf_malloc(*alloc_size);
+
+	safe_int64_sub(&pool->bytes_held, *alloc_size);
+	*is_hit = GF_TRUE;
+	return block;
+}
+
+static void pck_pool_release(GF_FilterSession *fsess, u8 *block, u32 alloc_size, u32 node)
+{
+	GF_PckPool *pool = fsess->pck_pool;
+	GF_PckPoolCache *cache;
+	u64 held;
+	s32 c = pck_pool_block_class(alloc_size);
+
+	cache = (c>=0) ? pck_pool_get_cache(fsess) : NULL;
+	if (cache) cache->stats.nb_releases++;
+	if (c<0) {
+		gf_free(block);
+		return;
+	}
+	alloc_size = pck_pool_class_size(c);
+	held = safe_int64_fetch_add(&pool->bytes_held, alloc_size) + alloc_size;
+	//over memory ceiling
+	if (held > pool->max_bytes) {
+		safe_int64_sub(&pool->bytes_held, alloc_size);
+		gf_free(block);
+		if (cache) cache->stats.nb_drops++;
+		else {
+			gf_mx_p(pool->mx);
+			pool->stats.nb_drops++;
+			gf_mx_v(pool->mx);
+		}
+		return;
+	}
+	if (held > pool->peak_bytes) pool->peak_bytes = held;
+
+	//only cache blocks allocated on the node of this thread
+	if (cache && (cache->node==node) && (cache->nb_blocks[c] < GF_PCK_POOL_TH_CACHE)) {
+		cache->blocks[c][cache->nb_blocks[c]] = block;
+		cache->nb_blocks[c]++;
+		return;
+	}
+	if (node >= pool->nb_nodes) node = 0;
+	gf_mx_p(pool->mx);
+	if (!cache) pool->stats.nb_releases++;
+	*(void **) block = pool->free_blocks[node][c];
+	pool->free_blocks[node][c] = block;
+	gf_mx_v(pool->mx);
+}
+
+void gf_fs_pck_pool_print_stats(GF_FilterSession *fsess)
+{
+	u32 i;
+	GF_PckPoolStats st;
+	GF_PckPool *pool = fsess->pck_pool;
+	if (!pool) return;
+
+	st = pool->stats;
+	for (i=0; i<pool->nb_caches; i++) {
+		st.nb_requests += pool->caches[i].stats.nb_requests;
+		st.nb_hits += pool->caches[i].stats.nb_hits;
+		st.nb_reallocs_avoided += pool->caches[i].stats.nb_reallocs_avoided;
+		st.nb_releases += pool->caches[i].stats.nb_releases;
+		st.nb_drops += pool->caches[i].stats.nb_drops;
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("Packet pool: "LLU" requests, "LLU" hits (%.02f %%) - "LLU" reallocs avoided - "LLU" releases "LLU" drops\n",
+		st.nb_requests, st.nb_hits, st.nb_requests ? ((Double) st.nb_hits) * 100 / st.nb_requests : 0.0,
+		st.nb_reallocs_avoided, st.nb_releases, st.nb_drops));
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t"LLU" bytes held ("LLU" peak) - max "LLU" bytes\n", pool->bytes_held, pool->peak_bytes, pool->max_bytes));
+}
+
+static GF_FilterPacket *gf_filter_pck_new_alloc_pool(GF_FilterPid *pid, u32 data_size, u8 **data)
+{
+	Bool is_hit;
+	u32 alloc_size, prev_size = 0;
+	GF_FilterSession *fsess = pid->filter->session;
+	GF_FilterPacket *pck = gf_fq_pop(pid->filter->pcks_alloc_reservoir);
+
+	if (pck) {
+		//data is normally already in pool, but filter destruction may have left some
+		if (pck->data) gf_free(pck->data);
+		prev_size = pck->alloc_size;
+	} else {
+		GF_SAFEALLOC(pck, GF_FilterPacket);
+		if (!pck) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to allocate new packet on PID %s of filter %s\n", pid->name, pid->filter->name));
+			return NULL;
+		}
+	}
+	pck->data = pck_pool_alloc(fsess, data_size, &alloc_size, &pck->pool_node, &is_hit);
+	if (!pck->data) {
+		gf_free(pck);
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to allocate new packet on PID %s of filter %s\n", pid->name, pid->filter->name));
+		return NULL;
+	}
+	pck->alloc_size = alloc_size;
+	//a recycled packet too small for the request would have been reallocated
+	if (is_hit && prev_size && (prev_size < data_size)) {
+		GF_PckPoolCache *cache = pck_pool_get_cache(fsess);
+		if (cache) cache->stats.nb_reallocs_avoided++;
+	}
+#ifdef GPAC_MEMORY_TRACKING
+	if (!is_hit) fsess->nb_alloc_pck++;
+#endif
+
+	pck->pck = pck;
+	pck->data_length = data_size;
+	if (data) *data = pck->data;
+	pck->filter_owns_mem = 0;
+
+	gf_filter_pck_reset_props(pck, pid);
+	return pck;
+}
+
 static GF_FilterPacket *gf_filter_pck_new_alloc_internal(GF_FilterPid *pid, u32 data_size, u8 **data)
 {
 	GF_FilterPacket *pck=NULL;
@@ -109,6 +391,8 @@ static GF_FilterPacket *gf_filter_pck_new_alloc_internal(GF_FilterPid *pid, u32
 		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Attempt to allocate a packet on an input PID in filter %s\n", pid->filter->name));
 		return NULL;
 	}
+	if (pid->filter->session->pck_pool)
+		return gf_filter_pck_new_alloc_pool(pid, data_size, data);
 
 	count = gf_fq_count(pid->filter->pcks_alloc_reservoir);
 
@@ -704,6 +988,11 @@ void gf_filter_packet_destroy(GF_FilterPacket *pck)
 			gf_free(pck);
 		}
 	} else {
+		//give back payload to session pool, keeping last size in alloc_size
+		if (pid->filter && pck->data && pid->filter->session->pck_pool) {
+			pck_pool_release(pid->filter->session, pck->data, pck->alloc_size, pck->pool_node);
+			pck->data = NULL;
+		}
 		if (!pid->filter || gf_fq_res_add(pid->filter->pcks_alloc_reservoir, pck)) {
 			if (pck->data) gf_free(pck->data);
 			gf_free(pck);
@@ -853,6 +1142,21 @@ void gf_filter_pck_discard(GF_FilterPacket *pck)
 	}
 }
 
+//update buffer occupancy of output pid after dispatching to the given destination, tasks mutex of the pid filter must be locked
+static void gf_filter_pck_update_buffer_level(GF_FilterPid *pid, GF_FilterPidInst *dst, u64 us_duration)
+{
+	u32 nb_pck = gf_fq_count(dst->packets);
+	//update buffer occupancy before dispatching the task - if target pid is processed before we are done disptching his packet, pid buffer occupancy
+	//will be updated during packet drop of target
+	if (pid->nb_buffer_unit < nb_pck) pid->nb_buffer_unit = nb_pck;
+	if ((s64) pid->buffer_duration < dst->buffer_duration) pid->buffer_duration = dst->buffer_duration;
+	//if computed duration of packet is larger than pid max_buffer_time, update
+	//this is to make sure playback at speed > 1 won't trigger blocking state
+	//otherwise we would have max_buffer_time=1ms (default) and a single AU dispatched would block unless speed is AU_DUR_ms/1ms ...
+	if (us_duration && pid->max_buffer_time && (pid->max_buffer_time<us_duration))
+		pid->max_buffer_time = us_duration;
+}
+
 GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 {
 	u32 i, count, nb_dispatch=0;
@@ -1132,8 +1436,11 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 
 	gf_assert(pck->pid);
 	count = pck->pid->num_destinations;
+	if (pid->filter->session->trace_file)
+		gf_fs_trace(pid->filter->session, NULL, GF_FS_TRACE_SEND, 0, pid->filter->name, pid->name);
 	//check if processing this packet must be done on main thread (OpenGL interface or source filter asked for this)
 	Bool force_main_thread = (pck->info.flags & GF_PCKF_FORCE_MAIN) ? GF_TRUE : GF_FALSE;
+	pck->dispatch_time = pid->filter->session->lat_hist ? gf_sys_clock_high_res() : 0;
 
 	for (i=0; i<count; i++) {
 		Bool post_task=GF_FALSE;
@@ -1279,17 +1586,9 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 					inst->pck->reference = NULL;
 					inst->pck->destructor = NULL;
 					inst->pck->frame_ifce = NULL;
-					if (pck->props) {
-						GF_Err e;
-						inst->pck->props = gf_props_new(pck->pid->filter);
-						if (inst->pck->props) {
-							e = gf_props_merge_property(inst->pck->props, pck->props, NULL, NULL);
-						} else {
-							e = GF_OUT_OF_MEM;
-						}
-						if (e) {
-							GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Filter %s: failed to copy properties for cloned packet: %s\n", pid->filter->name, gf_error_to_string(e) ));
-						}
+					//properties are shared with the source packet and copied on write
+					if (inst->pck->props) {
+						safe_int_inc(&inst->pck->props->reference_count);
 					}
 					if (inst->pck->pid_props) {
 						safe_int_inc(&inst->pck->pid_props->reference_count);
@@ -1339,20 +1638,17 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 				pid->filter->in_eos_resume = GF_FALSE;
 			}
 
+			//batch send, buffer levels and task are updated once at the end of the batch
+			if (pid->in_batch) {
+				dst->batch_post = GF_TRUE;
+				if (pid->batch_us_duration < us_duration) pid->batch_us_duration = us_duration;
+				continue;
+			}
+
 			//make sure we lock the tasks mutex before getting the packet count, otherwise we might end up with a wrong number of packets
 			//if one thread consumes one packet while the dispatching thread  (the caller here) is still updating the state for that pid
 			gf_mx_p(pid->filter->tasks_mx);
-			u32 nb_pck = gf_fq_count(dst->packets);
-			//update buffer occupancy before dispatching the task - if target pid is processed before we are done disptching his packet, pid buffer occupancy
-			//will be updated during packet drop of target
-			if (pid->nb_buffer_unit < nb_pck) pid->nb_buffer_unit = nb_pck;
-			if ((s64) pid->buffer_duration < dst->buffer_duration) pid->buffer_duration = dst->buffer_duration;
-			//if computed duration of packet is larger than pid max_buffer_time, update
-			//this is to make sure playback at speed > 1 won't trigger blocking state
-			//otherwise we would have max_buffer_time=1ms (default) and a single AU dispatched would block unless speed is AU_DUR_ms/1ms ...
-			if (us_duration && pid->max_buffer_time && (pid->max_buffer_time<us_duration))
-				pid->max_buffer_time = us_duration;
-
+			gf_filter_pck_update_buffer_level(pid, dst, us_duration);
 			gf_mx_v(pid->filter->tasks_mx);
 
 			//post process task
@@ -1368,7 +1664,8 @@ GF_Err gf_filter_pck_send_internal(GF_FilterPacket *pck, Bool from_filter)
 	}
 #endif
 
-	gf_filter_pid_would_block(pid);
+	if (!pid->in_batch)
+		gf_filter_pid_would_block(pid);
 
 	//unprotect the packet now that it is safely dispatched
 	gf_assert(pck->reference_count);
@@ -1406,6 +1703,61 @@ GF_Err gf_filter_pck_send(GF_FilterPacket *pck)
 	return gf_filter_pck_send_internal(pck, GF_TRUE);
 }
 
+GF_EXPORT
+GF_Err gf_filter_pck_send_batch(GF_FilterPacket **pcks, u32 nb_pcks)
+{
+	u32 i, count;
+	GF_Err e = GF_OK;
+	GF_FilterPid *pid;
+
+	if (!pcks || !nb_pcks || !pcks[0] || !pcks[0]->pid) return GF_BAD_PARAM;
+	pid = pcks[0]->pid;
+	for (i=0; i<nb_pcks; i++) {
+		if (!pcks[i] || (pcks[i]->pid != pid) || PCK_IS_INPUT(pcks[i])) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Attempt to batch send packets not belonging to output PID %s of filter %s\n", pid->name, pid->filter->name));
+			return GF_BAD_PARAM;
+		}
+	}
+	if (nb_pcks==1)
+		return gf_filter_pck_send(pcks[0]);
+
+	pid->in_batch = GF_TRUE;
+	pid->batch_us_duration = 0;
+	for (i=0; i<nb_pcks; i++) {
+		//dangling packet
+		if (pcks[i]->is_dangling) {
+			gf_filter_pck_discard(pcks[i]);
+			continue;
+		}
+		if (e) {
+			gf_filter_pck_discard(pcks[i]);
+			continue;
+		}
+		e = gf_filter_pck_send_internal(pcks[i], GF_TRUE);
+	}
+	pid->in_batch = GF_FALSE;
+
+	//single buffer level update and process task for each destination
+	count = pid->num_destinations;
+	gf_mx_p(pid->filter->tasks_mx);
+	for (i=0; i<count; i++) {
+		GF_FilterPidInst *dst = gf_list_get(pid->destinations, i);
+		if (dst->batch_post)
+			gf_filter_pck_update_buffer_level(pid, dst, pid->batch_us_duration);
+	}
+	gf_mx_v(pid->filter->tasks_mx);
+
+	for (i=0; i<count; i++) {
+		GF_FilterPidInst *dst = gf_list_get(pid->destinations, i);
+		if (!dst->batch_post) continue;
+		dst->batch_post = GF_FALSE;
+		if (!dst->filter) continue;
+		gf_filter_post_process_task_internal(dst->filter, pid->direct_dispatch);
+	}
+	gf_filter_pid_would_block(pid);
+	return e;
+}
+
 GF_EXPORT
 GF_Err gf_filter_pck_ref(GF_FilterPacket **pck)
 {
@@ -1510,7 +1862,7 @@ const u8 *gf_filter_pck_get_data(GF_FilterPacket *pck, u32 *size)
 
 static GF_Err gf_filter_pck_set_property_full(GF_FilterPacket *pck, u32 prop_4cc, const char *prop_name, char *dyn_name, const GF_PropertyValue *value)
 {
-	u32 hash;
+	u32 key;
 	gf_assert(pck);
 	gf_assert(pck->pid);
 	if (PCK_IS_INPUT(pck)) {
@@ -1546,16 +1898,19 @@ static GF_Err gf_filter_pck_set_property_full(GF_FilterPacket *pck, u32 prop_4cc
 		}
 	}
 
-	hash = gf_props_hash_djb2(prop_4cc, prop_name ? prop_name : dyn_name);
+	key = gf_props_key(prop_4cc, prop_name ? prop_name : dyn_name);
 
 	if (!pck->props) {
 		pck->props = gf_props_new(pck->pid->filter);
+		if (!pck->props) return GF_OUT_OF_MEM;
 	} else {
-		gf_props_remove_property(pck->props, hash, prop_4cc, prop_name ? prop_name : dyn_name);
+		GF_Err e = gf_filter_pck_detach_props(pck, pck->pid->filter);
+		if (e) return e;
+		gf_props_remove_property(pck->props, key, prop_4cc, prop_name ? prop_name : dyn_name);
 	}
 	if (!value) return GF_OK;
 
-	return gf_props_insert_property(pck->props, hash, prop_4cc, prop_name, dyn_name, value);
+	return gf_props_insert_property(pck->props, key, prop_4cc, prop_name, dyn_name, value);
 }
 
 GF_EXPORT
@@ -188,6 +188,8 @@ static void gf_filter_pid_check_unblock(GF_FilterPid *pid)
 		gf_assert(pid->filter->would_block + pid->filter->num_out_pids_not_connected <= pid->filter->num_output_pids);
 
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Filter %s PID %s unblocked (filter has %d blocking pids)\n", pid->pid->filter->name, pid->pid->name, pid->pid->filter->would_block));
+		if (pid->filter->session->trace_file)
+			gf_fs_trace(pid->filter->session, NULL, GF_FS_TRACE_UNBLOCK, 0, pid->filter->name, pid->pid->name);
 
 		//check filter unblock
 		unblock = GF_TRUE;
@@ -3271,6 +3273,568 @@ void reset_bundle_cache(GF_FilterSession *fsess)
 	}
 }
 
+#define GF_LINK_CACHE_MAGIC	GF_4CC('G','F','L','C')
+#define GF_LINK_CACHE_VERSION	1
+//max number of resolved chains kept in cache
+#define GF_LINK_CACHE_MAX_CHAINS	2000
+
+static GFINLINE u64 link_cache_hash(u64 h, const void *data, u32 size)
+{
+	u32 i;
+	const u8 *ptr = data;
+	for (i=0; i<size; i++) {
+		h ^= ptr[i];
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+static u64 link_cache_hash_u32(u64 h, u32 val)
+{
+	return link_cache_hash(h, &val, 4);
+}
+static u64 link_cache_hash_str(u64 h, const char *str)
+{
+	if (!str) return link_cache_hash_u32(h, 0);
+	return link_cache_hash(h, str, (u32) strlen(str) + 1);
+}
+
+static u64 link_cache_hash_prop(u64 h, const GF_PropertyValue *p)
+{
+	u32 i;
+	u32 type = gf_props_get_base_type(p->type);
+	h = link_cache_hash_u32(h, type);
+	switch (type) {
+	case GF_PROP_STRING:
+		return link_cache_hash_str(h, p->value.string);
+	case GF_PROP_DATA:
+		h = link_cache_hash_u32(h, p->value.data.size);
+		if (p->value.data.ptr) h = link_cache_hash(h, p->value.data.ptr, p->value.data.size);
+		return h;
+	case GF_PROP_STRING_LIST:
+		for (i=0; i<p->value.string_list.nb_items; i++)
+			h = link_cache_hash_str(h, p->value.string_list.vals[i]);
+		return h;
+	case GF_PROP_UINT_LIST:
+	case GF_PROP_SINT_LIST:
+		if (p->value.uint_list.vals) h = link_cache_hash(h, p->value.uint_list.vals, sizeof(u32) * p->value.uint_list.nb_items);
+		return h;
+	case GF_PROP_VEC2I_LIST:
+		if (p->value.v2i_list.vals) h = link_cache_hash(h, p->value.v2i_list.vals, sizeof(GF_PropVec2i) * p->value.v2i_list.nb_items);
+		return h;
+	case GF_PROP_POINTER:
+		return h;
+	case GF_PROP_SINT:
+	case GF_PROP_UINT:
+	case GF_PROP_BOOL:
+		return link_cache_hash_u32(h, p->value.uint);
+	case GF_PROP_LSINT:
+	case GF_PROP_LUINT:
+		return link_cache_hash(h, &p->value.longuint, sizeof(u64));
+	case GF_PROP_FRACTION:
+		return link_cache_hash(h, &p->value.frac, sizeof(GF_Fraction));
+	case GF_PROP_FRACTION64:
+		return link_cache_hash(h, &p->value.lfrac, sizeof(GF_Fraction64));
+	case GF_PROP_FLOAT:
+		return link_cache_hash(h, &p->value.fnumber, sizeof(Fixed));
+	case GF_PROP_DOUBLE:
+		return link_cache_hash(h, &p->value.number, sizeof(Double));
+	case GF_PROP_VEC2I:
+		return link_cache_hash(h, &p->value.vec2i, sizeof(GF_PropVec2i));
+	case GF_PROP_VEC2:
+		return link_cache_hash(h, &p->value.vec2, sizeof(GF_PropVec2));
+	case GF_PROP_VEC3I:
+		return link_cache_hash(h, &p->value.vec3i, sizeof(GF_PropVec3i));
+	case GF_PROP_VEC4I:
+		return link_cache_hash(h, &p->value.vec4i, sizeof(GF_PropVec4i));
+	default:
+		return h;
+	}
+}
+
+static u64 link_cache_hash_caps(u64 h, const GF_FilterCapability *caps, u32 nb_caps)
+{
+	u32 i;
+	h = link_cache_hash_u32(h, nb_caps);
+	for (i=0; i<nb_caps; i++) {
+		const GF_FilterCapability *cap = &caps[i];
+		h = link_cache_hash_u32(h, cap->code);
+		h = link_cache_hash_u32(h, cap->flags);
+		h = link_cache_hash_u32(h, cap->priority);
+		h = link_cache_hash_str(h, cap->name);
+		h = link_cache_hash_prop(h, &cap->val);
+	}
+	return h;
+}
+
+//hash of everything the registry graph depends on: build version, registers and their caps
+static u64 link_cache_registry_hash(GF_FilterSession *fsess)
+{
+	u32 i, count = gf_list_count(fsess->registry);
+	u64 h = 0xcbf29ce484222325ULL;
+	h = link_cache_hash_str(h, gf_gpac_version());
+	h = link_cache_hash_u32(h, count);
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+		h = link_cache_hash_str(h, freg->name);
+		h = link_cache_hash_u32(h, freg->flags);
+		h = link_cache_hash_u32(h, (u32) freg->priority);
+		h = link_cache_hash_u32(h, freg->max_extra_pids);
+		h = link_cache_hash_u32(h, (freg->configure_pid ? 1 : 0) | (freg->reconfigure_output ? 2 : 0) );
+		h = link_cache_hash_caps(h, freg->caps, freg->nb_caps);
+	}
+	return h;
+}
+
+static int link_cache_cmp_code(const void *a, const void *b)
+{
+	u32 c1 = *(const u32 *)a;
+	u32 c2 = *(const u32 *)b;
+	return (c1<c2) ? -1 : (c1>c2) ? 1 : 0;
+}
+
+static void link_cache_chain_del(GF_LinkCacheChain *lcc)
+{
+	if (lcc->chain) gf_free(lcc->chain);
+	gf_free(lcc);
+}
+
+static void link_cache_reset_chains(GF_FilterLinkCache *lc)
+{
+	while (gf_list_count(lc->chains)) {
+		link_cache_chain_del(gf_list_pop_back(lc->chains));
+	}
+}
+
+static s32 link_cache_find_chain(GF_FilterLinkCache *lc, u64 key, u32 *insert_idx)
+{
+	s32 lo = 0, hi = (s32) gf_list_count(lc->chains) - 1;
+	while (lo <= hi) {
+		s32 mid = (lo+hi)/2;
+		GF_LinkCacheChain *lcc = gf_list_get(lc->chains, mid);
+		if (lcc->key == key) return mid;
+		if (lcc->key < key) lo = mid+1;
+		else hi = mid-1;
+	}
+	if (insert_idx) *insert_idx = (u32) lo;
+	return -1;
+}
+
+//setup registry hash, cache path and input cap codes for the current registry - returns GF_FALSE if out of memory
+static Bool link_cache_setup(GF_FilterSession *fsess)
+{
+	u32 i, j, count;
+	u32 *codes;
+	char szName[100];
+	const char *cache_dir;
+	GF_FilterLinkCache *lc = fsess->link_cache;
+
+	lc->reg_hash = link_cache_registry_hash(fsess);
+	lc->nb_regs = gf_list_count(fsess->registry);
+	lc->graph_loaded = GF_FALSE;
+	link_cache_reset_chains(lc);
+	lc->chains_dirty = GF_FALSE;
+
+	if (lc->path) gf_free(lc->path);
+	lc->path = NULL;
+	cache_dir = gf_opts_get_key("core", "cache");
+	if (cache_dir && cache_dir[0]) {
+		sprintf(szName, "gpac_links_%016"LLX_SUF".bin", lc->reg_hash);
+		lc->path = gf_strdup(cache_dir);
+		if (!lc->path) return GF_FALSE;
+		if (lc->path[strlen(lc->path)-1] != GF_PATH_SEPARATOR) {
+			char szSep[2] = {GF_PATH_SEPARATOR, 0};
+			gf_dynstrcat(&lc->path, szSep, NULL);
+		}
+		gf_dynstrcat(&lc->path, szName, NULL);
+	}
+
+	//gather all property codes and names checked when matching input caps
+	lc->nb_cap_codes = lc->nb_cap_names = 0;
+	count = gf_list_count(fsess->registry);
+	for (i=0; i<count; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+		for (j=0; j<freg->nb_caps; j++) {
+			const GF_FilterCapability *cap = &freg->caps[j];
+			if (!(cap->flags & GF_CAPFLAG_INPUT)) continue;
+			if (cap->code) {
+				codes = gf_realloc(lc->cap_codes, sizeof(u32) * (lc->nb_cap_codes+1));
+				if (!codes) return GF_FALSE;
+				lc->cap_codes = codes;
+				lc->cap_codes[lc->nb_cap_codes++] = cap->code;
+			}
+			if (cap->name) {
+				u32 k;
+				const char **names;
+				for (k=0; k<lc->nb_cap_names; k++) {
+					if (!strcmp(lc->cap_names[k], cap->name)) break;
+				}
+				if (k<lc->nb_cap_names) continue;
+				names = gf_realloc((void *) lc->cap_names, sizeof(char *) * (lc->nb_cap_names+1));
+				if (!names) return GF_FALSE;
+				lc->cap_names = names;
+				lc->cap_names[lc->nb_cap_names++] = cap->name;
+			}
+		}
+	}
+	//always checked by caps matching
+	codes = gf_realloc(lc->cap_codes, sizeof(u32) * (lc->nb_cap_codes+3));
+	if (!codes) return GF_FALSE;
+	lc->cap_codes = codes;
+	lc->cap_codes[lc->nb_cap_codes++] = GF_PROP_PID_FAKE;
+	lc->cap_codes[lc->nb_cap_codes++] = GF_PROP_PID_MIME;
+	lc->cap_codes[lc->nb_cap_codes++] = GF_PROP_PID_FILE_EXT;
+	qsort(lc->cap_codes, lc->nb_cap_codes, sizeof(u32), link_cache_cmp_code);
+	for (i=1, j=1; i<lc->nb_cap_codes; i++) {
+		if (lc->cap_codes[i] != lc->cap_codes[j-1])
+			lc->cap_codes[j++] = lc->cap_codes[i];
+	}
+	lc->nb_cap_codes = j;
+	return GF_TRUE;
+}
+
+static Bool link_cache_load(GF_FilterSession *fsess)
+{
+	u32 i, j, nb_regs, nb_chains;
+	u64 size;
+	char szVersion[100];
+	GF_FilterRegDesc **descs;
+	GF_BitStream *bs;
+	const u8 *data;
+	Bool ok = GF_FALSE;
+	GF_FilterLinkCache *lc = fsess->link_cache;
+	GF_FileMap *fmap;
+
+	if (!lc->path) return GF_FALSE;
+	fmap = gf_file_map_new(lc->path);
+	if (!fmap) return GF_FALSE;
+	data = gf_file_map_get_data(fmap, &size);
+	bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+	if (!bs) {
+		gf_file_map_unref(fmap);
+		return GF_FALSE;
+	}
+
+	nb_regs = gf_list_count(fsess->registry);
+	descs = gf_malloc(sizeof(GF_FilterRegDesc *) * nb_regs);
+	if (!descs) goto exit;
+	memset(descs, 0, sizeof(GF_FilterRegDesc *) * nb_regs);
+
+	if (gf_bs_read_u32(bs) != GF_LINK_CACHE_MAGIC) goto exit;
+	if (gf_bs_read_u32(bs) != GF_LINK_CACHE_VERSION) goto exit;
+	i = gf_bs_read_u8(bs);
+	gf_bs_read_data(bs, szVersion, i);
+	szVersion[i] = 0;
+	if (strcmp(szVersion, gf_gpac_version())) goto exit;
+	if (gf_bs_read_u64(bs) != lc->reg_hash) goto exit;
+	if (gf_bs_read_u32(bs) != nb_regs) goto exit;
+
+	for (i=0; i<nb_regs; i++) {
+		GF_SAFEALLOC(descs[i], GF_FilterRegDesc);
+		if (!descs[i]) goto exit;
+		descs[i]->freg = gf_list_get(fsess->registry, i);
+	}
+	for (i=0; i<nb_regs; i++) {
+		GF_FilterRegDesc *rdesc = descs[i];
+		rdesc->has_input = gf_bs_read_u8(bs);
+		rdesc->has_output = gf_bs_read_u8(bs);
+		rdesc->nb_bundles = gf_bs_read_u32(bs);
+		rdesc->nb_edges = gf_bs_read_u32(bs);
+		//16 bytes per edge
+		if (gf_bs_available(bs) < (u64) rdesc->nb_edges * 16) goto exit;
+		if (!rdesc->nb_edges) continue;
+		rdesc->nb_alloc_edges = rdesc->nb_edges;
+		rdesc->edges = gf_malloc(sizeof(GF_FilterRegEdge) * rdesc->nb_edges);
+		if (!rdesc->edges) goto exit;
+		memset(rdesc->edges, 0, sizeof(GF_FilterRegEdge) * rdesc->nb_edges);
+		for (j=0; j<rdesc->nb_edges; j++) {
+			GF_FilterRegEdge *edge = &rdesc->edges[j];
+			u32 src_idx = gf_bs_read_u32(bs);
+			if (src_idx >= nb_regs) goto exit;
+			edge->src_reg = descs[src_idx];
+			edge->src_cap_idx = gf_bs_read_u16(bs);
+			edge->dst_cap_idx = gf_bs_read_u16(bs);
+			edge->weight = gf_bs_read_u8(bs);
+			edge->loaded_filter_only = gf_bs_read_u8(bs);
+			edge->priority = (s16) gf_bs_read_u16(bs);
+			edge->src_stream_type = (s32) gf_bs_read_u32(bs);
+		}
+	}
+
+	nb_chains = gf_bs_read_u32(bs);
+	for (i=0; i<nb_chains; i++) {
+		GF_LinkCacheChain *lcc;
+		u64 key = gf_bs_read_u64(bs);
+		u32 nb = gf_bs_read_u32(bs);
+		if (gf_bs_available(bs) < (u64) nb * 8) goto exit;
+		GF_SAFEALLOC(lcc, GF_LinkCacheChain);
+		if (!lcc) goto exit;
+		lcc->key = key;
+		lcc->nb_regs = nb;
+		if (nb) {
+			lcc->chain = gf_malloc(sizeof(u32) * 2 * nb);
+			if (!lcc->chain) {
+				gf_free(lcc);
+				goto exit;
+			}
+			for (j=0; j<2*nb; j++)
+				lcc->chain[j] = gf_bs_read_u32(bs);
+			for (j=0; j<nb; j++) {
+				if (lcc->chain[2*j] >= nb_regs) break;
+			}
+		}
+		//chains are written sorted
+		if ((j<nb) || (link_cache_find_chain(lc, key, NULL)>=0)) {
+			link_cache_chain_del(lcc);
+			continue;
+		}
+		gf_list_add(lc->chains, lcc);
+	}
+	if (gf_bs_is_overflow(bs)) goto exit;
+
+	for (i=0; i<nb_regs; i++) {
+		gf_list_add(fsess->links, descs[i]);
+		descs[i] = NULL;
+	}
+	ok = GF_TRUE;
+
+exit:
+	if (!ok) {
+		GF_LOG(GF_LOG_INFO, GF_LOG_FILTER, ("[Filters] Ignoring invalid link cache %s\n", lc->path));
+		link_cache_reset_chains(lc);
+	}
+	if (descs) {
+		for (i=0; i<nb_regs; i++) {
+			if (!descs[i]) continue;
+			if (descs[i]->edges) gf_free(descs[i]->edges);
+			gf_free(descs[i]);
+		}
+		gf_free(descs);
+	}
+	gf_bs_del(bs);
+	gf_file_map_unref(fmap);
+	return ok;
+}
+
+static void link_cache_write(GF_FilterSession *fsess)
+{
+	u32 i, j, nb_regs, size;
+	u8 *data = NULL;
+	char *tmp_path;
+	char szPID[50];
+	FILE *f;
+	GF_BitStream *bs;
+	GF_FilterLinkCache *lc = fsess->link_cache;
+	if (!lc->path) return;
+
+	//only write graphs built in registry order
+	nb_regs = gf_list_count(fsess->links);
+	if ((nb_regs != lc->nb_regs) || (nb_regs != gf_list_count(fsess->registry)))
+		return;
+	for (i=0; i<nb_regs; i++) {
+		GF_FilterRegDesc *rdesc = gf_list_get(fsess->links, i);
+		if (rdesc->freg != gf_list_get(fsess->registry, i)) return;
+	}
+
+	bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	if (!bs) return;
+	gf_bs_write_u32(bs, GF_LINK_CACHE_MAGIC);
+	gf_bs_write_u32(bs, GF_LINK_CACHE_VERSION);
+	size = (u32) strlen(gf_gpac_version());
+	if (size>99) size = 99;
+	gf_bs_write_u8(bs, size);
+	gf_bs_write_data(bs, gf_gpac_version(), size);
+	gf_bs_write_u64(bs, lc->reg_hash);
+	gf_bs_write_u32(bs, nb_regs);
+	for (i=0; i<nb_regs; i++) {
+		GF_FilterRegDesc *rdesc = gf_list_get(fsess->links, i);
+		gf_bs_write_u8(bs, rdesc->has_input);
+		gf_bs_write_u8(bs, rdesc->has_output);
+		gf_bs_write_u32(bs, rdesc->nb_bundles);
+		gf_bs_write_u32(bs, rdesc->nb_edges);
+		for (j=0; j<rdesc->nb_edges; j++) {
+			GF_FilterRegEdge *edge = &rdesc->edges[j];
+			gf_bs_write_u32(bs, gf_list_find(fsess->links, edge->src_reg));
+			gf_bs_write_u16(bs, edge->src_cap_idx);
+			gf_bs_write_u16(bs, edge->dst_cap_idx);
+			gf_bs_write_u8(bs, edge->weight);
+			gf_bs_write_u8(bs, edge->loaded_filter_only);
+			gf_bs_write_u16(bs, (u16) edge->priority);
+			gf_bs_write_u32(bs, (u32) edge->src_stream_type);
+		}
+	}
+	gf_bs_write_u32(bs, gf_list_count(lc->chains));
+	for (i=0; i<gf_list_count(lc->chains); i++) {
+		GF_LinkCacheChain *lcc = gf_list_get(lc->chains, i);
+		gf_bs_write_u64(bs, lcc->key);
+		gf_bs_write_u32(bs, lcc->nb_regs);
+		for (j=0; j<2*lcc->nb_regs; j++)
+			gf_bs_write_u32(bs, lcc->chain[j]);
+	}
+	gf_bs_get_content(bs, &data, &size);
+	gf_bs_del(bs);
+	if (!data) return;
+
+	//write to temp file and move, concurrent sessions may read or write the same cache
+	sprintf(szPID, ".%u.tmp", gf_sys_get_process_id());
+	tmp_path = gf_strdup(lc->path);
+	gf_dynstrcat(&tmp_path, szPID, NULL);
+	f = gf_fopen(tmp_path, "wb");
+	if (f) {
+		Bool write_ok = (gf_fwrite(data, size, f) == size) ? GF_TRUE : GF_FALSE;
+		gf_fclose(f);
+		if (write_ok && (gf_file_move(tmp_path, lc->path) != GF_OK)) {
+			gf_file_delete(lc->path);
+			write_ok = (gf_file_move(tmp_path, lc->path) == GF_OK) ? GF_TRUE : GF_FALSE;
+		}
+		if (!write_ok) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Filters] Failed to write link cache %s\n", lc->path));
+			gf_file_delete(tmp_path);
+		}
+	}
+	lc->chains_dirty = GF_FALSE;
+	gf_free(tmp_path);
+	gf_free(data);
+}
+
+GF_FilterLinkCache *gf_fs_link_cache_new(GF_FilterSession *fsess)
+{
+	GF_FilterLinkCache *lc;
+	GF_SAFEALLOC(lc, GF_FilterLinkCache);
+	if (!lc) return NULL;
+	lc->chains = gf_list_new();
+	if (!lc->chains) {
+		gf_free(lc);
+		return NULL;
+	}
+	return lc;
+}
+
+void gf_fs_link_cache_del(GF_FilterSession *fsess)
+{
+	GF_FilterLinkCache *lc = fsess->link_cache;
+	if (!lc) return;
+	if (lc->chains_dirty)
+		link_cache_write(fsess);
+	link_cache_reset_chains(lc);
+	gf_list_del(lc->chains);
+	if (lc->cap_codes) gf_free(lc->cap_codes);
+	if (lc->cap_names) gf_free((void *) lc->cap_names);
+	if (lc->path) gf_free(lc->path);
+	gf_free(lc);
+	fsess->link_cache = NULL;
+}
+
+void gf_fs_link_cache_print_stats(GF_FilterSession *fsess)
+{
+	GF_FilterLinkCache *lc = fsess->link_cache;
+	if (!lc) return;
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("Link cache %s\n", lc->path ? lc->path : "disabled (no cache directory)"));
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tregistry graph %s in "LLU" us\n", lc->graph_loaded ? "loaded from cache" : "built", lc->graph_time_us));
+	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t%u links resolved in "LLU" us - %u links from cache in "LLU" us\n", lc->nb_resolved, lc->resolve_time_us, lc->nb_cache_hits, lc->cache_time_us));
+}
+
+//computes key of resolved chain, or 0 if resolution cannot be cached
+static u64 link_cache_chain_key(GF_FilterPid *pid, GF_Filter *dst, const char *prefRegister, Bool reconfigurable_only, GF_List *tmp_blacklist, GF_LinkInfo *link_info)
+{
+	u32 i;
+	u64 h;
+	const GF_PropertyValue *p;
+	GF_FilterSession *fsess = pid->filter->session;
+	GF_FilterLinkCache *lc = fsess->link_cache;
+
+	if (!lc || !lc->nb_regs || (gf_list_count(fsess->registry) != lc->nb_regs)) return 0;
+	//resolutions depending on session state other than PID properties are not cached
+	if (reconfigurable_only || tmp_blacklist || link_info || prefRegister[0]) return 0;
+	if (gf_list_count(pid->filter->blacklisted) || pid->adapters_blacklist) return 0;
+	if (pid->caps_negotiate || dst->encoder_codec_id || (dst->bundle_idx_at_resolution>=0)) return 0;
+	if ((dst->freg->flags | pid->filter->freg->flags) & (GF_FS_REG_SCRIPT|GF_FS_REG_CUSTOM)) return 0;
+
+	h = 0xcbf29ce484222325ULL;
+	h = link_cache_hash_str(h, pid->filter->freg->name);
+	h = link_cache_hash_str(h, dst->freg->name);
+	h = link_cache_hash_u32(h, fsess->max_resolve_chain_len);
+	h = link_cache_hash_u32(h, pid->ext_not_trusted);
+	//destination caps may be restricted by its arguments, eg output file extension
+	if (dst->forced_caps) {
+		h = link_cache_hash_u32(h, dst->nb_forced_bundles);
+		h = link_cache_hash_caps(h, dst->forced_caps, dst->nb_forced_caps);
+	} else {
+		h = link_cache_hash_u32(h, 0);
+	}
+	if (pid->filter->dst_filter) {
+		h = link_cache_hash_u32(h, (pid->filter->dst_filter==dst) ? 1 : 2);
+		h = link_cache_hash_str(h, pid->filter->dst_filter->freg->name);
+	} else {
+		h = link_cache_hash_u32(h, 0);
+	}
+	p = gf_filter_pid_get_property(pid, GF_PROP_PID_STREAM_TYPE);
+	h = p ? link_cache_hash_prop(h, p) : link_cache_hash_u32(h, 0);
+
+	for (i=0; i<lc->nb_cap_codes; i++) {
+		p = gf_filter_pid_get_property_first(pid, lc->cap_codes[i]);
+		if (!p) continue;
+		h = link_cache_hash_u32(h, lc->cap_codes[i]);
+		h = link_cache_hash_prop(h, p);
+	}
+	for (i=0; i<lc->nb_cap_names; i++) {
+		p = gf_filter_pid_get_property_str_first(pid, lc->cap_names[i]);
+		if (!p) continue;
+		h = link_cache_hash_str(h, lc->cap_names[i]);
+		h = link_cache_hash_prop(h, p);
+	}
+	return h ? h : 1;
+}
+
+static Bool link_cache_get_chain(GF_FilterSession *fsess, u64 key, GF_List *out_reg_chain)
+{
+	u32 i;
+	GF_LinkCacheChain *lcc;
+	s32 idx = link_cache_find_chain(fsess->link_cache, key, NULL);
+	if (idx<0) return GF_FALSE;
+	lcc = gf_list_get(fsess->link_cache->chains, idx);
+	for (i=0; i<lcc->nb_regs; i++) {
+		const GF_FilterRegister *freg = gf_list_get(fsess->registry, lcc->chain[2*i]);
+		gf_list_add(out_reg_chain, (void *) freg);
+		gf_list_add(out_reg_chain, (void *) &freg->caps[lcc->chain[2*i+1]]);
+	}
+	return GF_TRUE;
+}
+
+static void link_cache_add_chain(GF_FilterSession *fsess, u64 key, GF_List *out_reg_chain, u32 first_idx)
+{
+	u32 i, insert_idx=0, count = gf_list_count(out_reg_chain);
+	GF_LinkCacheChain *lcc;
+	GF_FilterLinkCache *lc = fsess->link_cache;
+
+	if (gf_list_count(lc->chains) >= GF_LINK_CACHE_MAX_CHAINS) return;
+	if (link_cache_find_chain(lc, key, &insert_idx) >= 0) return;
+
+	GF_SAFEALLOC(lcc, GF_LinkCacheChain);
+	if (!lcc) return;
+	lcc->key = key;
+	lcc->nb_regs = (count - first_idx) / 2;
+	if (lcc->nb_regs) {
+		lcc->chain = gf_malloc(sizeof(u32) * 2 * lcc->nb_regs);
+		if (!lcc->chain) {
+			gf_free(lcc);
+			return;
+		}
+	}
+	for (i=0; i<lcc->nb_regs; i++) {
+		const GF_FilterRegister *freg = gf_list_get(out_reg_chain, first_idx + 2*i);
+		const GF_FilterCapability *cap = gf_list_get(out_reg_chain, first_idx + 2*i + 1);
+		s32 reg_idx = gf_list_find(fsess->registry, (void *) freg);
+		if (reg_idx<0) {
+			link_cache_chain_del(lcc);
+			return;
+		}
+		lcc->chain[2*i] = (u32) reg_idx;
+		lcc->chain[2*i+1] = (u32) (cap - freg->caps);
+	}
+	gf_list_insert(lc->chains, lcc, insert_idx);
+	lc->chains_dirty = GF_TRUE;
+}
+
 void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister *for_reg)
 {
 	u32 i, count;
@@ -3284,21 +3848,39 @@ void gf_filter_sess_build_graph(GF_FilterSession *fsess, const GF_FilterRegister
 		} else {
 			gf_list_add(fsess->links, freg_desc);
 		}
+		//registry changed, cached chains no longer valid
+		if (fsess->link_cache) fsess->link_cache->nb_regs = 0;
 	} else {
-#ifndef GPAC_DISABLE_LOG
+		Bool loaded = GF_FALSE;
 		u64 start_time = gf_sys_clock_high_res();
-#endif
-		count = gf_list_count(fsess->registry);
-		for (i=0; i<count; i++) {
-			const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
-			GF_FilterRegDesc *freg_desc = gf_filter_reg_build_graph(fsess->links, freg, NULL, NULL, 0);
-			if (!freg_desc) {
-				GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to build graph entry for filter %s\n", freg->name));
+
+		if (fsess->link_cache && !gf_list_count(fsess->links)) {
+			if (!fsess->link_cache->reg_hash && !link_cache_setup(fsess)) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("No more memory to setup link cache, disabling it\n"));
+				gf_fs_link_cache_del(fsess);
 			} else {
-				gf_list_add(fsess->links, freg_desc);
+				loaded = link_cache_load(fsess);
+			}
+		}
+		if (!loaded) {
+			count = gf_list_count(fsess->registry);
+			for (i=0; i<count; i++) {
+				const GF_FilterRegister *freg = gf_list_get(fsess->registry, i);
+				GF_FilterRegDesc *freg_desc = gf_filter_reg_build_graph(fsess->links, freg, NULL, NULL, 0);
+				if (!freg_desc) {
+					GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Failed to build graph entry for filter %s\n", freg->name));
+				} else {
+					gf_list_add(fsess->links, freg_desc);
+				}
 			}
+			if (fsess->link_cache && fsess->link_cache->nb_regs)
+				link_cache_write(fsess);
+		}
+		if (fsess->link_cache) {
+			fsess->link_cache->graph_loaded = loaded;
+			fsess->link_cache->graph_time_us = gf_sys_clock_high_res() - start_time;
 		}
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Built filter graph in "LLU" us\n", gf_sys_clock_high_res() - start_time));
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("%s filter graph in "LLU" us\n", loaded ? "Loaded" : "Built", gf_sys_clock_high_res() - start_time));
 
 		if (fsess->flags & GF_FS_FLAG_PRINT_CONNECTIONS) {
 			u32 j;
@@ -3321,6 +3903,7 @@ void gf_filter_sess_reset_graph(GF_FilterSession *fsess, const GF_FilterRegister
 	gf_mx_p(fsess->links_mx);
 	//explicit registry removal and not destroying the session
 	if (freg && fsess->filters) {
+		if (fsess->link_cache) fsess->link_cache->nb_regs = 0;
 		s32 reg_idx=-1;
 		u32 i, count = gf_list_count(fsess->links);
 		for (i=0; i<count; i++) {
@@ -3428,9 +4011,21 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	u32 path_weight, pid_stream_type, max_weight=0;
 	u64 dijkstra_time_us, sort_time_us, start_time_us = gf_sys_clock_high_res();
 	const GF_PropertyValue *p;
+	u64 cache_key = 0;
+	u32 first_chain_idx = gf_list_count(out_reg_chain);
 	if (!fsess->links || ! gf_list_count( fsess->links))
 	 	gf_filter_sess_build_graph(fsess, NULL);
 
+	if (fsess->link_cache) {
+		cache_key = link_cache_chain_key(pid, dst, prefRegister, reconfigurable_only, tmp_blacklist, link_info);
+		if (cache_key && link_cache_get_chain(fsess, cache_key, out_reg_chain)) {
+			fsess->link_cache->nb_cache_hits++;
+			fsess->link_cache->cache_time_us += gf_sys_clock_high_res() - start_time_us;
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("[Filters] Dijkstra: using cached chain for %s to %s\n", pid->filter->freg->name, dst->freg->name));
+			return;
+		}
+	}
+
 	dijkstra_nodes = gf_list_new();
 
 	result = NULL;
@@ -3444,7 +4039,7 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	//note that encoders must use reconfigure output
 	if (reconfigurable_only
 		&& pid->caps_negotiate
-		&& (gf_list_count(pid->caps_negotiate->properties)==1)
+		&& (gf_props_count(pid->caps_negotiate)==1)
 	) {
 		const GF_PropertyValue *cid = gf_props_get_property(pid->caps_negotiate, GF_PROP_PID_CODECID, NULL);
 		//for now we only check decoders, encoders must use reconfigure output
@@ -3808,6 +4403,13 @@ static void gf_filter_pid_resolve_link_dijkstra(GF_FilterPid *pid, GF_Filter *ds
 	bundle_cache_free(reg_dst);
 	gf_free(reg_dst->edges);
 	gf_free(reg_dst);
+
+	if (fsess->link_cache) {
+		if (cache_key)
+			link_cache_add_chain(fsess, cache_key, out_reg_chain, first_chain_idx);
+		fsess->link_cache->nb_resolved++;
+		fsess->link_cache->resolve_time_us += gf_sys_clock_high_res() - start_time_us;
+	}
 }
 
 
@@ -4781,10 +5383,11 @@ static void dump_pid_props(GF_FilterPid *pid)
 {
 	u32 idx = 0;
 	char szDump[GF_PROP_DUMP_ARG_SIZE];
-	const GF_PropertyEntry *p;
+	u32 p4cc;
+	const GF_PropertyValue *p;
 	GF_PropertyMap *pmap = gf_list_get(pid->properties, 0);
-	while (pmap && (p = gf_list_enum(pmap->properties, &idx))) {
-		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Pid prop %s: %s\n", gf_props_4cc_get_name(p->p4cc), gf_props_dump(p->p4cc, &p->prop, szDump, GF_PROP_DUMP_DATA_NONE) ));
+	while (pmap && (p = gf_props_enum_property(pmap, &idx, &p4cc, NULL))) {
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Pid prop %s: %s\n", gf_props_4cc_get_name(p4cc), gf_props_dump(p4cc, p, szDump, GF_PROP_DUMP_DATA_NONE) ));
 	}
 }
 #endif
@@ -7093,6 +7696,35 @@ restart:
 	return (GF_FilterPacket *)pcki;
 }
 
+GF_EXPORT
+u32 gf_filter_pid_get_packets(GF_FilterPid *pid, GF_FilterPacket **pcks, u32 max_pcks)
+{
+	u32 i, nb_pcks;
+	GF_FilterPacketInstance *first;
+	GF_FilterPidInst *pidinst = (GF_FilterPidInst *)pid;
+	if (!pcks || !max_pcks) return 0;
+
+	//first packet goes through regular fetch, processing internal packets and configuration changes
+	first = (GF_FilterPacketInstance *) gf_filter_pid_get_packet(pid);
+	if (!first) return 0;
+	if (max_pcks==1) {
+		pcks[0] = (GF_FilterPacket *) first;
+		return 1;
+	}
+	nb_pcks = gf_fq_get_range(pidinst->packets, (void **) pcks, max_pcks);
+	gf_assert(nb_pcks && (pcks[0] == (GF_FilterPacket *) first));
+
+	for (i=1; i<nb_pcks; i++) {
+		GF_FilterPacketInstance *pcki = (GF_FilterPacketInstance *) pcks[i];
+		//stop at packets which must be handled by gf_filter_pid_get_packet
+		if (pcki->pck->info.flags & (GF_PCK_CMD_MASK|GF_PCK_CKTYPE_MASK|GF_PCKF_PROPS_CHANGED|GF_PCKF_INFO_CHANGED))
+			break;
+		if (pcki->pck->pid_props != first->pck->pid_props)
+			break;
+	}
+	return i;
+}
+
 static GF_FilterPacketInstance *gf_filter_pid_probe_next_packet(GF_FilterPidInst *pidinst)
 {
 	u32 i=0;
@@ -7341,6 +7973,10 @@ void gf_filter_pid_drop_packet(GF_FilterPid *pid)
 	}
 
 	gf_filter_pidinst_update_stats(pidinst, pck);
+	if (pck->dispatch_time && pidinst->filter && pidinst->filter->queue_hist)
+		gf_filter_hist_add(pidinst->filter->queue_hist, gf_sys_clock_high_res() - pck->dispatch_time);
+	if (pidinst->filter && pidinst->filter->session->trace_file)
+		gf_fs_trace(pidinst->filter->session, NULL, GF_FS_TRACE_DROP, 0, pidinst->filter->name, pid->name);
 	if (timescale && (pck->info.cts!=GF_FILTER_NO_TS)) {
 		pidinst->last_ts_drop.num = pck->info.cts;
 		pidinst->last_ts_drop.den = timescale;
@@ -7643,6 +8279,8 @@ Bool gf_filter_pid_would_block(GF_FilterPid *pid)
 		safe_int_inc(&pid->would_block);
 		safe_int_inc(&pid->filter->would_block);
 		gf_assert(pid->filter->would_block + pid->filter->num_out_pids_not_connected <= pid->filter->num_output_pids);
+		if (pid->filter->session->trace_file)
+			gf_fs_trace(pid->filter->session, NULL, GF_FS_TRACE_BLOCK, 0, pid->filter->name, pid->name);
 
 #ifndef GPAC_DISABLE_LOG
 		if (gf_log_tool_level_on(GF_LOG_FILTER, GF_LOG_DEBUG)) {
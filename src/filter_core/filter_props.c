@@ -933,25 +933,129 @@ Bool gf_props_equal_strict(const GF_PropertyValue *p1, const GF_PropertyValue *p
 	return gf_props_equal_internal(p1, p2, GF_TRUE);
 }
 
-#if GF_PROPS_HASHTABLE_SIZE
-GFINLINE u32 gf_props_hash_djb2(u32 p4cc, const char *str)
+u32 gf_props_key(u32 p4cc, const char *name)
 {
 	u32 hash = 5381;
+	int c;
+	if (p4cc) return p4cc;
+	if (!name) return 0;
+	while ( (c = *name++) )
+		hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+	return hash;
+}
 
-	if (p4cc) {
-		hash = ((hash << 5) + hash) + ((p4cc>>24)&0xFF);
-		hash = ((hash << 5) + hash) + ((p4cc>>16)&0xFF);
-		hash = ((hash << 5) + hash) + ((p4cc>>8)&0xFF);
-		hash = ((hash << 5) + hash) + (p4cc&0xFF);
-	} else {
-		int c;
-		while ( (c = *str++) )
-			hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
+//4CCs mostly differ in their last bytes, mix bits before selecting a slot
+static GFINLINE u32 gf_props_slot(u32 key, u32 mask)
+{
+	key ^= key >> 16;
+	key *= 0x45d9f3b;
+	key ^= key >> 16;
+	return key & mask;
+}
 
-	}
-	return (hash % GF_PROPS_HASHTABLE_SIZE);
+const char *gf_props_intern_name(GF_FilterSession *fsess, const char *name)
+{
+	u32 pos;
+	char *atom;
+	gf_mx_p(fsess->atoms_mx);
+	//grow at 50% load
+	if (!fsess->prop_atoms || (2*(fsess->nb_prop_atoms+1) > fsess->prop_atoms_mask+1)) {
+		u32 i, nb_slots = fsess->prop_atoms ? 2*(fsess->prop_atoms_mask+1) : 64;
+		char **atoms = gf_malloc(sizeof(char *) * nb_slots);
+		u32 *refs = gf_malloc(sizeof(u32) * nb_slots);
+		if (!atoms || !refs) {
+			if (atoms) gf_free(atoms);
+			if (refs) gf_free(refs);
+			gf_mx_v(fsess->atoms_mx);
+			return NULL;
+		}
+		memset(atoms, 0, sizeof(char *) * nb_slots);
+		memset(refs, 0, sizeof(u32) * nb_slots);
+		for (i=0; fsess->prop_atoms && (i<=fsess->prop_atoms_mask); i++) {
+			atom = fsess->prop_atoms[i];
+			if (!atom) continue;
+			pos = gf_props_slot(gf_props_key(0, atom), nb_slots-1);
+			while (atoms[pos]) pos = (pos+1) & (nb_slots-1);
+			atoms[pos] = atom;
+			refs[pos] = fsess->prop_atoms_refs[i];
+		}
+		if (fsess->prop_atoms) gf_free(fsess->prop_atoms);
+		if (fsess->prop_atoms_refs) gf_free(fsess->prop_atoms_refs);
+		fsess->prop_atoms = atoms;
+		fsess->prop_atoms_refs = refs;
+		fsess->prop_atoms_mask = nb_slots-1;
+	}
+	pos = gf_props_slot(gf_props_key(0, name), fsess->prop_atoms_mask);
+	while ((atom = fsess->prop_atoms[pos])) {
+		if (!strcmp(atom, name)) break;
+		pos = (pos+1) & fsess->prop_atoms_mask;
+	}
+	if (!atom) {
+		atom = gf_strdup(name);
+		if (atom) {
+			fsess->prop_atoms[pos] = atom;
+			fsess->nb_prop_atoms++;
+		}
+	}
+	if (atom) fsess->prop_atoms_refs[pos]++;
+	gf_mx_v(fsess->atoms_mx);
+	return atom;
+}
+
+void gf_props_release_name(GF_FilterSession *fsess, const char *name)
+{
+	u32 pos, next, mask;
+	char *atom;
+	gf_mx_p(fsess->atoms_mx);
+	//table already destroyed, name is gone
+	if (!fsess->prop_atoms) {
+		gf_mx_v(fsess->atoms_mx);
+		return;
+	}
+	mask = fsess->prop_atoms_mask;
+	pos = gf_props_slot(gf_props_key(0, name), mask);
+	while ((atom = fsess->prop_atoms[pos])) {
+		if (atom == name) break;
+		pos = (pos+1) & mask;
+	}
+	if (!atom || --fsess->prop_atoms_refs[pos]) {
+		gf_mx_v(fsess->atoms_mx);
+		return;
+	}
+	gf_free(atom);
+	fsess->prop_atoms[pos] = NULL;
+	fsess->nb_prop_atoms--;
+
+	//backward-shift the following run so that lookups never stop on the freed slot
+	next = (pos+1) & mask;
+	while ((atom = fsess->prop_atoms[next])) {
+		u32 home = gf_props_slot(gf_props_key(0, atom), mask);
+		//entry can move to the hole only if its home slot is not within ]pos, next]
+		if (((next - home) & mask) >= ((next - pos) & mask)) {
+			fsess->prop_atoms[pos] = atom;
+			fsess->prop_atoms_refs[pos] = fsess->prop_atoms_refs[next];
+			fsess->prop_atoms[next] = NULL;
+			fsess->prop_atoms_refs[next] = 0;
+			pos = next;
+		}
+		next = (next+1) & mask;
+	}
+	gf_mx_v(fsess->atoms_mx);
+}
+
+void gf_props_del_atoms(GF_FilterSession *fsess)
+{
+	u32 i;
+	if (!fsess->prop_atoms) return;
+	for (i=0; i<=fsess->prop_atoms_mask; i++) {
+		if (fsess->prop_atoms[i]) gf_free(fsess->prop_atoms[i]);
+	}
+	gf_free(fsess->prop_atoms);
+	gf_free(fsess->prop_atoms_refs);
+	fsess->prop_atoms = NULL;
+	fsess->prop_atoms_refs = NULL;
+	fsess->nb_prop_atoms = fsess->prop_atoms_mask = 0;
 }
-#endif
 
 GF_PropertyMap * gf_props_new(GF_Filter *filter)
 {
@@ -964,10 +1068,6 @@ GF_PropertyMap * gf_props_new(GF_Filter *filter)
 		if (!map) return NULL;
 
 		map->session = filter->session;
-#if GF_PROPS_HASHTABLE_SIZE
-#else
-		map->properties = gf_list_new();
-#endif
 	}
 	gf_assert(!map->reference_count);
 	map->reference_count = 1;
@@ -1007,10 +1107,11 @@ void gf_props_del_property(GF_PropertyEntry *it)
 {
 	gf_assert(it->reference_count);
 	if (safe_int_dec(&it->reference_count) == 0 ) {
-		if (it->pname && it->name_alloc)
-			gf_free(it->pname);
-
-		it->name_alloc = GF_FALSE;
+		if (it->pname_interned) {
+			gf_props_release_name(it->session, it->pname);
+			it->pname_interned = GF_FALSE;
+		}
+		it->pname = NULL;
 
 		if (it->prop.type==GF_PROP_STRING) {
 			gf_free(it->prop.value.string);
@@ -1055,36 +1156,19 @@ void gf_props_del_property(GF_PropertyEntry *it)
 
 void gf_propmap_del(void *pmap)
 {
-#if GF_PROPS_HASHTABLE_SIZE
-	gf_free(pamp);
-#else
 	GF_PropertyMap *map = pmap;
-	gf_list_del(map->properties);
+	if (map->keys) gf_free(map->keys);
+	if (map->entries) gf_free(map->entries);
+	if (map->slots) gf_free(map->slots);
 	gf_free(map);
-#endif
-
 }
+
 void gf_props_reset(GF_PropertyMap *prop)
 {
-#if GF_PROPS_HASHTABLE_SIZE
-	u32 i;
-	for (i=0; i<GF_PROPS_HASHTABLE_SIZE; i++) {
-		if (prop->hash_table[i]) {
-			GF_List *l = prop->hash_table[i];
-			while (gf_list_count(l)) {
-				gf_props_del_property((GF_PropertyEntry *) gf_list_pop_back(l) );
-			}
-			prop->hash_table[i] = NULL;
-			if (gf_fq_res_add(prop->session->prop_maps_list_reservoir, l)) {
-				gf_list_del(l);
-			}
-		}
-	}
-#else
-	while (gf_list_count(prop->properties)) {
-		gf_props_del_property( (GF_PropertyEntry *) gf_list_pop_back(prop->properties) );
+	while (prop->nb_props) {
+		prop->nb_props--;
+		gf_props_del_property(prop->entries[prop->nb_props]);
 	}
-#endif
 }
 
 void gf_props_del(GF_PropertyMap *map)
@@ -1097,53 +1181,115 @@ void gf_props_del(GF_PropertyMap *map)
 	map->reference_count = 0;
 	map->timescale = 0;
 	if (!map->session || gf_fq_res_add(map->session->prop_maps_reservoir, map)) {
-		gf_list_del(map->properties);
-		gf_free(map);
+		gf_propmap_del(map);
 	}
 }
 
+static GFINLINE Bool gf_props_entry_match(const GF_PropertyEntry *p, u32 p4cc, const char *name)
+{
+	if (p4cc) return (p->p4cc==p4cc) ? GF_TRUE : GF_FALSE;
+	if (!p->pname) return GF_FALSE;
+	//interned or static names
+	if (p->pname==name) return GF_TRUE;
+	return strcmp(p->pname, name) ? GF_FALSE : GF_TRUE;
+}
 
-
-//purge existing property of same name
-void gf_props_remove_property(GF_PropertyMap *map, u32 hash, u32 p4cc, const char *name)
+static s32 gf_props_find(GF_PropertyMap *map, u32 key, u32 p4cc, const char *name)
 {
-#if GF_PROPS_HASHTABLE_SIZE
-	if (map->hash_table[hash]) {
-		u32 i, count = gf_list_count(map->hash_table[hash]);
-		for (i=0; i<count; i++) {
-			GF_PropertyEntry *prop = gf_list_get(map->hash_table[hash], i);
-			if ((p4cc && (p4cc==prop->p4cc)) || (name && prop->pname && !strcmp(prop->pname, name)) ) {
-				gf_list_rem(map->hash_table[hash], i);
-				gf_props_del_property(prop);
-				break;
-			}
+	u32 i;
+	if (!p4cc && !name) return -1;
+
+	if ((map->nb_props >= GF_PROPS_LINEAR_MAX) && map->slots) {
+		u32 pos = gf_props_slot(key, map->slot_mask);
+		while ((i = map->slots[pos])) {
+			i--;
+			if ((map->keys[i]==key) && gf_props_entry_match(map->entries[i], p4cc, name))
+				return (s32) i;
+			pos = (pos+1) & map->slot_mask;
 		}
+		return -1;
 	}
-#else
-	u32 i, count = gf_list_count(map->properties);
-	for (i=0; i<count; i++) {
-		GF_PropertyEntry *prop = gf_list_get(map->properties, i);
-		if ((p4cc && (p4cc==prop->p4cc)) || (name && prop->pname && !strcmp(prop->pname, name)) ) {
-			gf_list_rem(map->properties, i);
-			gf_props_del_property(prop);
-			break;
-		}
+	for (i=0; i<map->nb_props; i++) {
+		if ((map->keys[i]==key) && gf_props_entry_match(map->entries[i], p4cc, name))
+			return (s32) i;
 	}
-#endif
+	return -1;
 }
 
+static void gf_props_index_add(GF_PropertyMap *map, u32 idx)
+{
+	u32 pos = gf_props_slot(map->keys[idx], map->slot_mask);
+	while (map->slots[pos])
+		pos = (pos+1) & map->slot_mask;
+	map->slots[pos] = idx+1;
+}
 
-#if GF_PROPS_HASHTABLE_SIZE
-GF_List *gf_props_get_list(GF_PropertyMap *map)
+static void gf_props_reindex(GF_PropertyMap *map)
 {
-	GF_List *l;
+	u32 i, nb_slots;
+	if (map->nb_props < GF_PROPS_LINEAR_MAX) return;
+
+	nb_slots = map->slots ? map->slot_mask+1 : 0;
+	if (nb_slots < 2*map->nb_props) {
+		u32 *slots;
+		nb_slots = 2*GF_PROPS_LINEAR_MAX;
+		while (nb_slots < 2*map->nb_props) nb_slots *= 2;
+		slots = gf_realloc(map->slots, sizeof(u32) * nb_slots);
+		//no index, lookups will be linear
+		if (!slots) return;
+		map->slots = slots;
+		map->slot_mask = nb_slots-1;
+	}
+	memset(map->slots, 0, sizeof(u32) * nb_slots);
+	for (i=0; i<map->nb_props; i++)
+		gf_props_index_add(map, i);
+}
 
-	l = gf_fq_pop(map->session->prop_maps_list_reservoir);
+static GF_Err gf_props_append(GF_PropertyMap *map, u32 key, GF_PropertyEntry *prop)
+{
+	if (map->nb_props == map->nb_alloc) {
+		u32 *keys;
+		GF_PropertyEntry **entries;
+		u32 nb_alloc = map->nb_alloc ? 2*map->nb_alloc : 4;
+		keys = gf_realloc(map->keys, sizeof(u32) * nb_alloc);
+		if (!keys) return GF_OUT_OF_MEM;
+		map->keys = keys;
+		entries = gf_realloc(map->entries, sizeof(GF_PropertyEntry *) * nb_alloc);
+		if (!entries) return GF_OUT_OF_MEM;
+		map->entries = entries;
+		map->nb_alloc = nb_alloc;
+	}
+	map->keys[map->nb_props] = key;
+	map->entries[map->nb_props] = prop;
+	map->nb_props++;
+
+	if (map->nb_props >= GF_PROPS_LINEAR_MAX) {
+		//index is not maintained below GF_PROPS_LINEAR_MAX entries, rebuild it when crossing the threshold
+		if (!map->slots || (map->nb_props == GF_PROPS_LINEAR_MAX) || (2*map->nb_props > map->slot_mask+1))
+			gf_props_reindex(map);
+		else
+			gf_props_index_add(map, map->nb_props-1);
+	}
+	return GF_OK;
+}
 
-	if (!l) l = gf_list_new();
-	return l;
+//purge existing property of same name
+void gf_props_remove_property(GF_PropertyMap *map, u32 key, u32 p4cc, const char *name)
+{
+	GF_PropertyEntry *prop;
+	s32 idx = gf_props_find(map, key, p4cc, name);
+	if (idx<0) return;
+
+	prop = map->entries[idx];
+	map->nb_props--;
+	//keep insertion order
+	if ((u32) idx < map->nb_props) {
+		memmove(&map->keys[idx], &map->keys[idx+1], sizeof(u32) * (map->nb_props - idx));
+		memmove(&map->entries[idx], &map->entries[idx+1], sizeof(GF_PropertyEntry *) * (map->nb_props - idx));
+	}
+	gf_props_reindex(map);
+	gf_props_del_property(prop);
 }
-#endif
 
 static GF_Err gf_props_assign_value(GF_PropertyEntry *prop, const GF_PropertyValue *value, Bool is_old_prop)
 {
@@ -1211,35 +1357,17 @@ static GF_Err gf_props_assign_value(GF_PropertyEntry *prop, const GF_PropertyVal
 	return GF_OK;
 }
 
-GF_Err gf_props_insert_property(GF_PropertyMap *map, u32 hash, u32 p4cc, const char *name, char *dyn_name, const GF_PropertyValue *value)
+GF_Err gf_props_insert_property(GF_PropertyMap *map, u32 key, u32 p4cc, const char *name, char *dyn_name, const GF_PropertyValue *value)
 {
 	GF_PropertyEntry *prop;
 	GF_Err e;
-#if GF_PROPS_HASHTABLE_SIZE
-	u32 i, count;
-#endif
+
 	if ((value->type == GF_PROP_DATA) || (value->type == GF_PROP_DATA_NO_COPY)) {
 		if (!value->value.data.ptr) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Attempt at defining data property %s with NULL pointer, not allowed\n", p4cc ? gf_4cc_to_str(p4cc) : name ? name : dyn_name ));
 			return GF_BAD_PARAM;
 		}
 	}
-#if GF_PROPS_HASHTABLE_SIZE
-	if (! map->hash_table[hash] ) {
-		map->hash_table[hash] = gf_props_get_list(map);
-		if (!map->hash_table[hash]) return GF_OUT_OF_MEM;
-	} else {
-		count = gf_list_count(map->hash_table[hash]);
-		if (count) {
-			GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("PropertyMap hash collision for %s - %d entries before insertion:\n", p4cc ? gf_4cc_to_str(p4cc) : name ? name : dyn_name, gf_list_count(map->hash_table[hash]) ));
-			for (i=0; i<count; i++) {
-				GF_PropertyEntry *prop_c = gf_list_get(map->hash_table[hash], i);
-				GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("\t%s\n\n", prop_c->pname ? prop_c->pname : gf_4cc_to_str(prop_c->p4cc)  ));
-				gf_assert(!prop_c->p4cc || (prop_c->p4cc != p4cc));
-			}
-		}
-	}
-#endif
 	if ((value->type == GF_PROP_DATA) && value->value.data.ptr) {
 		prop = gf_fq_pop(map->session->prop_maps_entry_data_alloc_reservoir);
 	} else {
@@ -1254,94 +1382,45 @@ GF_Err gf_props_insert_property(GF_PropertyMap *map, u32 hash, u32 p4cc, const c
 
 	prop->reference_count = 1;
 	prop->p4cc = p4cc;
-	prop->pname = (char *) name;
+	prop->pname = name;
+	prop->pname_interned = GF_FALSE;
 	if (dyn_name) {
-		prop->pname = gf_strdup(dyn_name);
-		prop->name_alloc=GF_TRUE;
+		prop->pname = gf_props_intern_name(map->session, dyn_name);
+		prop->pname_interned = prop->pname ? GF_TRUE : GF_FALSE;
+		if (!prop->pname) {
+			gf_props_del_property(prop);
+			return GF_OUT_OF_MEM;
+		}
 	}
 
 	e = gf_props_assign_value(prop, value, GF_FALSE);
+	if (!e) e = gf_props_append(map, key, prop);
 	if (e) {
 		gf_props_del_property(prop);
 		return e;
 	}
-
-#if GF_PROPS_HASHTABLE_SIZE
-	return gf_list_add(map->hash_table[hash], prop);
-#else
-	return gf_list_add(map->properties, prop);
-#endif
-
+	return GF_OK;
 }
 
 GF_Err gf_props_set_property(GF_PropertyMap *map, u32 p4cc, const char *name, char *dyn_name, const GF_PropertyValue *value)
 {
 	GF_Err e;
-	u32 hash = gf_props_hash_djb2(p4cc, name ? name : dyn_name);
+	u32 key = gf_props_key(p4cc, name ? name : dyn_name);
 	gf_mx_p(map->session->info_mx);
-	gf_props_remove_property(map, hash, p4cc, name ? name : dyn_name);
+	gf_props_remove_property(map, key, p4cc, name ? name : dyn_name);
 	if (!value)
 		e = GF_OK;
 	else
-		e = gf_props_insert_property(map, hash, p4cc, name, dyn_name, value);
+		e = gf_props_insert_property(map, key, p4cc, name, dyn_name, value);
 	gf_mx_v(map->session->info_mx);
 	return e;
 }
 
 const GF_PropertyEntry *gf_props_get_property_entry(GF_PropertyMap *map, u32 prop_4cc, const char *name)
 {
-	u32 i, count, len;
-	const GF_PropertyEntry *res=NULL;
-#if GF_PROPS_HASHTABLE_SIZE
-	u32 hash = gf_props_hash_djb2(prop_4cc, name);
-	if (map->hash_table[hash] ) {
-		count = gf_list_count(map->hash_table[hash]);
-		for (i=0; i<count; i++) {
-			GF_PropertyEntry *p = gf_list_get(map->hash_table[hash], i);
-
-			if ((prop_4cc && (p->p4cc==prop_4cc)) || (p->pname && name && !strcmp(p->pname, name)) ) {
-				res = p;
-				break;
-			}
-		}
-	}
-#else
-	count = gf_list_count(map->properties);
-	if (name) {
-		len = (u32) strlen(name);
-	} else {
-		if (!prop_4cc) return NULL;
-		len = 0;
-	}
-	for (i=0; i<count; i++) {
-		GF_PropertyEntry *p = gf_list_get(map->properties, i);
-		if (!p) {
-			GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("Concurrent read/write access to property map, cannot query property now\n"));
-			return NULL;
-		}
-
-		if (prop_4cc) {
-			if (p->p4cc==prop_4cc) {
-				res = p;
-				break;
-			}
-		} else if (p->pname) {
-			u32 j;
-			for (j=0; j<=len; j++) {
-				char c = p->pname[j];
-				if (!c)
-					break;
-				if (c != name[j])
-					break;
-			}
-			if (j==len) {
-				res = p;
-				break;
-			}
-		}
-	}
-#endif
-	return res;
+	s32 idx = gf_props_find(map, gf_props_key(prop_4cc, name), prop_4cc, name);
+	if (idx<0) return NULL;
+	return map->entries[idx];
 }
 
 const GF_PropertyValue *gf_props_get_property(GF_PropertyMap *map, u32 prop_4cc, const char *name)
@@ -1354,102 +1433,48 @@ const GF_PropertyValue *gf_props_get_property(GF_PropertyMap *map, u32 prop_4cc,
 GF_Err gf_props_merge_property(GF_PropertyMap *dst_props, GF_PropertyMap *src_props, gf_filter_prop_filter filter_prop, void *cbk)
 {
 	GF_Err e;
-	u32 i, count;
-#if GF_PROPS_HASHTABLE_SIZE
-	u32 idx;
-#endif
-	GF_List *list;
+	u32 i;
 	if (src_props->timescale)
 		dst_props->timescale = src_props->timescale;
 
-#if GF_PROPS_HASHTABLE_SIZE
-	for (idx=0; idx<GF_PROPS_HASHTABLE_SIZE; idx++) {
-		if (src_props->hash_table[idx]) {
-			list = src_props->hash_table[idx];
-#else
-			list = src_props->properties;
-#endif
-			count = gf_list_count(list);
-			for (i=0; i<count; i++) {
-				GF_PropertyEntry *prop = gf_list_get(list, i);
-				gf_assert(prop->reference_count);
-				if (!filter_prop || filter_prop(cbk, prop->p4cc, prop->pname, &prop->prop)) {
-					safe_int_inc(&prop->reference_count);
-
-					//remove existing property if any
-					gf_props_remove_property(dst_props, gf_props_hash_djb2(prop->p4cc, prop->pname), prop->p4cc, prop->pname);
-
-#if GF_PROPS_HASHTABLE_SIZE
-					if (!dst_props->hash_table[idx]) {
-						dst_props->hash_table[idx] = gf_props_get_list(dst_props);
-						if (!dst_props->hash_table[idx]) return GF_OUT_OF_MEM;
-					}
-					e = gf_list_add(dst_props->hash_table[idx], prop);
-					if (e) return e;
-#else
-					e = gf_list_add(dst_props->properties, prop);
-					if (e) return e;
-#endif
-				}
+	for (i=0; i<src_props->nb_props; i++) {
+		GF_PropertyEntry *prop = src_props->entries[i];
+		gf_assert(prop->reference_count);
+		if (!filter_prop || filter_prop(cbk, prop->p4cc, prop->pname, &prop->prop)) {
+			u32 key = src_props->keys[i];
+			safe_int_inc(&prop->reference_count);
+
+			//remove existing property if any
+			gf_props_remove_property(dst_props, key, prop->p4cc, prop->pname);
+
+			e = gf_props_append(dst_props, key, prop);
+			if (e) {
+				gf_props_del_property(prop);
+				return e;
 			}
-#if GF_PROPS_HASHTABLE_SIZE
 		}
 	}
-#endif
 	return GF_OK;
 }
 
 const GF_PropertyValue *gf_props_enum_property(GF_PropertyMap *props, u32 *io_idx, u32 *prop_4cc, const char **prop_name)
 {
-#if GF_PROPS_HASHTABLE_SIZE
-	u32 i, nb_items = 0;
-#endif
-	u32 idx, count;
-
+	u32 idx;
 	const GF_PropertyEntry *pe;
 	if (!io_idx) return NULL;
 
 	idx = *io_idx;
 	if (idx == 0xFFFFFFFF) return NULL;
 
-#if GF_PROPS_HASHTABLE_SIZE
-	for (i=0; i<GF_PROPS_HASHTABLE_SIZE; i++) {
-		if (props->hash_table[i]) {
-			count = gf_list_count(props->hash_table[i]);
-			nb_items+=count;
-			if (idx >= count) {
-				idx -= count;
-				continue;
-			}
-			pe = gf_list_get(props->hash_table[i], idx);
-			if (!pe) {
-				*io_idx = nb_items;
-				return NULL;
-			}
-			if (prop_4cc) *prop_4cc = pe->p4cc;
-			if (prop_name) *prop_name = pe->pname;
-			*io_idx = (*io_idx) + 1;
-			return &pe->prop;
-		}
-	}
-	*io_idx = nb_items;
-	return NULL;
-#else
-	count = gf_list_count(props->properties);
-	if (idx >= count) {
-		*io_idx = count;
-		return NULL;
-	}
-	pe = gf_list_get(props->properties, idx);
-	if (!pe) {
-		*io_idx = count;
+	if (idx >= props->nb_props) {
+		*io_idx = props->nb_props;
 		return NULL;
 	}
+	pe = props->entries[idx];
 	if (prop_4cc) *prop_4cc = pe->p4cc;
 	if (prop_name) *prop_name = pe->pname;
 	*io_idx = (*io_idx) + 1;
 	return &pe->prop;
-#endif
 }
 
 typedef struct
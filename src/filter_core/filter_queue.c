@@ -2,7 +2,7 @@
  *			GPAC - Multimedia Framework C SDK
  *
  *			Authors: Jean Le Feuvre
- *			Copyright (c) Telecom ParisTech 2017-2023
+ *			Copyright (c) Telecom ParisTech 2017-2026
  *					All rights reserved
  *
  *  This file is part of GPAC / filters sub-project
@@ -44,6 +44,15 @@ typedef struct __lf_item
 	void *data;
 } GF_LFQItem;
 
+typedef struct
+{
+	//sequence number of the slot: equals position when free for enqueue, position+1 when ready for dequeue
+	volatile u32 seq;
+	void *data;
+} GF_FQRingSlot;
+
+#define GF_FQ_CACHE_LINE	64
+
 struct __gf_filter_queue
 {
 	//head element is dummy, never swaped
@@ -53,23 +62,70 @@ struct __gf_filter_queue
 	GF_LFQItem *res_head;
 	GF_LFQItem *res_tail;
 
-	volatile u32 nb_items;
-
 	GF_Mutex *mx;
 	u8 use_mx;
-};
-
 
+	//bounded ring mode, NULL if not used. The linked list is then protected by an internal mutex
+	//and only used once the ring has been full
+	GF_FQRingSlot *ring;
+	u32 ring_mask;
+	//set once the ring has been full: all new items are then pushed in the linked list, and popped once the ring is empty
+	//reset, under mutex, once both ring and linked list are empty
+	volatile u32 ring_overflow;
+	//set, under mutex, once the ring is empty after overflow, only the linked list is then used
+	volatile u32 ring_drained;
+
+	//ring positions, item count and ring writers count are kept on separate cache lines
+	u8 _pad1[GF_FQ_CACHE_LINE];
+	volatile u32 enq_pos;
+	u8 _pad2[GF_FQ_CACHE_LINE - sizeof(u32)];
+	volatile u32 deq_pos;
+	u8 _pad3[GF_FQ_CACHE_LINE - sizeof(u32)];
+	volatile u32 nb_items;
+	u8 _pad4[GF_FQ_CACHE_LINE - sizeof(u32)];
+	volatile u32 ring_writers;
+	u8 _pad5[GF_FQ_CACHE_LINE - sizeof(u32)];
+};
 
 
 GF_FilterQueue *gf_fq_new(const GF_Mutex *mx)
+{
+	if (!mx && gf_opts_get_bool("core", "no-mx"))
+		return gf_fq_new_ex(NULL, GF_TRUE, 0);
+	return gf_fq_new_ex(mx, GF_FALSE, mx ? 0 : gf_opts_get_int("core", "fq-ring"));
+}
+
+GF_FilterQueue *gf_fq_new_ex(const GF_Mutex *mx, Bool force_mx, u32 nb_ring_slots)
 {
 	GF_FilterQueue *q;
 	GF_SAFEALLOC(q, GF_FilterQueue);
 	if (!q) return NULL;
 
 	q->mx = (GF_Mutex *) mx;
-	if (mx || gf_opts_get_bool("core", "no-mx")) q->use_mx = 1;
+	if (mx || force_mx) q->use_mx = 1;
+
+	if (!q->use_mx && nb_ring_slots) {
+		u32 i, size = 2;
+		//round to next power of 2
+		while ((size < nb_ring_slots) && (size < 0x40000000)) size <<= 1;
+		q->ring = gf_malloc(sizeof(GF_FQRingSlot) * size);
+		q->mx = gf_mx_new("FilterQueueRing");
+		if (q->ring && q->mx) {
+			q->ring_mask = size-1;
+			for (i=0; i<size; i++) {
+				q->ring[i].seq = i;
+				q->ring[i].data = NULL;
+			}
+			//overflow list uses the mutex version
+			q->use_mx = 1;
+		} else {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_SCHEDULER, ("Failed to allocate queue ring of %u slots, using linked mode\n", size));
+			if (q->ring) gf_free(q->ring);
+			q->ring = NULL;
+			gf_mx_del(q->mx);
+			q->mx = NULL;
+		}
+	}
 	if (q->use_mx) return q;
 
 
@@ -112,9 +168,136 @@ void gf_fq_del(GF_FilterQueue *q, void (*item_delete)(void *) )
 		it = it->next;
 		gf_free(ptr);
 	}
+	if (q->ring) {
+		u32 pos;
+		for (pos=q->deq_pos; pos!=q->enq_pos; pos++) {
+			GF_FQRingSlot *slot = &q->ring[pos & q->ring_mask];
+			if (slot->data && item_delete) item_delete(slot->data);
+		}
+		gf_free(q->ring);
+		//mutex is owned by queue in ring mode
+		gf_mx_del(q->mx);
+	}
 	gf_free(q);
 }
 
+//Vyukov bounded MPMC queue - returns GF_FALSE if ring is full
+static Bool gf_fq_ring_enqueue(GF_FilterQueue *q, void *item)
+{
+	GF_FQRingSlot *slot;
+	u32 pos = q->enq_pos;
+	while (1) {
+		s32 diff;
+		slot = &q->ring[pos & q->ring_mask];
+		diff = (s32) (slot->seq - pos);
+		if (!diff) {
+			if (atomic_compare_and_swap(&q->enq_pos, pos, pos+1))
+				break;
+		} else if (diff < 0) {
+			//slot not yet released by consumer, ring is full
+			return GF_FALSE;
+		}
+		pos = q->enq_pos;
+	}
+	slot->data = item;
+	//publish slot
+	safe_int_inc(&slot->seq);
+	return GF_TRUE;
+}
+
+static void *gf_fq_ring_dequeue(GF_FilterQueue *q)
+{
+	void *data;
+	GF_FQRingSlot *slot;
+	u32 pos = q->deq_pos;
+	while (1) {
+		s32 diff;
+		slot = &q->ring[pos & q->ring_mask];
+		diff = (s32) (slot->seq - (pos+1));
+		if (!diff) {
+			if (atomic_compare_and_swap(&q->deq_pos, pos, pos+1))
+				break;
+		} else if (diff < 0) {
+			//slot not yet published, ring is empty
+			return NULL;
+		}
+		pos = q->deq_pos;
+	}
+	data = slot->data;
+	slot->data = NULL;
+	//release slot for next round: seq = pos + ring size
+	safe_int_add(&slot->seq, q->ring_mask);
+	return data;
+}
+
+static Bool gf_fq_ring_add(GF_FilterQueue *q, void *item)
+{
+	Bool done;
+	safe_int_inc(&q->ring_writers);
+	//count the item before publishing it, so that a concurrent pop never sees a count lower than the number of popped items
+	safe_int_inc(&q->nb_items);
+	done = (!q->ring_overflow && gf_fq_ring_enqueue(q, item)) ? GF_TRUE : GF_FALSE;
+	if (!done) {
+		safe_int_dec(&q->nb_items);
+		//ring full, switch to linked mode to preserve ordering
+		if (!q->ring_overflow) {
+			q->ring_overflow = 1;
+			GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Queue ring of %u slots full, switching to linked mode\n", q->ring_mask+1));
+		}
+	}
+	safe_int_dec(&q->ring_writers);
+	return done;
+}
+
+static void *gf_fq_ring_pop(GF_FilterQueue *q)
+{
+	void *data = gf_fq_ring_dequeue(q);
+	if (data) safe_int_dec(&q->nb_items);
+	return data;
+}
+
+//max number of yields while waiting for a claimed ring slot to be published
+#define FQ_RING_MAX_WAIT	100
+
+//called with queue mutex held in overflow mode, before popping from the linked list
+//returns a ring item if any, NULL otherwise - *pending is set if a claimed slot is still not published
+static void *gf_fq_ring_pop_overflow(GF_FilterQueue *q, Bool *pending)
+{
+	u32 i;
+	*pending = GF_FALSE;
+	for (i=0; i<FQ_RING_MAX_WAIT; i++) {
+		void *data = gf_fq_ring_pop(q);
+		if (data) return data;
+		//ring empty
+		if (q->deq_pos == q->enq_pos) {
+			//no pending ring writer and all claimed slots consumed: no more items can be pushed in the ring until overflow is reset
+			if (q->ring_overflow && !q->ring_writers)
+				q->ring_drained = 1;
+			return NULL;
+		}
+		//slot claimed before the linked list items were pushed but not yet published, the list cannot be popped
+		gf_sleep(0);
+	}
+	*pending = GF_TRUE;
+	return NULL;
+}
+
+//get item at given index in ring, NULL if not found - *idx is decremented by the number of items in the ring
+static void *gf_fq_ring_get(GF_FilterQueue *q, u32 *idx)
+{
+	u32 pos = q->deq_pos;
+	u32 end = q->enq_pos;
+	while (pos != end) {
+		GF_FQRingSlot *slot = &q->ring[pos & q->ring_mask];
+		//not yet published
+		if (slot->seq != pos+1) return NULL;
+		if (! *idx) return slot->data;
+		(*idx)--;
+		pos++;
+	}
+	return NULL;
+}
+
 static void gf_fq_lockfree_enqueue(GF_LFQItem *it, GF_LFQItem **tail_ptr)
 {
 	GF_LFQItem *tail;
@@ -217,10 +400,20 @@ void gf_fq_add(GF_FilterQueue *fq, void *item)
 	GF_LFQItem *it;
 	gf_assert(fq);
 
+	if (fq->ring && !fq->ring_overflow && gf_fq_ring_add(fq, item))
+		return;
+
 	if (! fq->use_mx) {
 		gf_lfq_add(fq, item);
 	} else {
 		gf_mx_p(fq->mx);
+		//overflow was reset since our check, the linked list is empty: go back to the ring
+		while (fq->ring && !fq->ring_overflow) {
+			gf_mx_v(fq->mx);
+			if (gf_fq_ring_add(fq, item))
+				return;
+			gf_mx_p(fq->mx);
+		}
 
 		it = fq->res_head;
 		if (it) {
@@ -239,7 +432,7 @@ void gf_fq_add(GF_FilterQueue *fq, void *item)
 			fq->tail->next = it;
 			fq->tail = it;
 		}
-		fq->nb_items++;
+		safe_int_inc(&fq->nb_items);
 		gf_mx_v(fq->mx);
 	}
 }
@@ -251,11 +444,25 @@ void *gf_fq_pop(GF_FilterQueue *fq)
 		return NULL;
 
 	void *data=NULL;
+	if (fq->ring && !fq->ring_drained) {
+		data = gf_fq_ring_pop(fq);
+		if (data || !fq->ring_overflow) return data;
+	}
 	if (! fq->use_mx) {
 		return gf_lfq_pop(fq);
 	}
 
 	gf_mx_p(fq->mx);
+	//ring items must be popped before list items, check again now that list writers are blocked
+	if (fq->ring && !fq->ring_drained) {
+		Bool pending;
+		data = gf_fq_ring_pop_overflow(fq, &pending);
+		if (data || pending) {
+			gf_mx_v(fq->mx);
+			return data;
+		}
+	}
+
 	it = fq->head;
 	if (it) {
 		fq->head = it->next;
@@ -271,11 +478,16 @@ void *gf_fq_pop(GF_FilterQueue *fq)
 			fq->res_head = fq->res_tail = it;
 		}
 		gf_assert(fq->nb_items);
-		fq->nb_items--;
+		safe_int_dec(&fq->nb_items);
 
 		if (! fq->head) fq->tail = NULL;
 
 	}
+	//linked list is empty and ring drained, switch back to ring mode
+	if (!fq->head && fq->ring_drained) {
+		fq->ring_overflow = 0;
+		fq->ring_drained = 0;
+	}
 	gf_mx_v(fq->mx);
 	return data;
 }
@@ -286,6 +498,11 @@ void *gf_fq_head(GF_FilterQueue *fq)
 	void *data;
 	if (!fq) return NULL;
 
+	if (fq->ring) {
+		u32 idx = 0;
+		data = gf_fq_ring_get(fq, &idx);
+		if (data || !fq->ring_overflow) return data;
+	}
 	if (fq->use_mx) {
 		gf_mx_p(fq->mx);
 		data = fq->head ? fq->head->data : NULL;
@@ -303,6 +520,10 @@ void *gf_fq_get(GF_FilterQueue *fq, u32 idx)
 	GF_LFQItem *it;
 	gf_assert(fq);
 
+	if (fq->ring) {
+		data = gf_fq_ring_get(fq, &idx);
+		if (data || !fq->ring_overflow) return data;
+	}
 	if (fq->use_mx) {
 		gf_mx_p(fq->mx);
 		it = fq->head;
@@ -327,12 +548,59 @@ void *gf_fq_get(GF_FilterQueue *fq, u32 idx)
 	return data;
 }
 
+//get up to max_items items from the head of the queue, in order, in a single traversal
+u32 gf_fq_get_range(GF_FilterQueue *fq, void **items, u32 max_items)
+{
+	u32 nb_items = 0;
+	GF_LFQItem *it;
+	gf_assert(fq);
+
+	if (fq->ring) {
+		u32 pos = fq->deq_pos;
+		u32 end = fq->enq_pos;
+		while ((pos != end) && (nb_items<max_items)) {
+			GF_FQRingSlot *slot = &fq->ring[pos & fq->ring_mask];
+			//not yet published
+			if (slot->seq != pos+1) return nb_items;
+			items[nb_items++] = slot->data;
+			pos++;
+		}
+		if (!fq->ring_overflow || (nb_items==max_items)) return nb_items;
+	}
+	if (fq->use_mx) {
+		gf_mx_p(fq->mx);
+		it = fq->head;
+		while (it && (nb_items<max_items)) {
+			items[nb_items++] = it->data;
+			it = it->next;
+		}
+		gf_mx_v(fq->mx);
+	} else {
+		it = fq->head->next;
+		while (it && (nb_items<max_items)) {
+			items[nb_items++] = it->data;
+			it = it->next;
+		}
+	}
+	return nb_items;
+}
+
 void gf_fq_enum(GF_FilterQueue *fq, void (*enum_func)(void *udta1, void *item), void *udta)
 {
 	GF_LFQItem *it;
 	if (!enum_func) return;
 	gf_assert(fq);
 
+	if (fq->ring) {
+		u32 pos = fq->deq_pos;
+		u32 end = fq->enq_pos;
+		while (pos != end) {
+			GF_FQRingSlot *slot = &fq->ring[pos & fq->ring_mask];
+			if (slot->seq != pos+1) break;
+			enum_func(udta, slot->data);
+			pos++;
+		}
+	}
 	if (fq->use_mx) {
 		gf_mx_p(fq->mx);
 		it = fq->head;
@@ -360,3 +628,116 @@ Bool gf_fq_res_add(GF_FilterQueue *fq, void *item)
 	gf_fq_add(fq, item);
 	return GF_FALSE;
 }
+
+
+struct __gf_task_deque
+{
+	//circular buffer of items, top is the oldest item, bottom is top+nb_items
+	void **items;
+	u32 alloc_items;
+	u32 top;
+	volatile u32 nb_items;
+	GF_Mutex *mx;
+};
+
+GF_TaskDeque *gf_tdq_new(const char *name)
+{
+	GF_TaskDeque *dq;
+	GF_SAFEALLOC(dq, GF_TaskDeque);
+	if (!dq) return NULL;
+	dq->alloc_items = 32;
+	dq->items = gf_malloc(sizeof(void *) * dq->alloc_items);
+	dq->mx = gf_mx_new(name);
+	if (!dq->items || !dq->mx) {
+		if (dq->items) gf_free(dq->items);
+		gf_mx_del(dq->mx);
+		gf_free(dq);
+		return NULL;
+	}
+	return dq;
+}
+
+void gf_tdq_del(GF_TaskDeque *dq, void (*item_delete)(void *) )
+{
+	u32 i;
+	if (!dq) return;
+	if (item_delete) {
+		for (i=0; i<dq->nb_items; i++) {
+			item_delete(dq->items[(dq->top + i) % dq->alloc_items]);
+		}
+	}
+	gf_free(dq->items);
+	gf_mx_del(dq->mx);
+	gf_free(dq);
+}
+
+Bool gf_tdq_push(GF_TaskDeque *dq, void *item)
+{
+	gf_assert(dq);
+	gf_mx_p(dq->mx);
+	if (dq->nb_items == dq->alloc_items) {
+		u32 i, new_alloc = 2*dq->alloc_items;
+		void **items = gf_malloc(sizeof(void *) * new_alloc);
+		if (!items) {
+			gf_mx_v(dq->mx);
+			GF_LOG(GF_LOG_WARNING, GF_LOG_SCHEDULER, ("No more memory to grow task deque\n"));
+			return GF_FALSE;
+		}
+		//unwrap items
+		for (i=0; i<dq->nb_items; i++) {
+			items[i] = dq->items[(dq->top + i) % dq->alloc_items];
+		}
+		gf_free(dq->items);
+		dq->items = items;
+		dq->alloc_items = new_alloc;
+		dq->top = 0;
+	}
+	dq->items[(dq->top + dq->nb_items) % dq->alloc_items] = item;
+	dq->nb_items++;
+	gf_mx_v(dq->mx);
+	return GF_TRUE;
+}
+
+void *gf_tdq_pop(GF_TaskDeque *dq)
+{
+	void *data = NULL;
+	//unprotected check, avoids locking when empty
+	if (!dq || !dq->nb_items) return NULL;
+	gf_mx_p(dq->mx);
+	if (dq->nb_items) {
+		dq->nb_items--;
+		data = dq->items[(dq->top + dq->nb_items) % dq->alloc_items];
+	}
+	gf_mx_v(dq->mx);
+	return data;
+}
+
+void *gf_tdq_steal(GF_TaskDeque *dq)
+{
+	void *data = NULL;
+	if (!dq || !dq->nb_items) return NULL;
+	gf_mx_p(dq->mx);
+	if (dq->nb_items) {
+		data = dq->items[dq->top];
+		dq->top = (dq->top + 1) % dq->alloc_items;
+		dq->nb_items--;
+	}
+	gf_mx_v(dq->mx);
+	return data;
+}
+
+u32 gf_tdq_count(GF_TaskDeque *dq)
+{
+	return dq ? dq->nb_items : 0;
+}
+
+void gf_tdq_enum(GF_TaskDeque *dq, void (*enum_func)(void *udta1, void *item), void *udta)
+{
+	u32 i;
+	if (!dq || !enum_func) return;
+	gf_mx_p(dq->mx);
+	for (i=0; i<dq->nb_items; i++) {
+		enum_func(udta, dq->items[(dq->top + i) % dq->alloc_items]);
+	}
+	gf_mx_v(dq->mx);
+}
@@ -60,7 +60,7 @@ static GFINLINE void gf_fs_sema_io(GF_FilterSession *fsess, Bool notify, Bool ma
 			nb_tasks = 1;
 			//no active threads, count number of tasks. If no posted tasks we are likely at the end of the session, don't block, rather use a sem_wait
 			if (!fsess->active_threads)
-			 	nb_tasks = gf_fq_count(fsess->main_thread_tasks) + gf_fq_count(fsess->tasks);
+			 	nb_tasks = gf_fq_count(fsess->main_thread_tasks) + gf_fq_count(fsess->tasks) + fsess->nb_local_tasks;
 
 			//if main semaphore, keep track that we are going to sleep
 			if (main) {
@@ -200,6 +200,98 @@ static Bool fs_check_locales(void *__self, const char *locales_parent_path, cons
 #include <emscripten/threading.h>
 #endif
 
+static GF_FSTraceRing *gf_fs_trace_ring_new(GF_FilterSession *fsess);
+static void gf_fs_trace_ring_del(GF_FSTraceRing *ring);
+static void gf_fs_trace_write(GF_FilterSession *fsess);
+
+#ifndef GPAC_DISABLE_THREADS
+#define GF_FS_MAX_CPUS		1024
+#define GF_FS_MAX_NUMA_NODES	64
+
+static u32 gf_fs_cpu_node(u8 *cpu_nodes, s32 cpu)
+{
+	if ((cpu<0) || (cpu>=GF_FS_MAX_CPUS)) return 0;
+	return cpu_nodes[cpu];
+}
+
+//setup CPU affinity and NUMA node of session threads, replacing any previous setup
+static void gf_fs_setup_affinity(GF_FilterSession *fsess, const char *cpu_list)
+{
+	u32 i, j, nb_cpus=0, nb_nodes=0;
+	u32 *cpus;
+	u8 *cpu_nodes;
+	u32 nodes[GF_FS_MAX_NUMA_NODES];
+	u32 nb_threads = gf_list_count(fsess->threads);
+	Bool numa = (fsess->flags & GF_FS_FLAG_NUMA) ? GF_TRUE : GF_FALSE;
+
+	for (i=0; i<nb_threads; i++) {
+		GF_SessionThread *sess_th = gf_list_get(fsess->threads, i);
+		if (sess_th->cpus) gf_free(sess_th->cpus);
+		sess_th->cpus = NULL;
+		sess_th->nb_cpus = 0;
+		sess_th->numa_node = 0;
+	}
+	fsess->main_th.numa_node = 0;
+	if (!nb_threads || (!numa && !cpu_list)) return;
+
+	cpus = gf_malloc(sizeof(u32)*GF_FS_MAX_CPUS);
+	cpu_nodes = gf_malloc(sizeof(u8)*GF_FS_MAX_CPUS);
+	if (!cpus || !cpu_nodes) goto exit;
+	memset(cpu_nodes, 0, sizeof(u8)*GF_FS_MAX_CPUS);
+
+	//CPU to node map
+	for (i=0; i<GF_FS_MAX_NUMA_NODES; i++) {
+		u32 nb_node_cpus = gf_th_get_numa_cpus(i, cpus, GF_FS_MAX_CPUS);
+		if (!nb_node_cpus) continue;
+		for (j=0; j<nb_node_cpus; j++) {
+			if (cpus[j]<GF_FS_MAX_CPUS) cpu_nodes[cpus[j]] = i;
+		}
+		nodes[nb_nodes++] = i;
+		fsess->nb_numa_nodes = i+1;
+	}
+	if (numa && (fsess->nb_numa_nodes>1))
+		fsess->numa_aware = GF_TRUE;
+
+	if (cpu_list) {
+		nb_cpus = gf_th_parse_cpu_list(cpu_list, cpus, GF_FS_MAX_CPUS);
+		if (!nb_cpus) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_SCHEDULER, ("Invalid CPU list %s, ignoring\n", cpu_list));
+		}
+	}
+
+	for (i=0; i<nb_threads; i++) {
+		GF_SessionThread *sess_th = gf_list_get(fsess->threads, i);
+		//one CPU per thread, round-robin
+		if (nb_cpus) {
+			sess_th->cpus = gf_malloc(sizeof(u32));
+			if (!sess_th->cpus) continue;
+			sess_th->cpus[0] = cpus[i % nb_cpus];
+			sess_th->nb_cpus = 1;
+			sess_th->numa_node = gf_fs_cpu_node(cpu_nodes, cpus[i % nb_cpus]);
+		}
+		//all CPUs of one node per thread, nodes round-robin
+		else if (fsess->numa_aware) {
+			u32 *node_cpus = gf_malloc(sizeof(u32)*GF_FS_MAX_CPUS);
+			if (!node_cpus) continue;
+			sess_th->numa_node = nodes[i % nb_nodes];
+			sess_th->nb_cpus = gf_th_get_numa_cpus(sess_th->numa_node, node_cpus, GF_FS_MAX_CPUS);
+			sess_th->cpus = gf_realloc(node_cpus, sizeof(u32)*sess_th->nb_cpus);
+			if (!sess_th->cpus) {
+				gf_free(node_cpus);
+				sess_th->nb_cpus = 0;
+			}
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_SCHEDULER, ("Thread %u bound to %u CPUs (first %u) on node %u\n", i+1, sess_th->nb_cpus, sess_th->nb_cpus ? sess_th->cpus[0] : 0, sess_th->numa_node));
+	}
+	//main thread is not bound, use node it is currently running on
+	fsess->main_th.numa_node = gf_fs_cpu_node(cpu_nodes, gf_th_current_cpu());
+
+exit:
+	if (cpus) gf_free(cpus);
+	if (cpu_nodes) gf_free(cpu_nodes);
+}
+#endif
+
 GF_EXPORT
 GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, GF_FilterSessionFlags flags, const char *blacklist)
 {
@@ -317,9 +409,6 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 		fsess->props_mx = gf_mx_new("FilterSessionProps");
 
 	if (!(flags & GF_FS_FLAG_NO_RESERVOIR)) {
-#if GF_PROPS_HASHTABLE_SIZE
-		fsess->prop_maps_list_reservoir = gf_fq_new(fsess->props_mx);
-#endif
 		fsess->prop_maps_reservoir = gf_fq_new(fsess->props_mx);
 		fsess->prop_maps_entry_reservoir = gf_fq_new(fsess->props_mx);
 		fsess->prop_maps_entry_data_alloc_reservoir = gf_fq_new(fsess->props_mx);
@@ -337,6 +426,7 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 	if (nb_threads) {
 		fsess->info_mx = gf_mx_new("FilterSessionInfo");
 		fsess->ui_mx = gf_mx_new("FilterSessionUIProc");
+		fsess->atoms_mx = gf_mx_new("FilterSessionPropNames");
 	}
 
 #ifndef GPAC_DISABLE_THREADS
@@ -352,10 +442,54 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 			continue;
 		}
 		sess_thread->fsess = fsess;
+		if (sched_type==GF_FS_SCHEDULER_WORK_STEAL) {
+			sprintf(szName, "gf_fs_th_%d_tasks", i+1);
+			sess_thread->local_tasks = gf_tdq_new(szName);
+		}
 		gf_list_add(fsess->threads, sess_thread);
 	}
+	if ((sched_type==GF_FS_SCHEDULER_WORK_STEAL) && gf_list_count(fsess->threads))
+		fsess->work_stealing = GF_TRUE;
+
+	if (gf_opts_get_bool("core", "th-numa"))
+		fsess->flags |= GF_FS_FLAG_NUMA;
+	gf_fs_setup_affinity(fsess, gf_opts_get_key("core", "th-cpus"));
 #endif
 
+	opt = gf_opts_get_key("core", "trace");
+	if (opt && opt[0]) {
+		u32 trace_size = 1024;
+		while ((trace_size < gf_opts_get_int("core", "trace-size")) && (trace_size < 0x4000000))
+			trace_size *= 2;
+		fsess->trace_file = gf_strdup(opt);
+		fsess->trace_mask = trace_size-1;
+		fsess->trace_start = gf_sys_clock_high_res();
+		fsess->main_th.trace = gf_fs_trace_ring_new(fsess);
+		fsess->trace_ext = gf_fs_trace_ring_new(fsess);
+#ifndef GPAC_DISABLE_THREADS
+		for (i=0; i<gf_list_count(fsess->threads); i++) {
+			GF_SessionThread *sess_thread = gf_list_get(fsess->threads, i);
+			sess_thread->trace = gf_fs_trace_ring_new(fsess);
+		}
+#endif
+	}
+
+	if (!(flags & GF_FS_FLAG_NO_RESERVOIR)) {
+		u64 pool_size = gf_opts_get_int("core", "pck-pool");
+		if (pool_size)
+			fsess->pck_pool = gf_fs_pck_pool_new(fsess, pool_size * 1024 * 1024);
+	}
+
+	opt = gf_opts_get_key("core", "lat-dump");
+	if (opt && opt[0]) {
+		fsess->lat_dump = gf_strdup(opt);
+		fsess->lat_period = gf_opts_get_int("core", "lat-period");
+		if (!fsess->lat_period) fsess->lat_period = 1000;
+		fsess->lat_hist = GF_TRUE;
+	}
+	if (gf_opts_get_bool("core", "lat-hist"))
+		fsess->lat_hist = GF_TRUE;
+
 	gf_fs_set_separators(fsess, NULL);
 
 	fsess->registry = gf_list_new();
@@ -404,8 +538,11 @@ GF_FilterSession *gf_fs_new(s32 nb_threads, GF_FilterSchedulerType sched_type, G
 	fsess->gl_providers = gf_list_new();
 #endif
 
-	if (! (fsess->flags & GF_FS_FLAG_NO_GRAPH_CACHE))
+	if (! (fsess->flags & GF_FS_FLAG_NO_GRAPH_CACHE)) {
+		if (gf_opts_get_bool("core", "link-cache"))
+			fsess->link_cache = gf_fs_link_cache_new(fsess);
 		gf_filter_sess_build_graph(fsess, NULL);
+	}
 
 	fsess->init_done = GF_TRUE;
 
@@ -546,6 +683,7 @@ GF_FilterSession *gf_fs_new_defaults(GF_FilterSessionFlags inflags)
 	else if (!strcmp(opt, "direct")) sched_type = GF_FS_SCHEDULER_DIRECT;
 	else if (!strcmp(opt, "free")) sched_type = GF_FS_SCHEDULER_LOCK_FREE;
 	else if (!strcmp(opt, "freex")) sched_type = GF_FS_SCHEDULER_LOCK_FREE_X;
+	else if (!strcmp(opt, "steal")) sched_type = GF_FS_SCHEDULER_WORK_STEAL;
 	else {
 		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("Unrecognized scheduler type %s\n", opt));
 		return NULL;
@@ -574,6 +712,9 @@ GF_FilterSession *gf_fs_new_defaults(GF_FilterSessionFlags inflags)
 	if (inflags & GF_FS_FLAG_PREVENT_PLAY)
 		flags |= GF_FS_FLAG_PREVENT_PLAY;
 
+	if (inflags & GF_FS_FLAG_NUMA)
+		flags |= GF_FS_FLAG_NUMA;
+
 	if (gf_opts_get_bool("core", "dbg-edges"))
 		flags |= GF_FS_FLAG_PRINT_CONNECTIONS;
 
@@ -616,6 +757,21 @@ GF_FilterSession *gf_fs_new_defaults(GF_FilterSessionFlags inflags)
 }
 
 
+GF_EXPORT
+GF_Err gf_fs_set_thread_cpus(GF_FilterSession *session, const char *cpu_list)
+{
+	if (!session) return GF_BAD_PARAM;
+#ifndef GPAC_DISABLE_THREADS
+	//threads are bound when they start
+	if (session->nb_threads_stopped != 1 + gf_list_count(session->threads)) return GF_BAD_PARAM;
+	if (cpu_list && !cpu_list[0]) cpu_list = NULL;
+	gf_fs_setup_affinity(session, cpu_list);
+	if (session->pck_pool)
+		gf_fs_pck_pool_set_nodes(session->pck_pool, session);
+#endif
+	return GF_OK;
+}
+
 GF_EXPORT
 GF_Err gf_fs_set_separators(GF_FilterSession *session, const char *separator_set)
 {
@@ -730,6 +886,20 @@ void gf_fs_del(GF_FilterSession *fsess)
 	gf_fs_stop(fsess);
 	GF_LOG(GF_LOG_DEBUG, GF_LOG_FILTER, ("Session destroy begin\n"));
 
+	//flush resolved chains before destroying filters and registry
+	if (fsess->link_cache)
+		gf_fs_link_cache_del(fsess);
+
+	if (fsess->trace_file)
+		gf_fs_trace_write(fsess);
+
+	//final latency dump
+	if (fsess->lat_dump) {
+		gf_fs_dump_latency(fsess);
+		gf_free(fsess->lat_dump);
+		fsess->lat_dump = NULL;
+	}
+
 	if (fsess->parsed_args) {
 		while (gf_list_count(fsess->parsed_args)) {
 			GF_FSArgItem *ai = gf_list_pop_back(fsess->parsed_args);
@@ -831,18 +1001,27 @@ void gf_fs_del(GF_FilterSession *fsess)
 		while (gf_list_count(fsess->threads)) {
 			GF_SessionThread *sess_th = gf_list_pop_back(fsess->threads);
 			gf_th_del(sess_th->th);
+			if (sess_th->local_tasks)
+				gf_tdq_del(sess_th->local_tasks, gf_task_del);
+			gf_fs_trace_ring_del(sess_th->trace);
+			if (sess_th->cpus) gf_free(sess_th->cpus);
 			gf_free(sess_th);
 		}
 		gf_list_del(fsess->threads);
 	}
 #endif
 
+	if (fsess->pck_pool)
+		gf_fs_pck_pool_del(fsess->pck_pool);
+
+	if (fsess->trace_file) {
+		gf_fs_trace_ring_del(fsess->main_th.trace);
+		gf_fs_trace_ring_del(fsess->trace_ext);
+		gf_free(fsess->trace_file);
+	}
+
 	if (fsess->prop_maps_reservoir)
 		gf_fq_del(fsess->prop_maps_reservoir, gf_propmap_del);
-#if GF_PROPS_HASHTABLE_SIZE
-	if (fsess->prop_maps_list_reservoir)
-		gf_fq_del(fsess->prop_maps_list_reservoir, (gf_destruct_fun) gf_list_del);
-#endif
 	if (fsess->prop_maps_entry_reservoir)
 		gf_fq_del(fsess->prop_maps_entry_reservoir, gf_void_del);
 	if (fsess->prop_maps_entry_data_alloc_reservoir) {
@@ -851,6 +1030,11 @@ void gf_fs_del(GF_FilterSession *fsess)
 	if (fsess->pcks_refprops_reservoir)
 		gf_fq_del(fsess->pcks_refprops_reservoir, gf_void_del);
 
+	gf_props_del_atoms(fsess);
+	if (fsess->atoms_mx) {
+		gf_mx_del(fsess->atoms_mx);
+		fsess->atoms_mx = NULL;
+	}
 
 	if (fsess->props_mx)
 		gf_mx_del(fsess->props_mx);
@@ -943,6 +1127,35 @@ static void check_task_list(GF_FilterQueue *fq, GF_FSTask *task)
 }
 #endif
 
+//get the local task deque of the thread the filter last ran on, NULL if task shall be posted on the secondary task list
+static GFINLINE GF_TaskDeque *gf_fs_get_local_tasks(GF_FilterSession *fsess, GF_Filter *filter)
+{
+#ifndef GPAC_DISABLE_THREADS
+	GF_SessionThread *sess_th;
+	//filters pinned to a thread use the secondary list as usual
+	if (!fsess->work_stealing || !filter || !filter->sched_th_idx || filter->restrict_th_idx)
+		return NULL;
+	sess_th = gf_list_get(fsess->threads, filter->sched_th_idx-1);
+	return sess_th ? sess_th->local_tasks : NULL;
+#else
+	return NULL;
+#endif
+}
+
+static GFINLINE void gf_fs_post_secondary_task(GF_FilterSession *fsess, GF_FSTask *task)
+{
+	GF_TaskDeque *local_tasks = gf_fs_get_local_tasks(fsess, task->filter);
+	if (local_tasks) {
+		//count before pushing, the task may be popped right away by another thread
+		safe_int_inc(&fsess->nb_local_tasks);
+		if (gf_tdq_push(local_tasks, task))
+			return;
+		//deque cannot grow, use the secondary task list
+		safe_int_dec(&fsess->nb_local_tasks);
+	}
+	gf_fq_add(fsess->tasks, task);
+}
+
 void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, GF_Filter *filter, GF_FilterPid *pid, const char *log_name, void *udta, Bool is_configure, Bool force_main_thread, Bool force_direct_call, GF_TaskClassType class_type, u32 delay_ms)
 {
 	GF_FSTask *task;
@@ -972,6 +1185,8 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 			filter->scheduled_for_next_task = GF_FILTER_DIRECT_SCHEDULED;
 		task_fun(&atask);
 		filter = atask.filter;
+		if (fsess->trace_file)
+			gf_fs_trace(fsess, &fsess->main_th, GF_FS_TRACE_TASK, task_time, filter ? filter->name : NULL, log_name);
 		if (filter) {
 			filter->last_task_time = (u32) (gf_sys_clock_high_res() - task_time);
 			filter->time_process += filter->last_task_time;
@@ -1018,6 +1233,9 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 	task->udta = udta;
 	task->class_type = class_type;
 
+	if (fsess->trace_file)
+		gf_fs_trace(fsess, NULL, GF_FS_TRACE_POST, 0, filter ? filter->name : NULL, log_name);
+
 	if (filter && is_configure) {
 		if (filter->freg->flags & GF_FS_REG_CONFIGURE_MAIN_THREAD)
 			force_main_thread = GF_TRUE;
@@ -1085,7 +1303,7 @@ void gf_fs_post_task_ex(GF_FilterSession *fsess, gf_fs_task_callback task_fun, G
 			gf_fs_sema_io(fsess, GF_TRUE, GF_TRUE);
 		} else {
 			gf_assert(task->run_task);
-			gf_fq_add(fsess->tasks, task);
+			gf_fs_post_secondary_task(fsess, task);
 			gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
 		}
 	}
@@ -1814,6 +2032,17 @@ void gf_fs_print_debug_info(GF_FilterSession *fsess, GF_SessionDebugFlag dbg_fla
 			i=0;
 			gf_fq_enum(fsess->tasks, print_task_list, &i);
 		}
+#ifndef GPAC_DISABLE_THREADS
+		if (fsess->work_stealing) {
+			count = gf_list_count(fsess->threads);
+			for (i=0; i<count; i++) {
+				u32 j=0;
+				GF_SessionThread *sess_th = gf_list_get(fsess->threads, i);
+				fprintf(stderr, "Thread %u local tasks:\n", i+2);
+				gf_tdq_enum(sess_th->local_tasks, print_task_list, &j);
+			}
+		}
+#endif
 	}
 
 	if (dbg_flags & GF_FS_DEBUG_FILTERS) {
@@ -1902,7 +2131,77 @@ const char *gf_th_log_name(GF_Thread *t);
 #define gf_th_log_name(_t) "Main Process"
 #endif
 
+//fetch a task from the secondary task list. For work-stealing scheduler, tasks are fetched from the thread local deque (LIFO),
+//then from the secondary task list, and then stolen from other threads deques (FIFO)
+static GFINLINE GF_FSTask *gf_fs_pop_secondary_task(GF_FilterSession *fsess, GF_SessionThread *sess_thread, u32 thid, u32 th_count)
+{
+	GF_FSTask *task;
+	if (!fsess->work_stealing)
+		return gf_fq_pop(fsess->tasks);
+
+	task = gf_tdq_pop(sess_thread->local_tasks);
+	if (task) {
+		safe_int_dec(&fsess->nb_local_tasks);
+		return task;
+	}
+	task = gf_fq_pop(fsess->tasks);
+	if (task || !fsess->nb_local_tasks)
+		return task;
+
+#ifndef GPAC_DISABLE_THREADS
+	u32 i, pass;
+	//in NUMA-aware mode, steal from threads of the same node first
+	for (pass = fsess->numa_aware ? 0 : 1; pass<2; pass++) {
+		//start from next thread to avoid all threads stealing from the same victim
+		for (i=0; i<th_count; i++) {
+			GF_SessionThread *victim = gf_list_get(fsess->threads, (thid+i) % th_count);
+			if (victim == sess_thread) continue;
+			if (fsess->numa_aware) {
+				Bool same_node = (victim->numa_node == sess_thread->numa_node) ? GF_TRUE : GF_FALSE;
+				if (pass ? same_node : !same_node) continue;
+			}
+			task = gf_tdq_steal(victim->local_tasks);
+			if (task) {
+				safe_int_dec(&fsess->nb_local_tasks);
+				sess_thread->nb_tasks_stolen++;
+				return task;
+			}
+		}
+	}
+#endif
+	return NULL;
+}
+
+//session thread running tasks on the calling thread, NULL if none
+#if defined(_MSC_VER)
+static __declspec(thread) GF_SessionThread *current_session_thread = NULL;
+#else
+static __thread GF_SessionThread *current_session_thread = NULL;
+#endif
+
+GF_SessionThread *gf_fs_get_current_thread(GF_FilterSession *fsess)
+{
+	GF_SessionThread *sess_th = current_session_thread;
+	if (sess_th && (sess_th->fsess == fsess)) return sess_th;
+	//main thread outside of session run
+	if (fsess->main_th.th_id && (fsess->main_th.th_id == gf_th_id())) return &fsess->main_th;
+	return NULL;
+}
+
+static u32 gf_fs_thread_run_tasks(GF_SessionThread *sess_thread);
+
 static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
+{
+	u32 ret;
+	//sessions may run nested on the same thread
+	GF_SessionThread *prev_sess_thread = current_session_thread;
+	current_session_thread = sess_thread;
+	ret = gf_fs_thread_run_tasks(sess_thread);
+	current_session_thread = prev_sess_thread;
+	return ret;
+}
+
+static u32 gf_fs_thread_run_tasks(GF_SessionThread *sess_thread)
 {
 	GF_FilterSession *fsess = sess_thread->fsess;
 #ifndef GPAC_DISABLE_THREADS
@@ -1948,6 +2247,9 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 	//first time we enter the thread proc
 	if (!sess_thread->th_id) {
 		sess_thread->th_id = gf_th_id();
+		//bind before any allocation is made by this thread
+		if (sess_thread->cpus)
+			gf_th_set_cpu_affinity(NULL, sess_thread->cpus, sess_thread->nb_cpus);
 #ifdef GPAC_CONFIG_EMSCRIPTEN
 		if (fsess->non_blocking && thid) {
 			sess_thread->run_time = 0;
@@ -1982,16 +2284,24 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 		safe_int_dec(&fsess->active_threads);
 
 		if (!skip_next_sema_wait && (current_filter==NULL)) {
+			u64 wait_start = sess_thread->trace ? gf_sys_clock_high_res() : 0;
 			GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %s Waiting scheduler %s semaphore\n", sys_thid, use_main_sema ? "main" : "secondary"));
 			//wait for something to be done
 			gf_fs_sema_io(fsess, GF_FALSE, use_main_sema);
 			consecutive_filter_tasks = 0;
+			if (wait_start)
+				gf_fs_trace(fsess, sess_thread, GF_FS_TRACE_WAIT, wait_start, use_main_sema ? "main" : "secondary", NULL);
 		}
 		safe_int_inc(&fsess->active_threads);
 		skip_next_sema_wait = GF_FALSE;
 
 		active_start = gf_sys_clock_high_res();
 
+		//periodic latency dump, done by main thread
+		if (!thid && fsess->lat_dump && (active_start >= fsess->lat_next_dump)) {
+			gf_fs_dump_latency(fsess);
+		}
+
 		if (current_filter==NULL) {
 			//main thread
 			if (thid==0) {
@@ -1999,7 +2309,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 					task = gf_fq_pop(fsess->main_thread_tasks);
 				}
 				if (!task) {
-					task = gf_fq_pop(fsess->tasks);
+					task = gf_fs_pop_secondary_task(fsess, sess_thread, thid, th_count);
 					//if task is blocking, don't use it, let a secondary thread deal with it
 					if (task && task->blocking) {
 						gf_fq_add(fsess->tasks, task);
@@ -2017,7 +2327,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 				}
 #endif
 			} else {
-				task = gf_fq_pop(fsess->tasks);
+				task = gf_fs_pop_secondary_task(fsess, sess_thread, thid, th_count);
 				if (task && (task->force_main || (task->filter && task->filter->nb_main_thread_forced) ) ) {
 					//post to main
 					gf_fq_add(fsess->main_thread_tasks, task);
@@ -2091,7 +2401,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 
 			//no pending tasks and first time main task queue is empty, flush to detect if we
 			//are indeed done
-			if (!fsess->tasks_pending && !fsess->tasks_in_process && !sess_thread->has_seen_eot && !gf_fq_count(fsess->tasks)) {
+			if (!fsess->tasks_pending && !fsess->tasks_in_process && !sess_thread->has_seen_eot && !gf_fq_count(fsess->tasks) && !fsess->nb_local_tasks) {
 				//maybe last task, force a notify to check if we are truly done
 				sess_thread->has_seen_eot = GF_TRUE;
 				//not main thread and some tasks pending on main, notify only ourselves
@@ -2399,6 +2709,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 			gf_assert(!current_filter->in_process);
 			current_filter->in_process = GF_TRUE;
 			current_filter->process_th_id = gf_th_id();
+			current_filter->sched_th_idx = thid;
 		}
 
 		sess_thread->nb_tasks++;
@@ -2421,6 +2732,10 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 		task->thid = 0;
 		requeue = task->requeue_request;
 
+		//task filter may have been destroyed
+		if (sess_thread->trace)
+			gf_fs_trace(fsess, sess_thread, GF_FS_TRACE_TASK, task_time, task->filter ? task->filter->name : NULL, task->log_name);
+
 		task_time = gf_sys_clock_high_res() - task_time;
 		safe_int_dec(& fsess->tasks_in_process );
 
@@ -2437,6 +2752,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 			current_filter->nb_tasks_done++;
 			current_filter->last_task_time = task_time;
 			current_filter->time_process += task_time;
+			if (requeue) current_filter->nb_tasks_requeued++;
 			consecutive_filter_tasks++;
 
 #if defined(GPAC_CONFIG_EMSCRIPTEN)
@@ -2580,12 +2896,12 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 #ifndef GPAC_DISABLE_THREADS
 					//FIXME, we sometimes miss a sema notify resulting in secondary tasks being locked
 					//until we find the cause, notify secondary sema if non-main-thread tasks are scheduled and we are the only task in main
-					if (use_main_sema && (thid==0) && fsess->threads && (gf_fq_count(fsess->main_thread_tasks)==1) && gf_fq_count(fsess->tasks)) {
+					if (use_main_sema && (thid==0) && fsess->threads && (gf_fq_count(fsess->main_thread_tasks)==1) && (gf_fq_count(fsess->tasks) || fsess->nb_local_tasks)) {
 						gf_fs_sema_io(fsess, GF_TRUE, GF_FALSE);
 					}
 #endif
 				} else {
-					gf_fq_add(fsess->tasks, task);
+					gf_fs_post_secondary_task(fsess, task);
 				}
 				gf_fs_sema_io(fsess, GF_TRUE, use_main_sema);
 			}
@@ -2624,7 +2940,7 @@ static u32 gf_fs_thread_proc(GF_SessionThread *sess_thread)
 			current_filter->in_process = GF_FALSE;
 		}
 		//not requeuing and first time we have an empty task queue, flush to detect if we are indeed done
-		if (!current_filter && !fsess->tasks_pending && !sess_thread->has_seen_eot && !gf_fq_count(fsess->tasks)) {
+		if (!current_filter && !fsess->tasks_pending && !sess_thread->has_seen_eot && !gf_fq_count(fsess->tasks) && !fsess->nb_local_tasks) {
 			//if not the main thread, or if main thread and task list is empty, enter end of session probing mode
 			if (thid || !gf_fq_count(fsess->main_thread_tasks) ) {
 				//maybe last task, force a notify to check if we are truly done. We only tag "session done" for the non-main
@@ -2921,7 +3237,7 @@ GF_Err gf_fs_stop(GF_FilterSession *fsess)
 		if (gf_fq_count(fsess->main_thread_tasks))
 			continue;
 
-		if (count && (count == fsess->nb_threads_stopped) && gf_fq_count(fsess->tasks) ) {
+		if (count && (count == fsess->nb_threads_stopped) && (gf_fq_count(fsess->tasks) || fsess->nb_local_tasks) ) {
 			continue;
 		}
 		break;
@@ -3060,6 +3376,17 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 		if (f->nb_errors) {
 			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t%d errors while processing\n", f->nb_errors));
 		}
+		if (f->process_hist && f->process_hist->nb_samples) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\tprocess "LLU" calls: p50 "LLU" us p99 "LLU" us p99.9 "LLU" us max "LLU" us\n", f->process_hist->nb_samples,
+				gf_filter_hist_percentile(f->process_hist, 50), gf_filter_hist_percentile(f->process_hist, 99), gf_filter_hist_percentile(f->process_hist, 99.9), f->process_hist->max));
+		}
+		if (f->queue_hist && f->queue_hist->nb_samples) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\tqueue wait "LLU" packets: p50 "LLU" us p99 "LLU" us p99.9 "LLU" us max "LLU" us\n", f->queue_hist->nb_samples,
+				gf_filter_hist_percentile(f->queue_hist, 50), gf_filter_hist_percentile(f->queue_hist, 99), gf_filter_hist_percentile(f->queue_hist, 99.9), f->queue_hist->max));
+		}
+		if (f->nb_tasks_requeued) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\t\t"LLU" tasks requeued\n", f->nb_tasks_requeued));
+		}
 #endif
 
 		gf_mx_v(f->tasks_mx);
@@ -3084,7 +3411,17 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 	for (i=0; i<count; i++) {
 		GF_SessionThread *s = gf_list_get(fsess->threads, i);
 
-		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", i+2, s->run_time, s->active_time, s->nb_tasks));
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\tThread %u: run_time "LLU" us active_time "LLU" us nb_tasks "LLU, i+2, s->run_time, s->active_time, s->nb_tasks));
+		if (fsess->work_stealing) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" stolen "LLU, s->nb_tasks_stolen));
+		}
+		if (s->nb_cpus==1) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" CPU %u", s->cpus[0]));
+		}
+		if (fsess->numa_aware) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_APP, (" node %u", s->numa_node));
+		}
+		GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\n"));
 
 		run_time+=s->run_time;
 		active_time+=s->active_time;
@@ -3092,6 +3429,8 @@ void gf_fs_print_stats(GF_FilterSession *fsess)
 	}
 	GF_LOG(GF_LOG_INFO, GF_LOG_APP, ("\nTotal: run_time "LLU" us active_time "LLU" us nb_tasks "LLU"\n", run_time, active_time, nb_tasks));
 #endif
+	gf_fs_pck_pool_print_stats(fsess);
+	gf_fs_link_cache_print_stats(fsess);
 }
 
 static void gf_fs_print_filter_outputs(GF_Filter *f, GF_List *filters_done, u32 indent, GF_FilterPid *pid, GF_Filter *alias_for, u32 src_num_tiled_pids, Bool skip_print, s32 nb_recursion, u32 max_length)
@@ -3362,6 +3701,7 @@ void gf_fs_print_connections(GF_FilterSession *fsess)
 
 	gf_mx_v(fsess->filters_mx);
 	gf_list_del(filters_done);
+	gf_fs_link_cache_print_stats(fsess);
 }
 
 GF_EXPORT
@@ -4557,6 +4897,102 @@ GF_Err gf_fs_post_user_task_delay(GF_FilterSession *fsess, Bool (*task_execute)
 	return gf_fs_post_user_task_internal(fsess, task_execute, udta_callback, log_name, fsess->force_main_thread_tasks, delay_ms);
 }
 
+typedef struct
+{
+	GF_Err (*job_run)(void *udta, u32 job_idx);
+	void *udta;
+	u32 nb_jobs;
+	//index of next job to claim
+	volatile u32 next;
+	volatile u32 nb_done;
+	//caller and posted tasks
+	volatile u32 ref_count;
+	//notified once by the thread completing the last job
+	GF_Semaphore *done;
+	GF_Err e;
+} GF_FSJobs;
+
+static void gf_fs_jobs_process(GF_FSJobs *jobs)
+{
+	while (1) {
+		GF_Err e;
+		u32 idx = (u32) safe_int_fetch_add(&jobs->next, 1);
+		if (idx >= jobs->nb_jobs) break;
+		e = jobs->job_run(jobs->udta, idx);
+		if (e) jobs->e = e;
+		if (safe_int_inc(&jobs->nb_done) == jobs->nb_jobs)
+			gf_sema_notify(jobs->done, 1);
+	}
+}
+
+static void gf_fs_jobs_release(GF_FSJobs *jobs)
+{
+	if (safe_int_dec(&jobs->ref_count)) return;
+	gf_sema_del(jobs->done);
+	gf_free(jobs);
+}
+
+static Bool gf_fs_jobs_task(GF_FilterSession *fsess, void *callback, u32 *reschedule_ms)
+{
+	GF_FSJobs *jobs = (GF_FSJobs *)callback;
+	//tasks scheduled after all jobs were claimed only drop their reference
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_SCHEDULER, ("Thread %u processing jobs, %u/%u claimed\n", gf_th_id(), jobs->next, jobs->nb_jobs));
+	gf_fs_jobs_process(jobs);
+	gf_fs_jobs_release(jobs);
+	return GF_FALSE;
+}
+
+GF_EXPORT
+GF_Err gf_fs_run_jobs(GF_FilterSession *fsess, u32 nb_jobs, u32 max_threads, GF_Err (*job_run)(void *udta, u32 job_idx), void *udta)
+{
+	u32 i, nb_helpers = 0;
+	GF_Err e;
+	GF_FSJobs *jobs;
+	if (!job_run) return GF_BAD_PARAM;
+
+	if (fsess && !fsess->force_main_thread_tasks)
+		nb_helpers = gf_list_count(fsess->threads);
+	if (max_threads && (nb_helpers >= max_threads)) nb_helpers = max_threads-1;
+	if (nb_helpers >= nb_jobs) nb_helpers = nb_jobs ? nb_jobs-1 : 0;
+
+	if (!nb_helpers) {
+		e = GF_OK;
+		for (i=0; i<nb_jobs; i++) {
+			GF_Err ret = job_run(udta, i);
+			if (ret) e = ret;
+		}
+		return e;
+	}
+
+	GF_SAFEALLOC(jobs, GF_FSJobs);
+	if (!jobs) return GF_OUT_OF_MEM;
+	jobs->done = gf_sema_new(1, 0);
+	if (!jobs->done) {
+		gf_free(jobs);
+		return GF_OUT_OF_MEM;
+	}
+	jobs->job_run = job_run;
+	jobs->udta = udta;
+	jobs->nb_jobs = nb_jobs;
+	jobs->ref_count = 1 + nb_helpers;
+	for (i=0; i<nb_helpers; i++) {
+		if (gf_fs_post_user_task_internal(fsess, gf_fs_jobs_task, jobs, "run_jobs", GF_FALSE, 0) != GF_OK)
+			safe_int_dec(&jobs->ref_count);
+	}
+	//the calling thread works on jobs as well, and only waits for jobs already claimed by workers
+	gf_fs_jobs_process(jobs);
+	gf_sema_wait(jobs->done);
+	e = jobs->e;
+	gf_fs_jobs_release(jobs);
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_filter_run_jobs(GF_Filter *filter, u32 nb_jobs, u32 max_threads, GF_Err (*job_run)(void *udta, u32 job_idx), void *udta)
+{
+	return gf_fs_run_jobs(filter ? filter->session : NULL, nb_jobs, max_threads, job_run, udta);
+}
+
 GF_EXPORT
 GF_Err gf_fs_post_user_task_main(GF_FilterSession *fsess, Bool (*task_execute) (GF_FilterSession *fsess, void *callback, u32 *reschedule_ms), void *udta_callback, const char *log_name)
 {
@@ -4593,6 +5029,7 @@ Bool gf_fs_is_last_task(GF_FilterSession *fsess)
 	if (fsess->tasks_pending>1) return GF_FALSE;
 	if (gf_fq_count(fsess->main_thread_tasks)) return GF_FALSE;
 	if (gf_fq_count(fsess->tasks)) return GF_FALSE;
+	if (fsess->nb_local_tasks) return GF_FALSE;
 	if (fsess->non_blocking && fsess->tasks_in_process) return GF_FALSE;
 	return GF_TRUE;
 }
@@ -4649,6 +5086,242 @@ GF_Filter *gf_fs_get_filter(GF_FilterSession *session, u32 idx)
 	return session ? gf_list_get(session->filters, idx) : NULL;
 }
 
+//values below 8 have their own bucket, then 8 sub-buckets per power of 2
+static u32 gf_filter_hist_bucket(u64 val)
+{
+	u32 msb = 3;
+	if (val < 8) return (u32) val;
+	while ((msb < 39) && (val >> (msb+1))) msb++;
+	if (val >> (msb+1)) return GF_FILTER_HIST_BUCKETS-1;
+	return 8 + (msb-3)*8 + (u32) ((val >> (msb-3)) & 7);
+}
+
+//highest value of bucket
+static u64 gf_filter_hist_bucket_max(u32 idx)
+{
+	u32 shift;
+	if (idx < 8) return idx;
+	shift = (idx-8) / 8;
+	return ((u64) (8 + (idx-8) % 8 + 1) << shift) - 1;
+}
+
+void gf_filter_hist_add(GF_FilterHistogram *hist, u64 val)
+{
+	safe_int_inc(&hist->counts[gf_filter_hist_bucket(val)]);
+	safe_int64_add(&hist->nb_samples, 1);
+	safe_int64_add(&hist->total, val);
+	//max may miss a concurrent update, bucket values are exact
+	if (val > hist->max) hist->max = val;
+}
+
+GF_EXPORT
+u64 gf_filter_hist_percentile(const GF_FilterHistogram *hist, Double percentile)
+{
+	u32 i;
+	u64 nb_samples=0, count=0, target;
+	if (!hist) return 0;
+	for (i=0; i<GF_FILTER_HIST_BUCKETS; i++)
+		nb_samples += hist->counts[i];
+	if (!nb_samples) return 0;
+	if (percentile>100) percentile = 100;
+	target = (u64) (percentile * nb_samples / 100);
+	if (target * 100 < percentile * nb_samples) target++;
+	if (!target) target = 1;
+	for (i=0; i<GF_FILTER_HIST_BUCKETS; i++) {
+		count += hist->counts[i];
+		if (count >= target) {
+			u64 val = gf_filter_hist_bucket_max(i);
+			return (hist->max && (val > hist->max)) ? hist->max : val;
+		}
+	}
+	return hist->max;
+}
+
+static void gf_fs_dump_hist_json(FILE *out, const char *name, const GF_FilterHistogram *hist)
+{
+	gf_fprintf(out, ", \"%s\": {\"count\": "LLU", \"mean\": "LLU", \"max\": "LLU", \"p50\": "LLU", \"p90\": "LLU", \"p99\": "LLU", \"p999\": "LLU"}",
+		name, hist->nb_samples, hist->nb_samples ? hist->total / hist->nb_samples : 0, hist->max,
+		gf_filter_hist_percentile(hist, 50), gf_filter_hist_percentile(hist, 90), gf_filter_hist_percentile(hist, 99), gf_filter_hist_percentile(hist, 99.9));
+}
+
+static void gf_fs_dump_json_str(FILE *out, const char *name, const char *str)
+{
+	gf_fprintf(out, "\"%s\": ", name);
+	if (!str) {
+		gf_fprintf(out, "null");
+		return;
+	}
+	gf_fputc('"', out);
+	while (*str) {
+		if ((*str=='"') || (*str=='\\')) gf_fputc('\\', out);
+		if ((u8) *str >= 0x20) gf_fputc(*str, out);
+		str++;
+	}
+	gf_fputc('"', out);
+}
+
+static GF_FSTraceRing *gf_fs_trace_ring_new(GF_FilterSession *fsess)
+{
+	GF_FSTraceRing *ring;
+	GF_SAFEALLOC(ring, GF_FSTraceRing);
+	if (!ring) return NULL;
+	ring->events = gf_malloc(sizeof(GF_FSTraceEvent) * (fsess->trace_mask+1));
+	if (!ring->events) {
+		gf_free(ring);
+		return NULL;
+	}
+	return ring;
+}
+
+static void gf_fs_trace_ring_del(GF_FSTraceRing *ring)
+{
+	if (!ring) return;
+	gf_free(ring->events);
+	gf_free(ring);
+}
+
+void gf_fs_trace(GF_FilterSession *fsess, GF_SessionThread *sess_th, u32 type, u64 start, const char *name, const char *sub_name)
+{
+	u32 idx;
+	u64 now;
+	GF_FSTraceEvent *evt;
+	GF_FSTraceRing *ring;
+
+	if (!sess_th)
+		sess_th = gf_fs_get_current_thread(fsess);
+	ring = (sess_th && sess_th->trace) ? sess_th->trace : fsess->trace_ext;
+	if (!ring) return;
+
+	//only the owning thread writes to a session thread ring, but any thread may write to the external ring
+	idx = (u32) safe_int_fetch_add(&ring->pos, 1);
+	evt = &ring->events[idx & fsess->trace_mask];
+	now = gf_sys_clock_high_res();
+	if (start) {
+		evt->ts = start - fsess->trace_start;
+		evt->dur = (u32) (now - start);
+	} else {
+		evt->ts = now - fsess->trace_start;
+		evt->dur = 0;
+	}
+	evt->type = type;
+	if (sub_name)
+		snprintf(evt->name, sizeof(evt->name), "%s:%s", name ? name : "", sub_name);
+	else
+		snprintf(evt->name, sizeof(evt->name), "%s", name ? name : "");
+}
+
+static const char *gf_fs_trace_cat[] = {"task", "post", "send", "drop", "block", "unblock", "wait"};
+
+static u32 gf_fs_trace_write_ring(GF_FilterSession *fsess, FILE *out, GF_FSTraceRing *ring, u32 tid, const char *th_name)
+{
+	u32 i, first, nb_dropped=0;
+	if (!ring) return 0;
+	gf_fprintf(out, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}}", tid, th_name);
+
+	first = 0;
+	if (ring->pos > fsess->trace_mask+1) {
+		first = ring->pos - fsess->trace_mask - 1;
+		nb_dropped = first;
+	}
+	for (i=first; i<ring->pos; i++) {
+		GF_FSTraceEvent *evt = &ring->events[i & fsess->trace_mask];
+		gf_fprintf(out, ",\n{");
+		gf_fs_dump_json_str(out, "name", evt->name);
+		gf_fprintf(out, ", \"cat\": \"%s\", \"pid\": 1, \"tid\": %u, \"ts\": "LLU, gf_fs_trace_cat[evt->type], tid, evt->ts);
+		if ((evt->type==GF_FS_TRACE_TASK) || (evt->type==GF_FS_TRACE_WAIT)) {
+			gf_fprintf(out, ", \"ph\": \"X\", \"dur\": %u}", evt->dur);
+		} else {
+			gf_fprintf(out, ", \"ph\": \"i\", \"s\": \"t\"}");
+		}
+	}
+	return nb_dropped;
+}
+
+//writes all trace rings as chrome trace event JSON
+static void gf_fs_trace_write(GF_FilterSession *fsess)
+{
+	u32 nb_dropped;
+	FILE *out = gf_fopen(fsess->trace_file, "w");
+	if (!out) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_FILTER, ("[Filters] Failed to open trace file %s\n", fsess->trace_file));
+		return;
+	}
+	gf_fprintf(out, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+	gf_fprintf(out, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"gpac\"}}");
+	nb_dropped = gf_fs_trace_write_ring(fsess, out, fsess->main_th.trace, 1, "main");
+#ifndef GPAC_DISABLE_THREADS
+	if (fsess->threads) {
+		u32 i, count = gf_list_count(fsess->threads);
+		for (i=0; i<count; i++) {
+			char szName[30];
+			GF_SessionThread *st = gf_list_get(fsess->threads, i);
+			sprintf(szName, "thread %u", i+2);
+			nb_dropped += gf_fs_trace_write_ring(fsess, out, st->trace, i+2, szName);
+		}
+	}
+#endif
+	if (fsess->trace_ext && fsess->trace_ext->pos)
+		nb_dropped += gf_fs_trace_write_ring(fsess, out, fsess->trace_ext, 0, "external");
+
+	gf_fprintf(out, "\n], \"otherData\": {\"dropped_events\": \"%u\"}}\n", nb_dropped);
+	gf_fclose(out);
+	if (nb_dropped) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Filters] Trace buffers full, %u oldest events dropped - increase -trace-size\n", nb_dropped));
+	}
+}
+
+void gf_fs_dump_latency(GF_FilterSession *fsess)
+{
+	u32 i, count;
+	FILE *out;
+	char *tmp_name;
+	Bool first = GF_TRUE;
+	if (!fsess->lat_dump) return;
+
+	fsess->lat_next_dump = gf_sys_clock_high_res() + (u64) fsess->lat_period * 1000;
+
+	//write to temp file and rename, so that readers never see a partial file
+	tmp_name = gf_strdup(fsess->lat_dump);
+	gf_dynstrcat(&tmp_name, ".tmp", NULL);
+	out = gf_fopen(tmp_name, "w");
+	if (!out) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Filters] Failed to open latency dump file %s\n", tmp_name));
+		gf_free(tmp_name);
+		return;
+	}
+	gf_fprintf(out, "{\"utc\": "LLU", \"filters\": [\n", gf_net_get_utc());
+
+	gf_mx_p(fsess->filters_mx);
+	count = gf_list_count(fsess->filters);
+	for (i=0; i<count; i++) {
+		GF_Filter *f = gf_list_get(fsess->filters, i);
+		if (f->multi_sink_target || !f->process_hist) continue;
+		gf_fprintf(out, "%s {", first ? "" : ",\n");
+		first = GF_FALSE;
+		gf_fs_dump_json_str(out, "name", f->name);
+		gf_fprintf(out, ", ");
+		gf_fs_dump_json_str(out, "reg", f->freg->name);
+		gf_fprintf(out, ", ");
+		gf_fs_dump_json_str(out, "id", f->id);
+		gf_fprintf(out, ", \"tasks\": "LLU", \"requeued\": "LLU", \"time_process\": "LLU, f->nb_tasks_done, f->nb_tasks_requeued, f->time_process);
+		gf_fs_dump_hist_json(out, "process", f->process_hist);
+		gf_fs_dump_hist_json(out, "queue", f->queue_hist);
+		gf_fprintf(out, "}");
+	}
+	gf_mx_v(fsess->filters_mx);
+	gf_fprintf(out, "\n]}\n");
+	gf_fclose(out);
+
+	if (gf_file_move(tmp_name, fsess->lat_dump) != GF_OK) {
+		gf_file_delete(fsess->lat_dump);
+		if (gf_file_move(tmp_name, fsess->lat_dump) != GF_OK) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_FILTER, ("[Filters] Failed to write latency dump file %s\n", fsess->lat_dump));
+			gf_file_delete(tmp_name);
+		}
+	}
+	gf_free(tmp_name);
+}
+
 GF_EXPORT
 GF_Err gf_filter_get_stats(GF_Filter *f, GF_FilterStats *stats)
 {
@@ -4669,6 +5342,9 @@ GF_Err gf_filter_get_stats(GF_Filter *f, GF_FilterStats *stats)
 	stats->nb_pck_sent = f->nb_pck_sent;
 	stats->nb_bytes_sent = f->nb_bytes_sent;
 	stats->nb_tasks_done = f->nb_tasks_done;
+	stats->nb_tasks_requeued = f->nb_tasks_requeued;
+	stats->process_hist = f->process_hist;
+	stats->queue_hist = f->queue_hist;
 	stats->nb_errors = f->nb_errors;
 	stats->name = f->name;
 	stats->reg_name = f->freg->name;
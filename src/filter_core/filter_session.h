@@ -50,8 +50,10 @@ struct __gf_prop_entry
 	GF_FilterSession *session;
 	volatile u32 reference_count;
 	u32 p4cc;
-	Bool name_alloc;
-	char *pname;
+	//property name, either a static string or a name interned at session level
+	const char *pname;
+	//set if pname is interned, the name reference is released when the entry is destroyed
+	Bool pname_interned;
 
 	GF_PropertyValue prop;
 	u32 alloc_size;
@@ -62,19 +64,22 @@ struct __gf_prop_entry
 
 #define GF_FS_FLAG_FORCE_DEBUG	(1<<30)
 
-#ifndef GF_PROPS_HASHTABLE_SIZE
-#define GF_PROPS_HASHTABLE_SIZE 0
-#endif
+//maps with less entries than this are scanned linearly, larger maps use an open-addressing index
+#define GF_PROPS_LINEAR_MAX	8
 
 void gf_propmap_del(void *pmap);
 
 typedef struct
 {
-#if GF_PROPS_HASHTABLE_SIZE
-	GF_List *hash_table[GF_PROPS_HASHTABLE_SIZE];
-#else
-	GF_List *properties;
-#endif
+	//property keys (4CC, or name hash for named properties) and entries, stored as two arrays in insertion order
+	u32 *keys;
+	GF_PropertyEntry **entries;
+	u32 nb_props, nb_alloc;
+	//open-addressing index of entries (position+1, 0 for free slots), only used for maps of GF_PROPS_LINEAR_MAX entries or more
+	u32 *slots;
+	u32 slot_mask;
+
+	//maps are shared between packets and copied on write, a map with more than one reference must not be modified
 	volatile u32 reference_count;
 	//number of references hold by packet references - since these may be destroyed at the end of the referring filter
 	//the pid might be dead. This is only used for pid props maps
@@ -88,25 +93,31 @@ GF_PropertyMap * gf_props_new(GF_Filter *filter);
 void gf_props_del(GF_PropertyMap *prop);
 void gf_props_reset(GF_PropertyMap *prop);
 
+//gets lookup key of a property, 4CC for built-in properties or hash of the name
+u32 gf_props_key(u32 p4cc, const char *name);
+
 GF_Err gf_props_set_property(GF_PropertyMap *map, u32 p4cc, const char *name, char *dyn_name, const GF_PropertyValue *value);
-GF_Err gf_props_insert_property(GF_PropertyMap *map, u32 hash, u32 p4cc, const char *name, char *dyn_name, const GF_PropertyValue *value);
+GF_Err gf_props_insert_property(GF_PropertyMap *map, u32 key, u32 p4cc, const char *name, char *dyn_name, const GF_PropertyValue *value);
 
-void gf_props_remove_property(GF_PropertyMap *map, u32 hash, u32 p4cc, const char *name);
+void gf_props_remove_property(GF_PropertyMap *map, u32 key, u32 p4cc, const char *name);
 
 const GF_PropertyValue *gf_props_get_property(GF_PropertyMap *map, u32 prop_4cc, const char *name);
 
 const GF_PropertyEntry *gf_props_get_property_entry(GF_PropertyMap *map, u32 prop_4cc, const char *name);
 
-#if GF_PROPS_HASHTABLE_SIZE
-u32 gf_props_hash_djb2(u32 p4cc, const char *str);
-#else
-#define gf_props_hash_djb2(_a, _b) 0
-#endif
-
 GF_Err gf_props_merge_property(GF_PropertyMap *dst_props, GF_PropertyMap *src_props, gf_filter_prop_filter filter_prop, void *cbk);
 
 const GF_PropertyValue *gf_props_enum_property(GF_PropertyMap *props, u32 *io_idx, u32 *prop_4cc, const char **prop_name);
 
+#define gf_props_count(_map) ((_map)->nb_props)
+
+//gets the session-wide interned copy of a dynamic property name, adding a reference to it
+const char *gf_props_intern_name(GF_FilterSession *fsess, const char *name);
+//releases a reference to an interned name, the name is destroyed when no longer used
+void gf_props_release_name(GF_FilterSession *fsess, const char *name);
+//destroys all interned names of the session
+void gf_props_del_atoms(GF_FilterSession *fsess);
+
 void gf_props_del_property(GF_PropertyEntry *it);
 
 
@@ -114,14 +125,36 @@ typedef struct __gf_filter_queue GF_FilterQueue;
 //constructs a new fifo queue. If mx is set all pop/add/head operations are protected by the mutex
 //otherwise, a lock-free version of the fifo is used
 GF_FilterQueue *gf_fq_new(const GF_Mutex *mx);
+//constructs a new fifo queue. If force_mx is set, the queue is protected by mx (may be NULL)
+//if nb_ring_slots is not 0 and the queue is lock-free, a bounded ring of nb_ring_slots (rounded to next power of 2) is used,
+//switching to the linked list once the ring is full, and back to the ring once both ring and linked list are empty
+GF_FilterQueue *gf_fq_new_ex(const GF_Mutex *mx, Bool force_mx, u32 nb_ring_slots);
 void gf_fq_del(GF_FilterQueue *fq, void (*item_delete)(void *) );
 void gf_fq_add(GF_FilterQueue *fq, void *item);
 void *gf_fq_pop(GF_FilterQueue *fq);
 void *gf_fq_head(GF_FilterQueue *fq);
 u32 gf_fq_count(GF_FilterQueue *fq);
 void *gf_fq_get(GF_FilterQueue *fq, u32 idx);
+//gets up to max_items first items of the queue without removing them, returns the number of items copied
+//safe with concurrent producers, but items are read without locking in lock-free and ring modes: this must only be called
+//by the single consumer of the queue, items could otherwise be popped and recycled by another consumer during the walk
+u32 gf_fq_get_range(GF_FilterQueue *fq, void **items, u32 max_items);
 void gf_fq_enum(GF_FilterQueue *fq, void (*enum_func)(void *udta1, void *item), void *udta);
 
+typedef struct __gf_task_deque GF_TaskDeque;
+//constructs a new task deque for work-stealing scheduler. The owner thread pushes and pops at the bottom (LIFO),
+//other threads steal from the top (FIFO). All operations are protected by an internal mutex
+GF_TaskDeque *gf_tdq_new(const char *name);
+void gf_tdq_del(GF_TaskDeque *dq, void (*item_delete)(void *) );
+//pushes an item (owner thread), returns GF_FALSE if the deque cannot grow
+Bool gf_tdq_push(GF_TaskDeque *dq, void *item);
+//pops last pushed item (owner thread)
+void *gf_tdq_pop(GF_TaskDeque *dq);
+//pops first pushed item (other threads)
+void *gf_tdq_steal(GF_TaskDeque *dq);
+u32 gf_tdq_count(GF_TaskDeque *dq);
+void gf_tdq_enum(GF_TaskDeque *dq, void (*enum_func)(void *udta1, void *item), void *udta);
+
 
 typedef void (*gf_destruct_fun)(void *cbck);
 
@@ -273,6 +306,10 @@ struct __gf_filter_pck
 	u8 filter_owns_mem;
 	//0: regular packet, 1: dangling packet with copied mem, 2: dangling packet with shared mem
 	u8 is_dangling;
+	//NUMA node of the thread which allocated data from the session packet pool
+	u8 pool_node;
+	//dispatch time in us, shared by all destinations, 0 if session has no latency histograms
+	u64 dispatch_time;
 };
 
 /*!
@@ -330,6 +367,37 @@ void gf_fs_post_task_class(GF_FilterSession *fsess, gf_fs_task_callback task_fun
 void gf_filter_pid_send_event_downstream(GF_FSTask *task);
 
 
+//trace event types
+enum
+{
+	GF_FS_TRACE_TASK=0,
+	GF_FS_TRACE_POST,
+	GF_FS_TRACE_SEND,
+	GF_FS_TRACE_DROP,
+	GF_FS_TRACE_BLOCK,
+	GF_FS_TRACE_UNBLOCK,
+	GF_FS_TRACE_WAIT,
+};
+
+//trace event, names are copied since filters and tasks may be destroyed before the trace is written
+typedef struct
+{
+	//start time in us since session creation
+	u64 ts;
+	//duration in us, only for tasks and waits
+	u32 dur;
+	u8 type;
+	char name[51];
+} GF_FSTraceEvent;
+
+//ring of trace events, oldest events are overwritten when full
+typedef struct
+{
+	GF_FSTraceEvent *events;
+	//number of events written since creation
+	u32 pos;
+} GF_FSTraceRing;
+
 typedef struct __gf_fs_thread
 {
 	//NULL for main thread
@@ -340,12 +408,33 @@ typedef struct __gf_fs_thread
 
 	Bool has_seen_eot; //set when no more tasks in global queue
 
+	//local task deque, only used by work-stealing scheduler (NULL for main thread)
+	GF_TaskDeque *local_tasks;
+
 	u64 nb_tasks;
+	u64 nb_tasks_stolen;
 	u64 run_time;
 	u64 active_time;
 
+	//trace events recorded by this thread, NULL if tracing is disabled
+	GF_FSTraceRing *trace;
+
+	//CPUs this thread is bound to, NULL if no affinity
+	u32 *cpus;
+	u32 nb_cpus;
+	//NUMA node of the thread
+	u32 numa_node;
+	//index of the packet pool cache of the thread
+	u32 pck_cache_idx;
 } GF_SessionThread;
 
+//gets the session thread of the calling thread, NULL if not a thread of this session
+GF_SessionThread *gf_fs_get_current_thread(GF_FilterSession *fsess);
+
+//records a trace event in the ring of the given thread, or of the calling thread if NULL
+//if start is 0, records an instant event at the current time, otherwise records an event from start to now
+void gf_fs_trace(GF_FilterSession *fsess, GF_SessionThread *sess_th, u32 type, u64 start, const char *name, const char *sub_name);
+
 typedef enum {
 	GF_ARGTYPE_LOCAL = 0, //:arg syntax
 	GF_ARGTYPE_GLOBAL, //--arg syntax
@@ -378,6 +467,99 @@ typedef struct {
 	char *metric;
 } GF_FSCustomMetric;
 
+//packet payload pool with size classes: 4 classes per power of 2 starting from 256 bytes, up to about 14 MBytes
+#define GF_PCK_POOL_MIN_SIZE	256
+#define GF_PCK_POOL_NB_CLASSES	64
+//max number of blocks per class in thread caches
+#define GF_PCK_POOL_TH_CACHE	4
+
+typedef struct
+{
+	u64 nb_requests;
+	u64 nb_hits;
+	u64 nb_reallocs_avoided;
+	u64 nb_releases;
+	//blocks freed because the pool was full
+	u64 nb_drops;
+} GF_PckPoolStats;
+
+typedef struct
+{
+	void *blocks[GF_PCK_POOL_NB_CLASSES][GF_PCK_POOL_TH_CACHE];
+	u8 nb_blocks[GF_PCK_POOL_NB_CLASSES];
+	GF_PckPoolStats stats;
+	//NUMA node of the thread owning the cache
+	u32 node;
+} GF_PckPoolCache;
+
+typedef struct
+{
+	GF_Mutex *mx;
+	//free blocks per NUMA node and size class, linked through their first bytes
+	void *(*free_blocks)[GF_PCK_POOL_NB_CLASSES];
+	u32 nb_nodes;
+	//memory ceiling
+	u64 max_bytes;
+	//bytes held in free lists and thread caches
+	volatile u64 bytes_held;
+	u64 peak_bytes;
+	//one cache for main thread and one for each extra thread
+	GF_PckPoolCache *caches;
+	u32 nb_caches;
+	//stats for global free lists, protected by mutex
+	GF_PckPoolStats stats;
+} GF_PckPool;
+
+GF_PckPool *gf_fs_pck_pool_new(GF_FilterSession *fsess, u64 max_bytes);
+void gf_fs_pck_pool_del(GF_PckPool *pool);
+//updates the node of thread caches, only valid when session threads are not running
+void gf_fs_pck_pool_set_nodes(GF_PckPool *pool, GF_FilterSession *fsess);
+void gf_fs_pck_pool_print_stats(GF_FilterSession *fsess);
+
+//resolved filter chain stored in link cache
+typedef struct
+{
+	u64 key;
+	//number of filters in chain
+	u32 nb_regs;
+	//pairs of register index in session registry and capability index
+	u32 *chain;
+} GF_LinkCacheChain;
+
+//persistent cache of the filter registry graph and of resolved chains, stored in the cache directory
+typedef struct
+{
+	//cache file path, depends on registry hash
+	char *path;
+	u64 reg_hash;
+	//number of registers in registry when the hash was computed
+	u32 nb_regs;
+	//registry graph was loaded from the cache file
+	Bool graph_loaded;
+	//cached chains, sorted by key
+	GF_List *chains;
+	Bool chains_dirty;
+	//property codes (sorted) and names of all input caps in the registry, used to compute chain keys
+	u32 *cap_codes;
+	u32 nb_cap_codes;
+	const char **cap_names;
+	u32 nb_cap_names;
+
+	//stats
+	u64 graph_time_us;
+	u32 nb_resolved, nb_cache_hits;
+	u64 resolve_time_us, cache_time_us;
+} GF_FilterLinkCache;
+
+//adds a sample to latency histogram, safe to call from any thread
+void gf_filter_hist_add(GF_FilterHistogram *hist, u64 val);
+//writes latency histograms of all filters as JSON to the session lat_dump file
+void gf_fs_dump_latency(GF_FilterSession *fsess);
+
+GF_FilterLinkCache *gf_fs_link_cache_new(GF_FilterSession *fsess);
+void gf_fs_link_cache_del(GF_FilterSession *fsess);
+void gf_fs_link_cache_print_stats(GF_FilterSession *fsess);
+
 struct __gf_filter_session
 {
 	u32 flags;
@@ -397,6 +579,13 @@ struct __gf_filter_session
 	GF_FilterQueue *tasks;
 	GF_FilterQueue *main_thread_tasks;
 	GF_FilterQueue *tasks_reservoir;
+	//work-stealing scheduler: tasks are posted to per-thread deques when the target thread is known
+	Bool work_stealing;
+	//number of tasks present in all per-thread deques
+	volatile u32 nb_local_tasks;
+	//NUMA-aware mode: per-node packet pool lists and same-node work stealing first
+	Bool numa_aware;
+	u32 nb_numa_nodes;
 	volatile Bool in_main_sem_wait;
 	volatile u32 active_threads;
 
@@ -411,10 +600,12 @@ struct __gf_filter_session
 	GF_FilterQueue *prop_maps_entry_reservoir;
 	//reservoir for property entries with allocated data buffers - properties may be inherited between packets
 	GF_FilterQueue *prop_maps_entry_data_alloc_reservoir;
-#if GF_PROPS_HASHTABLE_SIZE
-	//reservoir for property maps hash table entries (GF_Lists) for PID and packets properties
-	GF_FilterQueue *prop_maps_list_reservoir;
-#endif
+	//interned names of dynamic properties (open-addressing table) and their reference counts, protected by atoms_mx
+	//a dedicated mutex is used since names are interned and released when creating and destroying packet properties
+	GF_Mutex *atoms_mx;
+	char **prop_atoms;
+	u32 *prop_atoms_refs;
+	u32 nb_prop_atoms, prop_atoms_mask;
 	//reservoir for reference property packets - we mutualize at session level to collect them
 	//it is not possible to do so at filter or pid level because a prop ref packet may be destroyed after the source
 	//pid/packet is destroyed, and we don't want to track them per pid/filter
@@ -477,6 +668,22 @@ struct __gf_filter_session
 	Bool check_allocs;
 	u32 nb_alloc_pck, nb_realloc_pck;
 #endif
+	//session-wide packet payload pool, NULL if disabled
+	GF_PckPool *pck_pool;
+	//persistent filter graph and link resolution cache, NULL if disabled
+	GF_FilterLinkCache *link_cache;
+	//per-filter latency histograms enabled
+	Bool lat_hist;
+	//periodic JSON dump of latency histograms, NULL if disabled
+	char *lat_dump;
+	u32 lat_period;
+	u64 lat_next_dump;
+	//chrome trace output file, NULL if tracing is disabled
+	char *trace_file;
+	u32 trace_mask;
+	u64 trace_start;
+	//trace events from threads outside of the session
+	GF_FSTraceRing *trace_ext;
 	GF_Err last_connect_error, last_process_error;
 
 	GF_FilterSessionCaps caps;
@@ -653,6 +860,8 @@ struct __gf_filter
 	//set to true when the filter is being processed by a thread
 	volatile Bool in_process;
 	u32 process_th_id, restrict_th_idx;
+	//1-based index of the last session thread (excluding main) having processed this filter, 0 if main thread
+	u32 sched_th_idx;
 	//user data for the filter implementation
 	void *filter_udta;
 
@@ -753,6 +962,10 @@ struct __gf_filter
 	u64 time_process;
 	//last task time in us
 	u32 last_task_time;
+	//number of tasks requeued
+	u64 nb_tasks_requeued;
+	//process() duration and input packet queue wait histograms, NULL if disabled
+	GF_FilterHistogram *process_hist, *queue_hist;
 
 #ifdef GPAC_MEMORY_TRACKING
 	//various stats in mem tracking mode, mostly used to detect heavy alloc/free usage by the filter
@@ -980,6 +1193,8 @@ struct __gf_filter_pid_inst
 	Bool requires_full_data_block;
 	Bool last_block_ended;
 	Bool first_block_started;
+	//set when packets were queued during a batch send and buffer levels/process task are pending
+	Bool batch_post;
 	//set during play/stop/reset phases
 	volatile u32 discard_packets;
 
@@ -1088,6 +1303,9 @@ struct __gf_filter_pid
 	Bool has_seen_eos;
 	Bool eos_keepalive;
 	u32 nb_reaggregation_pending;
+	//batch send in progress, buffer levels and process tasks are updated at the end of the batch
+	Bool in_batch;
+	u64 batch_us_duration;
 
 	//only valid for decoder output pids
 	u32 max_buffer_unit;
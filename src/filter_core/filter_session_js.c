@@ -656,8 +656,22 @@ enum
 	JSFF_LAST_TS_DROP,
 	JSFF_TAG,
 	JSFF_ITAG,
+	JSFF_LATENCY,
 };
 
+static JSValue jsfs_f_hist(JSContext *ctx, const GF_FilterHistogram *hist)
+{
+	JSValue res = JS_NewObject(ctx);
+	JS_SetPropertyStr(ctx, res, "count", JS_NewInt64(ctx, hist->nb_samples));
+	JS_SetPropertyStr(ctx, res, "mean", JS_NewInt64(ctx, hist->nb_samples ? hist->total / hist->nb_samples : 0));
+	JS_SetPropertyStr(ctx, res, "max", JS_NewInt64(ctx, hist->max));
+	JS_SetPropertyStr(ctx, res, "p50", JS_NewInt64(ctx, gf_filter_hist_percentile(hist, 50)));
+	JS_SetPropertyStr(ctx, res, "p90", JS_NewInt64(ctx, gf_filter_hist_percentile(hist, 90)));
+	JS_SetPropertyStr(ctx, res, "p99", JS_NewInt64(ctx, gf_filter_hist_percentile(hist, 99)));
+	JS_SetPropertyStr(ctx, res, "p999", JS_NewInt64(ctx, gf_filter_hist_percentile(hist, 99.9)));
+	return res;
+}
+
 
 static JSValue jsfs_f_prop_get(JSContext *ctx, JSValueConst this_val, int magic)
 {
@@ -763,6 +777,16 @@ static JSValue jsfs_f_prop_get(JSContext *ctx, JSValueConst this_val, int magic)
 		JS_SetPropertyStr(ctx, res, "d", JS_NewInt64(ctx, stats.last_ts_drop.den));
 		return res;
 
+	case JSFF_LATENCY:
+		if (!f->process_hist && !f->queue_hist) return JS_NULL;
+		res = JS_NewObject(ctx);
+		if (f->process_hist)
+			JS_SetPropertyStr(ctx, res, "process", jsfs_f_hist(ctx, f->process_hist));
+		if (f->queue_hist)
+			JS_SetPropertyStr(ctx, res, "queue", jsfs_f_hist(ctx, f->queue_hist));
+		JS_SetPropertyStr(ctx, res, "requeued", JS_NewInt64(ctx, f->nb_tasks_requeued));
+		return res;
+
 	case JSFF_INAME:
 		if (f->iname) return JS_NewString(ctx, f->iname);
 		return JS_NULL;
@@ -1760,6 +1784,7 @@ static const JSCFunctionListEntry fs_f_funcs[] = {
 	JS_CGETSET_MAGIC_DEF_ENUM("last_ts_sent", jsfs_f_prop_get, NULL, JSFF_LAST_TS_SENT),
 	JS_CGETSET_MAGIC_DEF_ENUM("last_ts_drop", jsfs_f_prop_get, NULL, JSFF_LAST_TS_DROP),
 	JS_CGETSET_MAGIC_DEF_ENUM("last_task_time", jsfs_f_prop_get, NULL, JSFF_LAST_TASK_TIME),
+	JS_CGETSET_MAGIC_DEF_ENUM("latency", jsfs_f_prop_get, NULL, JSFF_LATENCY),
 
 	JS_CFUNC_DEF("is_destroyed", 0, jsff_is_destroyed),
 	JS_CFUNC_DEF("ipid_props", 0, jsff_enum_ipid_props),
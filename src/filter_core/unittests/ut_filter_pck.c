@@ -0,0 +1,83 @@
+#include "tests.h"
+#include <gpac/filters.h>
+
+static u8 *pck_pool_test_alloc(GF_FilterPid *pid, u32 size, GF_FilterPacket **pck)
+{
+	u8 *data = NULL;
+	u32 data_size = 0;
+	*pck = gf_filter_pck_new_alloc(pid, size, &data);
+	assert_not_null(*pck);
+	assert_not_null(data);
+	if (!*pck) return NULL;
+	gf_filter_pck_get_data(*pck, &data_size);
+	assert_equal(data_size, size, "%u");
+	return data;
+}
+
+//packet payloads are recycled through the session pool per size class, oversized payloads are plain allocations
+unittest(filter_pck_pool)
+{
+	GF_Err e;
+	GF_Filter *f;
+	GF_FilterPid *pid = NULL;
+	GF_FilterPacket *pck1, *pck2, *pck3;
+	u8 *d1, *d2, *d3, *d;
+	GF_FilterSession *fs;
+	u32 big_size = 30000000;
+
+	//1 MB pool
+	gf_opts_set_key("core", "pck-pool", "1");
+	fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	gf_opts_set_key("core", "pck-pool", NULL);
+	assert_not_null(fs);
+	if (!fs) return;
+	f = gf_fs_new_filter(fs, "ut_pck_pool", 0, &e);
+	assert_not_null(f);
+	if (f) pid = gf_filter_pid_new(f);
+	assert_not_null(pid);
+	if (!pid) goto exit;
+
+	//same size class (1024 bytes)
+	d1 = pck_pool_test_alloc(pid, 1000, &pck1);
+	if (!d1) goto exit;
+	gf_filter_pck_discard(pck1);
+	d = pck_pool_test_alloc(pid, 900, &pck1);
+	assert_true(d == d1);
+
+	//other size class (2048 bytes) while the first block is in use
+	d2 = pck_pool_test_alloc(pid, 2000, &pck2);
+	assert_true(d2 != d1);
+	gf_filter_pck_discard(pck1);
+	gf_filter_pck_discard(pck2);
+
+	//each class gives back its own block
+	d = pck_pool_test_alloc(pid, 1800, &pck2);
+	assert_true(d == d2);
+	d = pck_pool_test_alloc(pid, 1024, &pck1);
+	assert_true(d == d1);
+
+	//larger than the largest class
+	d3 = pck_pool_test_alloc(pid, big_size, &pck3);
+	if (d3) {
+		d3[big_size-1] = 1;
+		gf_filter_pck_discard(pck3);
+	}
+	gf_filter_pck_discard(pck1);
+	gf_filter_pck_discard(pck2);
+	//pooled blocks are not affected
+	d = pck_pool_test_alloc(pid, 1000, &pck1);
+	assert_true(d == d1);
+	gf_filter_pck_discard(pck1);
+
+	//over the 1 MB ceiling, the second released block is freed and the first one is kept
+	d1 = pck_pool_test_alloc(pid, 600000, &pck1);
+	d3 = pck_pool_test_alloc(pid, 600000, &pck3);
+	gf_filter_pck_discard(pck1);
+	gf_filter_pck_discard(pck3);
+	d = pck_pool_test_alloc(pid, 600000, &pck1);
+	assert_true(d == d1);
+	gf_filter_pck_discard(pck1);
+
+exit:
+	gf_fs_del(fs);
+}
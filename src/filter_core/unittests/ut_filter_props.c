@@ -0,0 +1,208 @@
+#include "tests.h"
+#include "../filter_props.c"
+
+//not exported by libgpac and not used by these tests
+u32 gf_audio_fmt_get_cicp_from_name(const char *name) { return 0; }
+const char *gf_audio_fmt_get_cicp_name(u32 cicp_code) { return NULL; }
+const char *gf_audio_fmt_cicp_all_names() { return NULL; }
+
+#define PROPS_BENCH_LOOKUPS	1000000
+
+static u32 props_bench_4cc[] = {
+	GF_PROP_PID_ID, GF_PROP_PID_ESID, GF_PROP_PID_STREAM_TYPE, GF_PROP_PID_CODECID, GF_PROP_PID_TIMESCALE,
+	GF_PROP_PID_DURATION, GF_PROP_PID_DECODER_CONFIG, GF_PROP_PID_WIDTH, GF_PROP_PID_HEIGHT, GF_PROP_PID_FPS,
+	GF_PROP_PID_BITRATE, GF_PROP_PID_LANGUAGE, GF_PROP_PID_URL, GF_PROP_PID_FILEPATH, GF_PROP_PID_MIME,
+	GF_PROP_PID_FILE_EXT, GF_PROP_PID_PLAYBACK_MODE, GF_PROP_PID_NB_FRAMES, GF_PROP_PID_SAR, GF_PROP_PID_PIXFMT,
+	GF_PROP_PID_DASH_SEGMENTS, GF_PROP_PID_ISOM_TRACK_TEMPLATE, GF_PROP_PID_TRACK_NUM, GF_PROP_PID_ISOM_HANDLER
+};
+
+//reference lookup over a list of entries, as done before flat maps
+static const GF_PropertyEntry *props_bench_list_get(GF_List *l, u32 p4cc, const char *name)
+{
+	u32 i, count = gf_list_count(l);
+	for (i=0; i<count; i++) {
+		const GF_PropertyEntry *p = gf_list_get(l, i);
+		if (p4cc) {
+			if (p->p4cc==p4cc) return p;
+		} else if (name && p->pname && !strcmp(p->pname, name)) {
+			return p;
+		}
+	}
+	return NULL;
+}
+
+static GF_PropertyMap *props_bench_map(GF_Filter *f, GF_List *ref, u32 nb_4cc, u32 nb_names)
+{
+	u32 i;
+	char szName[20];
+	GF_PropertyMap *map = gf_props_new(f);
+	for (i=0; i<nb_4cc; i++) {
+		gf_props_set_property(map, props_bench_4cc[i], NULL, NULL, &PROP_UINT(i));
+		if (ref) gf_list_add(ref, (void *) gf_props_get_property_entry(map, props_bench_4cc[i], NULL));
+	}
+	for (i=0; i<nb_names; i++) {
+		sprintf(szName, "user_prop_%u", i);
+		gf_props_set_property(map, 0, NULL, szName, &PROP_UINT(i));
+		if (ref) gf_list_add(ref, (void *) gf_props_get_property_entry(map, 0, szName));
+	}
+	return map;
+}
+
+static void props_bench_run(GF_Filter *f, u32 nb_4cc, u32 nb_names)
+{
+	u32 i, nb_found=0;
+	GF_List *ref = gf_list_new();
+	GF_PropertyMap *map = props_bench_map(f, ref, nb_4cc, nb_names);
+
+	//the map must return the same entries as a linear search in the property list
+	for (i=0; i<PROPS_BENCH_LOOKUPS; i++) {
+		const GF_PropertyEntry *e, *e_ref;
+		if (nb_names && (i%4==3)) {
+			e = gf_props_get_property_entry(map, 0, "user_prop_0");
+			e_ref = props_bench_list_get(ref, 0, "user_prop_0");
+		} else {
+			e = gf_props_get_property_entry(map, props_bench_4cc[i % nb_4cc], NULL);
+			e_ref = props_bench_list_get(ref, props_bench_4cc[i % nb_4cc], NULL);
+		}
+		if (e && (e == e_ref)) nb_found++;
+	}
+	assert_equal(nb_found, PROPS_BENCH_LOOKUPS, "%u");
+
+	gf_list_del(ref);
+	map->reference_count = 0;
+	gf_props_del(map);
+}
+
+unittest(filter_props_map)
+{
+	u32 i, idx, p4cc=0;
+	const char *pname;
+	GF_FilterSession fs;
+	GF_Filter f;
+	GF_PropertyMap *map, *copy;
+	memset(&fs, 0, sizeof(GF_FilterSession));
+	memset(&f, 0, sizeof(GF_Filter));
+	f.session = &fs;
+
+	//crosses the linear/indexed threshold
+	map = props_bench_map(&f, NULL, 20, 4);
+	assert_equal(gf_props_count(map), 24, "%u");
+	assert_not_null(map->slots);
+	for (i=0; i<20; i++) {
+		const GF_PropertyValue *p = gf_props_get_property(map, props_bench_4cc[i], NULL);
+		assert_true(p && (p->value.uint==i));
+	}
+	assert_true(gf_props_get_property(map, 0, "user_prop_3")->value.uint == 3);
+	assert_true(gf_props_get_property(map, 0, "user_prop_4") == NULL);
+	assert_true(gf_props_get_property(map, GF_PROP_PCK_SENDER_NTP, NULL) == NULL);
+	//dynamic names are interned
+	pname = gf_props_intern_name(&fs, "user_prop_1");
+	assert_true(gf_props_get_property_entry(map, 0, "user_prop_1")->pname == pname);
+	gf_props_release_name(&fs, pname);
+	assert_equal(fs.nb_prop_atoms, 4, "%u");
+
+	//replacing moves the property last, removing keeps order of others
+	gf_props_set_property(map, props_bench_4cc[0], NULL, NULL, &PROP_UINT(100));
+	gf_props_set_property(map, props_bench_4cc[1], NULL, NULL, NULL);
+	assert_equal(gf_props_count(map), 23, "%u");
+	idx = 0;
+	gf_props_enum_property(map, &idx, &p4cc, &pname);
+	assert_equal(p4cc, props_bench_4cc[2], "%u");
+	idx = 22;
+	assert_true(gf_props_enum_property(map, &idx, &p4cc, &pname)->value.uint == 100);
+	assert_equal(p4cc, props_bench_4cc[0], "%u");
+	assert_true(gf_props_get_property(map, props_bench_4cc[1], NULL) == NULL);
+	for (i=2; i<20; i++) {
+		assert_true(gf_props_get_property(map, props_bench_4cc[i], NULL)->value.uint == i);
+	}
+
+	//merged entries are shared
+	copy = gf_props_new(&f);
+	gf_props_merge_property(copy, map, NULL, NULL);
+	assert_equal(gf_props_count(copy), 23, "%u");
+	assert_true(gf_props_get_property_entry(copy, props_bench_4cc[5], NULL) == gf_props_get_property_entry(map, props_bench_4cc[5], NULL));
+	assert_true(gf_props_get_property(copy, 0, "user_prop_2")->value.uint == 2);
+
+	//shrink back to linear lookup
+	for (i=2; i<20; i++) {
+		gf_props_set_property(copy, props_bench_4cc[i], NULL, NULL, NULL);
+	}
+	assert_equal(gf_props_count(copy), 5, "%u");
+	assert_true(gf_props_get_property(copy, props_bench_4cc[0], NULL)->value.uint == 100);
+	assert_true(gf_props_get_property(copy, 0, "user_prop_0")->value.uint == 0);
+	assert_true(gf_props_get_property(map, props_bench_4cc[7], NULL)->value.uint == 7);
+
+	//grow back above the threshold, index must be rebuilt
+	for (i=2; i<12; i++) {
+		gf_props_set_property(copy, props_bench_4cc[i], NULL, NULL, &PROP_UINT(i+1));
+	}
+	assert_equal(gf_props_count(copy), 15, "%u");
+	for (i=2; i<12; i++) {
+		assert_true(gf_props_get_property(copy, props_bench_4cc[i], NULL)->value.uint == i+1);
+	}
+	assert_true(gf_props_get_property(copy, 0, "user_prop_3")->value.uint == 3);
+
+	//names still used by the copy are kept
+	gf_props_set_property(map, 0, NULL, "user_prop_0", NULL);
+	assert_equal(fs.nb_prop_atoms, 4, "%u");
+	assert_true(gf_props_get_property(copy, 0, "user_prop_0")->value.uint == 0);
+
+	//interned names are destroyed with the last property using them
+	copy->reference_count = 0;
+	gf_props_del(copy);
+	assert_equal(fs.nb_prop_atoms, 3, "%u");
+	map->reference_count = 0;
+	gf_props_del(map);
+	assert_equal(fs.nb_prop_atoms, 0, "%u");
+	gf_props_del_atoms(&fs);
+}
+
+//removal must keep colliding names reachable
+unittest(filter_props_atoms)
+{
+	u32 i;
+	char name[32];
+	const char *atoms[200];
+	GF_FilterSession fs;
+	memset(&fs, 0, sizeof(GF_FilterSession));
+
+	for (i=0; i<200; i++) {
+		sprintf(name, "atom_%u", i);
+		atoms[i] = gf_props_intern_name(&fs, name);
+		assert_not_null(atoms[i]);
+		assert_true(gf_props_intern_name(&fs, name) == atoms[i]);
+	}
+	assert_equal(fs.nb_prop_atoms, 200, "%u");
+	//one reference left on odd names
+	for (i=0; i<200; i++) {
+		gf_props_release_name(&fs, atoms[i]);
+		if (!(i&1)) gf_props_release_name(&fs, atoms[i]);
+	}
+	assert_equal(fs.nb_prop_atoms, 100, "%u");
+	for (i=1; i<200; i+=2) {
+		sprintf(name, "atom_%u", i);
+		assert_true(gf_props_intern_name(&fs, name) == atoms[i]);
+		gf_props_release_name(&fs, atoms[i]);
+		gf_props_release_name(&fs, atoms[i]);
+	}
+	assert_equal(fs.nb_prop_atoms, 0, "%u");
+	for (i=0; i<=fs.prop_atoms_mask; i++) {
+		assert_true(fs.prop_atoms[i] == NULL);
+	}
+	gf_props_del_atoms(&fs);
+}
+
+unittest(filter_props_lookup)
+{
+	GF_FilterSession fs;
+	GF_Filter f;
+	memset(&fs, 0, sizeof(GF_FilterSession));
+	memset(&f, 0, sizeof(GF_Filter));
+	f.session = &fs;
+
+	//typical packet properties
+	props_bench_run(&f, 3, 1);
+	//typical PID properties
+	props_bench_run(&f, 24, 2);
+	gf_props_del_atoms(&fs);
+}
@@ -0,0 +1,235 @@
+#include "tests.h"
+#include "../filter_queue.c"
+
+#define FQ_BENCH_ITEMS	20000
+
+typedef struct
+{
+	GF_FilterQueue *fq;
+	u32 id;
+	u32 nb_producers;
+	volatile u32 *nb_popped;
+	u32 total;
+	u32 last_seq[16];
+	Bool order_ok;
+} FQBenchCtx;
+
+static u32 fq_bench_produce(void *par)
+{
+	u32 i;
+	FQBenchCtx *ctx = par;
+	for (i=0; i<FQ_BENCH_ITEMS; i++) {
+		//encode producer id and sequence number, never 0
+		gf_fq_add(ctx->fq, (void *) (uintptr_t) ( ((ctx->id+1)<<24) | (i+1) ));
+	}
+	return 0;
+}
+
+static u32 fq_bench_consume(void *par)
+{
+	FQBenchCtx *ctx = par;
+	while (*ctx->nb_popped < ctx->total) {
+		u32 v = (u32) (uintptr_t) gf_fq_pop(ctx->fq);
+		if (!v) {
+			gf_sleep(0);
+			continue;
+		}
+		safe_int_inc(ctx->nb_popped);
+		//items from one producer must be seen in order
+		u32 pid = (v>>24) - 1;
+		u32 seq = v & 0xFFFFFF;
+		if ((pid >= ctx->nb_producers) || (seq <= ctx->last_seq[pid])) ctx->order_ok = GF_FALSE;
+		else ctx->last_seq[pid] = seq;
+	}
+	return 0;
+}
+
+//mx: use mutex-protected list, otherwise lock-free (ring if nb_ring_slots is set)
+//returns GF_TRUE if all items were popped, in order for each producer
+static Bool fq_bench_run(u32 nb_threads, Bool use_mx, u32 nb_ring_slots)
+{
+	u32 i;
+	GF_Thread *prod[16], *cons[16];
+	FQBenchCtx pctx[16], cctx[16];
+	volatile u32 nb_popped = 0;
+	GF_Mutex *mx = use_mx ? gf_mx_new("FQBench") : NULL;
+	GF_FilterQueue *fq = gf_fq_new_ex(mx, GF_FALSE, nb_ring_slots);
+	Bool order_ok = GF_TRUE;
+
+	for (i=0; i<nb_threads; i++) {
+		memset(&pctx[i], 0, sizeof(FQBenchCtx));
+		pctx[i].fq = fq;
+		pctx[i].id = i;
+		cctx[i] = pctx[i];
+		cctx[i].nb_producers = nb_threads;
+		cctx[i].nb_popped = &nb_popped;
+		cctx[i].total = nb_threads * FQ_BENCH_ITEMS;
+		cctx[i].order_ok = GF_TRUE;
+		prod[i] = gf_th_new("fq_prod");
+		cons[i] = gf_th_new("fq_cons");
+		gf_th_run(cons[i], fq_bench_consume, &cctx[i]);
+		gf_th_run(prod[i], fq_bench_produce, &pctx[i]);
+	}
+	for (i=0; i<nb_threads; i++) {
+		gf_th_stop(prod[i]);
+		gf_th_stop(cons[i]);
+		gf_th_del(prod[i]);
+		gf_th_del(cons[i]);
+		if (!cctx[i].order_ok) order_ok = GF_FALSE;
+	}
+	if (gf_fq_count(fq) || (nb_popped != nb_threads * FQ_BENCH_ITEMS))
+		order_ok = GF_FALSE;
+	gf_fq_del(fq, NULL);
+	gf_mx_del(mx);
+	return order_ok;
+}
+
+unittest(filter_queue_ring_overflow)
+{
+	u32 i;
+	GF_FilterQueue *fq = gf_fq_new_ex(NULL, GF_FALSE, 3);
+	assert_not_null(fq);
+	//rounded to 4 slots
+	assert_equal(fq->ring_mask, 3, "%u");
+
+	for (i=1; i<=10; i++)
+		gf_fq_add(fq, (void *) (uintptr_t) i);
+	assert_equal(gf_fq_count(fq), 10, "%u");
+	assert_true(fq->ring_overflow);
+	assert_equal((u32) (uintptr_t) gf_fq_head(fq), 1, "%u");
+	assert_equal((u32) (uintptr_t) gf_fq_get(fq, 3), 4, "%u");
+	assert_equal((u32) (uintptr_t) gf_fq_get(fq, 4), 5, "%u");
+	assert_true(gf_fq_get(fq, 10) == NULL);
+
+	for (i=1; i<=10; i++) {
+		assert_equal((u32) (uintptr_t) gf_fq_pop(fq), i, "%u");
+	}
+	assert_true(gf_fq_pop(fq) == NULL);
+	assert_equal(gf_fq_count(fq), 0, "%u");
+	//both ring and list are empty, back to ring mode
+	assert_true(!fq->ring_overflow);
+	assert_true(!fq->ring_drained);
+
+	for (i=1; i<=3; i++)
+		gf_fq_add(fq, (void *) (uintptr_t) i);
+	assert_true(!fq->ring_overflow);
+	assert_true(fq->head == NULL);
+	assert_equal((u32) (uintptr_t) gf_fq_pop(fq), 1, "%u");
+
+	//overflow again, then refill while draining the list
+	for (i=4; i<=8; i++)
+		gf_fq_add(fq, (void *) (uintptr_t) i);
+	assert_true(fq->ring_overflow);
+	for (i=2; i<=5; i++) {
+		assert_equal((u32) (uintptr_t) gf_fq_pop(fq), i, "%u");
+	}
+	//ring empty, list still holds 6..8: new items go to the list
+	gf_fq_add(fq, (void *) (uintptr_t) 9);
+	assert_true(fq->ring_overflow);
+	for (i=6; i<=9; i++) {
+		assert_equal((u32) (uintptr_t) gf_fq_pop(fq), i, "%u");
+	}
+	assert_true(!fq->ring_overflow);
+	assert_equal(gf_fq_count(fq), 0, "%u");
+	gf_fq_del(fq, NULL);
+}
+
+static u32 fq_range_produce(void *par)
+{
+	u32 i;
+	GF_FilterQueue *fq = par;
+	for (i=1; i<=FQ_BENCH_ITEMS; i++) {
+		gf_fq_add(fq, (void *) (uintptr_t) i);
+	}
+	return 0;
+}
+
+//lock-free linked, mutex linked, small ring overflowing to the list, large ring
+static GF_FilterQueue *fq_range_new(u32 mode, GF_Mutex *mx)
+{
+	if (mode==0) return gf_fq_new_ex(NULL, GF_FALSE, 0);
+	if (mode==1) return gf_fq_new_ex(mx, GF_FALSE, 0);
+	if (mode==2) return gf_fq_new_ex(NULL, GF_FALSE, 4);
+	return gf_fq_new_ex(NULL, GF_FALSE, 2*FQ_BENCH_ITEMS);
+}
+
+unittest(filter_queue_get_range)
+{
+	u32 mode, i, nb;
+	void *items[64];
+	GF_Mutex *mx = gf_mx_new("FQRange");
+
+	for (mode=0; mode<4; mode++) {
+		u32 next = 1;
+		GF_Thread *th;
+		GF_FilterQueue *fq = fq_range_new(mode, mx);
+		assert_not_null(fq);
+		assert_equal(gf_fq_get_range(fq, items, 64), 0, "%u");
+
+		for (i=1; i<=10; i++)
+			gf_fq_add(fq, (void *) (uintptr_t) i);
+		if (mode==2) assert_true(fq->ring_overflow);
+		//limited by max_items
+		assert_equal(gf_fq_get_range(fq, items, 6), 6, "%u");
+		for (i=0; i<6; i++) {
+			assert_equal((u32) (uintptr_t) items[i], i+1, "%u");
+		}
+		//items are not removed
+		assert_equal(gf_fq_get_range(fq, items, 64), 10, "%u");
+		for (i=0; i<10; i++) {
+			assert_equal((u32) (uintptr_t) items[i], i+1, "%u");
+		}
+		assert_equal(gf_fq_count(fq), 10, "%u");
+		//range starts at the queue head, across ring and list
+		for (i=1; i<=5; i++) {
+			assert_equal((u32) (uintptr_t) gf_fq_pop(fq), i, "%u");
+		}
+		assert_equal(gf_fq_get_range(fq, items, 64), 5, "%u");
+		for (i=0; i<5; i++) {
+			assert_equal((u32) (uintptr_t) items[i], i+6, "%u");
+		}
+		while (gf_fq_pop(fq)) {}
+
+		//single consumer with a concurrent producer: each range is an ordered prefix of the remaining items
+		th = gf_th_new("fq_range_prod");
+		gf_th_run(th, fq_range_produce, fq);
+		while (next <= FQ_BENCH_ITEMS) {
+			nb = gf_fq_get_range(fq, items, 64);
+			if (!nb) {
+				gf_sleep(0);
+				continue;
+			}
+			for (i=0; i<nb; i++) {
+				u32 v = (u32) (uintptr_t) items[i];
+				if (v != next+i) break;
+				if ((u32) (uintptr_t) gf_fq_pop(fq) != v) break;
+			}
+			assert_equal(i, nb, "%u");
+			if (i != nb) break;
+			next += nb;
+		}
+		gf_th_stop(th);
+		gf_th_del(th);
+		assert_equal(next, FQ_BENCH_ITEMS+1, "%u");
+		assert_equal(gf_fq_count(fq), 0, "%u");
+		gf_fq_del(fq, NULL);
+	}
+	gf_mx_del(mx);
+}
+
+unittest(filter_queue_mpmc)
+{
+	u32 i;
+	u32 nb_threads[3] = {1, 4, 16};
+
+	//lock-free linked list is only safe with a single consumer
+	assert_true(fq_bench_run(1, GF_FALSE, 0));
+
+	for (i=0; i<3; i++) {
+		assert_true(fq_bench_run(nb_threads[i], GF_TRUE, 0));
+		//small ring to exercise overflow
+		assert_true(fq_bench_run(nb_threads[i], GF_FALSE, 256));
+		//ring large enough to never overflow
+		assert_true(fq_bench_run(nb_threads[i], GF_FALSE, 16*FQ_BENCH_ITEMS));
+	}
+}
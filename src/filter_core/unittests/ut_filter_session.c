@@ -0,0 +1,190 @@
+#include "../../isomedia/unittests/isom_tests.h"
+#include <gpac/filters.h>
+#include "../filter_session.h"
+
+#define SCHED_TEST_TRACKS	4
+#define SCHED_TEST_SAMPLES	500
+
+//interleaved tracks, one PID and decoding chain per track in the session
+static Bool sched_test_make_file(const char *path)
+{
+	u32 i, t;
+	u8 data[1000];
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	assert_not_null(file);
+	if (!file) return GF_FALSE;
+
+	for (t=0; t<SCHED_TEST_TRACKS; t++) {
+		u32 track = isom_test_new_track(file, t+1, GF_ISOM_MEDIA_AUDIO, 1000);
+		assert_equal(track, t+1, "%u");
+		if (track != t+1) goto exit;
+		isom_test_ok( gf_isom_set_track_enabled(file, track, GF_TRUE) );
+	}
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	samp.IsRAP = RAP;
+	for (i=0; i<SCHED_TEST_SAMPLES; i++) {
+		for (t=0; t<SCHED_TEST_TRACKS; t++) {
+			samp.dataLength = 100 + (i*13 + t*57) % 900;
+			memset(data, (u8) (i+t), samp.dataLength);
+			samp.DTS = i*20;
+			isom_test_ok( gf_isom_add_sample(file, t+1, 1, &samp) );
+		}
+	}
+	isom_test_ok( gf_isom_close(file) );
+	return GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+static Bool sched_test_run(const char *path, const char *log_path, GF_FilterSchedulerType sched)
+{
+	GF_Err e;
+	char url[2*GF_MAX_PATH];
+	GF_FilterSession *fs = gf_fs_new(4, sched, 0, NULL);
+	assert_not_null(fs);
+	if (!fs) return GF_FALSE;
+
+	gf_fs_load_source(fs, path, NULL, NULL, &e);
+	assert_equal(e, GF_OK, "%d");
+	//packets of each PID are dumped at the end of the session, independently of thread interleaving
+	snprintf(url, sizeof(url), "inspect:interleave=false:fmt=%%pid.ID%% %%dts%% %%size%% %%crc%%%%lf%%:log=%s", log_path);
+	if (!e) gf_fs_load_filter(fs, url, &e);
+	assert_equal(e, GF_OK, "%d");
+	if (!e) e = gf_fs_run(fs);
+	assert_equal(e, GF_EOS, "%d");
+	gf_fs_del(fs);
+	return (e==GF_EOS) ? GF_TRUE : GF_FALSE;
+}
+
+//a multi-threaded session using the work-stealing scheduler must produce the same output as the lock-free one
+unittest(filter_session_work_steal)
+{
+	u8 *ref=NULL, *res=NULL;
+	u32 ref_size=0, res_size=0;
+	char path[GF_MAX_PATH], ref_log[GF_MAX_PATH], res_log[GF_MAX_PATH];
+
+	isom_test_path(path, "ut_fs_steal.mp4");
+	isom_test_path(ref_log, "ut_fs_steal_free.txt");
+	isom_test_path(res_log, "ut_fs_steal.txt");
+	if (!sched_test_make_file(path)) goto exit;
+
+	if (!sched_test_run(path, ref_log, GF_FS_SCHEDULER_LOCK_FREE)) goto exit;
+	if (!sched_test_run(path, res_log, GF_FS_SCHEDULER_WORK_STEAL)) goto exit;
+
+	assert_equal(gf_file_load_data(ref_log, &ref, &ref_size), GF_OK, "%d");
+	assert_equal(gf_file_load_data(res_log, &res, &res_size), GF_OK, "%d");
+	//header line and one line per packet at least
+	assert_greater(ref_size, SCHED_TEST_TRACKS*SCHED_TEST_SAMPLES, "%u");
+	assert_equal(res_size, ref_size, "%u");
+	if (ref && res && (res_size == ref_size)) {
+		assert_equal_mem(res, ref, ref_size);
+	}
+
+exit:
+	if (ref) gf_free(ref);
+	if (res) gf_free(res);
+	gf_file_delete(path);
+	gf_file_delete(ref_log);
+	gf_file_delete(res_log);
+}
+
+typedef struct
+{
+	Bool graph_loaded;
+	u32 nb_resolved, nb_cache_hits;
+	char path[GF_MAX_PATH];
+} LinkCacheTestInfo;
+
+static void link_cache_test_run(const char *path, const char *blacklist, LinkCacheTestInfo *info)
+{
+	GF_Err e;
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, blacklist);
+	memset(info, 0, sizeof(LinkCacheTestInfo));
+	assert_not_null(fs);
+	if (!fs) return;
+	assert_not_null(fs->link_cache);
+
+	gf_fs_load_source(fs, path, NULL, NULL, &e);
+	assert_equal(e, GF_OK, "%d");
+	if (!e) gf_fs_load_filter(fs, "inspect:fmt=%pid.ID%%lf%:log=null", &e);
+	assert_equal(e, GF_OK, "%d");
+	if (!e) gf_fs_run(fs);
+	if (fs->link_cache) {
+		info->graph_loaded = fs->link_cache->graph_loaded;
+		info->nb_resolved = fs->link_cache->nb_resolved;
+		info->nb_cache_hits = fs->link_cache->nb_cache_hits;
+		if (fs->link_cache->path) gf_strlcpy(info->path, fs->link_cache->path, GF_MAX_PATH);
+	}
+	//cache file written when destroying the session
+	gf_fs_del(fs);
+}
+
+//a second session with the same registry reloads the graph and chains, a different registry or stored hash invalidates them
+unittest(filter_session_link_cache)
+{
+	u8 *data = NULL;
+	u32 size;
+	FILE *f;
+	char *cache_dir = NULL;
+	LinkCacheTestInfo ref, res;
+	char path[GF_MAX_PATH], lc_dir[GF_MAX_PATH];
+
+	isom_test_path(path, "ut_fs_link_cache.mp4");
+	isom_test_path(lc_dir, "ut_link_cache");
+	if (!sched_test_make_file(path)) goto exit;
+	gf_mkdir(lc_dir);
+	gf_dir_cleanup(lc_dir);
+	if (gf_opts_get_key("core", "cache")) cache_dir = gf_strdup(gf_opts_get_key("core", "cache"));
+	gf_opts_set_key("core", "cache", lc_dir);
+	gf_opts_set_key("core", "link-cache", "yes");
+
+	//empty cache directory, chains resolved and stored
+	link_cache_test_run(path, NULL, &ref);
+	assert_false(ref.graph_loaded);
+	assert_greater(ref.nb_resolved, 0, "%u");
+	assert_equal(ref.nb_cache_hits, 0, "%u");
+	assert_true(gf_file_exists(ref.path));
+
+	//same registry, everything from cache
+	link_cache_test_run(path, NULL, &res);
+	assert_true(res.graph_loaded);
+	assert_equal_str(res.path, ref.path);
+	assert_equal(res.nb_resolved, 0, "%u");
+	assert_equal(res.nb_cache_hits, ref.nb_resolved, "%u");
+
+	//other registry, other cache file
+	link_cache_test_run(path, "rfadts", &res);
+	assert_false(res.graph_loaded);
+	assert_not_equal_str(res.path, ref.path);
+	assert_equal(res.nb_cache_hits, 0, "%u");
+
+	//registry hash stored in the file no longer matching, file ignored and rewritten
+	assert_equal(gf_file_load_data(ref.path, &data, &size), GF_OK, "%d");
+	if (!data) goto exit;
+	assert_greater(size, 9 + (u32) strlen(gf_gpac_version()) + 8, "%u");
+	data[9 + strlen(gf_gpac_version())] ^= 0xFF;
+	f = gf_fopen(ref.path, "wb");
+	assert_not_null(f);
+	if (!f) goto exit;
+	gf_fwrite(data, size, f);
+	gf_fclose(f);
+	link_cache_test_run(path, NULL, &res);
+	assert_false(res.graph_loaded);
+	assert_equal(res.nb_cache_hits, 0, "%u");
+	link_cache_test_run(path, NULL, &res);
+	assert_true(res.graph_loaded);
+	assert_equal(res.nb_cache_hits, ref.nb_resolved, "%u");
+
+exit:
+	if (data) gf_free(data);
+	gf_opts_set_key("core", "link-cache", NULL);
+	gf_opts_set_key("core", "cache", cache_dir);
+	if (cache_dir) gf_free(cache_dir);
+	gf_dir_cleanup(lc_dir);
+	gf_rmdir(lc_dir);
+	gf_file_delete(path);
+}
@@ -234,7 +234,7 @@ typedef struct
 	Bool check_dur, skip_seg, loop, reschedule, scope_deps, keep_src, tpl_force, keep_segs;
 	Double refresh, tsb, subdur;
 	u64 *_p_gentime, *_p_mpdtime;
-	Bool cmpd, dual, segcts, sreg, ttml_agg, evte_agg;
+	Bool cmpd, dual, segcts, sreg, ttml_agg, evte_agg, sbin, mpatch;
 	char *styp;
 	Bool sigfrag, sigfo;
 	DasherTSSHandlingMode sbound;
@@ -256,6 +256,7 @@ typedef struct
 	GF_DashAbsoluteURLMode hls_absu;
 	DasherWaitLastPktCtrl seg_sync;
 	Bool hls_ap;
+	s32 hlsth;
 	Scte35Mode scte35;
 	//Scte35ModeHLS scte35_hls;
 
@@ -334,6 +335,8 @@ typedef struct
 	u32 forward_mode;
 
 	u8 last_hls_signature[GF_SHA1_DIGEST_SIZE], last_mpd_signature[GF_SHA1_DIGEST_SIZE], last_hls2_signature[GF_SHA1_DIGEST_SIZE];
+	//name of MPD patch file, set once a patch location was advertised
+	char *patch_name;
 
 	GF_CryptInfo *cinfo;
 
@@ -2132,6 +2135,23 @@ static GF_Err dasher_update_mpd(GF_DasherCtx *ctx)
 			ctx->mpd->minimum_update_period = 0;
 		}
 	}
+	if (ctx->mpd->patch_location) {
+		gf_free(ctx->mpd->patch_location);
+		ctx->mpd->patch_location = NULL;
+	}
+	//patch file is named after the manifest, the last MPD is static and not advertised
+	if (ctx->mpatch && (ctx->dmode==GF_MPD_TYPE_DYNAMIC) && ctx->out_path) {
+		char *name = gf_file_basename(ctx->out_path);
+		if (!ctx->mpd->ID) ctx->mpd->ID = gf_strdup(name);
+		if (!ctx->patch_name) {
+			char *ext;
+			ctx->patch_name = gf_strdup(name);
+			ext = gf_file_ext_start(ctx->patch_name);
+			if (ext) ext[0] = 0;
+			gf_dynstrcat(&ctx->patch_name, ".mpp", NULL);
+		}
+		ctx->mpd->patch_location = gf_strdup(ctx->patch_name);
+	}
 	dasher_check_chaining(ctx, "urn:mpeg:dash:mpd-chaining:2016", ctx->chain);
 	dasher_check_chaining(ctx, "urn:mpeg:dash:fallback:2016", ctx->chain_fbk);
 
@@ -2151,6 +2171,7 @@ static GF_Err dasher_update_mpd(GF_DasherCtx *ctx)
 					rep->tsb_first_entry=0;
 					if (rep->segment_template) rep->segment_template->tsb_first_entry = 0;
 					if (rep->segment_list) rep->segment_list->tsb_first_entry = 0;
+					gf_mpd_representation_m3u8_modified(rep);
 				}
 			}
 		}
@@ -5052,10 +5073,12 @@ static void dasher_purge_segment_timeline(GF_MPD_SegmentTimeline *stl, GF_DASH_S
 	if (stl_e->repeat_count) {
 		stl_e->repeat_count--;
 		stl_e->start_time += stl_e->duration;
+		gf_mpd_segment_timeline_head_removed(stl, 0);
 	} else {
 		u64 start_time = stl_e->start_time + stl_e->duration;
 		gf_list_rem(stl->entries, 0);
 		gf_free(stl_e);
+		gf_mpd_segment_timeline_head_removed(stl, 1);
 
 		stl_e = gf_list_get(stl->entries, 0);
 		if (!stl_e) {
@@ -5116,6 +5139,8 @@ static void dasher_purge_rep(GF_DasherCtx *ctx, GF_MPD_Representation *rep, GF_M
 	if (!target_ds)
 		target_ds = gf_list_get(ctx->current_period->streams, 0);
 
+	u32 prev_tsb_first_entry = rep->tsb_first_entry;
+	Bool purged = GF_FALSE;
 	rep->tsb_first_entry = 0;
 	u32 state_idx=0;
 	while (1) {
@@ -5213,7 +5238,10 @@ static void dasher_purge_rep(GF_DasherCtx *ctx, GF_MPD_Representation *rep, GF_M
 		if (sctx->llhas_template) gf_free(sctx->llhas_template);
 		gf_free(sctx);
 		gf_list_rem(rep->state_seg_list, 0);
+		purged = GF_TRUE;
 	}
+	if (purged || (rep->tsb_first_entry != prev_tsb_first_entry))
+		gf_mpd_representation_m3u8_modified(rep);
 }
 
 static void dasher_purge_segments(GF_DasherCtx *ctx, u64 *period_dur)
@@ -5980,6 +6008,33 @@ static GF_Err dasher_write_index(GF_DasherCtx *ctx, GF_FilterPid *opid)
 }
 
 
+static void dasher_send_mpd_patch(GF_DasherCtx *ctx, GF_FilterPid *opid)
+{
+	GF_Err e;
+	char *name;
+	FILE *tmp = gf_file_temp(NULL);
+	if (!tmp) return;
+
+	ctx->mpd->segment_template = ctx->template;
+	e = gf_mpd_write_patch(ctx->mpd, tmp, ctx->cmpd);
+	ctx->mpd->segment_template = NULL;
+	if (e) {
+		if (e!=GF_NOT_READY) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] failed to write MPD patch: %s\n", gf_error_to_string(e) ));
+		}
+		gf_fclose(tmp);
+		return;
+	}
+	if (ctx->explicit_mode) {
+		dasher_transfer_file(tmp, opid, ctx->patch_name, NULL, GF_TRUE);
+	} else {
+		name = gf_url_concatenate(ctx->out_path, ctx->patch_name);
+		dasher_transfer_file(tmp, opid, name ? name : ctx->patch_name, NULL, GF_FALSE);
+		if (name) gf_free(name);
+	}
+	gf_fclose(tmp);
+}
+
 static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_dur, Bool do_m3u8, Bool m3u8_second_pass, GF_FilterPid *opid, char *alt_name)
 {
 	void *last_signature;
@@ -6010,6 +6065,8 @@ static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_
 		ctx->mpd->llhls_part_holdback = ctx->ll_part_hb;
 		ctx->mpd->hls_abs_url = ctx->hls_absu;
 		ctx->mpd->hls_audio_primary = ctx->hls_ap;
+		//-1 uses all session threads
+		ctx->mpd->hls_nb_threads = (ctx->hlsth<0) ? 0xFFFFFFFF : (u32) ctx->hlsth;
 
 		if (ctx->llhls==GF_DASH_LL_HLS_BRSF)
 			ctx->mpd->force_llhls_mode = m3u8_second_pass ? 2 : 1;
@@ -6052,6 +6109,10 @@ static GF_Err dasher_write_and_send_manifest(GF_DasherCtx *ctx, u64 last_period_
 
 		if (ctx->from_index!=IDXMODE_CHILD)
 			dasher_transfer_file(tmp, opid, alt_name, NULL, GF_FALSE);
+
+		//once advertised, patches are sent until the MPD is no longer dynamic, the last one forcing clients to reload the MPD
+		if (!do_m3u8 && !alt_name && ctx->patch_name && (ctx->mpd->patch_location || ctx->mpd->patch_state))
+			dasher_send_mpd_patch(ctx, opid);
 	}
 	gf_fclose(tmp);
 	return GF_OK;
@@ -6089,6 +6150,8 @@ GF_Err dasher_send_manifest(GF_Filter *filter, GF_DasherCtx *ctx, Bool for_mpd_o
 		dasher_update_dyn_bitrates(ctx);
 
 	ctx->mpd->publishTime = dasher_get_utc(ctx);
+	//used to run variant playlist generation on session threads
+	ctx->mpd->hls_filter = filter;
 	if (ctx->utc_timing_type==DASHER_UTCREF_INBAND) {
 		GF_MPD_Descriptor *d = gf_list_get(ctx->mpd->utc_timings, 0);
 		if (d) {
@@ -6259,18 +6322,29 @@ resend:
 
 
 	if (ctx->state) {
-		tmp = gf_fopen(ctx->state, "w");
+		//write to a temporary file and rename it, so that the context file is never seen partially written
+		char *state_tmp = gf_strdup(ctx->state);
+		gf_dynstrcat(&state_tmp, ".tmp", NULL);
+		tmp = state_tmp ? gf_fopen(state_tmp, "w") : NULL;
 		if (!tmp) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] failed to open context MPD %s for write\n", ctx->state ));
+			if (state_tmp) gf_free(state_tmp);
 			return GF_IO_ERR;
 		}
 		ctx->mpd->write_context = GF_TRUE;
-		e = gf_mpd_write(ctx->mpd, tmp, ctx->cmpd);
+		if (ctx->sbin)
+			e = gf_mpd_write_binary_state(ctx->mpd, tmp, ctx->cmpd);
+		else
+			e = gf_mpd_write(ctx->mpd, tmp, ctx->cmpd);
+		if (gf_ferror(tmp)) e = GF_IO_ERR;
 		gf_fclose(tmp);
 		ctx->mpd->write_context = GF_FALSE;
+		if (!e) e = gf_file_move(state_tmp, ctx->state);
 		if (e) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] failed to write MPD file: %s\n", gf_error_to_string(e) ));
+			gf_file_delete(state_tmp);
 		}
+		gf_free(state_tmp);
 	}
 
 	if (ctx->def_max_seg_dur)
@@ -6549,19 +6623,25 @@ static GF_Err dasher_reload_context(GF_Filter *filter, GF_DasherCtx *ctx)
 
 	if (!gf_file_exists(ctx->state)) return GF_OK;
 
-	/* parse the MPD */
-	mpd_parser = gf_xml_dom_new();
-	e = gf_xml_dom_parse(mpd_parser, ctx->state, NULL, NULL);
-
-	if (e != GF_OK) {
-		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Cannot parse MPD state %s: %s\n", ctx->state, gf_xml_dom_get_error(mpd_parser) ));
+	if (gf_mpd_is_binary_state(ctx->state, NULL)) {
+		if (ctx->mpd) gf_mpd_del(ctx->mpd);
+		ctx->mpd = gf_mpd_new();
+		e = gf_mpd_load_binary_state(ctx->mpd, ctx->state);
+	} else {
+		/* parse the MPD */
+		mpd_parser = gf_xml_dom_new();
+		e = gf_xml_dom_parse(mpd_parser, ctx->state, NULL, NULL);
+
+		if (e != GF_OK) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Cannot parse MPD state %s: %s\n", ctx->state, gf_xml_dom_get_error(mpd_parser) ));
+			gf_xml_dom_del(mpd_parser);
+			return GF_URL_ERROR;
+		}
+		if (ctx->mpd) gf_mpd_del(ctx->mpd);
+		ctx->mpd = gf_mpd_new();
+		e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), ctx->mpd, ctx->state);
 		gf_xml_dom_del(mpd_parser);
-		return GF_URL_ERROR;
 	}
-	if (ctx->mpd) gf_mpd_del(ctx->mpd);
-	ctx->mpd = gf_mpd_new();
-	e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), ctx->mpd, ctx->state);
-	gf_xml_dom_del(mpd_parser);
 	//test mode, strip URL path
 	if (gf_sys_is_test_mode()) {
 		count = gf_list_count(ctx->mpd->program_infos);
@@ -8100,6 +8180,7 @@ static void dasher_insert_timeline_entry(GF_DasherCtx *ctx, GF_DashStream *ds, B
 {
 	GF_MPD_SegmentTimelineEntry *s;
 	u64 duration, pto, prev_patch_dur=0;
+	u32 nb_stl;
 	Bool is_first = GF_FALSE;
 	Bool seg_align = GF_FALSE;
 	Bool stl_in_as = GF_FALSE;
@@ -8113,6 +8194,7 @@ static void dasher_insert_timeline_entry(GF_DasherCtx *ctx, GF_DashStream *ds, B
 		GF_DASH_SegmentContext *sctx = gf_list_last(ds->rep->state_seg_list);
 		if (sctx) {
 			sctx->dur = ds->first_cts_in_next_seg - ds->first_cts_in_seg;
+			gf_mpd_representation_m3u8_modified(ds->rep);
 		}
 	}
 	//we only use segment timeline with templates
@@ -8230,6 +8312,10 @@ static void dasher_insert_timeline_entry(GF_DasherCtx *ctx, GF_DashStream *ds, B
 		}
 	}
 
+	//only the last two entries may be modified below, except for live edge entry removal
+	nb_stl = gf_list_count(tl->entries);
+	gf_mpd_segment_timeline_modified(tl, (nb_stl>2) ? nb_stl-2 : 0);
+
 	//live edge, always inject an entry and remember we just did
 	if (is_ll_anouncement) {
 		//is timeline is at set level, only inject entry for LL edge on the rep owning the set
@@ -8251,6 +8337,7 @@ static void dasher_insert_timeline_entry(GF_DasherCtx *ctx, GF_DashStream *ds, B
 		for (i=nb_ent; i>0; i--) {
 			s = gf_list_get(tl->entries, i-1);
 			if (!s->is_ll_edge) continue;
+			gf_mpd_segment_timeline_modified(tl, i-1);
 			gf_list_rem(tl->entries, i-1);
 			gf_free(s);
 			break;
@@ -8368,6 +8455,7 @@ static void dasher_copy_segment_timelines(GF_DasherCtx *ctx, GF_MPD_AdaptationSe
 			tl = rep->segment_list->segment_timeline;
 		}
 		gf_assert(tl);
+		gf_mpd_segment_timeline_modified(tl, gf_list_count(tl->entries));
 		for (j=0; j<nb_s; j++) {
 			GF_MPD_SegmentTimelineEntry *s;
 			GF_MPD_SegmentTimelineEntry *src_s = gf_list_get(src_tl->entries, j);
@@ -8400,6 +8488,7 @@ static void dasher_set_timeline_parts(GF_DasherCtx *ctx, GF_DashStream *ds, GF_D
 	}
 	if (!ent)
 		return;
+	gf_mpd_segment_timeline_modified(stl, i-1);
 
 	//first seg in timeline entry
 	if (!ent->nb_parts) {
@@ -8424,6 +8513,7 @@ static void dasher_set_timeline_parts(GF_DasherCtx *ctx, GF_DashStream *ds, GF_D
 		gf_assert(stl);
 		//locate entry in new list and reset all nb_parts of future ones
 		nb_entries = gf_list_count(stl->entries);
+		gf_mpd_segment_timeline_modified(stl, 0);
 		for (i=nb_entries; i>0; i--) {
 			ent = gf_list_get(stl->entries, i-1);
 			if (ent->start_time == sctx->stl_start) break;
@@ -8541,6 +8631,7 @@ static void dasher_flush_segment(GF_DasherCtx *ctx, GF_DashStream *ds, Bool is_l
 
 					base_ds->rep->hls_max_seg_dur.num = (s32) segdur;
 					base_ds->rep->hls_max_seg_dur.den = base_ds->timescale;
+					gf_mpd_representation_m3u8_modified(base_ds->rep);
 				}
 			}
 		}
@@ -9072,6 +9163,7 @@ static void dasher_mark_segment_start(GF_DasherCtx *ctx, GF_DashStream *ds, GF_F
 		}
 
 		gf_list_add(ds->rep->state_seg_list, seg_state);
+		gf_mpd_representation_m3u8_modified(ds->rep);
 		if (ctx->sigfrag) {
 			const GF_PropertyValue *frag_range = gf_filter_pck_get_property(in_pck, GF_PROP_PCK_FRAG_RANGE);
 			const GF_PropertyValue *frag_url = gf_filter_pck_get_property(in_pck, GF_PROP_PCK_SEG_URL);
@@ -11362,6 +11454,7 @@ static void dasher_process_hls_ll(GF_DasherCtx *ctx, const GF_FilterEvent *evt)
 		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[Dasher] Received segment size info event but no pending segments\n"));
 		return;
 	}
+	gf_mpd_representation_m3u8_modified(ds->rep);
 	void *new_frags = gf_realloc(sctx->frags, sizeof (GF_DASH_FragmentContext) * (sctx->nb_frags+1));
 	if (!new_frags) {
 		gf_free(sctx->frags);
@@ -11472,6 +11565,9 @@ static Bool dasher_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 
 		if (ds->muxed_base)
 			ds = ds->muxed_base;
+		//segment sizes, parts and init segment of the representation may change
+		if (ds->rep)
+			gf_mpd_representation_m3u8_modified(ds->rep);
 
 		if (evt->seg_size.is_init && evt->seg_size.base64_version) {
 			if (!ds->init_base_64) {
@@ -11925,6 +12021,7 @@ static void dasher_finalize(GF_Filter *filter)
 	gf_free(ctx->next_period);
 	if (ctx->out_path) gf_free(ctx->out_path);
 	if (ctx->out_path_alt) gf_free(ctx->out_path_alt);
+	if (ctx->patch_name) gf_free(ctx->patch_name);
 	gf_list_del(ctx->postponed_pids);
 #ifndef GPAC_DISABLE_CRYPTO
 	if (ctx->cinfo) gf_crypt_info_del(ctx->cinfo);
@@ -12059,11 +12156,13 @@ static const GF_FilterArgs DasherArgs[] =
 	{ OFFS(lang), "language of MPD Info", GF_PROP_STRING, NULL, NULL, 0},
 	{ OFFS(location), "set MPD locations to given URL", GF_PROP_STRING_LIST, NULL, NULL, 0},
 	{ OFFS(base), "set base URLs of MPD", GF_PROP_STRING_LIST, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(mpatch), "generate MPD patches for dynamic MPDs, advertised through a PatchLocation element (the MPD ID is set to the manifest name if not set)", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(refresh), "refresh rate for dynamic manifests, in seconds (a negative value sets the MPD duration, value 0 uses dash duration)", GF_PROP_DOUBLE, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(tsb), "time-shift buffer depth in seconds (a negative value means infinity)", GF_PROP_DOUBLE, "30", NULL, 0},
 	{ OFFS(keep_segs), "do not delete segments no longer in time-shift buffer", GF_PROP_BOOL, "false", NULL, 0},
 	{ OFFS(ast), "set start date (as xs:date, e.g. YYYY-MM-DDTHH:MM:SSZ) for live mode. Default is now. !! Do not use with multiple periods, nor when DASH duration is not a multiple of GOP size !!", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(state), "path to file used to store/reload state info when simulating live. This is stored as a valid MPD with GPAC XML extensions", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(sbin), "store state info in binary form, reloading no longer parses the full segment history (the state file format is detected when reloading)", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(keep_ts), "do not shift timestamp when reloading a context", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(loop), "loop sources when dashing with subdur and state. If not set, a new period is created once the sources are over", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(subdur), "maximum duration of the input file to be segmented. This does not change the segment duration, segmentation stops once segments produced exceeded the duration", GF_PROP_DOUBLE, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
@@ -12128,6 +12227,7 @@ static const GF_FilterArgs DasherArgs[] =
 	"- both: use absolute URL everywhere"
 		, GF_PROP_UINT, "no", "no|var|mas|both", GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(hls_ap), "use audio as primary media instead of video when generating playlists", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(hlsth), "maximum number of session threads used to generate HLS variant playlists, 0 or 1 generates them in the dasher task and -1 uses all session threads", GF_PROP_SINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(seg_sync), "control how waiting on last packet P of fragment/segment to be written impacts segment injection in manifest\n"
 	"- no: do not wait for P\n"
 	"- yes: wait for P\n"
@@ -27,6 +27,11 @@
 #include <gpac/filters.h>
 #include <gpac/constants.h>
 
+//block size used for probing in mmap mode
+#define FILEIN_PROBE_SIZE	5000
+//files modified less than this (in microseconds) may still be written and are not mapped
+#define FILEIN_MMAP_MIN_AGE_US	2000000
+
 #ifndef GPAC_DISABLE_FIN
 
 
@@ -63,9 +68,16 @@ typedef struct
 	Bool full_file_only;
 	Bool do_reconfigure;
 	char *block;
+	//allocated size of block, only used for probing in mmap mode
+	u32 block_alloc;
 	u32 is_random;
 	Bool cached_set;
 	Bool no_failure;
+	Bool mmap;
+
+	GF_FileMap *fmap;
+	//mapping used by the packet being dispatched
+	GF_FileMap *pck_fmap;
 } GF_FileInCtx;
 
 static GF_Err filein_initialize_ex(GF_Filter *filter)
@@ -125,7 +137,8 @@ static GF_Err filein_initialize_ex(GF_Filter *filter)
 
 		if (!ctx->block_size) ctx->block_size = 5000;
 		while (ctx->block_size % 4) ctx->block_size++;
-		ctx->block = gf_malloc(ctx->block_size +1);
+		ctx->block_alloc = ctx->block_size;
+		ctx->block = gf_malloc(ctx->block_alloc +1);
 		return GF_OK;
 	}
 
@@ -220,6 +233,23 @@ static GF_Err filein_initialize_ex(GF_Filter *filter)
 	ctx->cached_set = GF_FALSE;
 	ctx->full_file_only = GF_FALSE;
 
+	if (ctx->fmap) {
+		gf_file_map_unref(ctx->fmap);
+		ctx->fmap = NULL;
+	}
+	if (ctx->mmap && ctx->file_size && !gf_fileio_check(ctx->file)) {
+		u64 mtime = gf_file_modification_time(src);
+		//file modified recently, it may still be written: don't map it
+		if (mtime + FILEIN_MMAP_MIN_AGE_US > gf_net_get_utc()*1000) {
+			GF_LOG(GF_LOG_INFO, GF_LOG_MMIO, ("[FileIn] File %s modified less than %d seconds ago, using regular reads\n", src, FILEIN_MMAP_MIN_AGE_US/1000000));
+		} else {
+			ctx->fmap = gf_file_map_new(src);
+			if (!ctx->fmap) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_MMIO, ("[FileIn] Failed to map %s in memory, using regular reads\n", src));
+			}
+		}
+	}
+
 	if (ctx->do_reconfigure && gf_fileio_check(ctx->file)) {
 		GF_FileIO *gfio = (GF_FileIO *)ctx->file;
 		gf_free(ctx->src);
@@ -248,10 +278,13 @@ static GF_Err filein_initialize_ex(GF_Filter *filter)
 
 	if (!ctx->block) {
 		if (!ctx->block_size) {
-			if (ctx->file_size>500000000) ctx->block_size = 1000000;
+			//no read cost in mmap mode, use large blocks
+			if (ctx->fmap || (ctx->file_size>500000000)) ctx->block_size = 1000000;
 			else ctx->block_size = 5000;
 		}
-		ctx->block = gf_malloc(ctx->block_size +1);
+		//in mmap mode the block is only used for probing and eof detection
+		ctx->block_alloc = ctx->fmap ? MIN(ctx->block_size, FILEIN_PROBE_SIZE) : ctx->block_size;
+		ctx->block = gf_malloc(ctx->block_alloc +1);
 	}
 	return GF_OK;
 }
@@ -274,6 +307,7 @@ static void filein_finalize(GF_Filter *filter)
 	if (ctx->fd>=0) close(ctx->fd);
 #endif
 	if (ctx->block) gf_free(ctx->block);
+	if (ctx->fmap) gf_file_map_unref(ctx->fmap);
 }
 
 static GF_FilterProbeScore filein_probe_url(const char *url, const char *mime_type)
@@ -375,7 +409,10 @@ static Bool filein_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 		ctx->range.den = ctx->end_pos;
 		if (evt->seek.hint_block_size > ctx->block_size) {
 			ctx->block_size = evt->seek.hint_block_size;
-			ctx->block = gf_realloc(ctx->block, ctx->block_size+1);
+			if (!ctx->fmap) {
+				ctx->block_alloc = ctx->block_size;
+				ctx->block = gf_realloc(ctx->block, ctx->block_alloc+1);
+			}
 		}
 		return GF_TRUE;
 	case GF_FEVT_SOURCE_SWITCH:
@@ -423,6 +460,10 @@ static Bool filein_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 static void filein_pck_destructor(GF_Filter *filter, GF_FilterPid *pid, GF_FilterPacket *pck)
 {
 	GF_FileInCtx *ctx = (GF_FileInCtx *) gf_filter_get_udta(filter);
+	if (ctx->pck_fmap) {
+		gf_file_map_unref(ctx->pck_fmap);
+		ctx->pck_fmap = NULL;
+	}
 	ctx->pck_out = GF_FALSE;
 	//ready to process again
 	gf_filter_post_process_task(filter);
@@ -435,6 +476,7 @@ static GF_Err filein_process(GF_Filter *filter)
 	u64 lto_read;
 	GF_FilterPacket *pck;
 	GF_FileInCtx *ctx = (GF_FileInCtx *) gf_filter_get_udta(filter);
+	u8 *pck_data = NULL;
 
 	if (ctx->is_end)
 		return GF_EOS;
@@ -540,8 +582,17 @@ static GF_Err filein_process(GF_Filter *filter)
 	else
 		to_read = (u32) lto_read;
 
+	//mapped file: no read, packet points to the mapping
+	if (ctx->fmap && ctx->pid && !ctx->do_reconfigure) {
+		u64 map_size;
+		const u8 *map_data = gf_file_map_get_data(ctx->fmap, &map_size);
+		if (ctx->file_pos >= map_size) nb_read = 0;
+		else if (ctx->file_pos + to_read > map_size) nb_read = (u32) (map_size - ctx->file_pos);
+		else nb_read = to_read;
+		pck_data = (u8 *) map_data + ctx->file_pos;
+	}
 	//force eof flush
-	if (!to_read) {
+	else if (!to_read) {
 #ifdef GPAC_HAS_FD
 		if (ctx->fd>=0) {
 			nb_read = (u32) read(ctx->fd, ctx->block, 1);
@@ -551,6 +602,8 @@ static GF_Err filein_process(GF_Filter *filter)
 			nb_read = (u32) gf_fread(ctx->block, 1, ctx->file);
 		if (nb_read) to_read=1;
 	} else {
+		//mapped file probing, block is smaller than block_size
+		if (to_read > ctx->block_alloc) to_read = ctx->block_alloc;
 #ifdef GPAC_HAS_FD
 		if (ctx->fd>=0) {
 			nb_read = (u32) read(ctx->fd, ctx->block, to_read);
@@ -560,7 +613,8 @@ static GF_Err filein_process(GF_Filter *filter)
 			nb_read = (u32) gf_fread(ctx->block, to_read, ctx->file);
 	}
 
-	ctx->block[nb_read] = 0;
+	if (!pck_data)
+		ctx->block[nb_read] = 0;
 	if (!ctx->pid || ctx->do_reconfigure) {
 		GF_FileIOCacheState cstate;
 		u64 fsize;
@@ -587,7 +641,8 @@ static GF_Err filein_process(GF_Filter *filter)
 					if (ctx->file_size>500000000) ctx->block_size = 1000000;
 					else ctx->block_size = 5000;
 				}
-				ctx->block = gf_realloc(ctx->block, ctx->block_size +1);
+				ctx->block_alloc = ctx->block_size;
+				ctx->block = gf_realloc(ctx->block, ctx->block_alloc +1);
 			}
 		}
 
@@ -603,7 +658,8 @@ static GF_Err filein_process(GF_Filter *filter)
 					probe_size = (u32) ctx->file_size;
 
 				ctx->block_size = probe_size;
-				ctx->block = gf_realloc(ctx->block, ctx->block_size+1);
+				ctx->block_alloc = probe_size;
+				ctx->block = gf_realloc(ctx->block, ctx->block_alloc+1);
 #ifdef GPAC_HAS_FD
 				if (ctx->fd>=0) {
 					nb_read += (u32) read(ctx->fd, ctx->block + nb_read, probe_size-nb_read);
@@ -691,8 +747,12 @@ static GF_Err filein_process(GF_Filter *filter)
 	}
 
 	if (nb_read) {
-		pck = gf_filter_pck_new_shared(ctx->pid, ctx->block, nb_read, filein_pck_destructor);
+		pck = gf_filter_pck_new_shared(ctx->pid, pck_data ? pck_data : (u8 *) ctx->block, nb_read, filein_pck_destructor);
 		if (!pck) return GF_OUT_OF_MEM;
+		if (pck_data) {
+			gf_file_map_ref(ctx->fmap);
+			ctx->pck_fmap = ctx->fmap;
+		}
 
 		gf_filter_pck_set_byte_offset(pck, ctx->file_pos);
 		gf_filter_pck_set_framing(pck, ctx->file_pos ? GF_FALSE : GF_TRUE, ctx->is_end);
@@ -724,12 +784,13 @@ static GF_Err filein_process(GF_Filter *filter)
 static const GF_FilterArgs FileInArgs[] =
 {
 	{ OFFS(src), "location of source file", GF_PROP_NAME, NULL, NULL, 0},
-	{ OFFS(block_size), "block size used to read file. 0 means 5000 if file less than 500m, 1M otherwise", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(block_size), "block size used to read file. 0 means 5000 if file less than 500m or not mapped, 1M otherwise", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(range), "byte range", GF_PROP_FRACTION64, "0-0", NULL, 0},
 	{ OFFS(ext), "override file extension", GF_PROP_NAME, NULL, NULL, 0},
 	{ OFFS(mime), "set file mime type", GF_PROP_NAME, NULL, NULL, 0},
 	{ OFFS(pck), "data to use instead of file", GF_PROP_DATA, NULL, NULL, 0},
 	{ OFFS(ptime), "timing for data packet, ignored if den is 0", GF_PROP_FRACTION, "0/0", NULL, 0},
+	{ OFFS(mmap), "memory-map local files and dispatch packets pointing to the mapped file instead of reading blocks. Files modified in the last few seconds are read normally; files must not be modified or truncated while mapped", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{0}
 };
 
@@ -63,7 +63,7 @@ typedef struct
 {
 	//options
 	char *src, *initseg;
-	Bool allt, itt, itemid;
+	Bool allt, itt, itemid, igrid;
 	ISOMReaderScalableTileLoadMode smode;
 	ISOMReaderEditListMode edits;
 	u32 stsd;
@@ -81,6 +81,8 @@ typedef struct
 	u32 nodata;
 	u32 mstore_purge, mstore_samples, mstore_size;
 	s32 ctso;
+	Bool mmap;
+	u32 rthreads, rahead;
 
 	//internal
 
@@ -144,6 +146,18 @@ typedef struct
 	GF_ISOFile *extkmov;
 	u32 extk_flags;
 	Bool extk;
+
+	//file mappings used by packets in mmap mode, each with one reference held by the reader
+	GF_List *mapped_files;
+	GF_Mutex *mapped_mx;
+
+	//sample data prefetch across tracks, NULL if disabled
+	struct __isor_prefetch *pfetch;
+
+	//tiles of all grid items sorted by tile ID, built when declaring the first tile item
+	struct __isor_grid_tile *grid_tiles;
+	u32 nb_grid_tiles;
+	Bool grid_tiles_loaded;
 } ISOMReader;
 
 typedef struct
@@ -170,6 +184,8 @@ typedef struct
 	
 	u32 sample_num, sample_last;
 	s64 ts_offset;
+	//next sample to plan for prefetch
+	u32 pf_sample;
 
 	/*for edit lists*/
 	u32 edit_sync_frame;
@@ -206,6 +222,9 @@ typedef struct
 	u64 dts, cts;
 	u32 skip_byte_block, crypt_byte_block;
 	u32 au_seq_num;
+	//item data loaded by a batch fetch of all items, and its error
+	Bool item_fetched;
+	GF_Err item_fetch_e;
 	u64 sender_ntp, ntp_at_server_ntp;
 
 	u64 isma_BSO;
@@ -226,6 +245,10 @@ typedef struct
 	GF_FilterPacket *pck;
 	u32 alloc_size;
 
+	//sample payload in mapped file, NULL if sample is not mapped
+	const u8 *mapped_data;
+	GF_FileMap *mapped_file;
+
 	u32 nb_empty_retry;
 } ISOMChannel;
 
@@ -247,11 +270,16 @@ void isor_set_crypt_config(ISOMChannel *ch);
 void isor_reader_check_config(ISOMChannel *ch);
 
 Bool isor_declare_item_properties(ISOMReader *read, ISOMChannel *ch, u32 item_idx);
+void isor_grid_tiles_reset(ISOMReader *read);
 
 void isor_declare_pssh(ISOMChannel *ch);
 
 void isor_set_sample_groups_and_aux_data(ISOMReader *read, ISOMChannel *ch, GF_FilterPacket *pck);
 
+typedef struct __isor_prefetch ISOMPrefetch;
+void isor_prefetch_update(ISOMReader *read);
+void isor_prefetch_del(ISOMReader *read);
+
 #endif /*GPAC_DISABLE_ISOM*/
 
 #endif /*_ISMO_IN_H_*/
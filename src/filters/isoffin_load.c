@@ -2074,6 +2074,113 @@ GF_Err isor_declare_objects(ISOMReader *read)
 	return GF_OK;
 }
 
+typedef struct __isor_grid_tile
+{
+	u32 tile_id;
+	//declaration order, the first grid using a tile gives its position
+	u32 order;
+	u32 col, row;
+	u32 grid_w, grid_h;
+} ISOMGridTile;
+
+void isor_grid_tiles_reset(ISOMReader *read)
+{
+	if (read->grid_tiles) gf_free(read->grid_tiles);
+	read->grid_tiles = NULL;
+	read->nb_grid_tiles = 0;
+	read->grid_tiles_loaded = GF_FALSE;
+}
+
+static int isor_grid_tile_cmp(const void *_a, const void *_b)
+{
+	const ISOMGridTile *a = (const ISOMGridTile *)_a;
+	const ISOMGridTile *b = (const ISOMGridTile *)_b;
+	if (a->tile_id != b->tile_id) return (a->tile_id < b->tile_id) ? -1 : 1;
+	if (a->order != b->order) return (a->order < b->order) ? -1 : 1;
+	return 0;
+}
+
+//parses each grid item once and records the position of all its tiles
+static void isor_load_grid_tiles(ISOMReader *read)
+{
+	u32 i, j, nb_alloc=0, count = gf_isom_get_meta_item_count(read->mov, GF_TRUE, 0);
+	read->grid_tiles_loaded = GF_TRUE;
+
+	for (i=0; i<count; i++) {
+		GF_BitStream *bs;
+		u8 *data=NULL;
+		u32 size=0, alloc_size=0, rows, cols, nb_bits, grid_w, grid_h;
+		u32 grid_id=0, item_type=0, nb_tiles;
+		gf_isom_get_meta_item_info(read->mov, GF_TRUE, 0, i+1, &grid_id, &item_type, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+		if (item_type != GF_4CC('g','r','i','d')) continue;
+
+		nb_tiles = gf_isom_meta_get_item_ref_count(read->mov, GF_TRUE, 0, grid_id, GF_4CC('d','i','m','g'));
+		if (!nb_tiles) continue;
+		if ((gf_isom_extract_meta_item_mem(read->mov, GF_TRUE, 0, grid_id, &data, &size, &alloc_size, NULL, GF_FALSE) != GF_OK) || (size<8)) {
+			if (data) gf_free(data);
+			continue;
+		}
+		bs = gf_bs_new(data, size, GF_BITSTREAM_READ);
+		/*version*/gf_bs_read_u8(bs);
+		nb_bits = (gf_bs_read_u8(bs) & 1) ? 32 : 16;
+		rows = 1 + gf_bs_read_u8(bs);
+		cols = 1 + gf_bs_read_u8(bs);
+		grid_w = gf_bs_read_int(bs, nb_bits);
+		grid_h = gf_bs_read_int(bs, nb_bits);
+		if (gf_bs_is_overflow(bs)) rows = 0;
+		gf_bs_del(bs);
+		gf_free(data);
+
+		//extra references are not part of the grid
+		if (nb_tiles > rows*cols) nb_tiles = rows*cols;
+		for (j=0; j<nb_tiles; j++) {
+			ISOMGridTile *tile;
+			if (read->nb_grid_tiles == nb_alloc) {
+				u32 new_alloc = nb_alloc ? 2*nb_alloc : 64;
+				ISOMGridTile *tiles = gf_realloc(read->grid_tiles, sizeof(ISOMGridTile) * new_alloc);
+				if (!tiles) break;
+				read->grid_tiles = tiles;
+				nb_alloc = new_alloc;
+			}
+			tile = &read->grid_tiles[read->nb_grid_tiles];
+			tile->tile_id = gf_isom_meta_get_item_ref_id(read->mov, GF_TRUE, 0, grid_id, GF_4CC('d','i','m','g'), j+1);
+			tile->order = read->nb_grid_tiles;
+			tile->col = j % cols;
+			tile->row = j / cols;
+			tile->grid_w = grid_w;
+			tile->grid_h = grid_h;
+			read->nb_grid_tiles++;
+		}
+	}
+	if (read->nb_grid_tiles)
+		qsort(read->grid_tiles, read->nb_grid_tiles, sizeof(ISOMGridTile), isor_grid_tile_cmp);
+}
+
+//gets position of a tile item in the grid image using it and size of the grid image
+static Bool isor_get_grid_tile_pos(ISOMReader *read, u32 tile_id, u32 tile_w, u32 tile_h, u32 *x, u32 *y, u32 *grid_w, u32 *grid_h)
+{
+	ISOMGridTile *tile;
+	u32 low=0, high;
+	if (!read->grid_tiles_loaded)
+		isor_load_grid_tiles(read);
+
+	//first entry for this tile ID
+	high = read->nb_grid_tiles;
+	while (low < high) {
+		u32 mid = (low + high) / 2;
+		if (read->grid_tiles[mid].tile_id < tile_id) low = mid+1;
+		else high = mid;
+	}
+	if ((low == read->nb_grid_tiles) || (read->grid_tiles[low].tile_id != tile_id)) return GF_FALSE;
+
+	tile = &read->grid_tiles[low];
+	*x = tile->col * tile_w;
+	*y = tile->row * tile_h;
+	*grid_w = tile->grid_w;
+	*grid_h = tile->grid_h;
+	return GF_TRUE;
+}
+
 Bool isor_declare_item_properties(ISOMReader *read, ISOMChannel *ch, u32 item_idx)
 {
 	GF_ImageItemProperties props;
@@ -2209,6 +2316,15 @@ retry:
 		gf_filter_pid_set_property(pid, GF_PROP_PID_ISOM_SUBTYPE,  &PROP_4CC(GF_ISOM_ITEM_TYPE_UNCI) );
 	}
 
+	//tile of a grid image, signal position in grid and grid size
+	if (read->igrid && !read->itt && props.width && props.height && gf_isom_meta_item_has_ref(read->mov, GF_TRUE, 0, item_id, GF_4CC('d','i','m','g'))) {
+		u32 x, y, grid_w, grid_h;
+		if (isor_get_grid_tile_pos(read, item_id, props.width, props.height, &x, &y, &grid_w, &grid_h)) {
+			gf_filter_pid_set_property(pid, GF_PROP_PID_CROP_POS, &PROP_VEC2I_INT(x, y) );
+			gf_filter_pid_set_property(pid, GF_PROP_PID_ORIG_SIZE, &PROP_VEC2I_INT(grid_w, grid_h) );
+		}
+	}
+
 	if (item_codecid == GF_CODECID_HEVC_TILES) {
 		gf_filter_pid_set_property(pid, GF_PROP_PID_CROP_POS, &PROP_VEC2I_INT(props.hOffset, props.vOffset) );
 
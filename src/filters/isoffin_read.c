@@ -135,7 +135,17 @@ static GF_Err isoffin_setup(GF_Filter *filter, ISOMReader *read, Bool input_is_e
 	}
 
 	read->missing_bytes = 0;
-	e = gf_isom_open_progressive(url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
+	//only map complete files
+	prop = read->pid ? gf_filter_pid_get_property(read->pid, GF_PROP_PID_FILE_CACHED) : NULL;
+	if (read->mmap && !read->start_range && !read->end_range && (!read->pid || (prop && prop->value.boolean))) {
+		e = gf_isom_open_mapped(url, read->sigfrag, &read->mov, &read->missing_bytes, NULL);
+		if (!read->mapped_mx) {
+			read->mapped_mx = gf_mx_new("ISOFFMappedFiles");
+			read->mapped_files = gf_list_new();
+		}
+	} else {
+		e = gf_isom_open_progressive(url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
+	}
 
 	if (e == GF_ISOM_INCOMPLETE_FILE) {
 		if (input_is_eos) {
@@ -210,6 +220,8 @@ static void isoffin_disconnect(ISOMReader *read)
 		isoffin_delete_channel(ch);
 	}
 
+	isor_prefetch_del(read);
+	isor_grid_tiles_reset(read);
 	if (read->mov) gf_isom_close(read->mov);
 	read->mov = NULL;
 
@@ -332,6 +344,8 @@ static GF_Err isoffin_reconfigure(GF_Filter *filter, ISOMReader *read, const cha
 			}
 		}
 #endif
+		isor_prefetch_del(read);
+		isor_grid_tiles_reset(read);
 		if (read->mov) gf_isom_close(read->mov);
 		e = gf_isom_open_progressive(next_url, read->start_range, read->end_range, read->sigfrag, &read->mov, &read->missing_bytes);
 
@@ -579,6 +593,8 @@ static void isoffin_finalize(GF_Filter *filter)
 	}
 	gf_list_del(read->channels);
 
+	isor_prefetch_del(read);
+	isor_grid_tiles_reset(read);
 	if (!read->extern_mov && read->mov) gf_isom_close(read->mov);
 	read->mov = NULL;
 
@@ -587,6 +603,13 @@ static void isoffin_finalize(GF_Filter *filter)
 		gf_blob_unregister(&read->mem_blob);
 		gf_free(read->mem_url);
 	}
+	//all packets are destroyed at this point
+	while (gf_list_count(read->mapped_files)) {
+		GF_FileMap *fmap = gf_list_pop_back(read->mapped_files);
+		gf_file_map_unref(fmap);
+	}
+	gf_list_del(read->mapped_files);
+	if (read->mapped_mx) gf_mx_del(read->mapped_mx);
 }
 
 void isor_declare_pssh(ISOMChannel *ch)
@@ -1155,6 +1178,11 @@ static Bool isoffin_process_event(GF_Filter *filter, const GF_FilterEvent *evt)
 						}
 					}
 				}
+				//try fragment index: in mem mode, samples of fragments already seen have been purged
+				else if (read->mem_load_mode && (gf_isom_get_fragment_offset_for_time(read->mov, evt->play.start_range, &max_offset)==GF_OK)) {
+					gf_isom_reset_tables(read->mov, GF_TRUE);
+					is_sidx_seek = GF_TRUE;
+				}
 			}
 #endif
 			if (!is_sidx_seek) {
@@ -1402,6 +1430,44 @@ static void isoffin_purge_mem(ISOMReader *read, u64 min_offset)
 	}
 }
 
+static void isor_mapped_pck_destructor(GF_Filter *filter, GF_FilterPid *pid, GF_FilterPacket *pck)
+{
+	u32 i, size;
+	ISOMReader *read = gf_filter_get_udta(filter);
+	const u8 *data = gf_filter_pck_get_data(pck, &size);
+
+	gf_mx_p(read->mapped_mx);
+	for (i=0; i<gf_list_count(read->mapped_files); i++) {
+		u64 map_size;
+		GF_FileMap *fmap = gf_list_get(read->mapped_files, i);
+		const u8 *map_data = gf_file_map_get_data(fmap, &map_size);
+		if ((data < map_data) || (data >= map_data + map_size)) continue;
+
+		//only our reference left, the file is no longer opened
+		if (gf_file_map_unref(fmap) == 1) {
+			gf_list_rem(read->mapped_files, i);
+			gf_file_map_unref(fmap);
+		}
+		break;
+	}
+	gf_mx_v(read->mapped_mx);
+}
+
+static GF_FilterPacket *isor_new_mapped_packet(ISOMReader *read, ISOMChannel *ch)
+{
+	GF_FilterPacket *pck = gf_filter_pck_new_shared(ch->pid, ch->mapped_data, ch->sample->dataLength, isor_mapped_pck_destructor);
+	if (!pck) return NULL;
+
+	gf_mx_p(read->mapped_mx);
+	if (gf_list_find(read->mapped_files, ch->mapped_file) < 0) {
+		gf_file_map_ref(ch->mapped_file);
+		gf_list_add(read->mapped_files, ch->mapped_file);
+	}
+	gf_file_map_ref(ch->mapped_file);
+	gf_mx_v(read->mapped_mx);
+	return pck;
+}
+
 static GF_Err isoffin_process(GF_Filter *filter)
 {
 	ISOMReader *read = gf_filter_get_udta(filter);
@@ -1576,6 +1642,9 @@ static GF_Err isoffin_process(GF_Filter *filter)
 		isor_check_producer_ref_time(read);
 	}
 
+	if (read->rthreads)
+		isor_prefetch_update(read);
+
 	u32 all_pck_sent=0;
 	for (i=0; i<count; i++) {
 		u8 *data;
@@ -1641,7 +1710,11 @@ static GF_Err isoffin_process(GF_Filter *filter)
 				//strip param sets from payload, trigger reconfig if needed
 				isor_reader_check_config(ch);
 
-				if (ch->pck) {
+				if (ch->mapped_data) {
+					pck = isor_new_mapped_packet(read, ch);
+					if (!pck) return GF_OUT_OF_MEM;
+				}
+				else if (ch->pck) {
 					pck = ch->pck;
 					ch->pck = NULL;
 					gf_filter_pck_check_realloc(pck, ch->sample->data, ch->sample->dataLength);
@@ -1891,6 +1964,7 @@ static const GF_FilterArgs ISOFFInArgs[] =
 		"- strict: use edit list even if only signaling a delay", GF_PROP_UINT, "auto", "auto|no|strict", GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(itt), "convert all items of root meta into a single PID", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(itemid), "keep item IDs in PID properties", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_ADVANCED},
+	{ OFFS(igrid), "signal position of tile items in their grid image and load data of all items in a single batch read (ignored if [-itt]() is set)", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(smode), "load mode for scalable/tile tracks\n"
 	"- split: each track is declared, extractors are removed\n"
 	"- splitx: each track is declared, extractors are kept\n"
@@ -1931,6 +2005,9 @@ static const GF_FilterArgs ISOFFInArgs[] =
 	"- set to `-1` to use the `cslg` box info or the minimum cts offset present in the track\n"
 	"- set to `-2` to use the minimum cts offset present in the track (`cslg` ignored)", GF_PROP_SINT, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(norw), "skip reformatting of samples - should only be used when rewriting fragments", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(mmap), "memory-map complete local files and dispatch sample payloads without copy when samples are not modified by the reader", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(rthreads), "maximum number of session threads loading sample data of all playing tracks of complete local files ahead of demultiplexing, 0 disables prefetch. When enabled and [-isom-index](CORE) is not set, a sample table index with one checkpoint every 64 entries is built", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(rahead), "maximum size in kilobytes of prefetched sample data", GF_PROP_UINT, "8192", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(keepc), "keep corrupted samples (for multicast sources only)", GF_PROP_BOOL, "true", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(sigfo), "signal segment boundaries on output packets for DASH or HLS sources (same as sigfrag but independent from dasher options)", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(drefu), "override dref URL in source file with given value", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
@@ -54,6 +54,8 @@ void isor_reset_reader(ISOMChannel *ch)
 	ch->sai_alloc_size = 0;
 	ch->dts = ch->cts = 0;
 	ch->seek_flag = 0;
+	//replan this channel only, blocks planned for it and not consumed are dropped after a few rounds
+	ch->pf_sample = 0;
 }
 
 void isor_check_producer_ref_time(ISOMReader *read)
@@ -282,8 +284,53 @@ static void isor_update_cenc_info(ISOMChannel *ch, Bool for_item)
 	}
 }
 
+//loads data of all item channels not yet fetched, coalescing reads of nearby items
+static void isor_fetch_items(ISOMReader *read)
+{
+	u32 i, nb_items=0, count = gf_list_count(read->channels);
+	GF_Err e;
+	GF_ISOItemData *items = gf_malloc(sizeof(GF_ISOItemData) * count);
+	if (!items) return;
+
+	for (i=0; i<count; i++) {
+		ISOMChannel *ch = gf_list_get(read->channels, i);
+		if (!ch->item_id || ch->item_fetched || ch->au_seq_num) continue;
+		if (!ch->static_sample) {
+			ch->static_sample = gf_isom_sample_new();
+			if (!ch->static_sample) continue;
+		}
+		memset(&items[nb_items], 0, sizeof(GF_ISOItemData));
+		items[nb_items].item_id = ch->item_id;
+		items[nb_items].data = ch->static_sample->data;
+		items[nb_items].alloc_size = ch->static_sample->alloc_size;
+		nb_items++;
+	}
+	if (!nb_items) {
+		gf_free(items);
+		return;
+	}
+	e = gf_isom_extract_meta_items_mem(read->mov, GF_TRUE, 0, items, nb_items, GF_FALSE);
+
+	nb_items = 0;
+	for (i=0; i<count; i++) {
+		ISOMChannel *ch = gf_list_get(read->channels, i);
+		if (!ch->item_id || ch->item_fetched || ch->au_seq_num || !ch->static_sample) continue;
+		//buffers may have been reallocated even on error
+		ch->static_sample->data = items[nb_items].data;
+		ch->static_sample->alloc_size = items[nb_items].alloc_size;
+		if (e==GF_OK) {
+			ch->static_sample->dataLength = items[nb_items].size;
+			ch->item_fetch_e = items[nb_items].e;
+			ch->item_fetched = GF_TRUE;
+		}
+		nb_items++;
+	}
+	gf_free(items);
+}
+
 void isor_reader_get_sample_from_item(ISOMChannel *ch)
 {
+	GF_Err e;
 	if (ch->au_seq_num) {
 		if (!ch->owner->itt || !isor_declare_item_properties(ch->owner, ch, 1+ch->au_seq_num)) {
 			ch->last_state = GF_EOS;
@@ -300,7 +347,15 @@ void isor_reader_get_sample_from_item(ISOMChannel *ch)
 	ch->sample->IsRAP = RAP;
 	ch->sample->duration = 1000;
 	ch->dts = ch->cts = 1000 * ch->au_seq_num;
-	GF_Err e = gf_isom_extract_meta_item_mem(ch->owner->mov, GF_TRUE, 0, ch->item_id, &ch->sample->data, &ch->sample->dataLength, &ch->static_sample->alloc_size, NULL, GF_FALSE);
+	if (ch->owner->igrid && !ch->owner->itt && !ch->item_fetched)
+		isor_fetch_items(ch->owner);
+
+	if (ch->item_fetched) {
+		e = ch->item_fetch_e;
+		ch->item_fetched = GF_FALSE;
+	} else {
+		e = gf_isom_extract_meta_item_mem(ch->owner->mov, GF_TRUE, 0, ch->item_id, &ch->sample->data, &ch->sample->dataLength, &ch->static_sample->alloc_size, NULL, GF_FALSE);
+	}
 	if ((e<0) && ch->sample) ch->sample->corrupted = GF_TRUE;
 
 	if (ch->is_encrypted && ch->is_cenc) {
@@ -332,6 +387,8 @@ void isor_reader_get_sample(ISOMChannel *ch)
 	Bool skip_sample=GF_FALSE;
 	u32 sample_desc_index;
 	if (ch->sample) return;
+	ch->mapped_data = NULL;
+	ch->mapped_file = NULL;
 
 	if (ch->next_track) {
 		ch->track = ch->next_track;
@@ -499,6 +556,10 @@ void isor_reader_get_sample(ISOMChannel *ch)
 		if (do_fetch) {
 			if (ch->owner->nodata) {
 				ch->sample = gf_isom_get_sample_info_ex(ch->owner->mov, ch->track, ch->sample_num, &sample_desc_index, &ch->sample_data_offset, ch->static_sample);
+			} else if (ch->owner->mmap && !ch->check_avc_ps && !ch->check_hevc_ps && !ch->check_vvc_ps && !ch->check_mhas_pl
+				&& (ch->sample = gf_isom_get_sample_mapped(ch->owner->mov, ch->track, ch->sample_num, &sample_desc_index, ch->static_sample, &ch->sample_data_offset, &ch->mapped_data, &ch->mapped_file))
+			) {
+				//payload is in mapped file, no data copy
 			} else {
 				ch->sample = gf_isom_get_sample_ex(ch->owner->mov, ch->track, ch->sample_num, &sample_desc_index, ch->static_sample, &ch->sample_data_offset);
 			}
@@ -679,6 +740,8 @@ void isor_reader_release_sample(ISOMChannel *ch)
 	if (ch->sample)
 		ch->au_seq_num++;
 	ch->sample = NULL;
+	ch->mapped_data = NULL;
+	ch->mapped_file = NULL;
 	ch->sai_buffer_size = 0;
 }
 
@@ -1211,4 +1274,325 @@ void isor_set_sample_groups_and_aux_data(ISOMReader *read, ISOMChannel *ch, GF_F
 }
 
 
+#ifndef GPAC_DISABLE_THREADS
+
+//max size of a single prefetch read
+#define ISOR_PREFETCH_BLOCK	(1024*1024)
+//max gap between two sample ranges read in a single block
+#define ISOR_PREFETCH_GAP	(16*1024)
+//max number of samples planned per channel at once
+#define ISOR_PREFETCH_SAMPLES	64
+//loaded blocks not fully consumed after this number of planning rounds are dropped
+#define ISOR_PREFETCH_ROUNDS	16
+
+typedef struct
+{
+	u64 offset;
+	u32 size;
+} ISOMPrefetchRange;
+
+typedef struct
+{
+	u64 offset;
+	u32 size;
+	u8 *data;
+	//sum of planned sample sizes in block and sum of sample sizes read from block
+	u32 planned, served;
+	u32 round;
+	Bool failed;
+} ISOMPrefetchBlock;
+
+struct __isor_prefetch
+{
+	GF_ISOFile *mov;
+	char *path;
+	GF_Filter *filter;
+	u32 nb_threads;
+
+	//loaded blocks, sorted by offset
+	GF_List *blocks;
+	u64 size, max_size;
+	u32 round;
+	Bool advance;
+
+	//blocks of the current planning round, loaded by session threads
+	ISOMPrefetchBlock **pending;
+	u32 nb_pending, alloc_pending, nb_jobs;
+
+	GF_ISOSample *info;
+	ISOMPrefetchRange *ranges;
+	u32 nb_ranges, alloc_ranges;
+
+	u32 nb_hits, nb_miss;
+};
+
+static void isor_prefetch_del_block(ISOMPrefetch *pf, ISOMPrefetchBlock *blk)
+{
+	gf_list_del_item(pf->blocks, blk);
+	pf->size -= blk->size;
+	if (blk->data) gf_free(blk->data);
+	gf_free(blk);
+}
+
+//loads every nb_jobs pending block starting from job_idx, called by session threads
+static GF_Err isor_prefetch_load(void *udta, u32 job_idx)
+{
+	u32 i;
+	ISOMPrefetch *pf = (ISOMPrefetch *) udta;
+	//each job uses its own file handle
+	FILE *fd = gf_fopen(pf->path, "rb");
+
+	for (i=job_idx; i<pf->nb_pending; i+=pf->nb_jobs) {
+		ISOMPrefetchBlock *blk = pf->pending[i];
+		blk->data = gf_malloc(blk->size);
+		if (!fd || !blk->data
+			|| gf_fseek(fd, blk->offset, SEEK_SET)
+			|| (gf_fread(blk->data, blk->size, fd) != blk->size)
+		) {
+			blk->failed = GF_TRUE;
+		}
+	}
+	if (fd) gf_fclose(fd);
+	return GF_OK;
+}
+
+//read callback from isomedia, called by the filter thread only
+static Bool isor_prefetch_read(void *udta, u64 offset, u8 *buffer, u32 size)
+{
+	u32 i, count;
+	ISOMPrefetch *pf = (ISOMPrefetch *) udta;
+
+	count = gf_list_count(pf->blocks);
+	for (i=0; i<count; i++) {
+		ISOMPrefetchBlock *blk = gf_list_get(pf->blocks, i);
+		if (blk->offset > offset) break;
+		if (blk->offset + blk->size < offset + size) continue;
+
+		if (blk->failed) {
+			isor_prefetch_del_block(pf, blk);
+			break;
+		}
+		memcpy(buffer, blk->data + (offset - blk->offset), size);
+		blk->served += size;
+		if (blk->served >= blk->planned)
+			isor_prefetch_del_block(pf, blk);
+		pf->nb_hits++;
+		return GF_TRUE;
+	}
+	pf->nb_miss++;
+	return GF_FALSE;
+}
+
+static int isor_prefetch_range_cmp(const void *a, const void *b)
+{
+	const ISOMPrefetchRange *r1 = (const ISOMPrefetchRange *)a;
+	const ISOMPrefetchRange *r2 = (const ISOMPrefetchRange *)b;
+	if (r1->offset < r2->offset) return -1;
+	if (r1->offset > r2->offset) return 1;
+	return 0;
+}
+
+static ISOMPrefetch *isor_prefetch_new(ISOMReader *read)
+{
+	ISOMPrefetch *pf;
+	const char *path = gf_isom_get_filename(read->mov);
+	if (!path) return NULL;
+
+	GF_SAFEALLOC(pf, ISOMPrefetch);
+	if (!pf) return NULL;
+	pf->mov = read->mov;
+	pf->path = gf_strdup(path);
+	pf->filter = read->filter;
+	pf->nb_threads = read->rthreads;
+	pf->blocks = gf_list_new();
+	pf->info = gf_isom_sample_new();
+	pf->max_size = (u64) read->rahead * 1024;
+	if (!pf->path || !pf->blocks || !pf->info) {
+		read->pfetch = pf;
+		isor_prefetch_del(read);
+		return NULL;
+	}
+	gf_isom_set_read_cache(read->mov, isor_prefetch_read, pf);
+	return pf;
+}
+
+void isor_prefetch_del(ISOMReader *read)
+{
+	ISOMPrefetch *pf = read->pfetch;
+	if (!pf) return;
+	read->pfetch = NULL;
+	//file may have been closed or switched
+	if (read->mov == pf->mov)
+		gf_isom_set_read_cache(read->mov, NULL, NULL);
+
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[IsoMedia] Prefetch done, %u samples read from prefetched blocks, %u from file\n", pf->nb_hits, pf->nb_miss));
+
+	if (pf->blocks) {
+		while (gf_list_count(pf->blocks)) {
+			isor_prefetch_del_block(pf, gf_list_last(pf->blocks));
+		}
+		gf_list_del(pf->blocks);
+	}
+	if (pf->pending) gf_free(pf->pending);
+	if (pf->info) gf_isom_sample_del(&pf->info);
+	if (pf->ranges) gf_free(pf->ranges);
+	if (pf->path) gf_free(pf->path);
+	gf_free(pf);
+}
+
+static void isor_prefetch_add_block(ISOMPrefetch *pf, ISOMPrefetchBlock *blk)
+{
+	if (pf->nb_pending == pf->alloc_pending) {
+		ISOMPrefetchBlock **pending;
+		u32 alloc = pf->alloc_pending ? 2*pf->alloc_pending : 16;
+		pending = gf_realloc(pf->pending, sizeof(ISOMPrefetchBlock *) * alloc);
+		if (!pending) {
+			blk->failed = GF_TRUE;
+			return;
+		}
+		pf->pending = pending;
+		pf->alloc_pending = alloc;
+	}
+	pf->pending[pf->nb_pending++] = blk;
+}
+
+void isor_prefetch_update(ISOMReader *read)
+{
+	u32 i, count;
+	u64 planned_size=0;
+	ISOMPrefetchBlock *blk = NULL;
+	ISOMPrefetch *pf = read->pfetch;
+
+	if (pf && (pf->mov != read->mov))
+		isor_prefetch_del(read);
+
+	//only for complete non-fragmented local files, not needed for memory mapped files
+	if (!read->rthreads || !read->mov || read->frag_type || read->mem_load_mode || !read->input_loaded
+		|| read->start_range || read->end_range || read->mapped_mx
+	)
+		return;
+
+	if (!read->pfetch) {
+		read->pfetch = isor_prefetch_new(read);
+		if (!read->pfetch) {
+			read->rthreads = 0;
+			return;
+		}
+		//planning moves the sample table cursors ahead of the channels, use checkpoints every 64 entries to come back
+		//unless an index was already set through -isom-index
+		if (!gf_opts_get_int("core", "isom-index"))
+			gf_isom_set_sample_index(read->mov, 64);
+	}
+	pf = read->pfetch;
+
+	//only count rounds where planning progressed or was blocked by size, channels may wait on their output for many calls
+	if (pf->advance) {
+		pf->round++;
+		for (i=0; i<gf_list_count(pf->blocks); i++) {
+			blk = gf_list_get(pf->blocks, i);
+			//not consumed (seek, channel reset, skipped samples), drop
+			if (pf->round - blk->round > ISOR_PREFETCH_ROUNDS) {
+				isor_prefetch_del_block(pf, blk);
+				i--;
+			}
+		}
+	}
+	planned_size = pf->size;
+
+	//gather next sample ranges of all channels
+	pf->nb_ranges = 0;
+	count = gf_list_count(read->channels);
+	for (i=0; i<count; i++) {
+		u32 nb_samples, k;
+		ISOMChannel *ch = gf_list_get(read->channels, i);
+		if (!ch->playing || ch->item_id || ch->eos_sent || (ch->speed<0)) continue;
+
+		if (ch->pf_sample <= ch->sample_num) ch->pf_sample = ch->sample_num + 1;
+		//enough samples planned
+		if (ch->pf_sample > ch->sample_num + ISOR_PREFETCH_SAMPLES/2) continue;
+
+		nb_samples = gf_isom_get_sample_count(read->mov, ch->track);
+		for (k=0; k<ISOR_PREFETCH_SAMPLES; k++) {
+			u32 di;
+			u64 offset;
+			GF_ISOSample *samp;
+			if ((ch->pf_sample > nb_samples) || (planned_size >= pf->max_size)) break;
+
+			samp = gf_isom_get_sample_info_ex(read->mov, ch->track, ch->pf_sample, &di, &offset, pf->info);
+			if (!samp) break;
+			ch->pf_sample++;
+			if (!samp->dataLength) continue;
+			//data is in another file, offset does not apply to the movie file
+			if (!gf_isom_is_self_contained(read->mov, ch->track, di)) continue;
+
+			if (pf->nb_ranges == pf->alloc_ranges) {
+				pf->alloc_ranges = pf->alloc_ranges ? 2*pf->alloc_ranges : 128;
+				pf->ranges = gf_realloc(pf->ranges, sizeof(ISOMPrefetchRange) * pf->alloc_ranges);
+				if (!pf->ranges) {
+					pf->nb_ranges = pf->alloc_ranges = 0;
+					return;
+				}
+			}
+			pf->ranges[pf->nb_ranges].offset = offset;
+			pf->ranges[pf->nb_ranges].size = samp->dataLength;
+			pf->nb_ranges++;
+			planned_size += samp->dataLength;
+		}
+	}
+	pf->advance = (pf->nb_ranges || (planned_size >= pf->max_size)) ? GF_TRUE : GF_FALSE;
+	if (!pf->nb_ranges) return;
+
+	//coalesce ranges of interleaved tracks into blocks
+	qsort(pf->ranges, pf->nb_ranges, sizeof(ISOMPrefetchRange), isor_prefetch_range_cmp);
+	blk = NULL;
+	pf->nb_pending = 0;
+	for (i=0; i<pf->nb_ranges; i++) {
+		ISOMPrefetchRange *r = &pf->ranges[i];
+		if (blk && (r->offset >= blk->offset + blk->size)
+			&& (r->offset <= blk->offset + blk->size + ISOR_PREFETCH_GAP)
+			&& (r->offset + r->size - blk->offset <= ISOR_PREFETCH_BLOCK)
+		) {
+			blk->size = (u32) (r->offset + r->size - blk->offset);
+			blk->planned += r->size;
+			continue;
+		}
+		if (blk) isor_prefetch_add_block(pf, blk);
+		GF_SAFEALLOC(blk, ISOMPrefetchBlock);
+		if (!blk) break;
+		blk->offset = r->offset;
+		blk->size = blk->planned = r->size;
+		blk->round = pf->round;
+	}
+	if (blk) isor_prefetch_add_block(pf, blk);
+
+	//load all blocks of this round on session threads, blocking until done
+	pf->nb_jobs = MIN(pf->nb_pending, pf->nb_threads);
+	gf_filter_run_jobs(pf->filter, pf->nb_jobs, pf->nb_threads, isor_prefetch_load, pf);
+
+	//insert loaded blocks, sorted for lookup
+	for (i=0; i<pf->nb_pending; i++) {
+		u32 j;
+		blk = pf->pending[i];
+		if (blk->failed) {
+			if (blk->data) gf_free(blk->data);
+			gf_free(blk);
+			continue;
+		}
+		count = gf_list_count(pf->blocks);
+		j = count;
+		while (j && (((ISOMPrefetchBlock *)gf_list_get(pf->blocks, j-1))->offset > blk->offset))
+			j--;
+		gf_list_insert(pf->blocks, blk, j);
+		pf->size += blk->size;
+	}
+	pf->nb_pending = 0;
+}
+
+#else
+
+void isor_prefetch_update(ISOMReader *read) {}
+void isor_prefetch_del(ISOMReader *read) {}
+
+#endif /*GPAC_DISABLE_THREADS*/
+
 #endif // !defined(GPAC_DISABLE_ISOM) && !defined(GPAC_DISABLE_MP4DMX)
@@ -189,6 +189,8 @@ typedef struct
 	GF_FilterPid *pid;
 	JSValue jsobj;
 	struct _js_pck_ctx *pck_head;
+	//input packets exposed after pck_head by get_packets, in buffer order
+	GF_List *pck_queue;
 	GF_List *shared_pck;
 } GF_JSPidCtx;
 
@@ -198,6 +200,8 @@ enum
 	GF_JS_PCK_IS_SHARED = 1<<1,
 	GF_JS_PCK_IS_OUTPUT = 1<<2,
 	GF_JS_PCK_IS_DANGLING = 1<<3,
+	//packet already listed in current batch send
+	GF_JS_PCK_IN_BATCH = 1<<4,
 };
 
 typedef struct _js_pck_ctx
@@ -348,8 +352,12 @@ static void jsf_pck_finalizer(JSRuntime *rt, JSValue val)
 		return;
 	}
 
-	if (pckctx->jspid)
-		pckctx->jspid->pck_head = NULL;
+	if (pckctx->jspid) {
+		if (pckctx->jspid->pck_head == pckctx)
+			pckctx->jspid->pck_head = NULL;
+		else if (pckctx->jspid->pck_queue)
+			gf_list_del_item(pckctx->jspid->pck_queue, pckctx);
+	}
 
 	/*we only keep a ref for input packet(s)*/
 	if (pckctx->pck && !(pckctx->flags & GF_JS_PCK_IS_OUTPUT))
@@ -2347,21 +2355,12 @@ static JSValue jsf_pid_get_info(JSContext *ctx, JSValueConst this_val, int argc,
 }
 
 
-static JSValue jsf_pid_get_packet(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+//get JS object for input packet at given index in pid buffer
+static JSValue jsf_pid_wrap_packet(JSContext *ctx, GF_JSPidCtx *pctx, GF_FilterPacket *pck, u32 idx)
 {
 	JSValue res;
-	GF_FilterPacket *pck;
-	GF_JSPckCtx *pckctx;
-	GF_JSPidCtx *pctx = JS_GetOpaque(this_val, jsf_pid_class_id);
-	if (!pctx) return GF_JS_EXCEPTION(ctx);
-	if (!pctx->jsf->is_custom && !pctx->jsf->filter->in_process_callback)
-		return js_throw_err_msg(ctx, GF_BAD_PARAM, "Filter %s attempt to query packet outside process callback not allowed!\n", pctx->jsf->filter->name);
-
-	pck = gf_filter_pid_get_packet(pctx->pid);
-	if (!pck) return JS_NULL;
-
-	if (pctx->pck_head) {
-		pckctx = pctx->pck_head;
+	GF_JSPckCtx *pckctx = idx ? gf_list_get(pctx->pck_queue, idx-1) : pctx->pck_head;
+	if (pckctx) {
 		gf_assert(pckctx->pck == pck);
 		return JS_DupValue(ctx, pckctx->jsobj);
 	}
@@ -2378,11 +2377,60 @@ static JSValue jsf_pid_get_packet(JSContext *ctx, JSValueConst this_val, int arg
 	pckctx->jsobj = JS_DupValue(ctx, res);
 	pckctx->ref_val = JS_UNDEFINED;
 	pckctx->data_ab = JS_UNDEFINED;
-	pctx->pck_head = pckctx;
+	if (!idx) {
+		pctx->pck_head = pckctx;
+	} else {
+		if (!pctx->pck_queue) pctx->pck_queue = gf_list_new();
+		gf_list_add(pctx->pck_queue, pckctx);
+	}
 
 	JS_SetOpaque(res, pckctx);
 	return res;
 }
+
+static JSValue jsf_pid_get_packet(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	GF_FilterPacket *pck;
+	GF_JSPidCtx *pctx = JS_GetOpaque(this_val, jsf_pid_class_id);
+	if (!pctx) return GF_JS_EXCEPTION(ctx);
+	if (!pctx->jsf->is_custom && !pctx->jsf->filter->in_process_callback)
+		return js_throw_err_msg(ctx, GF_BAD_PARAM, "Filter %s attempt to query packet outside process callback not allowed!\n", pctx->jsf->filter->name);
+
+	pck = gf_filter_pid_get_packet(pctx->pid);
+	if (!pck) return JS_NULL;
+	return jsf_pid_wrap_packet(ctx, pctx, pck, 0);
+}
+
+static JSValue jsf_pid_get_packets(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	u32 i, nb_pcks, max_pcks=0;
+	GF_FilterPacket **pcks;
+	JSValue res;
+	GF_JSPidCtx *pctx = JS_GetOpaque(this_val, jsf_pid_class_id);
+	if (!pctx || !argc || JS_ToInt32(ctx, &max_pcks, argv[0])) return GF_JS_EXCEPTION(ctx);
+	if (!pctx->jsf->is_custom && !pctx->jsf->filter->in_process_callback)
+		return js_throw_err_msg(ctx, GF_BAD_PARAM, "Filter %s attempt to query packet outside process callback not allowed!\n", pctx->jsf->filter->name);
+
+	res = JS_NewArray(ctx);
+	if (!max_pcks) return res;
+	pcks = gf_malloc(sizeof(GF_FilterPacket *) * max_pcks);
+	if (!pcks) {
+		JS_FreeValue(ctx, res);
+		return js_throw_err(ctx, GF_OUT_OF_MEM);
+	}
+	nb_pcks = gf_filter_pid_get_packets(pctx->pid, pcks, max_pcks);
+	for (i=0; i<nb_pcks; i++) {
+		JSValue v = jsf_pid_wrap_packet(ctx, pctx, pcks[i], i);
+		if (JS_IsException(v)) {
+			gf_free(pcks);
+			JS_FreeValue(ctx, res);
+			return v;
+		}
+		JS_SetPropertyUint32(ctx, res, i, v);
+	}
+	gf_free(pcks);
+	return res;
+}
 static JSValue jsf_pid_drop_packet(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
 {
 	GF_JSPckCtx *pckctx;
@@ -2404,6 +2452,70 @@ static JSValue jsf_pid_drop_packet(JSContext *ctx, JSValueConst this_val, int ar
 	JS_FreeValue(ctx, pckctx->jsobj);
 	pckctx->jsobj = JS_UNDEFINED;
 	gf_filter_pid_drop_packet(pctx->pid);
+	//next packet fetched through get_packets becomes head
+	if (pctx->pck_queue)
+		pctx->pck_head = gf_list_pop_front(pctx->pck_queue);
+	return JS_UNDEFINED;
+}
+
+static JSValue jsf_pid_send_batch(JSContext *ctx, JSValueConst this_val, int argc, JSValueConst *argv)
+{
+	GF_Err e;
+	u64 i, nb_pcks=0;
+	GF_FilterPacket **pcks;
+	JSValue js_length;
+	GF_JSPidCtx *pctx = JS_GetOpaque(this_val, jsf_pid_class_id);
+	if (!pctx || !argc || !JS_IsArray(ctx, argv[0])) return GF_JS_EXCEPTION(ctx);
+	if (!pctx->jsf->is_custom && !pctx->jsf->filter->in_process_callback)
+		return js_throw_err_msg(ctx, GF_BAD_PARAM, "Filter %s attempt to send packet outside process callback not allowed!\n", pctx->jsf->filter->name);
+
+	js_length = JS_GetPropertyStr(ctx, argv[0], "length");
+	if (JS_ToIndex(ctx, &nb_pcks, js_length)) {
+		JS_FreeValue(ctx, js_length);
+		return GF_JS_EXCEPTION(ctx);
+	}
+	JS_FreeValue(ctx, js_length);
+	if (!nb_pcks) return JS_UNDEFINED;
+
+	pcks = gf_malloc(sizeof(GF_FilterPacket *) * (size_t) nb_pcks);
+	if (!pcks) return js_throw_err(ctx, GF_OUT_OF_MEM);
+	//check all packets before sending any
+	for (i=0; i<nb_pcks; i++) {
+		JSValue v = JS_GetPropertyUint32(ctx, argv[0], (u32) i);
+		GF_JSPckCtx *pckctx = JS_GetOpaque(v, jsf_pck_class_id);
+		JS_FreeValue(ctx, v);
+		if (!pckctx || !pckctx->pck || (pckctx->jspid != pctx) || !(pckctx->flags & GF_JS_PCK_IS_OUTPUT) || (pckctx->flags & GF_JS_PCK_IN_BATCH)) {
+			u64 j;
+			for (j=0; j<i; j++) {
+				v = JS_GetPropertyUint32(ctx, argv[0], (u32) j);
+				pckctx = JS_GetOpaque(v, jsf_pck_class_id);
+				pckctx->flags &= ~GF_JS_PCK_IN_BATCH;
+				JS_FreeValue(ctx, v);
+			}
+			gf_free(pcks);
+			return js_throw_err_msg(ctx, GF_BAD_PARAM, "Filter %s attempt to batch send invalid packet at index %u\n", pctx->jsf->filter->name, (u32) i);
+		}
+		pckctx->flags |= GF_JS_PCK_IN_BATCH;
+		pcks[i] = pckctx->pck;
+	}
+	for (i=0; i<nb_pcks; i++) {
+		JSValue v = JS_GetPropertyUint32(ctx, argv[0], (u32) i);
+		GF_JSPckCtx *pckctx = JS_GetOpaque(v, jsf_pck_class_id);
+		pckctx->flags &= ~GF_JS_PCK_IN_BATCH;
+		if (!JS_IsUndefined(pckctx->data_ab)) {
+			JS_FreeValue(ctx, pckctx->data_ab);
+			pckctx->data_ab = JS_UNDEFINED;
+		}
+		JS_SetOpaque(v, NULL);
+		JS_FreeValue(ctx, v);
+		if (!(pckctx->flags & GF_JS_PCK_IS_SHARED)) {
+			gf_list_add(pctx->jsf->pck_res, pckctx);
+			memset(pckctx, 0, sizeof(GF_JSPckCtx));
+		}
+	}
+	e = gf_filter_pck_send_batch(pcks, (u32) nb_pcks);
+	gf_free(pcks);
+	if (e) return js_throw_err(ctx, e);
 	return JS_UNDEFINED;
 }
 
@@ -3073,7 +3185,9 @@ static const JSCFunctionListEntry jsf_pid_funcs[] = {
 	JS_CFUNC_DEF("get_prop", 0, jsf_pid_get_property),
 	JS_CFUNC_DEF("get_info", 0, jsf_pid_get_info),
 	JS_CFUNC_DEF("get_packet", 0, jsf_pid_get_packet),
+	JS_CFUNC_DEF("get_packets", 0, jsf_pid_get_packets),
 	JS_CFUNC_DEF("drop_packet", 0, jsf_pid_drop_packet),
+	JS_CFUNC_DEF("send_batch", 0, jsf_pid_send_batch),
 	JS_CFUNC_DEF("is_filter_in_parents", 0, jsf_pid_is_filter_in_parents),
 	JS_CFUNC_DEF("get_buffer_occupancy", 0, jsf_pid_get_buffer_occupancy),
 	JS_CFUNC_DEF("clear_eos", 0, jsf_pid_clear_eos),
@@ -4561,6 +4675,17 @@ static GF_Err jsfilter_configure_pid(GF_Filter *filter, GF_FilterPid *pid, Bool
 				pctx->pck_head->jspid = NULL;
 			}
 		}
+		while (gf_list_count(pctx->pck_queue)) {
+			GF_JSPckCtx *pckc = gf_list_get(pctx->pck_queue, 0);
+			JS_FreeValue(jsf->ctx, pckc->jsobj);
+			//might be removed while freeing above obj
+			if (gf_list_get(pctx->pck_queue, 0) == pckc) {
+				gf_list_rem(pctx->pck_queue, 0);
+				pckc->jsobj = JS_UNDEFINED;
+				pckc->jspid = NULL;
+			}
+		}
+		gf_list_del(pctx->pck_queue);
 		//force cleanup of all refs
 		gf_js_call_gc(jsf->ctx);
 
@@ -5023,6 +5148,8 @@ static void jsfilter_finalize(GF_Filter *filter)
 		GF_JSPidCtx *pctx = gf_list_pop_back(jsf->pids);
 		if (pctx->shared_pck)
 			gf_list_del(pctx->shared_pck);
+		if (pctx->pck_queue)
+			gf_list_del(pctx->pck_queue);
 		gf_free(pctx);
 	}
 	gf_list_del(jsf->pids);
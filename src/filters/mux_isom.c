@@ -279,6 +279,7 @@ typedef struct
 	Bool importer, pack_nal, moof_first, abs_offset, fsap, tfdt_traf, keep_utc, pps_inband, rsot, auto_reorder;
 	GF_MP4MuxInbandParamSetMode xps_inband;
 	u32 moovpad;
+	s32 moovres;
 	u32 block_size;
 	GF_MP4MuxFileStorageMode store;
 	u32 tktpl, mudta;
@@ -329,6 +330,7 @@ typedef struct
 	GF_MP4MuxChapterMode chapm;
 	u32 sfrag_tolerance;
 	Scte35Mode scte35;
+	char *hidx;
 
 	//internal
 	GF_Filter *filter;
@@ -375,6 +377,7 @@ typedef struct
 	u32 *seg_sizes;
 	u32 nb_seg_sizes, alloc_seg_sizes, config_retry_start;
 	Bool config_timing;
+	Bool moov_reserved;
 
 	u32 major_brand_set;
 	Bool def_brand_patched;
@@ -7444,6 +7447,63 @@ static void mp4_mux_update_init_edit(GF_MP4MuxCtx *ctx, TrackWriter *tkw, u64 mi
 	}
 }
 
+//estimate moov size for fast-start mode from sample counts, this is only a hint: if too small, moov is inserted at the end
+static void mp4_mux_reserve_moov(GF_MP4MuxCtx *ctx)
+{
+	u32 i, count;
+	u64 size = 1024;
+
+	ctx->moov_reserved = GF_TRUE;
+	count = gf_list_count(ctx->tracks);
+	for (i=0; i<count; i++) {
+		const GF_PropertyValue *p;
+		u64 nb_samples = 0;
+		TrackWriter *tkw = gf_list_get(ctx->tracks, i);
+		if (tkw->fake_track) continue;
+
+		if (ctx->moovres>0) {
+			nb_samples = ctx->moovres;
+		} else if (tkw->nb_frames) {
+			nb_samples = tkw->nb_frames;
+		} else {
+			p = gf_filter_pid_get_property(tkw->ipid, GF_PROP_PID_DURATION);
+			if (p && (p->value.lfrac.num>0) && p->value.lfrac.den) {
+				GF_Fraction64 dur = p->value.lfrac;
+				if (tkw->stream_type==GF_STREAM_AUDIO) {
+					u32 sr, fsize;
+					p = gf_filter_pid_get_property(tkw->ipid, GF_PROP_PID_SAMPLE_RATE);
+					sr = p ? p->value.uint : 0;
+					p = gf_filter_pid_get_property(tkw->ipid, GF_PROP_PID_SAMPLES_PER_FRAME);
+					fsize = (p && p->value.uint) ? p->value.uint : 1024;
+					nb_samples = gf_timestamp_rescale(dur.num, dur.den, sr) / fsize;
+				} else {
+					p = gf_filter_pid_get_property(tkw->ipid, GF_PROP_PID_FPS);
+					if (p && p->value.frac.num && p->value.frac.den)
+						nb_samples = gf_timestamp_rescale(dur.num * p->value.frac.num, dur.den, p->value.frac.den);
+				}
+			}
+			if (!nb_samples) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[MP4Mux] Cannot estimate number of samples for track %d, moov will likely be inserted at end\n", tkw->track_id));
+			}
+		}
+		//track boxes and sample description
+		size += 1024;
+		p = gf_filter_pid_get_property(tkw->ipid, GF_PROP_PID_DECODER_CONFIG);
+		if (p) size += p->value.data.size;
+		//stts+stsz+stco, and ctts+stss for video
+		size += nb_samples * ((tkw->stream_type==GF_STREAM_VISUAL) ? 28 : 16);
+	}
+	//5% margin
+	size += size / 20;
+	if (size >= 0xFFFFFFFF) size = 0xFFFFFFFF;
+
+	if (gf_isom_set_moov_reserve(ctx->file, (u32) size) != GF_OK) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MP4Mux] Cannot reserve moov space, data already written\n"));
+		return;
+	}
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[MP4Mux] Reserved "LLU" bytes for moov\n", size));
+}
+
 static void mp4_mux_config_timing(GF_MP4MuxCtx *ctx)
 {
 	if ((ctx->store>=MP4MX_MODE_FRAG) && !ctx->tsalign) {
@@ -7658,6 +7718,9 @@ retry_pck:
 		mp4_mux_update_init_edit(ctx, tkw, si->first_ts_min, ((count==1) && (tkw->stream_type == GF_STREAM_TEXT)) ? GF_TRUE : GF_FALSE);
 	}
 
+	if ((ctx->store==MP4MX_MODE_FASTSTART) && ctx->moovres && !ctx->moov_reserved && ctx->owns_mov)
+		mp4_mux_reserve_moov(ctx);
+
 	ctx->config_timing = GF_FALSE;
 	del_service_info(services);
 }
@@ -8173,6 +8236,9 @@ static GF_Err mp4_mux_initialize(GF_Filter *filter)
 
 		gf_isom_set_progress_callback(ctx->file, mp4_mux_progress_cbk, filter);
 
+		if (ctx->hidx)
+			gf_isom_set_sample_hash_index(ctx->file, ctx->hidx);
+
 		if (ctx->dref && (ctx->store>=MP4MX_MODE_FRAG)) {
 			GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[MP4Mux] Cannot use data reference in movie fragments, not supported. Ignoring it\n"));
 			ctx->dref = GF_FALSE;
@@ -8854,6 +8920,11 @@ static const GF_FilterArgs MP4MuxArgs[] =
 	{ OFFS(keep_utc), "force all new files and tracks to keep the source UTC creation and modification times", GF_PROP_BOOL, "false", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(pps_inband), "when [-xps_inband]() is set, inject PPS in each non SAP 1/2/3 sample", GF_PROP_BOOL, "no", NULL, GF_FS_ARG_HINT_ADVANCED},
 	{ OFFS(moovpad), "insert `free` box of given size after `moov` for future in-place editing", GF_PROP_UINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(moovres), "reserve space for `moov` before `mdat` in `fstart` mode (see filter help)\n"
+	"- 0: no reservation, `moov` is inserted before `mdat` when the file is complete\n"
+	"- -1: estimate `moov` size from number of frames or duration of input PIDs\n"
+	"- positive: estimate `moov` size for the given number of samples per track", GF_PROP_SINT, "0", NULL, GF_FS_ARG_HINT_EXPERT},
+	{ OFFS(hidx), "write a sample hash index with CRC32 of samples to the given file when the output file is closed (not written for DASH segments), to be checked with `MP4Box -hidx-check`", GF_PROP_STRING, NULL, NULL, GF_FS_ARG_HINT_EXPERT},
 	{ OFFS(cmaf), "use CMAF guidelines (turns on `mvex`, `truns_first`, `strun`, `straf`, `tfdt_traf`, `chain_sidx` and restricts `subs_sidx` to -1 or 0)\n"
 		"- no: CMAF not enforced\n"
 		"- cmfc: use CMAF `cmfc` guidelines\n"
@@ -8901,6 +8972,7 @@ GF_FilterRegister MP4MuxRegister = {
 	"# Storage\n"
 	"The [-store]() option allows controlling if the file is fragmented (`frag`) or not, and when not fragmented, how interleaving (`inter`) is done.\n"
 	"For cases where disk requirements are tight and fragmentation cannot be used, it is recommended to use either `flat` or `fstart` (fast-start) modes.\n"
+	"In `fstart` mode, the `moov` box is by default inserted before `mdat` once the file is complete, which requires moving all media data in the output. The [-moovres]() option allows reserving space for the `moov` before `mdat` from an estimated sample count: if the final `moov` fits, it is written in the reserved space (followed by a `free` box if needed) and media data is written only once, otherwise the `moov` is inserted before the reserved space.\n"
 	"`sfrag` mode is similar `frag` mode but aligns fragments on SAP samples. It is implied when using `sfrag_tolerance`.\n"
 	"`sfrag_tolerance` is expressed as a percentage of the fragment duration (`cdur`). It allows to modulate the fragment durations while keeping the same number of fragments per segment. This is useful to align fragments on randomly placed SAP samples (typically scene-cuts or events).\n"
 	"  \n"
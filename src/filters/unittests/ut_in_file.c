@@ -0,0 +1,131 @@
+#include "tests.h"
+#include <gpac/filters.h>
+#include <utime.h>
+
+#define FIN_TEST_SIZE	1000000
+#define FIN_TEST_BLOCK	50000
+
+typedef struct
+{
+	GF_FilterPid *ipid;
+	u8 *data;
+	u32 size;
+	const u8 *last_pck;
+	u32 last_pck_size;
+	//number of packets starting right after the previous one in memory
+	u32 nb_contiguous;
+} FinTestSink;
+
+static GF_Err fin_test_configure(GF_Filter *filter, GF_FilterPid *pid, Bool is_remove)
+{
+	GF_FilterEvent evt;
+	FinTestSink *sink = gf_filter_get_rt_udta(filter);
+	if (is_remove) {
+		sink->ipid = NULL;
+		return GF_OK;
+	}
+	sink->ipid = pid;
+	GF_FEVT_INIT(evt, GF_FEVT_PLAY, pid);
+	gf_filter_pid_send_event(pid, &evt);
+	return GF_OK;
+}
+
+static GF_Err fin_test_process(GF_Filter *filter)
+{
+	FinTestSink *sink = gf_filter_get_rt_udta(filter);
+	if (!sink->ipid) return GF_OK;
+	while (1) {
+		u32 size;
+		const u8 *data;
+		GF_FilterPacket *pck = gf_filter_pid_get_packet(sink->ipid);
+		if (!pck) {
+			if (gf_filter_pid_is_eos(sink->ipid)) return GF_EOS;
+			return GF_OK;
+		}
+		data = gf_filter_pck_get_data(pck, &size);
+		if (size && (sink->size + size <= FIN_TEST_SIZE)) {
+			memcpy(sink->data + sink->size, data, size);
+			sink->size += size;
+			if (sink->last_pck && (data == sink->last_pck + sink->last_pck_size))
+				sink->nb_contiguous++;
+			sink->last_pck = data;
+			sink->last_pck_size = size;
+		}
+		gf_filter_pid_drop_packet(sink->ipid);
+	}
+	return GF_OK;
+}
+
+static void fin_test_run(const char *path, Bool mmap, FinTestSink *sink)
+{
+	GF_Err e;
+	GF_Filter *f;
+	char url[GF_MAX_PATH+100];
+	GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	assert_not_null(fs);
+	if (!fs) return;
+
+	memset(sink, 0, sizeof(FinTestSink));
+	sink->data = gf_malloc(FIN_TEST_SIZE);
+	snprintf(url, sizeof(url), "fin:src=%s:block_size=%u%s", path, FIN_TEST_BLOCK, mmap ? ":mmap" : "");
+	gf_fs_load_source(fs, url, NULL, NULL, &e);
+	assert_equal(e, GF_OK, "%d");
+	f = gf_fs_new_filter(fs, "ut_fin_sink", 0, &e);
+	assert_not_null(f);
+	if (f) {
+		gf_filter_set_rt_udta(f, sink);
+		gf_filter_push_caps(f, GF_PROP_PID_STREAM_TYPE, &PROP_UINT(GF_STREAM_FILE), NULL, GF_CAPS_INPUT, 0);
+		gf_filter_set_configure_ckb(f, fin_test_configure);
+		gf_filter_set_process_ckb(f, fin_test_process);
+		gf_fs_run(fs);
+	}
+	gf_fs_del(fs);
+}
+
+//mapped blocks must carry the same data as read blocks, files being written are not mapped
+unittest(fin_mmap)
+{
+	u32 i;
+	u8 *ref;
+	FILE *f;
+	FinTestSink sink;
+	struct utimbuf times;
+	char path[GF_MAX_PATH];
+
+	snprintf(path, GF_MAX_PATH, "%s/ut_fin_mmap.bin", gf_get_default_cache_directory());
+	ref = gf_malloc(FIN_TEST_SIZE);
+	for (i=0; i<FIN_TEST_SIZE; i++) ref[i] = (u8) (i*7 + i/1000);
+	f = gf_fopen(path, "wb");
+	assert_not_null(f);
+	if (!f) goto exit;
+	assert_equal((u32) gf_fwrite(ref, FIN_TEST_SIZE, f), FIN_TEST_SIZE, "%u");
+	gf_fclose(f);
+
+	//just written, read in the block
+	fin_test_run(path, GF_TRUE, &sink);
+	assert_equal(sink.size, FIN_TEST_SIZE, "%u");
+	assert_equal_mem(sink.data, ref, FIN_TEST_SIZE);
+	assert_equal(sink.nb_contiguous, 0, "%u");
+	gf_free(sink.data);
+
+	times.actime = times.modtime = time(NULL) - 60;
+	assert_equal(utime(path, &times), 0, "%d");
+
+	//regular reads
+	fin_test_run(path, GF_FALSE, &sink);
+	assert_equal(sink.size, FIN_TEST_SIZE, "%u");
+	assert_equal_mem(sink.data, ref, FIN_TEST_SIZE);
+	assert_equal(sink.nb_contiguous, 0, "%u");
+	gf_free(sink.data);
+
+	//packets after the 5000 bytes probe block point to consecutive parts of the mapped file
+	fin_test_run(path, GF_TRUE, &sink);
+	assert_equal(sink.size, FIN_TEST_SIZE, "%u");
+	assert_equal_mem(sink.data, ref, FIN_TEST_SIZE);
+	assert_equal(sink.nb_contiguous, (FIN_TEST_SIZE - 5000 + FIN_TEST_BLOCK - 1) / FIN_TEST_BLOCK - 1, "%u");
+	gf_free(sink.data);
+
+exit:
+	gf_free(ref);
+	gf_file_delete(path);
+}
@@ -0,0 +1,178 @@
+#include "../../isomedia/unittests/isom_tests.h"
+#include <gpac/filters.h>
+
+#define PF_TEST_SAMPLES	300
+
+static u32 pf_test_sample_size(u32 track, u32 idx)
+{
+	return 500 + (idx*37 + track*101) % 700;
+}
+
+static void pf_test_sample_data(u8 *data, u32 track, u32 idx)
+{
+	u32 i, size = pf_test_sample_size(track, idx);
+	for (i=0; i<size; i++) data[i] = (u8) (track*31 + idx + i);
+}
+
+//two interleaved tracks in the movie file, and a third one with data in an external file at offsets also used in the movie file
+static Bool pf_test_make_file(const char *path, const char *ext_path)
+{
+	u32 i, t, tracks[3];
+	u64 ext_offset = 0;
+	u8 *data;
+	GF_ISOSample *samp;
+	GF_GenericSampleDescription udesc;
+	FILE *ext;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	assert_not_null(file);
+	if (!file) return GF_FALSE;
+
+	samp = gf_isom_sample_new();
+	data = gf_malloc(2000);
+	ext = gf_fopen(ext_path, "wb");
+	assert_not_null(ext);
+	if (!samp || !data || !ext) goto exit;
+
+	for (t=0; t<2; t++) {
+		tracks[t] = isom_test_new_track(file, t+1, GF_ISOM_MEDIA_AUDIO, 1000);
+		assert_true(tracks[t] != 0);
+		if (!tracks[t]) goto exit;
+	}
+	tracks[2] = gf_isom_new_track(file, 3, GF_ISOM_MEDIA_AUDIO, 1000);
+	assert_true(tracks[2] != 0);
+	if (!tracks[2]) goto exit;
+	memset(&udesc, 0, sizeof(GF_GenericSampleDescription));
+	udesc.codec_tag = GF_4CC('t','e','s','t');
+	isom_test_ok( gf_isom_new_generic_sample_description(file, tracks[2], ext_path, NULL, &udesc, &i) );
+	for (t=0; t<3; t++) {
+		isom_test_ok( gf_isom_set_track_enabled(file, tracks[t], GF_TRUE) );
+	}
+
+	samp->data = data;
+	samp->IsRAP = RAP;
+	for (i=0; i<PF_TEST_SAMPLES; i++) {
+		for (t=0; t<3; t++) {
+			samp->dataLength = pf_test_sample_size(t+1, i);
+			samp->DTS = i*20;
+			pf_test_sample_data(data, t+1, i);
+			if (t<2) {
+				isom_test_ok( gf_isom_add_sample(file, tracks[t], 1, samp) );
+			} else {
+				assert_equal((u32) gf_fwrite(data, samp->dataLength, ext), samp->dataLength, "%u");
+				isom_test_ok( gf_isom_add_sample_reference(file, tracks[t], 1, samp, ext_offset) );
+				ext_offset += samp->dataLength;
+			}
+		}
+	}
+	samp->data = NULL;
+	gf_isom_sample_del(&samp);
+	gf_free(data);
+	gf_fclose(ext);
+	isom_test_ok( gf_isom_close(file) );
+	return GF_TRUE;
+
+exit:
+	if (samp) {
+		samp->data = NULL;
+		gf_isom_sample_del(&samp);
+	}
+	if (data) gf_free(data);
+	if (ext) gf_fclose(ext);
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+//checks the CRC of every packet of each track against the generated samples, in order
+static void pf_test_check_log(const char *log_path)
+{
+	u32 nb_pck[3];
+	char line[100];
+	u8 data[2000];
+	FILE *f = gf_fopen(log_path, "r");
+	assert_not_null(f);
+	if (!f) return;
+	memset(nb_pck, 0, sizeof(nb_pck));
+	while (gf_fgets(line, 100, f)) {
+		u32 id, crc, size;
+		if (sscanf(line, "%u 0x%X", &id, &crc) != 2) continue;
+		assert_true(id && (id<=3));
+		if (!id || (id>3)) continue;
+		assert_less(nb_pck[id-1], PF_TEST_SAMPLES, "%u");
+		if (nb_pck[id-1] >= PF_TEST_SAMPLES) continue;
+		size = pf_test_sample_size(id, nb_pck[id-1]);
+		pf_test_sample_data(data, id, nb_pck[id-1]);
+		assert_equal(crc, gf_crc_32(data, size), "0x%08X");
+		nb_pck[id-1]++;
+	}
+	gf_fclose(f);
+	assert_equal(nb_pck[0], PF_TEST_SAMPLES, "%u");
+	assert_equal(nb_pck[1], PF_TEST_SAMPLES, "%u");
+	assert_equal(nb_pck[2], PF_TEST_SAMPLES, "%u");
+}
+
+//prefetched sample data must match the file, samples stored in other files are read from these files
+unittest(isoffin_prefetch)
+{
+	GF_Err e;
+	u32 i;
+	char path[GF_MAX_PATH], ext_path[GF_MAX_PATH], log_path[GF_MAX_PATH], url[3*GF_MAX_PATH];
+
+	isom_test_path(path, "ut_isoffin_pf.mp4");
+	isom_test_path(ext_path, "ut_isoffin_pf.bin");
+	isom_test_path(log_path, "ut_isoffin_pf.txt");
+	if (!pf_test_make_file(path, ext_path)) goto exit;
+
+	//without and with prefetch, small read-ahead to go through several planning rounds
+	for (i=0; i<2; i++) {
+		GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+		assert_not_null(fs);
+		if (!fs) break;
+		snprintf(url, sizeof(url), "%s:rthreads=%u:rahead=64", path, i ? 2 : 0);
+		gf_fs_load_source(fs, url, NULL, NULL, &e);
+		assert_equal(e, GF_OK, "%d");
+		snprintf(url, sizeof(url), "inspect:fmt=%%pid.ID%% %%crc%%%%lf%%:log=%s", log_path);
+		if (!e) gf_fs_load_filter(fs, url, &e);
+		assert_equal(e, GF_OK, "%d");
+		if (!e) gf_fs_run(fs);
+		gf_fs_del(fs);
+		pf_test_check_log(log_path);
+	}
+
+exit:
+	gf_file_delete(path);
+	gf_file_delete(ext_path);
+	gf_file_delete(log_path);
+}
+
+//samples sent from the mapped file must match the file, samples stored in other files are copied
+unittest(isoffin_mmap)
+{
+	GF_Err e;
+	u32 i;
+	char path[GF_MAX_PATH], ext_path[GF_MAX_PATH], log_path[GF_MAX_PATH], url[3*GF_MAX_PATH];
+
+	isom_test_path(path, "ut_isoffin_mmap.mp4");
+	isom_test_path(ext_path, "ut_isoffin_mmap.bin");
+	isom_test_path(log_path, "ut_isoffin_mmap.txt");
+	if (!pf_test_make_file(path, ext_path)) goto exit;
+
+	for (i=0; i<2; i++) {
+		GF_FilterSession *fs = gf_fs_new(0, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+		assert_not_null(fs);
+		if (!fs) break;
+		snprintf(url, sizeof(url), "%s%s", path, i ? ":mmap" : "");
+		gf_fs_load_source(fs, url, NULL, NULL, &e);
+		assert_equal(e, GF_OK, "%d");
+		snprintf(url, sizeof(url), "inspect:fmt=%%pid.ID%% %%crc%%%%lf%%:log=%s", log_path);
+		if (!e) gf_fs_load_filter(fs, url, &e);
+		assert_equal(e, GF_OK, "%d");
+		if (!e) gf_fs_run(fs);
+		gf_fs_del(fs);
+		pf_test_check_log(log_path);
+	}
+
+exit:
+	gf_file_delete(path);
+	gf_file_delete(ext_path);
+	gf_file_delete(log_path);
+}
@@ -34,6 +34,7 @@ void co64_box_del(GF_Box *s)
 	ptr = (GF_ChunkLargeOffsetBox *) s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -50,6 +51,11 @@ GF_Err co64_box_read(GF_Box *s,GF_BitStream *bs)
 		return GF_ISOM_INVALID_FILE;
 	}
 
+	ptr->lazy = gf_isom_lazy_table_new(bs, ptr->nb_entries, 64);
+	if (ptr->lazy) {
+		gf_bs_skip_bytes(bs, (u64) ptr->nb_entries * 8);
+		return GF_OK;
+	}
 	ptr->offsets = (u64 *) gf_malloc(ptr->nb_entries * sizeof(u64) );
 	if (ptr->offsets == NULL) return GF_OUT_OF_MEM;
 	ptr->alloc_size = ptr->nb_entries;
@@ -74,6 +80,8 @@ GF_Err co64_box_write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_ChunkLargeOffsetBox *ptr = (GF_ChunkLargeOffsetBox *) s;
 
+	e = gf_isom_box_unlazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -389,6 +397,7 @@ void ctts_box_del(GF_Box *s)
 {
 	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
 	if (ptr->entries) gf_free(ptr->entries);
+	gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -408,6 +417,32 @@ GF_Err ctts_box_read(GF_Box *s, GF_BitStream *bs)
 		return GF_ISOM_INVALID_FILE;
 	}
 
+	//entries are loaded on demand, only compute table properties
+	ptr->lazy = gf_isom_lazy_table_new(bs, 2*ptr->nb_entries, 32);
+	if (ptr->lazy) {
+		sampleCount = 0;
+		for (i=0; i<ptr->nb_entries; i++) {
+			s32 offset;
+			ISOM_DECREASE_SIZE(ptr, 8);
+			sampleCount += gf_bs_read_u32(bs);
+			offset = (s32) gf_bs_read_u32(bs);
+			if (!ptr->version) {
+				if (offset == INT_MIN) offset = 0;
+				if (offset<ptr->min_neg_cts_offset)
+					ptr->min_neg_cts_offset = offset;
+			}
+			if (offset == INT_MIN) {
+				ptr->max_cts_delta = INT_MAX;
+			} else if (ptr->max_cts_delta <= ABS(offset)) {
+				ptr->max_cts_delta = ABS(offset);
+			}
+		}
+#ifndef GPAC_DISABLE_ISOM_WRITE
+		ptr->w_LastSampleNumber = sampleCount;
+#endif
+		return GF_OK;
+	}
+
 	ptr->alloc_size = ptr->nb_entries;
 	ptr->entries = (GF_DttsEntry *)gf_malloc(sizeof(GF_DttsEntry)*ptr->alloc_size);
 	if (!ptr->entries) return GF_OUT_OF_MEM;
@@ -457,6 +492,8 @@ GF_Err ctts_box_write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_CompositionOffsetBox *ptr = (GF_CompositionOffsetBox *)s;
 
+	e = gf_isom_box_unlazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	if (ptr->nb_entries && !ptr->entries)
@@ -3737,7 +3774,7 @@ void mfhd_box_del(GF_Box *s)
 {
 	GF_MovieFragmentHeaderBox *ptr = (GF_MovieFragmentHeaderBox *)s;
 	if (ptr == NULL) return;
-	gf_free(ptr);
+	gf_isom_box_arena_del_box(s);
 }
 
 GF_Err mfhd_box_read(GF_Box *s, GF_BitStream *bs)
@@ -3750,7 +3787,7 @@ GF_Err mfhd_box_read(GF_Box *s, GF_BitStream *bs)
 
 GF_Box *mfhd_box_new()
 {
-	ISOM_DECL_BOX_ALLOC(GF_MovieFragmentHeaderBox, GF_ISOM_BOX_TYPE_MFHD);
+	ISOM_DECL_BOX_ALLOC_ARENA(GF_MovieFragmentHeaderBox, GF_ISOM_BOX_TYPE_MFHD);
 	return (GF_Box *)tmp;
 }
 
@@ -3897,7 +3934,7 @@ void moof_box_del(GF_Box *s)
 		gf_list_del(ptr->emsgs);
 	}
 	gf_list_del(ptr->trun_list);
-	gf_free(ptr);
+	gf_isom_box_arena_del_box(s);
 }
 
 GF_Err moof_on_child_box(GF_Box *s, GF_Box *a, Bool is_rem)
@@ -3924,7 +3961,7 @@ GF_Err moof_box_read(GF_Box *s, GF_BitStream *bs)
 
 GF_Box *moof_box_new()
 {
-	ISOM_DECL_BOX_ALLOC(GF_MovieFragmentBox, GF_ISOM_BOX_TYPE_MOOF);
+	ISOM_DECL_BOX_ALLOC_ARENA(GF_MovieFragmentBox, GF_ISOM_BOX_TYPE_MOOF);
 	tmp->TrackList = gf_list_new();
 	return (GF_Box *)tmp;
 }
@@ -5628,6 +5665,7 @@ void stco_box_del(GF_Box *s)
 	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->offsets) gf_free(ptr->offsets);
+	gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -5644,7 +5682,10 @@ GF_Err stco_box_read(GF_Box *s, GF_BitStream *bs)
 		return GF_ISOM_INVALID_FILE;
 	}
 
-	if (ptr->nb_entries) {
+	ptr->lazy = gf_isom_lazy_table_new(bs, ptr->nb_entries, 32);
+	if (ptr->lazy) {
+		gf_bs_skip_bytes(bs, (u64) ptr->nb_entries * 4);
+	} else if (ptr->nb_entries) {
 		ptr->offsets = (u32 *) gf_malloc(ptr->nb_entries * sizeof(u32) );
 		if (ptr->offsets == NULL) return GF_OUT_OF_MEM;
 		ptr->alloc_size = ptr->nb_entries;
@@ -5671,6 +5712,8 @@ GF_Err stco_box_write(GF_Box *s, GF_BitStream *bs)
 	GF_Err e;
 	u32 i;
 	GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)s;
+	e = gf_isom_box_unlazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	gf_bs_write_u32(bs, ptr->nb_entries);
@@ -5759,6 +5802,7 @@ void stsc_box_del(GF_Box *s)
 	GF_SampleToChunkBox *ptr = (GF_SampleToChunkBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) gf_free(ptr->r_index);
 	gf_free(ptr);
 }
 
@@ -6065,6 +6109,7 @@ void stsz_box_del(GF_Box *s)
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 	if (ptr == NULL) return;
 	if (ptr->sizes) gf_free(ptr->sizes);
+	gf_isom_lazy_table_del(ptr->lazy);
 	gf_free(ptr);
 }
 
@@ -6120,6 +6165,18 @@ GF_Err stsz_box_read(GF_Box *s, GF_BitStream *bs)
 				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of entries %d in stsz\n", ptr->sampleCount));
 				return GF_ISOM_INVALID_FILE;
 			}
+			//sizes are loaded on demand, only compute table properties
+			ptr->lazy = gf_isom_lazy_table_new(bs, ptr->sampleCount, 32);
+			if (ptr->lazy) {
+				for (i = 0; i < ptr->sampleCount; i++) {
+					u32 s_size = gf_bs_read_u32(bs);
+					if (ptr->max_size < s_size)
+						ptr->max_size = s_size;
+					ptr->total_size += s_size;
+					ptr->total_samples++;
+				}
+				return GF_OK;
+			}
 			ptr->sizes = (u32 *) gf_malloc(ptr->sampleCount * sizeof(u32));
 			if (! ptr->sizes) return GF_OUT_OF_MEM;
 			ptr->alloc_size = ptr->sampleCount;
@@ -6146,6 +6203,20 @@ GF_Err stsz_box_read(GF_Box *s, GF_BitStream *bs)
 		//note we could optimize the mem usage by keeping the table compact
 		//in memory. But that would complicate both caching and editing
 		//we therefore keep all sizes as u32 and uncompress the table
+		ptr->lazy = gf_isom_lazy_table_new(bs, ptr->sampleCount, ptr->sampleSize);
+		if (ptr->lazy) {
+			for (i = 0; i < ptr->sampleCount; i++) {
+				u32 s_size = gf_bs_read_int(bs, ptr->sampleSize);
+				if (ptr->max_size < s_size)
+					ptr->max_size = s_size;
+				ptr->total_size += s_size;
+				ptr->total_samples++;
+			}
+			//0 padding in odd sample count
+			if ((ptr->sampleSize==4) && (ptr->sampleCount % 2))
+				gf_bs_read_int(bs, 4);
+			return GF_OK;
+		}
 		ptr->sizes = (u32 *) gf_malloc(ptr->sampleCount * sizeof(u32));
 		if (! ptr->sizes) return GF_OUT_OF_MEM;
 		ptr->alloc_size = ptr->sampleCount;
@@ -6202,6 +6273,8 @@ GF_Err stsz_box_write(GF_Box *s, GF_BitStream *bs)
 	u32 i;
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 
+	e = gf_isom_box_unlazy(s);
+	if (e) return e;
 	e = gf_isom_full_box_write(s, bs);
 	if (e) return e;
 	//in both versions this is still valid
@@ -6244,11 +6317,14 @@ GF_Err stsz_box_write(GF_Box *s, GF_BitStream *bs)
 
 GF_Err stsz_box_size(GF_Box *s)
 {
+	GF_Err e;
 	u32 i, fieldSize, size;
 	GF_SampleSizeBox *ptr = (GF_SampleSizeBox *)s;
 
 	ptr->size += 8;
 	if (!ptr->sampleCount) return GF_OK;
+	e = gf_isom_box_unlazy(s);
+	if (e) return e;
 
 	//regular table
 	if (ptr->type == GF_ISOM_BOX_TYPE_STSZ) {
@@ -6316,6 +6392,7 @@ void stts_box_del(GF_Box *s)
 {
 	GF_TimeToSampleBox *ptr = (GF_TimeToSampleBox *)s;
 	if (ptr->entries) gf_free(ptr->entries);
+	if (ptr->r_index) gf_free(ptr->r_index);
 	gf_free(ptr);
 }
 
@@ -6464,7 +6541,7 @@ void tfhd_box_del(GF_Box *s)
 {
 	GF_TrackFragmentHeaderBox *ptr = (GF_TrackFragmentHeaderBox *)s;
 	if (ptr == NULL) return;
-	gf_free(ptr);
+	gf_isom_box_arena_del_box(s);
 }
 
 GF_Err tfhd_box_read(GF_Box *s, GF_BitStream *bs)
@@ -6500,7 +6577,7 @@ GF_Err tfhd_box_read(GF_Box *s, GF_BitStream *bs)
 
 GF_Box *tfhd_box_new()
 {
-	ISOM_DECL_BOX_ALLOC(GF_TrackFragmentHeaderBox, GF_ISOM_BOX_TYPE_TFHD);
+	ISOM_DECL_BOX_ALLOC_ARENA(GF_TrackFragmentHeaderBox, GF_ISOM_BOX_TYPE_TFHD);
 	//NO FLAGS SET BY DEFAULT
 	return (GF_Box *)tmp;
 }
@@ -6735,7 +6812,7 @@ void traf_box_del(GF_Box *s)
 	if (ptr->sampleGroupsDescription) gf_list_del(ptr->sampleGroupsDescription);
 	if (ptr->sai_sizes) gf_list_del(ptr->sai_sizes);
 	if (ptr->sai_offsets) gf_list_del(ptr->sai_offsets);
-	gf_free(ptr);
+	gf_isom_box_arena_del_box(s);
 }
 
 GF_Err traf_on_child_box(GF_Box *s, GF_Box *a, Bool is_rem)
@@ -6819,7 +6896,7 @@ GF_Err traf_box_read(GF_Box *s, GF_BitStream *bs)
 
 GF_Box *traf_box_new()
 {
-	ISOM_DECL_BOX_ALLOC(GF_TrackFragmentBox, GF_ISOM_BOX_TYPE_TRAF);
+	ISOM_DECL_BOX_ALLOC_ARENA(GF_TrackFragmentBox, GF_ISOM_BOX_TYPE_TRAF);
 	tmp->TrackRuns = gf_list_new();
 
 	if (gf_sys_old_arch_compat())
@@ -7027,6 +7104,12 @@ void trak_box_del(GF_Box *s)
 	GF_TrackBox *ptr = (GF_TrackBox *)s;
 	if (ptr->chunk_cache)
 		gf_bs_del(ptr->chunk_cache);
+	if (ptr->sample_hash)
+		gf_isom_sample_hash_track_del(ptr->sample_hash);
+#endif
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	if (((GF_TrackBox *)s)->frag_index)
+		gf_free(((GF_TrackBox *)s)->frag_index);
 #endif
 	gf_free(s);
 }
@@ -7891,7 +7974,7 @@ void trun_box_del(GF_Box *s)
 	GF_TrackFragmentRunBox *ptr = (GF_TrackFragmentRunBox *)s;
 	if (ptr == NULL) return;
 
-	if (ptr->samples) gf_free(ptr->samples);
+	gf_isom_box_arena_free(s, ptr->samples);
 	if (ptr->cache) gf_bs_del(ptr->cache);
 	if (ptr->sample_order) gf_free(ptr->sample_order);
 	if (ptr->sample_refs) {
@@ -7902,7 +7985,7 @@ void trun_box_del(GF_Box *s)
 		}
 		gf_list_del(ptr->sample_refs);
 	}
-	gf_free(ptr);
+	gf_isom_box_arena_del_box(s);
 }
 
 #ifdef GF_ENABLE_CTRN
@@ -8074,7 +8157,7 @@ GF_Err trun_box_read(GF_Box *s, GF_BitStream *bs)
 		ptr->first_sample_flags = gf_bs_read_u32(bs);
 	}
 	if (! (ptr->flags & (GF_ISOM_TRUN_DURATION | GF_ISOM_TRUN_SIZE | GF_ISOM_TRUN_FLAGS | GF_ISOM_TRUN_CTS_OFFSET) ) ) {
-		ptr->samples = gf_malloc(sizeof(GF_TrunEntry));
+		ptr->samples = gf_isom_box_arena_alloc(s, sizeof(GF_TrunEntry));
 		if (!ptr->samples) return GF_OUT_OF_MEM;
 		//memset to 0 !!
 		memset(ptr->samples, 0, sizeof(GF_TrunEntry));
@@ -8096,7 +8179,7 @@ GF_Err trun_box_read(GF_Box *s, GF_BitStream *bs)
 			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid number of samples %u in trun\n", ptr->sample_count));
 			return GF_ISOM_INVALID_FILE;
 		}
-		ptr->samples = gf_malloc(sizeof(GF_TrunEntry) * ptr->sample_count);
+		ptr->samples = gf_isom_box_arena_alloc(s, sizeof(GF_TrunEntry) * ptr->sample_count);
 		if (!ptr->samples) return GF_OUT_OF_MEM;
 		ptr->sample_alloc = ptr->nb_samples = ptr->sample_count;
 		//memset to 0 upfront
@@ -8144,7 +8227,7 @@ GF_Err trun_box_read(GF_Box *s, GF_BitStream *bs)
 
 GF_Box *trun_box_new()
 {
-	ISOM_DECL_BOX_ALLOC(GF_TrackFragmentRunBox, GF_ISOM_BOX_TYPE_TRUN);
+	ISOM_DECL_BOX_ALLOC_ARENA(GF_TrackFragmentRunBox, GF_ISOM_BOX_TYPE_TRUN);
 	//NO FLAGS SET BY DEFAULT
 	return (GF_Box *)tmp;
 }
@@ -10095,13 +10178,13 @@ GF_Err subs_box_read(GF_Box *s, GF_BitStream *bs)
 
 GF_Box *tfdt_box_new()
 {
-	ISOM_DECL_BOX_ALLOC(GF_TFBaseMediaDecodeTimeBox, GF_ISOM_BOX_TYPE_TFDT);
+	ISOM_DECL_BOX_ALLOC_ARENA(GF_TFBaseMediaDecodeTimeBox, GF_ISOM_BOX_TYPE_TFDT);
 	return (GF_Box *)tmp;
 }
 
 void tfdt_box_del(GF_Box *s)
 {
-	gf_free(s);
+	gf_isom_box_arena_del_box(s);
 }
 
 /*this is using chpl format according to some NeroRecode samples*/
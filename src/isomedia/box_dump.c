@@ -1052,6 +1052,7 @@ GF_Err ctts_box_dump(GF_Box *a, FILE * trace)
 
 	if (dump_skip_samples)
 		return GF_OK;
+	gf_isom_box_unlazy(a);
 
 	gf_isom_box_dump_start(a, "CompositionOffsetBox", trace);
 	gf_fprintf(trace, "EntryCount=\"%d\">\n", p->nb_entries);
@@ -1173,6 +1174,7 @@ GF_Err stsz_box_dump(GF_Box *a, FILE * trace)
 	p = (GF_SampleSizeBox *)a;
 	if (dump_skip_samples)
 		return GF_OK;
+	gf_isom_box_unlazy(a);
 
 	if (a->type == GF_ISOM_BOX_TYPE_STSZ) {
 		gf_isom_box_dump_start(a, "SampleSizeBox", trace);
@@ -1214,6 +1216,7 @@ GF_Err stco_box_dump(GF_Box *a, FILE * trace)
 
 	if (dump_skip_samples)
 		return GF_OK;
+	gf_isom_box_unlazy(a);
 
 	p = (GF_ChunkOffsetBox *)a;
 	gf_isom_box_dump_start(a, "ChunkOffsetBox", trace);
@@ -1364,6 +1367,7 @@ GF_Err co64_box_dump(GF_Box *a, FILE * trace)
 
 	if (dump_skip_samples)
 		return GF_OK;
+	gf_isom_box_unlazy(a);
 
 	p = (GF_ChunkLargeOffsetBox *)a;
 	gf_isom_box_dump_start(a, "ChunkLargeOffsetBox", trace);
@@ -24,6 +24,7 @@
  */
 
 #include <gpac/internal/isomedia_dev.h>
+#include <gpac/thread.h>
 
 #ifndef GPAC_DISABLE_ISOM
 
@@ -391,7 +392,7 @@ GF_Err gf_isom_box_parse_ex(GF_Box **outBox, GF_BitStream *bs, u32 parent_type,
 			((GF_SubsegmentIndexBox *)newBox)->compressed_diff = (s32)size - (s32)compressed_size;
 		}
 #endif
-		newBox->internal_flags = GF_ISOM_BOX_COMPRESSED;
+		newBox->internal_flags |= GF_ISOM_BOX_COMPRESSED;
 		bs = orig_bs;
 	}
 
@@ -1087,6 +1088,18 @@ ISOM_BOX_IMPL_DECL(sref)
 #define ITUNES_TAG(_val) \
 	BOX_DEFINE_S( _val, ilst_item, "ilst data", "apple")
 
+#define BOX_REG_MAX_PARENTS	16
+
+enum
+{
+	//box is allowed in any container
+	BOX_REG_PARENT_ANY = 1,
+	//box is allowed in any sample entry
+	BOX_REG_PARENT_SAMPLE_ENTRY = 1<<1,
+	//box is allowed in video sample entries only
+	BOX_REG_PARENT_VIDEO_SAMPLE_ENTRY = 1<<2,
+};
+
 static struct box_registry_entry {
 	u32 box_4cc;
 	GF_Box * (*new_fn)();
@@ -1106,6 +1119,10 @@ static struct box_registry_entry {
 	const char *spec;
 	Bool disabled;
 	GF_Err (*add_rem_fn)(GF_Box *par, GF_Box *b, Bool is_remove);
+	//parsed from parents_4cc when building the registry index
+	u32 parents[BOX_REG_MAX_PARENTS];
+	u8 nb_parents;
+	u8 parent_flags;
 } box_registry [] =
 {
 	//DO NOT MOVE THE FIRST ENTRY
@@ -1884,59 +1901,350 @@ static struct box_registry_entry {
 
 };
 
-Bool gf_box_valid_in_parent(GF_Box *a, const char *parent_4cc)
+#define BOX_REG_COUNT	(sizeof(box_registry) / sizeof(struct box_registry_entry))
+
+//registry indexes sorted by box 4CC, entries with the same 4CC are kept in registry order
+static u16 box_registry_sorted[BOX_REG_COUNT];
+//set once the index is built
+static volatile u32 box_registry_ready = 0;
+//number of threads which attempted to build the index, only the first one builds it
+static volatile u32 box_registry_claims = 0;
+
+static int box_registry_cmp(const void *_a, const void *_b)
+{
+	u32 a = *(const u16 *)_a;
+	u32 b = *(const u16 *)_b;
+	if (box_registry[a].box_4cc < box_registry[b].box_4cc) return -1;
+	if (box_registry[a].box_4cc > box_registry[b].box_4cc) return 1;
+	return (s32) a - (s32) b;
+}
+
+static void box_registry_parse_parents(struct box_registry_entry *reg)
+{
+	const char *par = reg->parents_4cc;
+	reg->nb_parents = 0;
+	reg->parent_flags = 0;
+	while (par && par[0]) {
+		u32 len = 0;
+		while (par[0]==' ') par++;
+		while (par[len] && (par[len]!=' ')) len++;
+		if (!len) break;
+
+		if ((len==1) && (par[0]=='*')) {
+			reg->parent_flags |= BOX_REG_PARENT_ANY;
+		} else if (len<=4) {
+			//4CCs with trailing spaces are declared without them, eg "rtp"
+			char c[4] = {' ', ' ', ' ', ' '};
+			memcpy(c, par, len);
+			if (reg->nb_parents < BOX_REG_MAX_PARENTS) {
+				reg->parents[reg->nb_parents] = GF_4CC(c[0], c[1], c[2], c[3]);
+				reg->nb_parents++;
+			} else {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Too many parents declared for box %s, ignoring %.*s\n", gf_4cc_to_str(reg->box_4cc), len, par));
+			}
+		} else if ((len==18) && !strncmp(par, "video_sample_entry", 18)) {
+			reg->parent_flags |= BOX_REG_PARENT_SAMPLE_ENTRY | BOX_REG_PARENT_VIDEO_SAMPLE_ENTRY;
+		} else if ((len>=12) && !strncmp(par + len - 12, "sample_entry", 12)) {
+			reg->parent_flags |= BOX_REG_PARENT_SAMPLE_ENTRY;
+		} else if (par[4]=='_') {
+			//sample formats also match their sample entry 4CC, eg "text_sample" in 'text'
+			if (reg->nb_parents < BOX_REG_MAX_PARENTS) {
+				reg->parents[reg->nb_parents] = GF_4CC(par[0], par[1], par[2], par[3]);
+				reg->nb_parents++;
+			} else {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Too many parents declared for box %s, ignoring %.*s\n", gf_4cc_to_str(reg->box_4cc), len, par));
+			}
+		}
+		par += len;
+	}
+}
+
+/*the index is built by gf_sys_init before any other thread is started, and otherwise on first use:
+the first caller builds it, concurrent callers wait for it to be published*/
+GF_NOT_EXPORTED
+void gf_isom_registry_init()
+{
+	u32 i;
+	if (box_registry_ready) return;
+
+	if (safe_int_fetch_add(&box_registry_claims, 1) != 0) {
+		//being built by another thread
+		while (!box_registry_ready) gf_sleep(0);
+		return;
+	}
+	for (i=0; i<BOX_REG_COUNT; i++) {
+		box_registry_sorted[i] = i;
+		box_registry_parse_parents(&box_registry[i]);
+	}
+	//first two entries (unknown and uuid) are never looked up by type
+	qsort(&box_registry_sorted[1], BOX_REG_COUNT-1, sizeof(u16), box_registry_cmp);
+	//full barrier, publish the index
+	safe_int_inc(&box_registry_ready);
+}
+
+//returns position in sorted index of the first registry entry for this 4CC, or BOX_REG_COUNT if none
+static u32 box_registry_find(u32 boxCode)
+{
+	u32 lo = 1, hi = BOX_REG_COUNT;
+	if (!box_registry_ready) gf_isom_registry_init();
+
+	while (lo < hi) {
+		u32 mid = (lo + hi) / 2;
+		if (box_registry[box_registry_sorted[mid]].box_4cc < boxCode) lo = mid + 1;
+		else hi = mid;
+	}
+	if ((lo<BOX_REG_COUNT) && (box_registry[box_registry_sorted[lo]].box_4cc == boxCode))
+		return lo;
+	return BOX_REG_COUNT;
+}
+
+static Bool box_registry_has_parent(const struct box_registry_entry *reg, u32 parent_4cc)
 {
-	if (!a || !a->registry || !a->registry->parents_4cc) return GF_FALSE;
-	if (strstr(a->registry->parents_4cc, parent_4cc) != NULL) return GF_TRUE;
+	u32 i;
+	if (!box_registry_ready) gf_isom_registry_init();
+	for (i=0; i<reg->nb_parents; i++) {
+		if (reg->parents[i] == parent_4cc) return GF_TRUE;
+	}
 	return GF_FALSE;
 }
 
+GF_NOT_EXPORTED
+Bool gf_box_valid_in_parent(GF_Box *a, const char *parent_4cc)
+{
+	u32 len;
+	char c[4] = {' ', ' ', ' ', ' '};
+	if (!a || !a->registry || !a->registry->parents_4cc || !parent_4cc) return GF_FALSE;
+	len = (u32) strlen(parent_4cc);
+	if (!len || (len>4)) return GF_FALSE;
+	memcpy(c, parent_4cc, len);
+	return box_registry_has_parent(a->registry, GF_4CC(c[0], c[1], c[2], c[3]));
+}
+
 GF_EXPORT
 u32 gf_isom_get_num_supported_boxes()
 {
-	return sizeof(box_registry) / sizeof(struct box_registry_entry);
+	return BOX_REG_COUNT;
 }
 
 void gf_isom_registry_disable(u32 boxCode, Bool disable)
 {
-	u32 i=0, count = gf_isom_get_num_supported_boxes();
-	for (i=1; i<count; i++) {
-		if (box_registry[i].box_4cc==boxCode) {
-			box_registry[i].disabled = disable;
-			return;
+	u32 i = box_registry_find(boxCode);
+	if (i<BOX_REG_COUNT)
+		box_registry[box_registry_sorted[i]].disabled = disable;
+}
+
+Bool gf_isom_box_is_disabled(GF_Box *a)
+{
+	if (!a || !a->registry) return GF_TRUE;
+	return a->registry->disabled;
+}
+
+/*box arena: boxes are allocated linearly in large blocks, prefixed by a pointer to their arena (8 bytes to keep alignment).
+Entry arrays owned by arena boxes are allocated in the same blocks without prefix and are never freed individually.
+Once the last box of the arena is destroyed, all blocks are recycled.
+An arena belongs to a single ISO file and is never shared: boxes are allocated and destroyed by whichever thread currently
+uses the file, and callers already serialize access to a file. The arena state, including nb_boxes, is therefore not atomic*/
+#define BOX_ARENA_BLOCK_SIZE	65536
+#define BOX_ARENA_HDR_SIZE	8
+
+typedef struct
+{
+	u8 *data;
+	u32 size;
+} GF_ISOBoxArenaBlock;
+
+struct __isom_box_arena
+{
+	GF_ISOBoxArenaBlock *blocks;
+	u32 nb_blocks, nb_alloc_blocks;
+	//block being filled and write position in this block
+	u32 cur_block, cur_pos;
+	//number of boxes allocated in the arena and not yet destroyed - only modified by the thread owning the arena
+	u32 nb_boxes;
+	Bool destroy_pending;
+};
+
+//arena used by box constructors, set by the parser of the calling thread
+#if defined(_MSC_VER)
+static __declspec(thread) GF_ISOBoxArena *current_box_arena = NULL;
+#else
+static __thread GF_ISOBoxArena *current_box_arena = NULL;
+#endif
+
+GF_ISOBoxArena *gf_isom_box_arena_new()
+{
+	GF_ISOBoxArena *arena;
+	GF_SAFEALLOC(arena, GF_ISOBoxArena);
+	return arena;
+}
+
+static void box_arena_free_blocks(GF_ISOBoxArena *arena)
+{
+	u32 i;
+	for (i=0; i<arena->nb_blocks; i++)
+		gf_free(arena->blocks[i].data);
+	if (arena->blocks) gf_free(arena->blocks);
+	arena->blocks = NULL;
+	arena->nb_blocks = arena->nb_alloc_blocks = 0;
+	arena->cur_block = arena->cur_pos = 0;
+}
+
+void gf_isom_box_arena_del(GF_ISOBoxArena *arena)
+{
+	if (!arena) return;
+	if (current_box_arena == arena) current_box_arena = NULL;
+	if (arena->nb_boxes) {
+		arena->destroy_pending = GF_TRUE;
+		return;
+	}
+	box_arena_free_blocks(arena);
+	gf_free(arena);
+}
+
+void gf_isom_box_arena_trim(GF_ISOBoxArena *arena)
+{
+	if (arena && !arena->nb_boxes)
+		box_arena_free_blocks(arena);
+}
+
+GF_ISOBoxArena *gf_isom_box_arena_set_current(GF_ISOBoxArena *arena)
+{
+	GF_ISOBoxArena *prev = current_box_arena;
+	current_box_arena = arena;
+	return prev;
+}
+
+static void *box_arena_get(GF_ISOBoxArena *arena, u32 size)
+{
+	u8 *ptr;
+	GF_ISOBoxArenaBlock *blk;
+	if (size > 0xFFFFFFF0) return NULL;
+	size = (size + 7) & ~7;
+
+	blk = arena->nb_blocks ? &arena->blocks[arena->cur_block] : NULL;
+	if (!blk || (blk->size - arena->cur_pos < size)) {
+		//use next block if large enough, otherwise insert a new block after the current one
+		u32 next = blk ? arena->cur_block+1 : 0;
+		if ((next >= arena->nb_blocks) || (arena->blocks[next].size < size)) {
+			u32 block_size = MAX(size, BOX_ARENA_BLOCK_SIZE);
+			u8 *data = gf_malloc(block_size);
+			if (!data) return NULL;
+			if (arena->nb_blocks == arena->nb_alloc_blocks) {
+				u32 nb_alloc = arena->nb_alloc_blocks ? 2*arena->nb_alloc_blocks : 4;
+				GF_ISOBoxArenaBlock *blocks = gf_realloc(arena->blocks, sizeof(GF_ISOBoxArenaBlock) * nb_alloc);
+				if (!blocks) {
+					gf_free(data);
+					return NULL;
+				}
+				arena->blocks = blocks;
+				arena->nb_alloc_blocks = nb_alloc;
+			}
+			if (next < arena->nb_blocks)
+				memmove(&arena->blocks[next+1], &arena->blocks[next], sizeof(GF_ISOBoxArenaBlock) * (arena->nb_blocks - next));
+			arena->blocks[next].data = data;
+			arena->blocks[next].size = block_size;
+			arena->nb_blocks++;
 		}
+		arena->cur_block = next;
+		arena->cur_pos = 0;
+		blk = &arena->blocks[next];
+	}
+	ptr = blk->data + arena->cur_pos;
+	arena->cur_pos += size;
+	memset(ptr, 0, size);
+	return ptr;
+}
+
+static GF_ISOBoxArena *box_arena_of(GF_Box *s)
+{
+	if (!s || !(s->internal_flags & GF_ISOM_BOX_IN_ARENA)) return NULL;
+	return *(GF_ISOBoxArena **) ( ((u8 *)s) - BOX_ARENA_HDR_SIZE);
+}
+
+void *gf_isom_box_arena_new_box(u32 size)
+{
+	u8 *ptr;
+	GF_Box *box;
+	GF_ISOBoxArena *arena = current_box_arena;
+	if (!arena) {
+		ptr = gf_malloc(size);
+		if (ptr) memset(ptr, 0, size);
+		return ptr;
+	}
+	ptr = box_arena_get(arena, size + BOX_ARENA_HDR_SIZE);
+	if (!ptr) return NULL;
+	*(GF_ISOBoxArena **)ptr = arena;
+	box = (GF_Box *) (ptr + BOX_ARENA_HDR_SIZE);
+	box->internal_flags = GF_ISOM_BOX_IN_ARENA;
+	arena->nb_boxes++;
+	return box;
+}
+
+void gf_isom_box_arena_del_box(GF_Box *s)
+{
+	GF_ISOBoxArena *arena = box_arena_of(s);
+	if (!arena) {
+		if (s) gf_free(s);
+		return;
+	}
+	gf_assert(arena->nb_boxes);
+	arena->nb_boxes--;
+	if (arena->nb_boxes) return;
+
+	if (arena->destroy_pending) {
+		box_arena_free_blocks(arena);
+		gf_free(arena);
+		return;
 	}
+	//all boxes destroyed, recycle blocks
+	arena->cur_block = arena->cur_pos = 0;
+}
+
+void *gf_isom_box_arena_alloc(GF_Box *owner, u32 size)
+{
+	GF_ISOBoxArena *arena = box_arena_of(owner);
+	if (!arena) return gf_malloc(size);
+	return box_arena_get(arena, size);
+}
+
+void gf_isom_box_arena_free(GF_Box *owner, void *ptr)
+{
+	if (ptr && !box_arena_of(owner))
+		gf_free(ptr);
 }
 
 static u32 get_box_reg_idx(u32 boxCode, u32 parent_type, u32 start_from)
 {
-	u32 i=0, count = gf_isom_get_num_supported_boxes();
+	u32 i;
 	if (!start_from) start_from = 1;
 
-	for (i=start_from; i<count; i++) {
+	for (i=box_registry_find(boxCode); i<BOX_REG_COUNT; i++) {
 		u32 start_par_from;
-		char p4cc[GF_4CC_MSIZE];
+		u32 idx = box_registry_sorted[i];
+		const struct box_registry_entry *reg = &box_registry[idx];
 
-		if (box_registry[i].box_4cc != boxCode)
+		if (reg->box_4cc != boxCode)
+			break;
+		if (idx < start_from)
 			continue;
 
 		if ((boxCode== GF_ISOM_BOX_TYPE_MOOV) && (parent_type==GF_QT_BOX_TYPE_CMOV))
-			return i;
+			return idx;
 
 		if (!parent_type)
-			return i;
-		if (strstr(box_registry[i].parents_4cc, gf_4cc_to_str_safe(parent_type, p4cc) ) != NULL)
-			return i;
-		if (strstr(box_registry[i].parents_4cc, "*") != NULL)
-			return i;
+			return idx;
+		if (box_registry_has_parent(reg, parent_type))
+			return idx;
+		if (reg->parent_flags & BOX_REG_PARENT_ANY)
+			return idx;
 
-		if (strstr(box_registry[i].parents_4cc, "sample_entry") == NULL)
+		if (!(reg->parent_flags & BOX_REG_PARENT_SAMPLE_ENTRY))
 			continue;
 
 		/*parent is a sample entry, check if the parent_type matches a sample entry box (eg its parent must be stsd)*/
 
 		if (parent_type==GF_QT_SUBTYPE_RAW)
-			return i;
+			return idx;
 
 		start_par_from = 0;
 		while (parent_type) {
@@ -1944,14 +2252,15 @@ static u32 get_box_reg_idx(u32 boxCode, u32 parent_type, u32 start_from)
 			u32 j = get_box_reg_idx(parent_type, 0, start_par_from);
 			if (!j) break;
 			//if parent registry has "stsd" as parent, this is a sample entry
-			if (box_registry[j].parents_4cc && (strstr(box_registry[j].parents_4cc, "stsd") != NULL))
-				return i;
+			if (box_registry_has_parent(&box_registry[j], GF_ISOM_BOX_TYPE_STSD))
+				return idx;
 			start_par_from = j+1;
 		}
 	}
 	return 0;
 }
 
+GF_NOT_EXPORTED
 GF_Box *gf_isom_box_new_ex(u32 boxType, u32 parentType, Bool skip_logs, Bool is_root_box, Bool is_uuid)
 {
 	GF_Box *a;
@@ -2080,17 +2389,16 @@ GF_Err gf_isom_box_array_read(GF_Box *parent, GF_BitStream *bs)
 		}
 
 		//check container validity
-		if (parent_type && strlen(a->registry->parents_4cc)) {
+		if (parent_type && a->registry->parents_4cc[0]) {
 			Bool parent_OK = GF_FALSE;
 			char parent_code[GF_4CC_MSIZE];
+			u32 parent_4cc = parent->type;
 			if (parent->type == GF_ISOM_BOX_TYPE_UNKNOWN)
-				gf_4cc_to_str_safe(((GF_UnknownBox*)parent)->original_4cc, parent_code);
-			else
-				gf_4cc_to_str_safe(parent->type, parent_code);
+				parent_4cc = ((GF_UnknownBox*)parent)->original_4cc;
 
-			if (strstr(a->registry->parents_4cc, parent_code) != NULL) {
+			if (box_registry_has_parent(a->registry, parent_4cc)) {
 				parent_OK = GF_TRUE;
-			} else if (!strcmp(a->registry->parents_4cc, "*") || strstr(a->registry->parents_4cc, "* ") || strstr(a->registry->parents_4cc, " *")) {
+			} else if (a->registry->parent_flags & BOX_REG_PARENT_ANY) {
 				parent_OK = GF_TRUE;
 			}
 			//these next two are needed because we don't parse CMVD as a smvd box but as a moov box after decompressing the payload
@@ -2100,10 +2408,10 @@ GF_Err gf_isom_box_array_read(GF_Box *parent, GF_BitStream *bs)
 				parent_OK = GF_TRUE;
 			} else {
 				//parent must be a sample entry
-				if (strstr(a->registry->parents_4cc, "sample_entry") !=	NULL) {
+				if (a->registry->parent_flags & BOX_REG_PARENT_SAMPLE_ENTRY) {
 					//parent is in an stsd
-					if (strstr(parent->registry->parents_4cc, "stsd") != NULL) {
-						if (strstr(a->registry->parents_4cc, "video_sample_entry") !=	NULL) {
+					if (box_registry_has_parent(parent->registry, GF_ISOM_BOX_TYPE_STSD)) {
+						if (a->registry->parent_flags & BOX_REG_PARENT_VIDEO_SAMPLE_ENTRY) {
 							if (((GF_SampleEntryBox*)parent)->internal_type==GF_ISOM_SAMPLE_ENTRY_VIDEO) {
 								parent_OK = GF_TRUE;
 							}
@@ -2117,6 +2425,7 @@ GF_Err gf_isom_box_array_read(GF_Box *parent, GF_BitStream *bs)
 				else if (a->type==GF_ISOM_BOX_TYPE_UUID) parent_OK = GF_TRUE;
 			}
 			if (! parent_OK && !skip_logs) {
+				gf_4cc_to_str_safe(parent_4cc, parent_code);
 				GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[iso file] Box \"%s\" is invalid in container %s\n", gf_4cc_to_str(a->type), parent_code));
 			}
 		}
@@ -2458,8 +2767,8 @@ void gf_isom_box_dump_done(const char *name, GF_Box *ptr, FILE *trace)
 Bool gf_isom_box_is_file_level(GF_Box *s)
 {
 	if (!s || !s->registry) return GF_FALSE;
-	if (strstr(s->registry->parents_4cc, "file")!= NULL) return GF_TRUE;
-	if (strstr(s->registry->parents_4cc, "*")!= NULL) return GF_TRUE;
+	if (box_registry_has_parent(s->registry, GF_4CC('f','i','l','e'))) return GF_TRUE;
+	if (s->registry->parent_flags & BOX_REG_PARENT_ANY) return GF_TRUE;
 	return GF_FALSE;
 }
 #endif
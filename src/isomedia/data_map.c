@@ -27,10 +27,6 @@
 #include <gpac/network.h>
 #include <gpac/thread.h>
 
-
-/*File Mapping object, read-only mode on complete files (no download)*/
-//#define GF_ISOM_DATA_FILE_MAPPING 0x02
-
 #ifndef GPAC_DISABLE_ISOM
 
 GF_BitStream *gf_bs_from_fd(int fd, u32 mode);
@@ -48,11 +44,9 @@ void gf_isom_datamap_del(GF_DataMap *ptr)
 	case GF_ISOM_DATA_MEM:
 		gf_isom_fdm_del((GF_FileDataMap *)ptr);
 		break;
-#if 0
 	case GF_ISOM_DATA_FILE_MAPPING:
 		gf_isom_fmo_del((GF_FileMappingDataMap *)ptr);
 		break;
-#endif
 	default:
 		if (ptr->bs) gf_bs_del(ptr->bs);
 		gf_free(ptr);
@@ -167,7 +161,16 @@ GF_Err gf_isom_datamap_new(const char *location, const char *parentPath, u8 mode
 		return GF_URL_ERROR;
 	}
 
-	if (mode == GF_ISOM_DATA_MAP_READ_ONLY) {
+	if (mode == GF_ISOM_DATA_MAP_READ_MAPPED) {
+		mode = GF_ISOM_DATA_MAP_READ;
+		*outDataMap = gf_isom_fmo_new(sPath, mode);
+		if (! (*outDataMap))
+			*outDataMap = gf_isom_fdm_new(sPath, mode);
+		if (*outDataMap) {
+			(*outDataMap)->szName = sPath;
+			sPath = NULL;
+		}
+	} else if (mode == GF_ISOM_DATA_MAP_READ_ONLY) {
 		mode = GF_ISOM_DATA_MAP_READ;
 
 #if 0 //file mapping is disabled
@@ -289,10 +292,8 @@ u32 gf_isom_datamap_get_data(GF_DataMap *map, u8 *buffer, u32 bufferLength, u64
 	case GF_ISOM_DATA_MEM:
 		return gf_isom_fdm_get_data((GF_FileDataMap *)map, buffer, bufferLength, Offset, is_corrupted);
 
-#if 0
 	case GF_ISOM_DATA_FILE_MAPPING:
 		return gf_isom_fmo_get_data((GF_FileMappingDataMap *)map, buffer, bufferLength, Offset, is_corrupted);
-#endif
 
 	default:
 		return 0;
@@ -621,11 +622,9 @@ Bool gf_isom_datamap_top_level_box_avail(GF_DataMap *map)
 	case GF_ISOM_DATA_MEM:
 		return gf_isom_fdm_check_top_level((GF_FileDataMap *)map);
 
-#if 0
 	case GF_ISOM_DATA_FILE_MAPPING:
 		if (gf_bs_available( ((GF_FileMappingDataMap*)map)->bs)) return GF_TRUE;
 		return GF_FALSE;
-#endif
 
 	default:
 		return 0;
@@ -676,85 +675,34 @@ GF_Err FDM_AddData(GF_FileDataMap *ptr, char *data, u32 dataSize)
 #endif	/*GPAC_DISABLE_ISOM_WRITE*/
 
 
-#if 0 //file mapping disabled
-
-#ifdef WIN32
-
-#include <windows.h>
-#include <winerror.h>
-
 GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
 {
 	GF_FileMappingDataMap *tmp;
-	HANDLE fileH, fileMapH;
-#ifdef _WIN32_WCE
-	unsigned short sWPath[MAX_PATH];
-#endif
+	GF_FileMap *fmap;
 
 	//only in read only
 	if (mode != GF_ISOM_DATA_MAP_READ) return NULL;
+	if (!strncmp(sPath, "gmem://", 7) || !strncmp(sPath, "gfio://", 7)) return NULL;
 
-	GF_SAFEALLOC(tmp, GF_FileMappingDataMap);
-	if (!tmp) return NULL;
-
-	tmp->type = GF_ISOM_DATA_FILE_MAPPING;
-	tmp->mode = mode;
-	tmp->name = gf_strdup(sPath);
-
-	//
-	//	Open the file
-	//
-#ifdef _WIN32_WCE
-	//convert to WIDE
-	CE_CharToWide((char *)sPath, sWPath);
-
-	fileH = CreateFileForMapping(sWPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
-	                             (FILE_ATTRIBUTE_READONLY | FILE_FLAG_RANDOM_ACCESS), NULL );
-#else
-	fileH = CreateFile(sPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
-	                   (FILE_ATTRIBUTE_READONLY | FILE_FLAG_RANDOM_ACCESS), NULL );
-#endif
-
-
-	if (fileH == INVALID_HANDLE_VALUE) {
-		gf_free(tmp->name);
-		gf_free(tmp);
-		return NULL;
-	}
-
-	tmp->file_size = GetFileSize(fileH, NULL);
-	if (tmp->file_size == 0xFFFFFFFF) {
-		CloseHandle(fileH);
-		gf_free(tmp->name);
-		gf_free(tmp);
-		return NULL;
-	}
+	fmap = gf_file_map_new(sPath);
+	if (!fmap) return NULL;
 
-	//
-	//	Create the mapping
-	//
-	fileMapH = CreateFileMapping(fileH, NULL, PAGE_READONLY, 0, 0, NULL);
-	if (fileMapH == NULL) {
-		CloseHandle(fileH);
-		gf_free(tmp->name);
-		gf_free(tmp);
-		return NULL;
-	}
-
-	tmp->byte_map = MapViewOfFile(fileMapH, FILE_MAP_READ, 0, 0, 0);
-	if (tmp->byte_map == NULL) {
-		CloseHandle(fileMapH);
-		CloseHandle(fileH);
-		gf_free(tmp->name);
-		gf_free(tmp);
+	GF_SAFEALLOC(tmp, GF_FileMappingDataMap);
+	if (!tmp) {
+		gf_file_map_unref(fmap);
 		return NULL;
 	}
-
-	CloseHandle(fileH);
-	CloseHandle(fileMapH);
+	tmp->type = GF_ISOM_DATA_FILE_MAPPING;
+	tmp->mode = mode;
+	tmp->fmap = fmap;
+	tmp->byte_map = gf_file_map_get_data(fmap, &tmp->file_size);
 
 	//finaly open our bitstream (from buffer)
 	tmp->bs = gf_bs_new(tmp->byte_map, tmp->file_size, GF_BITSTREAM_READ);
+	if (!tmp->bs) {
+		gf_isom_fmo_del(tmp);
+		return NULL;
+	}
 	return (GF_DataMap *)tmp;
 }
 
@@ -763,40 +711,22 @@ void gf_isom_fmo_del(GF_FileMappingDataMap *ptr)
 	if (!ptr || (ptr->type != GF_ISOM_DATA_FILE_MAPPING)) return;
 
 	if (ptr->bs) gf_bs_del(ptr->bs);
-	if (ptr->byte_map) UnmapViewOfFile(ptr->byte_map);
-	gf_free(ptr->name);
+	//mapping may still be used by samples handed out through gf_isom_get_sample_mapped
+	gf_file_map_unref(ptr->fmap);
 	gf_free(ptr);
 }
 
-
 u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *is_corrupted)
 {
+	if (is_corrupted)
+		*is_corrupted = GF_BLOB_RANGE_VALID;
 	//can we seek till that point ???
-	if (fileOffset > ptr->file_size) return 0;
+	if (fileOffset + bufferLength > ptr->file_size) return 0;
 
 	//we do only read operations, so trivial
 	memcpy(buffer, ptr->byte_map + fileOffset, bufferLength);
+	ptr->curPos = fileOffset + bufferLength;
 	return bufferLength;
 }
 
-#else
-
-GF_DataMap *gf_isom_fmo_new(const char *sPath, u8 mode)
-{
-	return gf_isom_fdm_new(sPath, mode);
-}
-
-void gf_isom_fmo_del(GF_FileMappingDataMap *ptr)
-{
-	gf_isom_fdm_del((GF_FileDataMap *)ptr);
-}
-
-u32 gf_isom_fmo_get_data(GF_FileMappingDataMap *ptr, u8 *buffer, u32 bufferLength, u64 fileOffset, GF_BlobRangeStatus *is_corrupted)
-{
-	return gf_isom_fdm_get_data((GF_FileDataMap *)ptr, buffer, bufferLength, fileOffset, is_corrupted);
-}
-
-#endif //win32
-#endif //file mapping disabled
-
 #endif /*GPAC_DISABLE_ISOM*/
@@ -385,12 +385,21 @@ static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType,
 	u64 top_start, mdat_end=0;
 	GF_Err e = GF_OK;
 	u32 btype;
-
 #ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+	GF_ISOBoxArena *prev_arena = NULL;
+
 	if (mov->single_moof_mode && mov->single_moof_state == 2) {
 		return e;
 	}
 
+	//fragment boxes are allocated in a per-file arena when reading, recycled once each fragment is merged
+	if (!mov->box_arena && (mov->openMode == GF_ISOM_OPEN_READ)
+		&& !(mov->FragmentsFlags & GF_ISOM_FRAG_READ_DEBUG)
+		&& gf_opts_get_bool("core", "isom-arena")
+	) {
+		mov->box_arena = gf_isom_box_arena_new();
+	}
+
 	/*restart from where we stopped last*/
 	top_start = mov->current_top_box_start;
 	if (mov->bytes_removed) {
@@ -404,6 +413,17 @@ static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType,
 	}
 #endif
 
+	//large sample tables are decoded on demand from the file when reading, never for in-memory or dumped files
+	if (!mov->moov && (mov->openMode == GF_ISOM_OPEN_READ)
+		&& ((mov->movieFileMap->type == GF_ISOM_DATA_FILE) || (mov->movieFileMap->type == GF_ISOM_DATA_FILE_MAPPING))
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+		&& !(mov->FragmentsFlags & GF_ISOM_FRAG_READ_DEBUG)
+#endif
+		&& gf_opts_get_int("core", "isom-lazy")
+	) {
+		gf_bs_set_cookie(mov->movieFileMap->bs, gf_bs_get_cookie(mov->movieFileMap->bs) | GF_ISOM_BS_COOKIE_LAZY_STBL);
+	}
+
 
 	/*while we have some data, parse our boxes*/
 	while (gf_isom_datamap_top_level_box_avail(mov->movieFileMap)) {
@@ -413,7 +433,17 @@ static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType,
 		GF_LOG(GF_LOG_DEBUG, GF_LOG_CONTAINER, ("[iso file] Parsing a top-level box at position %d\n", mov->current_top_box_start));
 #endif
 
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+		if (mov->box_arena)
+			prev_arena = gf_isom_box_arena_set_current(mov->box_arena);
+#endif
+
 		e = gf_isom_parse_root_box(&a, mov->movieFileMap->bs, &btype, bytesMissing, progressive_mode);
+
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+		if (mov->box_arena)
+			gf_isom_box_arena_set_current(prev_arena);
+#endif
 		if (boxType) *boxType = btype;
 
 		if (e >= 0) {
@@ -483,6 +513,21 @@ static GF_Err gf_isom_parse_movie_boxes_internal(GF_ISOFile *mov, u32 *boxType,
 			e = gf_list_add(mov->TopBoxes, a);
 			if (e) return e;
 
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+			//sample tables of fragmented files are modified when appending fragments
+			if (mov->moov->mvex) {
+				e = gf_isom_unlazy_tables(mov);
+				if (e) return e;
+			} else
+#endif
+			if (mov->openMode == GF_ISOM_OPEN_READ) {
+				u32 interval = gf_opts_get_int("core", "isom-index");
+				if (interval) {
+					e = gf_isom_set_sample_index(mov, interval);
+					if (e) return e;
+				}
+			}
+
 			if (!mov->moov->mvhd) {
 				if (mov->moov->has_cmvd!=2) {
 					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Missing MovieHeaderBox\n"));
@@ -1179,6 +1224,8 @@ void gf_isom_delete_movie(GF_ISOFile *mov)
 		gf_free(mov->sidx_pts_store);
 	if (mov->sidx_pts_next_store)
 		gf_free(mov->sidx_pts_next_store);
+	if (mov->moof_buffer)
+		gf_free(mov->moof_buffer);
 
 	if (mov->main_sidx)
 		gf_isom_box_del((GF_Box*)mov->main_sidx);
@@ -1188,11 +1235,16 @@ void gf_isom_delete_movie(GF_ISOFile *mov)
 
 	if (mov->emsgs)
 		gf_isom_box_array_del(mov->emsgs);
+	//destroyed last, possibly delayed until the last box allocated in the arena is destroyed
+	gf_isom_box_arena_del(mov->box_arena);
 #endif
 	if (mov->last_producer_ref_time)
 		gf_isom_box_del((GF_Box *) mov->last_producer_ref_time);
 	if (mov->fileName) gf_free(mov->fileName);
 	if (mov->override_dref_url) gf_free(mov->override_dref_url);
+#ifndef GPAC_DISABLE_ISOM_WRITE
+	if (mov->sample_hash_index) gf_free(mov->sample_hash_index);
+#endif
 	gf_free(mov);
 }
 
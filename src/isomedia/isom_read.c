@@ -26,6 +26,7 @@
 
 #include <gpac/internal/isomedia_dev.h>
 #include <gpac/constants.h>
+#include <gpac/filters.h>
 
 #ifndef GPAC_DISABLE_ISOM
 
@@ -431,8 +432,7 @@ static GF_Err isom_create_init_from_mem(const char *fileName, GF_ISOFile *file)
 					File Opening in streaming mode
 			the file map is regular (through FILE handles)
 **************************************************************/
-GF_EXPORT
-GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType)
+static GF_Err isom_open_progressive(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType, u8 map_mode)
 {
 	GF_Err e;
 	GF_ISOFile *movie;
@@ -463,7 +463,7 @@ GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 en
 #endif
 	} else {
 		//do NOT use FileMapping on incomplete files
-		e = gf_isom_datamap_new(fileName, NULL, GF_ISOM_DATA_MAP_READ, &movie->movieFileMap);
+		e = gf_isom_datamap_new(fileName, NULL, map_mode, &movie->movieFileMap);
 		if (e) {
 			gf_isom_delete_movie(movie);
 			return e;
@@ -499,6 +499,18 @@ GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 en
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_isom_open_progressive_ex(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType)
+{
+	return isom_open_progressive(fileName, start_range, end_range, enable_frag_bounds, the_file, BytesMissing, outBoxType, GF_ISOM_DATA_MAP_READ);
+}
+
+GF_EXPORT
+GF_Err gf_isom_open_mapped(const char *fileName, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing, u32 *outBoxType)
+{
+	return isom_open_progressive(fileName, 0, 0, enable_frag_bounds, the_file, BytesMissing, outBoxType, GF_ISOM_DATA_MAP_READ_MAPPED);
+}
+
 GF_EXPORT
 GF_Err gf_isom_open_progressive(const char *fileName, u64 start_range, u64 end_range, Bool enable_frag_bounds, GF_ISOFile **the_file, u64 *BytesMissing)
 {
@@ -625,12 +637,37 @@ static GF_Err gf_isom_write(GF_ISOFile *movie)
 	return e;
 }
 
+#ifndef GPAC_DISABLE_ISOM_WRITE
+static GF_Err isom_write_sample_hash_index(GF_ISOFile *movie)
+{
+	u32 i;
+	GF_Err e;
+	GF_TrackBox *trak;
+	GF_List *tracks = gf_list_new();
+	if (!tracks) return GF_OUT_OF_MEM;
+	i=0;
+	while (movie->moov && (trak = (GF_TrackBox*)gf_list_enum(movie->moov->trackList, &i))) {
+		if (trak->sample_hash && !trak->sample_hash->disabled) gf_list_add(tracks, trak->sample_hash);
+	}
+	e = gf_isom_sample_hash_index_save(movie->sample_hash_index, tracks);
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to write sample hash index %s: %s\n", movie->sample_hash_index, gf_error_to_string(e) ));
+	}
+	gf_list_del(tracks);
+	return e;
+}
+#endif
+
 GF_EXPORT
 GF_Err gf_isom_close(GF_ISOFile *movie)
 {
 	GF_Err e=GF_OK;
 	if (movie == NULL) return GF_ISOM_INVALID_FILE;
 	e = gf_isom_write(movie);
+#ifndef GPAC_DISABLE_ISOM_WRITE
+	if (!e && movie->sample_hash_index)
+		e = isom_write_sample_hash_index(movie);
+#endif
 	//free and return;
 	gf_isom_delete_movie(movie);
 	return e;
@@ -1877,7 +1914,10 @@ u32 gf_isom_has_time_offset(GF_ISOFile *the_file, u32 trackNumber)
 	//return true at the first offset found
 	ctts = trak->Media->information->sampleTable->CompositionOffset;
 	for (i=0; i<ctts->nb_entries; i++) {
-		if (ctts->entries[i].decodingOffset && ctts->entries[i].sampleCount) return ctts->version ? 2 : 1;
+		u32 count;
+		s32 offset;
+		if (stbl_GetCompositionEntry(ctts, i, &count, &offset)) return 0;
+		if (offset && count) return ctts->version ? 2 : 1;
 	}
 	return 0;
 }
@@ -2138,6 +2178,80 @@ GF_ISOSample *gf_isom_get_sample_info(GF_ISOFile *the_file, u32 trackNumber, u32
 	return gf_isom_get_sample_info_ex(the_file, trackNumber, sampleNumber, sampleDescriptionIndex, data_offset, NULL);
 }
 
+//check if samples of a NALU-based entry are modified when fetched
+static Bool isom_nalu_sample_needs_rewrite(GF_TrackBox *trak, GF_MPEGVisualSampleEntryBox *entry)
+{
+	GF_TrackReferenceTypeBox *ref = NULL;
+	if (trak->extractor_mode & (GF_ISOM_NALU_EXTRACT_INBAND_PS_FLAG|GF_ISOM_NALU_EXTRACT_ANNEXB_FLAG))
+		return GF_TRUE;
+	if (entry->svc_config || entry->mvc_config || entry->lhvc_config)
+		return GF_TRUE;
+	Track_FindRef(trak, GF_ISOM_REF_SCAL, &ref);
+	if (ref) return GF_TRUE;
+	Track_FindRef(trak, GF_ISOM_REF_SABT, &ref);
+	if (ref) return GF_TRUE;
+	return GF_FALSE;
+}
+
+GF_EXPORT
+GF_ISOSample *gf_isom_get_sample_mapped(GF_ISOFile *the_file, u32 trackNumber, u32 sampleNumber, u32 *sampleDescriptionIndex, GF_ISOSample *static_sample, u64 *data_offset, const u8 **data, GF_FileMap **file_map)
+{
+	GF_TrackBox *trak;
+	GF_ISOSample *samp;
+	GF_SampleEntryBox *entry = NULL;
+	GF_FileMappingDataMap *fmo;
+	u32 sdesc_idx = 0, dref_idx;
+	u64 offset = 0;
+
+	if (!data || !file_map || !static_sample) return NULL;
+	*data = NULL;
+	*file_map = NULL;
+	if (!the_file || !the_file->movieFileMap || (the_file->movieFileMap->type != GF_ISOM_DATA_FILE_MAPPING))
+		return NULL;
+	if (the_file->read_byte_offset || the_file->bytes_removed)
+		return NULL;
+	fmo = (GF_FileMappingDataMap *) the_file->movieFileMap;
+
+	trak = gf_isom_get_track_box(the_file, trackNumber);
+	if (!trak || !trak->Media || !trak->Media->handler || trak->padding_bytes) return NULL;
+	//OD and text samples may be rewritten
+	if (trak->Media->handler->handlerType == GF_ISOM_MEDIA_OD) return NULL;
+	if (the_file->convert_streaming_text) return NULL;
+
+	samp = gf_isom_get_sample_info_ex(the_file, trackNumber, sampleNumber, &sdesc_idx, &offset, static_sample);
+	if (!samp || !samp->dataLength) return NULL;
+	if (offset + samp->dataLength > fmo->file_size) return NULL;
+	if (!gf_isom_is_self_contained(the_file, trackNumber, sdesc_idx)) return NULL;
+	if (Media_GetSampleDesc(trak->Media, sdesc_idx, &entry, &dref_idx) || !entry) return NULL;
+
+	if (gf_isom_is_nalu_based_entry(trak->Media, entry) && !gf_isom_is_encrypted_entry(entry->type)) {
+		if (isom_nalu_sample_needs_rewrite(trak, (GF_MPEGVisualSampleEntryBox *)entry))
+			return NULL;
+
+		if (!gf_sys_old_arch_compat()) {
+			GF_ISOSAPType gf_isom_nalu_get_sample_sap(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample *sample, GF_MPEGVisualSampleEntryBox *entry);
+			GF_ISOSAPType sap;
+			u8 *sample_data = samp->data;
+			u32 media_sample_num = sampleNumber;
+#ifndef	GPAC_DISABLE_ISOM_FRAGMENTS
+			media_sample_num -= trak->sample_count_at_seg_start;
+#endif
+			//SAP inspection only reads the payload
+			samp->data = (u8 *) fmo->byte_map + offset;
+			sap = gf_isom_nalu_get_sample_sap(trak->Media, media_sample_num, samp, (GF_MPEGVisualSampleEntryBox *)entry);
+			samp->data = sample_data;
+			if (sap && !samp->IsRAP) samp->IsRAP = sap;
+			else if (samp->IsRAP < sap) samp->IsRAP = sap;
+		}
+	}
+
+	if (sampleDescriptionIndex) *sampleDescriptionIndex = sdesc_idx;
+	if (data_offset) *data_offset = offset;
+	*data = fmo->byte_map + offset;
+	*file_map = fmo->fmap;
+	return samp;
+}
+
 
 //get sample dts
 GF_EXPORT
@@ -3106,6 +3220,8 @@ GF_Err gf_isom_refresh_fragmented(GF_ISOFile *movie, u64 *MissingBytes, const ch
 		GF_DataMap *previous_movie_fileMap_address = movie->movieFileMap;
 		GF_Err e;
 
+		e = gf_isom_unlazy_tables(movie);
+		if (e) return e;
 		e = gf_isom_datamap_new(new_location, NULL, GF_ISOM_DATA_MAP_READ_ONLY, &movie->movieFileMap);
 		if (e) {
 			movie->movieFileMap = previous_movie_fileMap_address;
@@ -3305,6 +3421,7 @@ static void gf_isom_recreate_tables(GF_TrackBox *trak)
 	GF_Box *a;
 	GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
 
+	stbl_unlazy(stbl);
 	if (stbl->ChunkOffset) {
 		if (stbl->ChunkOffset->type==GF_ISOM_BOX_TYPE_CO64) {
 			GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
@@ -3554,6 +3671,8 @@ GF_Err gf_isom_release_segment(GF_ISOFile *movie, Bool reset_tables)
 
 	gf_isom_datamap_del(movie->movieFileMap);
 	movie->movieFileMap = NULL;
+	//release fragment box memory of the segment
+	gf_isom_box_arena_trim(movie->box_arena);
 
 #endif
 	return GF_OK;
@@ -3590,6 +3709,7 @@ GF_Err gf_isom_open_segment(GF_ISOFile *movie, const char *fileName, u64 start_r
 
 		e = gf_isom_datamap_new(fileName, NULL, GF_ISOM_DATA_MAP_READ_ONLY, &movie->movieFileMap);
 		if (e) return e;
+		movie->segment_idx++;
 	}
 	movie->moov->compressed_diff = 0;
 	movie->current_top_box_start = 0;
@@ -4152,9 +4272,11 @@ u64 gf_isom_get_media_data_size(GF_ISOFile *movie, u32 trackNumber)
 	}
 	if (stsz->sampleSize) return stsz->sampleSize*stsz->sampleCount;
 	size = 0;
-	if (stsz->sizes) {
+	if (stsz->sizes || stsz->lazy) {
 		for (i=0; i<stsz->sampleCount; i++) {
-			size += stsz->sizes[i];
+			u32 s_size = 0;
+			stbl_GetSampleSize(stsz, i+1, &s_size);
+			size += s_size;
 		}
 	}
 #ifndef GPAC_DISABLE_ISOM_FRAGMENTS
@@ -5923,6 +6045,35 @@ GF_Err gf_isom_set_byte_offset(GF_ISOFile *file, s64 byte_offset)
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_read_cache(GF_ISOFile *file, gf_isom_read_cache_cbk cache_cbk, void *udta)
+{
+	if (!file) return GF_BAD_PARAM;
+	file->read_cache_cbk = cache_cbk;
+	file->read_cache_udta = udta;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_set_sample_index(GF_ISOFile *file, u32 interval)
+{
+	u32 i=0;
+	GF_TrackBox *trak;
+	if (!file || !file->moov) return GF_BAD_PARAM;
+	//tables are modified when editing or appending fragments
+	if (file->openMode != GF_ISOM_OPEN_READ) return GF_NOT_SUPPORTED;
+#ifndef GPAC_DISABLE_ISOM_FRAGMENTS
+	if (file->moov->mvex) return GF_NOT_SUPPORTED;
+#endif
+	while ((trak = gf_list_enum(file->moov->trackList, &i))) {
+		GF_Err e;
+		if (!trak->Media || !trak->Media->information) continue;
+		e = stbl_build_index(trak->Media->information->sampleTable, interval);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
 GF_EXPORT
 u32 gf_isom_get_nalu_length_field(GF_ISOFile *file, u32 track, u32 StreamDescriptionIndex)
 {
@@ -6097,6 +6248,91 @@ Bool gf_isom_get_root_sidx_offsets(GF_ISOFile *movie, u64 *start, u64 *end)
 	return GF_TRUE;
 }
 
+GF_EXPORT
+u32 gf_isom_get_fragment_index_count(GF_ISOFile *movie, u32 trackNumber)
+{
+	GF_TrackBox *trak = gf_isom_get_track_box(movie, trackNumber);
+	if (!trak) return 0;
+	return trak->frag_index_count;
+}
+
+GF_EXPORT
+GF_Err gf_isom_get_fragment_index_entry(GF_ISOFile *movie, u32 trackNumber, u32 index, GF_ISOFragmentIndexEntry *entry)
+{
+	GF_TrackBox *trak = gf_isom_get_track_box(movie, trackNumber);
+	if (!trak || !entry || !index) return GF_BAD_PARAM;
+	if (index > trak->frag_index_count) return GF_BAD_PARAM;
+	*entry = trak->frag_index[index-1];
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_find_fragment_index(GF_ISOFile *movie, u32 trackNumber, u64 dts, Bool sync_start, u32 *index)
+{
+	u32 lo, hi;
+	GF_ISOFragmentIndexEntry *last;
+	GF_TrackBox *trak = gf_isom_get_track_box(movie, trackNumber);
+	if (!trak || !index) return GF_BAD_PARAM;
+	*index = 0;
+	if (!trak->frag_index_count) return GF_NOT_FOUND;
+
+	last = &trak->frag_index[trak->frag_index_count-1];
+	if ((dts < trak->frag_index[0].tfdt) || (dts >= last->tfdt + last->duration))
+		return GF_NOT_FOUND;
+
+	//last entry with tfdt <= dts
+	lo = 0;
+	hi = trak->frag_index_count;
+	while (hi - lo > 1) {
+		u32 mid = (lo + hi) / 2;
+		if (trak->frag_index[mid].tfdt <= dts) lo = mid;
+		else hi = mid;
+	}
+	//gap in the index (fragments not seen)
+	if (dts >= trak->frag_index[lo].tfdt + trak->frag_index[lo].duration)
+		return GF_NOT_FOUND;
+
+	if (sync_start) {
+		while (lo && !trak->frag_index[lo].first_is_sync)
+			lo--;
+	}
+	*index = lo+1;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_get_fragment_offset_for_time(GF_ISOFile *movie, Double start_time, u64 *offset)
+{
+	u32 i, count;
+	Bool found = GF_FALSE;
+	u64 min_offset = 0;
+	if (!movie || !movie->moov || !offset) return GF_BAD_PARAM;
+
+	count = gf_list_count(movie->moov->trackList);
+	for (i=0; i<count; i++) {
+		u32 idx;
+		u64 dts;
+		GF_ISOFragmentIndexEntry *fent;
+		GF_Err e;
+		GF_TrackBox *trak = gf_list_get(movie->moov->trackList, i);
+		if (!trak->frag_index_count || !trak->Media || !trak->Media->mediaHeader->timeScale) continue;
+
+		dts = (u64) (start_time * trak->Media->mediaHeader->timeScale);
+		e = gf_isom_find_fragment_index(movie, i+1, dts, GF_TRUE, &idx);
+		if (e) return e;
+		fent = &trak->frag_index[idx-1];
+		//fragment from another segment, offsets are meaningless here
+		if (fent->segment_idx != movie->segment_idx) return GF_NOT_FOUND;
+
+		if (!found || (fent->moof_start < min_offset))
+			min_offset = fent->moof_start;
+		found = GF_TRUE;
+	}
+	if (!found) return GF_NOT_SUPPORTED;
+	*offset = min_offset;
+	return GF_OK;
+}
+
 #endif
 
 
@@ -6402,10 +6638,7 @@ GF_Err gf_isom_get_chunk_info(GF_ISOFile *movie, u32 trackNumber, u32 chunk_num,
 	if (first_sample_num) *first_sample_num = nb_samples;
 	if (sample_desc_idx) *sample_desc_idx = sample_desc_index;
 	if (chunk_offset) {
-		if (stco)
-			*chunk_offset = stco->offsets[chunk_num-1];
-		else
-			*chunk_offset = co64->offsets[chunk_num-1];
+		return stbl_GetChunkOffset(stco ? (GF_Box *)stco : (GF_Box *)co64, chunk_num, chunk_offset);
 	}
 	return GF_OK;
 }
@@ -6726,8 +6959,12 @@ s32 gf_isom_get_min_negative_cts_offset(GF_ISOFile *the_file, u32 trackNumber, G
 GF_EXPORT
 GF_Err gf_isom_switch_source(GF_ISOFile *the_file, const char *new_file)
 {
+	GF_Err e;
 	if (!the_file) return GF_BAD_PARAM;
 	if (the_file->openMode>GF_ISOM_OPEN_READ) return GF_BAD_PARAM;
+	//lazy sample tables are read from the current source
+	e = gf_isom_unlazy_tables(the_file);
+	if (e) return e;
 	gf_isom_datamap_del(the_file->movieFileMap);
 
 	return gf_isom_datamap_new(new_file, NULL, GF_ISOM_DATA_MAP_READ_ONLY, &the_file->movieFileMap);
@@ -6766,4 +7003,553 @@ GF_Err gf_isom_override_dref_url(GF_ISOFile *the_file, const char *dref_url)
 	if (dref_url && !the_file->override_dref_url) return GF_OUT_OF_MEM;
 	return GF_OK;
 }
+
+#define SAMPLE_HASH_INDEX_MAGIC	GF_4CC('G','S','H','I')
+#define SAMPLE_HASH_INDEX_CRC32	1
+//size of sequential reads when computing checksums
+#define SAMPLE_HASH_READ_SIZE	(4*1024*1024)
+
+void gf_isom_sample_hash_track_del(GF_ISOSampleHashTrack *sht)
+{
+	if (!sht) return;
+	if (sht->entries) gf_free(sht->entries);
+	gf_free(sht);
+}
+
+static GF_ISOSampleHashEntry *sample_hash_new_entry(GF_ISOSampleHashTrack *sht)
+{
+	if (sht->nb_entries == sht->nb_alloc) {
+		u32 nb_alloc = sht->nb_alloc ? 2*sht->nb_alloc : 64;
+		GF_ISOSampleHashEntry *entries = gf_realloc(sht->entries, sizeof(GF_ISOSampleHashEntry) * nb_alloc);
+		if (!entries) return NULL;
+		sht->entries = entries;
+		sht->nb_alloc = nb_alloc;
+	}
+	memset(&sht->entries[sht->nb_entries], 0, sizeof(GF_ISOSampleHashEntry));
+	sht->nb_entries++;
+	return &sht->entries[sht->nb_entries-1];
+}
+
+#ifndef GPAC_DISABLE_ISOM_WRITE
+GF_Err gf_isom_sample_hash_track_new(GF_TrackBox *trak)
+{
+	GF_ISOSampleHashTrack *sht;
+	if (trak->sample_hash) return GF_OK;
+	GF_SAFEALLOC(sht, GF_ISOSampleHashTrack);
+	if (!sht) return GF_OUT_OF_MEM;
+	trak->sample_hash = sht;
+	sht->track_id = trak->Header->trackID;
+	//samples already present when enabling the index are not hashed
+	if (trak->Media && trak->Media->information->sampleTable->SampleSize)
+		sht->nb_samples = trak->Media->information->sampleTable->SampleSize->sampleCount;
+	return GF_OK;
+}
+
+void gf_isom_sample_hash_add(GF_ISOFile *movie, GF_TrackBox *trak, const u8 *data, u32 size, u32 nb_new_samples)
+{
+	GF_ISOSampleHashEntry *ent;
+	GF_ISOSampleHashTrack *sht;
+	if (!movie->sample_hash_index) return;
+
+	//tracks created after enabling the index have no samples yet
+	sht = trak->sample_hash;
+	if (!sht) {
+		GF_SAFEALLOC(sht, GF_ISOSampleHashTrack);
+		if (!sht) return;
+		trak->sample_hash = sht;
+		sht->track_id = trak->Header->trackID;
+	}
+	if (sht->disabled) return;
+	ent = sht->nb_entries ? &sht->entries[sht->nb_entries-1] : NULL;
+	if (nb_new_samples) {
+		//start a new entry every MByte
+		if (!ent || (sht->entry_size >= 1024*1024)) {
+			ent = sample_hash_new_entry(sht);
+			if (!ent) return;
+			ent->first_sample = sht->nb_samples + 1;
+			ent->crc = 0xFFFFFFFF;
+			sht->entry_size = 0;
+		}
+		sht->nb_samples += nb_new_samples;
+		ent->nb_samples += nb_new_samples;
+	}
+	if (!ent) return;
+	ent->crc = gf_crc_32_update(ent->crc, data, size);
+	sht->entry_size += size;
+}
+
+void gf_isom_sample_hash_disable(GF_ISOFile *movie, GF_TrackBox *trak)
+{
+	if (!movie->sample_hash_index) return;
+	if (!trak->sample_hash && gf_isom_sample_hash_track_new(trak)) return;
+	if (!trak->sample_hash->disabled) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[iso file] Sample inserted before the last sample of track %u, track will not be in the sample hash index\n", trak->Header->trackID));
+	}
+	trak->sample_hash->disabled = GF_TRUE;
+}
+#endif
+
+GF_Err gf_isom_sample_hash_index_save(const char *index_path, GF_List *tracks)
+{
+	u32 i, j, count;
+	GF_Err e;
+	GF_BitStream *bs;
+	FILE *f = gf_fopen(index_path, "wb");
+	if (!f) return GF_IO_ERR;
+	bs = gf_bs_from_file(f, GF_BITSTREAM_WRITE);
+	if (!bs) {
+		gf_fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+	count = gf_list_count(tracks);
+	gf_bs_write_u32(bs, SAMPLE_HASH_INDEX_MAGIC);
+	//version
+	gf_bs_write_u8(bs, 0);
+	gf_bs_write_u8(bs, SAMPLE_HASH_INDEX_CRC32);
+	gf_bs_write_u16(bs, 0);
+	gf_bs_write_u32(bs, count);
+	for (i=0; i<count; i++) {
+		GF_ISOSampleHashTrack *sht = gf_list_get(tracks, i);
+		gf_bs_write_u32(bs, sht->track_id);
+		gf_bs_write_u32(bs, sht->nb_entries);
+		for (j=0; j<sht->nb_entries; j++) {
+			gf_bs_write_u32(bs, sht->entries[j].first_sample);
+			gf_bs_write_u32(bs, sht->entries[j].nb_samples);
+			gf_bs_write_u32(bs, sht->entries[j].crc);
+		}
+	}
+	gf_bs_del(bs);
+	e = gf_ferror(f) ? GF_IO_ERR : GF_OK;
+	gf_fclose(f);
+	return e;
+}
+
+static GF_Err sample_hash_index_load(const char *index_path, GF_List *tracks)
+{
+	u32 i, j, nb_tracks;
+	GF_Err e = GF_OK;
+	GF_BitStream *bs;
+	FILE *f = gf_fopen(index_path, "rb");
+	if (!f) return GF_URL_ERROR;
+	bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+	if (!bs) {
+		gf_fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+	if ((gf_bs_read_u32(bs) != SAMPLE_HASH_INDEX_MAGIC) || gf_bs_read_u8(bs)) {
+		e = GF_NON_COMPLIANT_BITSTREAM;
+		goto exit;
+	}
+	if (gf_bs_read_u8(bs) != SAMPLE_HASH_INDEX_CRC32) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Unsupported hash type in sample hash index %s\n", index_path));
+		e = GF_NOT_SUPPORTED;
+		goto exit;
+	}
+	gf_bs_read_u16(bs);
+	nb_tracks = gf_bs_read_u32(bs);
+	for (i=0; i<nb_tracks; i++) {
+		u32 nb_entries;
+		GF_ISOSampleHashTrack *sht;
+		GF_SAFEALLOC(sht, GF_ISOSampleHashTrack);
+		if (!sht) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		gf_list_add(tracks, sht);
+		sht->track_id = gf_bs_read_u32(bs);
+		nb_entries = gf_bs_read_u32(bs);
+		if ((u64) nb_entries * 12 > gf_bs_available(bs)) {
+			e = GF_NON_COMPLIANT_BITSTREAM;
+			goto exit;
+		}
+		for (j=0; j<nb_entries; j++) {
+			GF_ISOSampleHashEntry *ent = sample_hash_new_entry(sht);
+			if (!ent) {
+				e = GF_OUT_OF_MEM;
+				goto exit;
+			}
+			ent->first_sample = gf_bs_read_u32(bs);
+			ent->nb_samples = gf_bs_read_u32(bs);
+			ent->crc = gf_bs_read_u32(bs);
+		}
+	}
+	if (gf_bs_is_overflow(bs)) e = GF_NON_COMPLIANT_BITSTREAM;
+
+exit:
+	if (e==GF_NON_COMPLIANT_BITSTREAM) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Invalid sample hash index %s\n", index_path));
+	}
+	gf_bs_del(bs);
+	gf_fclose(f);
+	return e;
+}
+
+typedef struct
+{
+	u64 offset;
+	u32 size;
+} SampleHashRange;
+
+typedef struct
+{
+	GF_ISOSampleHashTrack *sht;
+	u32 entry_idx;
+	//byte ranges of the entry in the file, in sample order
+	u32 first_range, nb_ranges;
+	u64 start;
+	u32 crc;
+	//set if some samples use data outside of the file
+	Bool skip;
+	Bool read_error;
+} SampleHashJob;
+
+typedef struct
+{
+	SampleHashRange *ranges;
+	u32 nb_ranges, nb_ranges_alloc;
+	SampleHashJob *jobs;
+	u32 nb_jobs, nb_jobs_alloc;
+} SampleHashJobs;
+
+typedef struct
+{
+	const char *path;
+	SampleHashJobs *sh;
+	//first job of each group, nb_groups+1 entries
+	u32 *groups;
+	u32 nb_groups;
+} SampleHashGroups;
+
+static SampleHashJob *sample_hash_new_job(SampleHashJobs *sh, GF_ISOSampleHashTrack *sht, u32 entry_idx)
+{
+	if (sh->nb_jobs == sh->nb_jobs_alloc) {
+		u32 nb_alloc = sh->nb_jobs_alloc ? 2*sh->nb_jobs_alloc : 256;
+		SampleHashJob *jobs = gf_realloc(sh->jobs, sizeof(SampleHashJob) * nb_alloc);
+		if (!jobs) return NULL;
+		sh->jobs = jobs;
+		sh->nb_jobs_alloc = nb_alloc;
+	}
+	memset(&sh->jobs[sh->nb_jobs], 0, sizeof(SampleHashJob));
+	sh->jobs[sh->nb_jobs].sht = sht;
+	sh->jobs[sh->nb_jobs].entry_idx = entry_idx;
+	sh->nb_jobs++;
+	return &sh->jobs[sh->nb_jobs-1];
+}
+
+//adds a byte range to the last job, merging it with the previous range when contiguous
+static GF_Err sample_hash_add_range(SampleHashJobs *sh, u64 offset, u32 size)
+{
+	SampleHashJob *job = &sh->jobs[sh->nb_jobs-1];
+	if (!size) return GF_OK;
+	if (job->nb_ranges) {
+		SampleHashRange *prev = &sh->ranges[sh->nb_ranges-1];
+		if ((prev->offset + prev->size == offset) && ((u64) prev->size + size <= GF_UINT_MAX)) {
+			prev->size += size;
+			return GF_OK;
+		}
+	}
+	if (sh->nb_ranges == sh->nb_ranges_alloc) {
+		u32 nb_alloc = sh->nb_ranges_alloc ? 2*sh->nb_ranges_alloc : 1024;
+		SampleHashRange *ranges = gf_realloc(sh->ranges, sizeof(SampleHashRange) * nb_alloc);
+		if (!ranges) return GF_OUT_OF_MEM;
+		sh->ranges = ranges;
+		sh->nb_ranges_alloc = nb_alloc;
+	}
+	if (!job->nb_ranges) {
+		job->first_range = sh->nb_ranges;
+		job->start = offset;
+	}
+	sh->ranges[sh->nb_ranges].offset = offset;
+	sh->ranges[sh->nb_ranges].size = size;
+	sh->nb_ranges++;
+	job->nb_ranges++;
+	return GF_OK;
+}
+
+//gets position of a sample in the file
+static GF_Err sample_hash_get_sample(GF_ISOFile *file, u32 track_num, GF_TrackBox *trak, u32 sample_num, u64 *offset, u32 *size, u32 *chunk_num, u32 *last_desc, Bool *self_contained)
+{
+	u32 desc_idx;
+	GF_Err e;
+	GF_SampleTableBox *stbl = trak->Media->information->sampleTable;
+
+	e = stbl_GetSampleSize(stbl->SampleSize, sample_num, size);
+	if (!e) e = stbl_GetSampleInfos(stbl, sample_num, offset, chunk_num, &desc_idx, NULL);
+	if (e) return e;
+
+	if (desc_idx != *last_desc) {
+		*last_desc = desc_idx;
+		*self_contained = gf_isom_is_self_contained(file, track_num, desc_idx);
+	}
+	return GF_OK;
+}
+
+//computes CRC of a group of jobs covering contiguous file ranges, run by gf_fs_run_jobs
+static GF_Err sample_hash_group_run(void *udta, u32 group_idx)
+{
+	u32 i, j;
+	u8 *buf;
+	u64 buf_start = 0;
+	u32 buf_size = 0;
+	SampleHashGroups *g = (SampleHashGroups *)udta;
+	FILE *f = gf_fopen(g->path, "rb");
+	if (!f) return GF_URL_ERROR;
+	buf = gf_malloc(SAMPLE_HASH_READ_SIZE);
+	if (!buf) {
+		gf_fclose(f);
+		return GF_OUT_OF_MEM;
+	}
+	for (i=g->groups[group_idx]; i<g->groups[group_idx+1]; i++) {
+		SampleHashJob *job = &g->sh->jobs[i];
+		u32 crc = 0xFFFFFFFF;
+		if (job->skip) continue;
+
+		for (j=0; j<job->nb_ranges; j++) {
+			SampleHashRange *r = &g->sh->ranges[job->first_range + j];
+			u64 offset = r->offset;
+			u32 size = r->size;
+			while (size) {
+				u32 nb_bytes;
+				//jobs are sorted by offset, refill with the next large block of the file
+				if ((offset < buf_start) || (offset >= buf_start + buf_size)) {
+					buf_size = 0;
+					if (gf_fseek(f, offset, SEEK_SET) == 0)
+						buf_size = (u32) gf_fread(buf, SAMPLE_HASH_READ_SIZE, f);
+					buf_start = offset;
+					if (!buf_size) break;
+				}
+				nb_bytes = (u32) (buf_start + buf_size - offset);
+				if (nb_bytes > size) nb_bytes = size;
+				crc = gf_crc_32_update(crc, buf + (offset - buf_start), nb_bytes);
+				offset += nb_bytes;
+				size -= nb_bytes;
+			}
+			if (size) {
+				job->read_error = GF_TRUE;
+				break;
+			}
+		}
+		job->crc = crc;
+	}
+	gf_free(buf);
+	gf_fclose(f);
+	return GF_OK;
+}
+
+static int sample_hash_job_cmp(const void *_a, const void *_b)
+{
+	const SampleHashJob *a = (const SampleHashJob *)_a;
+	const SampleHashJob *b = (const SampleHashJob *)_b;
+	if (a->start < b->start) return -1;
+	if (a->start > b->start) return 1;
+	return 0;
+}
+
+//computes CRC of all jobs, splitting them in groups of contiguous file ranges of about SAMPLE_HASH_READ_SIZE bytes run on the session threads
+static GF_Err sample_hash_run(const char *path, SampleHashJobs *sh, GF_FilterSession *session, u32 max_threads)
+{
+	u32 i;
+	u64 acc;
+	GF_Err e;
+	SampleHashGroups g;
+
+	if (!sh->nb_jobs) return GF_OK;
+	qsort(sh->jobs, sh->nb_jobs, sizeof(SampleHashJob), sample_hash_job_cmp);
+
+	memset(&g, 0, sizeof(SampleHashGroups));
+	g.path = path;
+	g.sh = sh;
+	g.groups = gf_malloc(sizeof(u32) * (sh->nb_jobs+1));
+	if (!g.groups) return GF_OUT_OF_MEM;
+
+	acc = 0;
+	for (i=0; i<sh->nb_jobs; i++) {
+		u32 j;
+		SampleHashJob *job = &sh->jobs[i];
+		if (!i || (acc >= SAMPLE_HASH_READ_SIZE)) {
+			g.groups[g.nb_groups] = i;
+			g.nb_groups++;
+			acc = 0;
+		}
+		for (j=0; j<job->nb_ranges; j++) acc += sh->ranges[job->first_range + j].size;
+	}
+	g.groups[g.nb_groups] = sh->nb_jobs;
+
+	e = gf_fs_run_jobs(session, g.nb_groups, max_threads, sample_hash_group_run, &g);
+	gf_free(g.groups);
+	return e;
+}
+
+static void sample_hash_jobs_reset(SampleHashJobs *sh, GF_List *tracks)
+{
+	if (sh->ranges) gf_free(sh->ranges);
+	if (sh->jobs) gf_free(sh->jobs);
+	while (gf_list_count(tracks)) {
+		gf_isom_sample_hash_track_del(gf_list_pop_back(tracks));
+	}
+	gf_list_del(tracks);
+}
+
+GF_EXPORT
+GF_Err gf_isom_make_sample_hash_index(const char *file_path, const char *index_path, GF_FilterSession *session, u32 max_threads)
+{
+	u32 i, count;
+	GF_Err e = GF_OK;
+	SampleHashJobs sh;
+	GF_List *tracks;
+	GF_ISOFile *file;
+
+	if (!file_path || !index_path) return GF_BAD_PARAM;
+	file = gf_isom_open(file_path, GF_ISOM_OPEN_READ, NULL);
+	if (!file) return gf_isom_last_error(NULL);
+
+	memset(&sh, 0, sizeof(SampleHashJobs));
+	tracks = gf_list_new();
+	count = gf_isom_get_track_count(file);
+	for (i=0; i<count; i++) {
+		u32 j, nb_samples, cur_chunk=0, last_desc=0;
+		Bool self_contained = GF_FALSE;
+		GF_ISOSampleHashTrack *sht;
+		GF_ISOSampleHashEntry *ent = NULL;
+		GF_TrackBox *trak = gf_isom_get_track_box(file, i+1);
+		if (!trak || !trak->Media->information->sampleTable->SampleSize) continue;
+		nb_samples = trak->Media->information->sampleTable->SampleSize->sampleCount;
+
+		GF_SAFEALLOC(sht, GF_ISOSampleHashTrack);
+		if (!sht) {
+			e = GF_OUT_OF_MEM;
+			break;
+		}
+		gf_list_add(tracks, sht);
+		sht->track_id = trak->Header->trackID;
+
+		//one entry per chunk
+		for (j=0; j<nb_samples; j++) {
+			u64 offset;
+			u32 size, chunk_num;
+			e = sample_hash_get_sample(file, i+1, trak, j+1, &offset, &size, &chunk_num, &last_desc, &self_contained);
+			if (e) break;
+			//not in file, do not index
+			if (!self_contained) {
+				ent = NULL;
+				continue;
+			}
+			if (!ent || (chunk_num != cur_chunk)) {
+				ent = sample_hash_new_entry(sht);
+				if (!ent || !sample_hash_new_job(&sh, sht, sht->nb_entries-1)) {
+					e = GF_OUT_OF_MEM;
+					break;
+				}
+				ent->first_sample = j+1;
+				cur_chunk = chunk_num;
+			}
+			ent->nb_samples++;
+			e = sample_hash_add_range(&sh, offset, size);
+			if (e) break;
+		}
+		if (e) break;
+	}
+	gf_isom_close(file);
+
+	if (!e) e = sample_hash_run(file_path, &sh, session, max_threads);
+	if (!e) {
+		for (i=0; i<sh.nb_jobs; i++) {
+			SampleHashJob *job = &sh.jobs[i];
+			if (job->read_error) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to read samples of track %d in %s\n", job->sht->track_id, file_path));
+				e = GF_IO_ERR;
+				break;
+			}
+			job->sht->entries[job->entry_idx].crc = job->crc;
+		}
+	}
+	if (!e) e = gf_isom_sample_hash_index_save(index_path, tracks);
+
+	sample_hash_jobs_reset(&sh, tracks);
+	return e;
+}
+
+GF_EXPORT
+GF_Err gf_isom_check_sample_hash_index(const char *file_path, const char *index_path, GF_FilterSession *session, u32 max_threads, u32 *nb_errors)
+{
+	u32 i, j, k, count;
+	GF_Err e;
+	SampleHashJobs sh;
+	GF_List *tracks;
+	GF_ISOFile *file;
+
+	if (!file_path || !index_path || !nb_errors) return GF_BAD_PARAM;
+	*nb_errors = 0;
+
+	memset(&sh, 0, sizeof(SampleHashJobs));
+	tracks = gf_list_new();
+	e = sample_hash_index_load(index_path, tracks);
+	if (e) {
+		sample_hash_jobs_reset(&sh, tracks);
+		return e;
+	}
+	file = gf_isom_open(file_path, GF_ISOM_OPEN_READ, NULL);
+	if (!file) {
+		sample_hash_jobs_reset(&sh, tracks);
+		return gf_isom_last_error(NULL);
+	}
+
+	count = gf_list_count(tracks);
+	for (i=0; i<count && !e; i++) {
+		u32 track_num, nb_samples, last_desc=0;
+		Bool self_contained = GF_FALSE;
+		GF_TrackBox *trak;
+		GF_ISOSampleHashTrack *sht = gf_list_get(tracks, i);
+
+		track_num = gf_isom_get_track_by_id(file, sht->track_id);
+		trak = gf_isom_get_track_box(file, track_num);
+		nb_samples = (trak && trak->Media->information->sampleTable->SampleSize) ? trak->Media->information->sampleTable->SampleSize->sampleCount : 0;
+
+		for (j=0; j<sht->nb_entries; j++) {
+			GF_ISOSampleHashEntry *ent = &sht->entries[j];
+			SampleHashJob *job = sample_hash_new_job(&sh, sht, j);
+			if (!job) {
+				e = GF_OUT_OF_MEM;
+				break;
+			}
+			if (!ent->first_sample || (ent->first_sample + ent->nb_samples - 1 > nb_samples) || (ent->first_sample + ent->nb_samples < ent->first_sample)) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Track %d samples %d to %d from hash index not found in %s\n", sht->track_id, ent->first_sample, ent->first_sample + ent->nb_samples - 1, file_path));
+				job->read_error = GF_TRUE;
+				continue;
+			}
+			for (k=0; k<ent->nb_samples; k++) {
+				u64 offset;
+				u32 size, chunk_num;
+				e = sample_hash_get_sample(file, track_num, trak, ent->first_sample + k, &offset, &size, &chunk_num, &last_desc, &self_contained);
+				if (e) break;
+				if (!self_contained) job->skip = GF_TRUE;
+				else e = sample_hash_add_range(&sh, offset, size);
+				if (e) break;
+			}
+			if (e) break;
+		}
+	}
+	gf_isom_close(file);
+
+	if (!e) e = sample_hash_run(file_path, &sh, session, max_threads);
+	if (!e) {
+		for (i=0; i<sh.nb_jobs; i++) {
+			SampleHashJob *job = &sh.jobs[i];
+			GF_ISOSampleHashEntry *ent = &job->sht->entries[job->entry_idx];
+			if (job->skip) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[iso file] Track %d samples %d to %d use external data, not checked\n", job->sht->track_id, ent->first_sample, ent->first_sample + ent->nb_samples - 1));
+				continue;
+			}
+			if (!job->read_error && (job->crc == ent->crc)) continue;
+
+			if (!job->read_error) {
+				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Track %d samples %d to %d do not match hash index\n", job->sht->track_id, ent->first_sample, ent->first_sample + ent->nb_samples - 1));
+			}
+			(*nb_errors)++;
+		}
+	}
+	sample_hash_jobs_reset(&sh, tracks);
+	return e;
+}
+
 #endif /*GPAC_DISABLE_ISOM*/
@@ -1205,6 +1205,9 @@ static GF_Err UpdateOffsets(GF_ISOFile *movie, GF_List *writers, Bool use_pad, B
 }
 
 
+//moov of given size can be written in the reserved space, exactly or followed by a free box
+#define MOOV_RESERVE_FITS(_movie, _size) ( ((_size) == (_movie)->moov_reserve) || ((_size) + 8 <= (_movie)->moov_reserve) )
+
 //write the file track by track, with moov box before or after the mdat
 static GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs, Bool non_seekable, Bool for_fragments, GF_BitStream *moov_bs)
 {
@@ -1215,6 +1218,7 @@ static GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs, Bool no
 	GF_List *writers = gf_list_new();
 	GF_ISOFile *movie = mw->movie;
 	s32 moov_meta_pos=-1;
+	u64 moov_start;
 
 	//in case we did a read on the file while producing it, seek to end of edit
 	totSize = gf_bs_get_size(bs);
@@ -1281,6 +1285,9 @@ static GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs, Bool no
 					if (e) goto exit;
 					begin += movie->pdin->size;
 				}
+				//reserved moov space is written between start boxes and mdat
+				if (movie->moov_reserve)
+					begin = movie->mdat->bsOffset;
 			}
 			totSize -= begin;
 		} else if (!non_seekable || for_fragments) {
@@ -1392,17 +1399,46 @@ static GF_Err WriteFlat(MovieWriter *mw, u8 moovFirst, GF_BitStream *bs, Bool no
 			e = DoWrite(mw, writers, bs, 1, movie->mdat->bsOffset);
 			if (e) goto exit;
 
-			e = UpdateOffsets(movie, writers, GF_FALSE, GF_FALSE);
-			if (e) goto exit;
+			//moov fits in reserved space (exactly or with a trailing free box), sample offsets are unchanged
+			movie->moov_reserve_fit = GF_FALSE;
+			if (movie->moov_reserve) {
+				u64 moov_size;
+				//get real sample offsets for meta items before estimating the size
+				if (movie->meta) {
+					store_meta_item_references(movie, writers, movie->meta);
+				}
+				moov_size = GetMoovAndMetaSize(movie, writers);
+				if (MOOV_RESERVE_FITS(movie, moov_size))
+					movie->moov_reserve_fit = GF_TRUE;
+			}
+			if (!movie->moov_reserve_fit) {
+				e = UpdateOffsets(movie, writers, GF_FALSE, GF_FALSE);
+				if (e) goto exit;
+			}
 		}
 		//get real sample offsets for meta items
 		if (movie->meta) {
 			store_meta_item_references(movie, writers, movie->meta);
 		}
 		//OK, write the movie box.
+		moov_start = moov_bs ? gf_bs_get_position(moov_bs) : 0;
 		e = WriteMoovAndMeta(movie, writers, moov_bs ? moov_bs : bs);
 		if (e) goto exit;
 
+		//the estimate was wrong, the written moov would overwrite the mdat: rewrite it with shifted offsets and insert it
+		if (moov_bs && movie->moov_reserve_fit) {
+			u64 moov_size = gf_bs_get_position(moov_bs) - moov_start;
+			if (!MOOV_RESERVE_FITS(movie, moov_size)) {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_CONTAINER, ("[ISOBMFF] written moov size "LLU" does not fit in reserved size %u, inserting moov\n", moov_size, movie->moov_reserve));
+				movie->moov_reserve_fit = GF_FALSE;
+				gf_bs_seek(moov_bs, moov_start);
+				e = UpdateOffsets(movie, writers, GF_FALSE, GF_FALSE);
+				if (e) goto exit;
+				e = WriteMoovAndMeta(movie, writers, moov_bs);
+				if (e) goto exit;
+			}
+		}
+
 #ifndef GPAC_DISABLE_ISOM_ADOBE
 		i=0;
 		while ((a = (GF_Box*)gf_list_enum(movie->TopBoxes, &i))) {
@@ -2597,7 +2633,8 @@ GF_Err WriteToFile(GF_ISOFile *movie, Bool for_fragments)
 			gf_bs_seek(movie->editFileMap->bs, gf_bs_get_size(movie->editFileMap->bs) );
 
 			if ((movie->storageMode==GF_ISOM_STORE_FASTSTART) && mdat_start && mdat_size) {
-				u32 pad = (u32) mdat_start;
+				//moov is written or inserted at the reserved space if any, otherwise inserted before mdat
+				u32 pad = (u32) (movie->moov_reserve ? movie->moov_reserve_offset : mdat_start);
 				//make sure the bitstream has the right offset - this is require for box using offsets into other boxes (typically saio)
 				moov_bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
 				while (pad) {
@@ -2645,15 +2682,26 @@ GF_Err WriteToFile(GF_ISOFile *movie, Bool for_fragments)
 			if (moov_bs) {
 				u8 *moov_data;
 				u32 moov_size;
+				u64 moov_pos = movie->moov_reserve ? movie->moov_reserve_offset : mdat_start;
 				if (!movie->on_block_patch) {
 					GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[ISOBMFF] Missing output block patch callback, cannot patch mdat size in fast-start storage\n"));
 					return GF_BAD_PARAM;
 				}
+				//shrink reserved free box to what is left after moov
+				if (movie->moov_reserve_fit) {
+					u32 left = movie->moov_reserve - (u32) (gf_bs_get_position(moov_bs) - moov_pos);
+					if (left) {
+						gf_bs_write_u32(moov_bs, left);
+						gf_bs_write_u32(moov_bs, GF_ISOM_BOX_TYPE_FREE);
+					}
+				} else if (movie->moov_reserve) {
+					GF_LOG(GF_LOG_INFO, GF_LOG_CONTAINER, ("[ISOBMFF] moov size "LLU" larger than reserved size %u, inserting moov\n", gf_bs_get_position(moov_bs) - moov_pos, movie->moov_reserve));
+				}
 
 				gf_bs_get_content(moov_bs, &moov_data, &moov_size);
 				gf_bs_del(moov_bs);
-				//the first mdat_start bytes are dummy, cf above
-				movie->on_block_patch(movie->on_block_out_usr_data, moov_data+mdat_start, (u32) (moov_size-mdat_start), mdat_start, GF_TRUE);
+				//the first moov_pos bytes are dummy, cf above
+				movie->on_block_patch(movie->on_block_out_usr_data, moov_data+moov_pos, (u32) (moov_size-moov_pos), moov_pos, movie->moov_reserve_fit ? GF_FALSE : GF_TRUE);
 				gf_free(moov_data);
 			}
 		} else {
@@ -2666,10 +2714,24 @@ GF_Err WriteToFile(GF_ISOFile *movie, Bool for_fragments)
 				u8 *moov_data;
 				u32 moov_size;
 
+				if (movie->moov_reserve_fit) {
+					u32 left = movie->moov_reserve - (u32) gf_bs_get_position(moov_bs);
+					if (left) {
+						gf_bs_write_u32(moov_bs, left);
+						gf_bs_write_u32(moov_bs, GF_ISOM_BOX_TYPE_FREE);
+					}
+				}
 				gf_bs_get_content(moov_bs, &moov_data, &moov_size);
 				gf_bs_del(moov_bs);
-				if (!e)
-					e = gf_bs_insert_data(movie->editFileMap->bs, moov_data, moov_size, movie->mdat->bsOffset);
+				if (!e && movie->moov_reserve_fit) {
+					u64 pos = gf_bs_get_position(movie->editFileMap->bs);
+					gf_bs_seek(movie->editFileMap->bs, movie->moov_reserve_offset);
+					if (gf_bs_write_data(movie->editFileMap->bs, moov_data, moov_size) != moov_size)
+						e = GF_IO_ERR;
+					gf_bs_seek(movie->editFileMap->bs, pos);
+				} else if (!e) {
+					e = gf_bs_insert_data(movie->editFileMap->bs, moov_data, moov_size, movie->moov_reserve ? movie->moov_reserve_offset : movie->mdat->bsOffset);
+				}
 
 				gf_free(moov_data);
 			}
@@ -88,6 +88,15 @@ GF_Err FlushCaptureMode(GF_ISOFile *movie)
 		e = gf_isom_box_write((GF_Box *)movie->pdin, movie->editFileMap->bs);
 		if (e) return e;
 	}
+	/*reserve space for the moov in fast-start mode, written as a free box*/
+	if (movie->moov_reserve && (movie->storageMode==GF_ISOM_STORE_FASTSTART)) {
+		movie->moov_reserve_offset = gf_bs_get_position(movie->editFileMap->bs);
+		gf_bs_write_u32(movie->editFileMap->bs, movie->moov_reserve);
+		gf_bs_write_u32(movie->editFileMap->bs, GF_ISOM_BOX_TYPE_FREE);
+		gf_bs_write_byte(movie->editFileMap->bs, 0, movie->moov_reserve - 8);
+	} else {
+		movie->moov_reserve = 0;
+	}
 	movie->mdat->bsOffset = gf_bs_get_position(movie->editFileMap->bs);
 
 	/*we have a trick here: the data will be stored on the fly, so the first
@@ -1117,6 +1126,24 @@ static GF_Err trak_add_sample(GF_ISOFile *movie, GF_TrackBox *trak, const GF_ISO
 	return GF_OK;
 }
 
+//checks if a sample with the given DTS is added after the last sample of the track, see stbl_AddDTS
+static Bool trak_sample_appended(GF_TrackBox *trak, u64 DTS)
+{
+	GF_TimeToSampleBox *stts = trak->Media->information->sampleTable->TimeToSample;
+	if (!stts->nb_entries || (DTS >= stts->w_LastDTS)) return GF_TRUE;
+	return GF_FALSE;
+}
+
+//updates the sample hash index once a sample is added, data is only hashed if in the file
+static void trak_sample_hash_add(GF_ISOFile *movie, GF_TrackBox *trak, const GF_ISOSample *sample, Bool in_file, Bool appended)
+{
+	if (!appended) {
+		gf_isom_sample_hash_disable(movie, trak);
+	} else {
+		gf_isom_sample_hash_add(movie, trak, in_file ? sample->data : NULL, in_file ? sample->dataLength : 0, sample->nb_pack ? sample->nb_pack : 1);
+	}
+}
+
 //Add samples to a track. Use streamDescriptionIndex to specify the desired stream (if several)
 GF_EXPORT
 GF_Err gf_isom_add_sample(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescriptionIndex, const GF_ISOSample *sample)
@@ -1127,6 +1154,7 @@ GF_Err gf_isom_add_sample(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescript
 	u32 dataRefIndex;
 	u64 data_offset;
 	u32 descIndex;
+	Bool appended;
 	GF_DataEntryURLBox *Dentry;
 
 	e = gf_isom_can_access_movie(movie, GF_ISOM_OPEN_WRITE);
@@ -1166,6 +1194,8 @@ GF_Err gf_isom_add_sample(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescript
 	//Get the offset...
 	data_offset = gf_isom_datamap_get_offset(trak->Media->information->dataHandler);
 
+	appended = trak_sample_appended(trak, sample->DTS);
+
 	/*rewrite OD frame*/
 	if (trak->Media->handler->handlerType == GF_ISOM_MEDIA_OD) {
 		GF_ISOSample *od_sample = NULL;
@@ -1174,11 +1204,13 @@ GF_Err gf_isom_add_sample(GF_ISOFile *movie, u32 trackNumber, u32 StreamDescript
 		if (e) return e;
 
 		e = trak_add_sample(movie, trak, od_sample, descIndex, data_offset, 0);
+		if (!e) trak_sample_hash_add(movie, trak, od_sample, GF_TRUE, appended);
 
 		if (od_sample)
 			gf_isom_sample_del(&od_sample);
 	} else {
 		e = trak_add_sample(movie, trak, sample, descIndex, data_offset, 0);
+		if (!e) trak_sample_hash_add(movie, trak, sample, GF_TRUE, appended);
 	}
 	if (e) return e;
 
@@ -1212,6 +1244,7 @@ GF_Err gf_isom_add_sample_shadow(GF_ISOFile *movie, u32 trackNumber, GF_ISOSampl
 	u32 sampleNum, prevSampleNum;
 	GF_DataEntryURLBox *Dentry;
 	Bool offset_times = GF_FALSE;
+	Bool appended;
 
 	e = gf_isom_can_access_movie(movie, GF_ISOM_OPEN_WRITE);
 	if (e) return e;
@@ -1251,6 +1284,7 @@ GF_Err gf_isom_add_sample_shadow(GF_ISOFile *movie, u32 trackNumber, GF_ISOSampl
 
 	data_offset = gf_isom_datamap_get_offset(trak->Media->information->dataHandler);
 	if (offset_times) sample->DTS += 1;
+	appended = trak_sample_appended(trak, sample->DTS);
 
 	/*REWRITE ANY OD STUFF*/
 	if (trak->Media->handler->handlerType == GF_ISOM_MEDIA_OD) {
@@ -1259,10 +1293,12 @@ GF_Err gf_isom_add_sample_shadow(GF_ISOFile *movie, u32 trackNumber, GF_ISOSampl
 		if (e) return e;
 
 		e = trak_add_sample(movie, trak, od_sample, descIndex, data_offset, sampleNum);
+		if (!e) trak_sample_hash_add(movie, trak, od_sample, GF_TRUE, appended);
 		if (od_sample)
 			gf_isom_sample_del(&od_sample);
 	} else {
 		e = trak_add_sample(movie, trak, sample, descIndex, data_offset, sampleNum);
+		if (!e) trak_sample_hash_add(movie, trak, sample, GF_TRUE, appended);
 	}
 	if (e) return e;
 	if (offset_times) sample->DTS -= 1;
@@ -1318,7 +1354,10 @@ GF_Err gf_isom_append_sample_data(GF_ISOFile *movie, u32 trackNumber, u8 *data,
 		if (e) return e;
 	}
 	//update data size
-	return stbl_SampleSizeAppend(trak->Media->information->sampleTable->SampleSize, data_size);
+	e = stbl_SampleSizeAppend(trak->Media->information->sampleTable->SampleSize, data_size);
+	if (e) return e;
+	gf_isom_sample_hash_add(movie, trak, data, data_size, 0);
+	return GF_OK;
 }
 
 
@@ -1333,6 +1372,7 @@ GF_Err gf_isom_add_sample_reference(GF_ISOFile *movie, u32 trackNumber, u32 Stre
 	GF_SampleEntryBox *entry;
 	u32 dataRefIndex;
 	u32 descIndex;
+	Bool appended;
 	GF_DataEntryURLBox *Dentry;
 	GF_Err e;
 
@@ -1367,9 +1407,12 @@ GF_Err gf_isom_add_sample_reference(GF_ISOFile *movie, u32 trackNumber, u32 Stre
 	Dentry =(GF_DataEntryURLBox*) gf_list_get(trak->Media->information->dataInformation->dref->child_boxes, dataRefIndex - 1);
 	if (Dentry->flags == 1) return GF_BAD_PARAM;
 
+	appended = trak_sample_appended(trak, sample->DTS);
 	//add the meta data
 	e = Media_AddSample(trak->Media, dataOffset, sample, descIndex, 0);
 	if (e) return e;
+	//data is not in file, only count the sample
+	trak_sample_hash_add(movie, trak, sample, GF_FALSE, appended);
 
 	if (!movie->keep_utc)
 		trak->Media->mediaHeader->modificationTime = gf_isom_get_mp4time();
@@ -2840,6 +2883,42 @@ GF_Err gf_isom_set_storage_mode(GF_ISOFile *movie, GF_ISOStorageMode storageMode
 	}
 }
 
+GF_EXPORT
+GF_Err gf_isom_set_sample_hash_index(GF_ISOFile *movie, const char *index_path)
+{
+	u32 i;
+	GF_Err e;
+	GF_TrackBox *trak;
+	e = gf_isom_can_access_movie(movie, GF_ISOM_OPEN_WRITE);
+	if (e) return e;
+	if (movie->sample_hash_index) gf_free(movie->sample_hash_index);
+	movie->sample_hash_index = index_path ? gf_strdup(index_path) : NULL;
+	if (index_path && !movie->sample_hash_index) return GF_OUT_OF_MEM;
+
+	i=0;
+	while (movie->moov && (trak = (GF_TrackBox*)gf_list_enum(movie->moov->trackList, &i))) {
+		if (index_path) {
+			e = gf_isom_sample_hash_track_new(trak);
+			if (e) return e;
+		} else {
+			gf_isom_sample_hash_track_del(trak->sample_hash);
+			trak->sample_hash = NULL;
+		}
+	}
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_isom_set_moov_reserve(GF_ISOFile *movie, u32 size)
+{
+	if (!movie || (movie->openMode != GF_ISOM_OPEN_WRITE)) return GF_BAD_PARAM;
+	//data already written
+	if (gf_bs_get_position(movie->editFileMap->bs)) return GF_BAD_PARAM;
+	if (size && (size<8)) size = 8;
+	movie->moov_reserve = size;
+	return GF_OK;
+}
+
 
 GF_EXPORT
 GF_Err gf_isom_enable_compression(GF_ISOFile *file, GF_ISOCompressMode compress_mode, u32 compress_flags)
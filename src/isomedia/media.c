@@ -635,6 +635,7 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 
 	if (data_size != 0) {
 		GF_BlobRangeStatus range_status;
+		GF_ISOFile *mov = mdia->mediaTrack->moov->mov;
 		if (mdia->mediaTrack->pack_num_samples) {
 			u32 idx_in_chunk = sampleNumber - mdia->information->sampleTable->SampleToChunk->firstSampleInCurrentChunk;
 			u32 left_in_chunk = stsc_entry->samplesPerChunk - idx_in_chunk;
@@ -676,7 +677,14 @@ GF_Err Media_GetSample(GF_MediaBox *mdia, u32 sampleNumber, GF_ISOSample **samp,
 				return GF_ISOM_INCOMPLETE_FILE;
 			}
 		}
-		bytesRead = gf_isom_datamap_get_data(mdia->information->dataHandler, (*samp)->data, (*samp)->dataLength, offset, &range_status);
+		range_status = GF_BLOB_RANGE_VALID;
+		if (mov->read_cache_cbk && (mdia->information->dataHandler == mov->movieFileMap)
+			&& mov->read_cache_cbk(mov->read_cache_udta, offset, (*samp)->data, (*samp)->dataLength)
+		) {
+			bytesRead = (*samp)->dataLength;
+		} else {
+			bytesRead = gf_isom_datamap_get_data(mdia->information->dataHandler, (*samp)->data, (*samp)->dataLength, offset, &range_status);
+		}
 		//if bytesRead != sampleSize, we have an IO err
 		if (bytesRead < data_size) {
 			if (range_status == GF_BLOB_RANGE_IN_TRANSFER) {
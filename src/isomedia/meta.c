@@ -230,33 +230,15 @@ u32 gf_isom_get_meta_item_by_id(GF_ISOFile *file, Bool root_meta, u32 track_num,
 	return 0;
 }
 
-static GF_Err gf_isom_extract_meta_item_intern(GF_ISOFile *file, Bool root_meta, u32 track_num, u32 item_id, const char *dump_file_name, u8 **out_data, u32 *out_size, u32 *out_alloc_size, const char **out_mime, Bool use_annex_b)
+/*locates data of an item - location_entry is set to NULL if the item is stored outside the file*/
+static GF_Err meta_item_locate(GF_ISOFile *file, GF_MetaBox *meta, u32 item_id, u32 item_num, GF_ItemLocationEntry **out_location, u64 *out_idat_offset)
 {
-	GF_BitStream *item_bs;
-	char szPath[1024];
-	FILE *resource = NULL;
 	u32 i, count;
-	GF_Err e;
 	GF_ItemLocationEntry *location_entry;
-	u32 item_num;
-	u32 item_type = 0;
-	u32 nalu_size_length = 0;
 	u64 idat_offset = 0;
-	char *item_name = NULL;
-
-	GF_MetaBox *meta = gf_isom_get_meta(file, root_meta, track_num);
-	if (!meta || !meta->item_infos || !meta->item_locations) return GF_BAD_PARAM;
-
-	if (out_mime) *out_mime = NULL;
 
-	item_num = gf_isom_get_meta_item_by_id(file, root_meta, track_num, item_id);
-	if (item_num) {
-		GF_ItemInfoEntryBox *item_entry = (GF_ItemInfoEntryBox *)gf_list_get(meta->item_infos->item_infos, item_num-1);
-		item_name = item_entry->item_name;
-		if (out_mime) *out_mime = item_entry->content_type;
-
-		item_type = item_entry->item_type;
-	}
+	*out_location = NULL;
+	*out_idat_offset = 0;
 
 	location_entry = NULL;
 	count = gf_list_count(meta->item_locations->location_entries);
@@ -344,6 +326,164 @@ static GF_Err gf_isom_extract_meta_item_intern(GF_ISOFile *file, Bool root_meta,
 #endif
 		   ) return GF_BAD_PARAM;
 	}
+	*out_location = location_entry;
+	*out_idat_offset = idat_offset;
+	return GF_OK;
+}
+
+/*writes parameter sets of NALU-based items if annex B is used, and gets NALU size length*/
+static GF_Err meta_item_write_config(GF_MetaBox *meta, u32 item_id, u32 item_type, GF_BitStream *item_bs, Bool use_annex_b, u32 *nalu_size_length)
+{
+	u32 i, j, nb_assoc;
+	GF_HEVCConfigurationBox *hvcc = NULL;
+	GF_AVCConfigurationBox *avcc = NULL;
+	GF_VVCConfigurationBox *vvcc = NULL;
+
+	*nalu_size_length = 0;
+	if ((item_type != GF_ISOM_SUBTYPE_HVC1) && (item_type != GF_ISOM_SUBTYPE_AVC_H264) && (item_type != GF_ISOM_SUBTYPE_VVC1))
+		return GF_OK;
+
+	if (!meta->item_props || !meta->item_props->property_container || !meta->item_props->property_association) {
+		return GF_NON_COMPLIANT_BITSTREAM;
+	}
+
+	nb_assoc = gf_list_count(meta->item_props->property_association->entries);
+	for (i=0; i<nb_assoc; i++) {
+		GF_ItemPropertyAssociationEntry *ent = gf_list_get(meta->item_props->property_association->entries, i);
+		if (ent->item_id!=item_id) continue;
+		for (j=0; j<ent->nb_associations; j++) {
+			u32 idx = ent->associations[j].index;
+			if (! idx) continue;
+			hvcc = gf_list_get(meta->item_props->property_container->child_boxes, idx - 1);
+			if (!hvcc) {
+				return GF_NON_COMPLIANT_BITSTREAM;
+			}
+			if (hvcc->type == GF_ISOM_BOX_TYPE_HVCC)
+				break;
+			if (hvcc->type == GF_ISOM_BOX_TYPE_AVCC) {
+				avcc = (GF_AVCConfigurationBox *) hvcc;
+				hvcc = NULL;
+				break;
+			}
+			if (hvcc->type == GF_ISOM_BOX_TYPE_VVCC) {
+				vvcc = (GF_VVCConfigurationBox *) hvcc;
+				hvcc = NULL;
+				break;
+			}
+			hvcc = NULL;
+		}
+		if (avcc || hvcc || vvcc) break;
+	}
+	if (hvcc) {
+		if (! hvcc->config) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Missing HEVC config in hvcC\n"));
+		} else {
+			if (use_annex_b) {
+				hvcc->config->write_annex_b = GF_TRUE;
+				gf_odf_hevc_cfg_write_bs(hvcc->config, item_bs);
+				hvcc->config->write_annex_b = GF_FALSE;
+			}
+			*nalu_size_length = hvcc->config->nal_unit_size;
+		}
+	} else if (avcc) {
+		if (! avcc->config) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Missing AVC config in avcC\n"));
+		} else {
+			if (use_annex_b) {
+				avcc->config->write_annex_b = GF_TRUE;
+				gf_odf_avc_cfg_write_bs(avcc->config, item_bs);
+				avcc->config->write_annex_b = GF_FALSE;
+			}
+			*nalu_size_length = avcc->config->nal_unit_size;
+		}
+	} else if (vvcc) {
+		if (! vvcc->config) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Missing VVC config in vvcC\n"));
+		} else {
+			if (use_annex_b) {
+				vvcc->config->write_annex_b = GF_TRUE;
+				gf_odf_vvc_cfg_write_bs(vvcc->config, item_bs);
+				vvcc->config->write_annex_b = GF_FALSE;
+			}
+			*nalu_size_length = vvcc->config->nal_unit_size;
+		}
+	}
+	return GF_OK;
+}
+
+/*copies one item extent from the current position of src_bs, rewriting NALU size fields if needed*/
+static GF_Err meta_item_copy_extent(GF_BitStream *src_bs, GF_BitStream *item_bs, u64 extent_length, u32 nalu_size_length, Bool use_annex_b)
+{
+	char buf_cache[4096];
+	u64 remain = extent_length;
+	while (remain) {
+		if (nalu_size_length) {
+			if (remain < nalu_size_length) {
+				return GF_ISOM_INVALID_FILE;
+			}
+
+			u32 nal_size = gf_bs_read_int(src_bs, 8*nalu_size_length);
+			if (remain - nalu_size_length < nal_size) {
+				return GF_ISOM_INVALID_FILE;
+			}
+
+			if (use_annex_b)
+				gf_bs_write_u32(item_bs, 1);
+			else
+				gf_bs_write_int(item_bs, nal_size, 8*nalu_size_length);
+
+			remain -= nalu_size_length + nal_size;
+			while (nal_size) {
+				u32 cache_size = (nal_size>4096) ? 4096 : (u32) nal_size;
+
+				gf_bs_read_data(src_bs, buf_cache, cache_size);
+				gf_bs_write_data(item_bs, buf_cache, cache_size);
+				nal_size -= cache_size;
+			}
+		} else {
+			u32 cache_size = (remain>4096) ? 4096 : (u32) remain;
+			gf_bs_read_data(src_bs, buf_cache, cache_size);
+			gf_bs_write_data(item_bs, buf_cache, cache_size);
+			remain -= cache_size;
+		}
+		if (gf_bs_is_overflow(src_bs)) {
+			return GF_ISOM_INVALID_FILE;
+		}
+	}
+	return GF_OK;
+}
+
+static GF_Err gf_isom_extract_meta_item_intern(GF_ISOFile *file, Bool root_meta, u32 track_num, u32 item_id, const char *dump_file_name, u8 **out_data, u32 *out_size, u32 *out_alloc_size, const char **out_mime, Bool use_annex_b)
+{
+	GF_BitStream *item_bs;
+	char szPath[1024];
+	FILE *resource = NULL;
+	u32 i, count;
+	GF_Err e;
+	GF_ItemLocationEntry *location_entry;
+	u32 item_num;
+	u32 item_type = 0;
+	u32 nalu_size_length = 0;
+	u64 idat_offset = 0;
+	char *item_name = NULL;
+
+	GF_MetaBox *meta = gf_isom_get_meta(file, root_meta, track_num);
+	if (!meta || !meta->item_infos || !meta->item_locations) return GF_BAD_PARAM;
+
+	if (out_mime) *out_mime = NULL;
+
+	item_num = gf_isom_get_meta_item_by_id(file, root_meta, track_num, item_id);
+	if (item_num) {
+		GF_ItemInfoEntryBox *item_entry = (GF_ItemInfoEntryBox *)gf_list_get(meta->item_infos->item_infos, item_num-1);
+		item_name = item_entry->item_name;
+		if (out_mime) *out_mime = item_entry->content_type;
+
+		item_type = item_entry->item_type;
+	}
+
+	e = meta_item_locate(file, meta, item_id, item_num, &location_entry, &idat_offset);
+	if (e || !location_entry) return e;
+	count = gf_list_count(location_entry->extent_entries);
 
 	item_bs = NULL;
 
@@ -364,125 +504,20 @@ static GF_Err gf_isom_extract_meta_item_intern(GF_ISOFile *file, Bool root_meta,
 	if (!item_bs)
 		return GF_BAD_PARAM;
 
-	if ((item_type == GF_ISOM_SUBTYPE_HVC1) || (item_type == GF_ISOM_SUBTYPE_AVC_H264)  || (item_type == GF_ISOM_SUBTYPE_VVC1) ) {
-		u32 j, nb_assoc;
-		GF_HEVCConfigurationBox *hvcc = NULL;
-		GF_AVCConfigurationBox *avcc = NULL;
-		GF_VVCConfigurationBox *vvcc = NULL;
-		if (!meta->item_props || !meta->item_props->property_container || !meta->item_props->property_association) {
-			if (item_bs) gf_bs_del(item_bs);
-			return GF_NON_COMPLIANT_BITSTREAM;
-		}
-
-		nb_assoc = gf_list_count(meta->item_props->property_association->entries);
-		for (i=0; i<nb_assoc; i++) {
-			GF_ItemPropertyAssociationEntry *ent = gf_list_get(meta->item_props->property_association->entries, i);
-			if (ent->item_id!=item_id) continue;
-			for (j=0; j<ent->nb_associations; j++) {
-				u32 idx = ent->associations[j].index;
-				if (! idx) continue;
-				hvcc = gf_list_get(meta->item_props->property_container->child_boxes, idx - 1);
-				if (!hvcc) {
-					if (item_bs) gf_bs_del(item_bs);
-					return GF_NON_COMPLIANT_BITSTREAM;
-				}
-				if (hvcc->type == GF_ISOM_BOX_TYPE_HVCC)
-					break;
-				if (hvcc->type == GF_ISOM_BOX_TYPE_AVCC) {
-					avcc = (GF_AVCConfigurationBox *) hvcc;
-					hvcc = NULL;
-					break;
-				}
-				if (hvcc->type == GF_ISOM_BOX_TYPE_VVCC) {
-					vvcc = (GF_VVCConfigurationBox *) hvcc;
-					hvcc = NULL;
-					break;
-				}
-				hvcc = NULL;
-			}
-			if (avcc || hvcc || vvcc) break;
-		}
-		if (hvcc) {
-			if (! hvcc->config) {
-				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Missing HEVC config in hvcC\n"));
-			} else {
-				if (use_annex_b) {
-					hvcc->config->write_annex_b = GF_TRUE;
-					gf_odf_hevc_cfg_write_bs(hvcc->config, item_bs);
-					hvcc->config->write_annex_b = GF_FALSE;
-				}
-				nalu_size_length = hvcc->config->nal_unit_size;
-			}
-		} else if (avcc) {
-			if (! avcc->config) {
-				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Missing AVC config in avcC\n"));
-			} else {
-				if (use_annex_b) {
-					avcc->config->write_annex_b = GF_TRUE;
-					gf_odf_avc_cfg_write_bs(avcc->config, item_bs);
-					avcc->config->write_annex_b = GF_FALSE;
-				}
-				nalu_size_length = avcc->config->nal_unit_size;
-			}
-		} else if (vvcc) {
-			if (! vvcc->config) {
-				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("Missing VVC config in vvcC\n"));
-			} else {
-				if (use_annex_b) {
-					vvcc->config->write_annex_b = GF_TRUE;
-					gf_odf_vvc_cfg_write_bs(vvcc->config, item_bs);
-					vvcc->config->write_annex_b = GF_FALSE;
-				}
-				nalu_size_length = vvcc->config->nal_unit_size;
-			}
-		}
+	e = meta_item_write_config(meta, item_id, item_type, item_bs, use_annex_b, &nalu_size_length);
+	if (e) {
+		gf_bs_del(item_bs);
+		if (resource) gf_fclose(resource);
+		return e;
 	}
 
-	e = GF_OK;
 	for (i=0; i<count; i++) {
-		char buf_cache[4096];
-		u64 remain;
+		GF_Err ext_e;
 		GF_ItemExtentEntry *extent_entry = (GF_ItemExtentEntry *)gf_list_get(location_entry->extent_entries, i);
 		gf_bs_seek(file->movieFileMap->bs, idat_offset + location_entry->base_offset + extent_entry->extent_offset);
 
-		remain = extent_entry->extent_length;
-		while (remain) {
-			if (nalu_size_length) {
-				if (remain < nalu_size_length) {
-					e = GF_ISOM_INVALID_FILE;
-					break;
-				}
-
-				u32 nal_size = gf_bs_read_int(file->movieFileMap->bs, 8*nalu_size_length);
-				if (remain - nalu_size_length < nal_size) {
-					e = GF_ISOM_INVALID_FILE;
-					break;
-				}
-
-				if (use_annex_b)
-					gf_bs_write_u32(item_bs, 1);
-				else
-					gf_bs_write_int(item_bs, nal_size, 8*nalu_size_length);
-
-				remain -= nalu_size_length + nal_size;
-				while (nal_size) {
-					u32 cache_size = (nal_size>4096) ? 4096 : (u32) nal_size;
-
-					gf_bs_read_data(file->movieFileMap->bs, buf_cache, cache_size);
-					gf_bs_write_data(item_bs, buf_cache, cache_size);
-					nal_size -= cache_size;
-				}
-			} else {
-				u32 cache_size = (remain>4096) ? 4096 : (u32) remain;
-				gf_bs_read_data(file->movieFileMap->bs, buf_cache, cache_size);
-				gf_bs_write_data(item_bs, buf_cache, cache_size);
-				remain -= cache_size;
-			}
-			if (gf_bs_is_overflow(file->movieFileMap->bs)) {
-				e = GF_ISOM_INVALID_FILE;
-				break;
-			}
-		}
+		ext_e = meta_item_copy_extent(file->movieFileMap->bs, item_bs, extent_entry->extent_length, nalu_size_length, use_annex_b);
+		if (ext_e) e = ext_e;
 	}
 	if (out_data) {
 		gf_bs_get_content_no_truncate(item_bs, out_data, out_size, out_alloc_size);
@@ -506,6 +541,190 @@ GF_Err gf_isom_extract_meta_item_mem(GF_ISOFile *file, Bool root_meta, u32 track
 	return gf_isom_extract_meta_item_intern(file, root_meta, track_num, item_id, NULL, out_data, out_size, out_alloc_size, out_mime, use_annex_b);
 }
 
+//extents closer than this are read in a single read
+#define ITEM_READ_MAX_GAP	4096
+//max size of a coalesced read, larger extents are copied from the file
+#define ITEM_READ_MAX_RUN	(4*1024*1024)
+
+typedef struct
+{
+	GF_ItemLocationEntry *location;
+	u64 idat_offset;
+	u32 item_type;
+	u32 first_extent;
+} ItemBatchEntry;
+
+typedef struct
+{
+	u64 offset, length;
+	//coalesced read holding the extent, -1 if extent is copied from the file
+	s32 run_idx;
+	u32 run_offset;
+} ItemBatchExtent;
+
+typedef struct
+{
+	u64 offset;
+	u32 size;
+	u8 *data;
+} ItemBatchRun;
+
+static int item_batch_extent_cmp(const void *a, const void *b)
+{
+	const ItemBatchExtent *e1 = *(const ItemBatchExtent **)a;
+	const ItemBatchExtent *e2 = *(const ItemBatchExtent **)b;
+	if (e1->offset < e2->offset) return -1;
+	if (e1->offset > e2->offset) return 1;
+	return 0;
+}
+
+GF_EXPORT
+GF_Err gf_isom_extract_meta_items_mem(GF_ISOFile *file, Bool root_meta, u32 track_num, GF_ISOItemData *items, u32 nb_items, Bool use_annex_b)
+{
+	u32 i, j, count, nb_extents=0, nb_runs=0;
+	ItemBatchEntry *entries = NULL;
+	ItemBatchExtent *extents = NULL, **sorted = NULL;
+	ItemBatchRun *runs = NULL, *run;
+	GF_Err e = GF_OK;
+	GF_MetaBox *meta = gf_isom_get_meta(file, root_meta, track_num);
+	if (!meta || !meta->item_infos || !meta->item_locations || !items) return GF_BAD_PARAM;
+	if (!nb_items) return GF_OK;
+
+	entries = gf_malloc(sizeof(ItemBatchEntry) * nb_items);
+	if (!entries) return GF_OUT_OF_MEM;
+	memset(entries, 0, sizeof(ItemBatchEntry) * nb_items);
+
+	//locate all items
+	for (i=0; i<nb_items; i++) {
+		u32 item_num = gf_isom_get_meta_item_by_id(file, root_meta, track_num, items[i].item_id);
+		items[i].mime = NULL;
+		if (item_num) {
+			GF_ItemInfoEntryBox *item_entry = (GF_ItemInfoEntryBox *)gf_list_get(meta->item_infos->item_infos, item_num-1);
+			items[i].mime = item_entry->content_type;
+			entries[i].item_type = item_entry->item_type;
+		}
+		items[i].e = meta_item_locate(file, meta, items[i].item_id, item_num, &entries[i].location, &entries[i].idat_offset);
+		if (items[i].e || !entries[i].location) {
+			entries[i].location = NULL;
+			items[i].size = 0;
+			continue;
+		}
+		entries[i].first_extent = nb_extents;
+		nb_extents += gf_list_count(entries[i].location->extent_entries);
+	}
+	if (!nb_extents) goto write_items;
+
+	extents = gf_malloc(sizeof(ItemBatchExtent) * nb_extents);
+	sorted = gf_malloc(sizeof(ItemBatchExtent *) * nb_extents);
+	runs = gf_malloc(sizeof(ItemBatchRun) * nb_extents);
+	if (!extents || !sorted || !runs) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	memset(runs, 0, sizeof(ItemBatchRun) * nb_extents);
+
+	//collect extents in item order
+	for (i=0; i<nb_items; i++) {
+		GF_ItemLocationEntry *location = entries[i].location;
+		if (!location) continue;
+		count = gf_list_count(location->extent_entries);
+		for (j=0; j<count; j++) {
+			GF_ItemExtentEntry *extent_entry = (GF_ItemExtentEntry *)gf_list_get(location->extent_entries, j);
+			ItemBatchExtent *ext = &extents[entries[i].first_extent + j];
+			ext->offset = entries[i].idat_offset + location->base_offset + extent_entry->extent_offset;
+			ext->length = extent_entry->extent_length;
+			ext->run_idx = -1;
+			ext->run_offset = 0;
+			sorted[entries[i].first_extent + j] = ext;
+		}
+	}
+
+	//coalesce extents in file order
+	qsort(sorted, nb_extents, sizeof(ItemBatchExtent *), item_batch_extent_cmp);
+	run = NULL;
+	for (i=0; i<nb_extents; i++) {
+		ItemBatchExtent *ext = sorted[i];
+		if (!ext->length || (ext->length > ITEM_READ_MAX_RUN)) continue;
+		if (run) {
+			u64 run_end = run->offset + run->size;
+			u64 new_end = MAX(run_end, ext->offset + ext->length);
+			if ((ext->offset <= run_end + ITEM_READ_MAX_GAP) && (new_end - run->offset <= ITEM_READ_MAX_RUN)) {
+				run->size = (u32) (new_end - run->offset);
+				ext->run_idx = nb_runs-1;
+				ext->run_offset = (u32) (ext->offset - run->offset);
+				continue;
+			}
+		}
+		run = &runs[nb_runs];
+		run->offset = ext->offset;
+		run->size = (u32) ext->length;
+		ext->run_idx = nb_runs;
+		nb_runs++;
+	}
+
+	for (i=0; i<nb_runs; i++) {
+		run = &runs[i];
+		run->data = gf_malloc(run->size);
+		if (!run->data) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		gf_bs_seek(file->movieFileMap->bs, run->offset);
+		//truncated read, extents beyond the end of the read will be invalid
+		run->size = gf_bs_read_data(file->movieFileMap->bs, run->data, run->size);
+	}
+
+write_items:
+	for (i=0; i<nb_items; i++) {
+		GF_BitStream *item_bs;
+		u32 nalu_size_length = 0;
+		if (!entries[i].location) continue;
+
+		item_bs = gf_bs_new(items[i].data, items[i].data ? items[i].alloc_size : 0, GF_BITSTREAM_WRITE_DYN);
+		if (!item_bs) {
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		items[i].e = meta_item_write_config(meta, items[i].item_id, entries[i].item_type, item_bs, use_annex_b, &nalu_size_length);
+		if (items[i].e) {
+			gf_bs_del(item_bs);
+			items[i].size = 0;
+			continue;
+		}
+		count = gf_list_count(entries[i].location->extent_entries);
+		for (j=0; j<count; j++) {
+			GF_Err ext_e;
+			ItemBatchExtent *ext = &extents[entries[i].first_extent + j];
+			if (ext->run_idx>=0) {
+				run = &runs[ext->run_idx];
+				if (ext->run_offset + ext->length > run->size) {
+					ext_e = GF_ISOM_INVALID_FILE;
+				} else {
+					GF_BitStream *run_bs = gf_bs_new(run->data + ext->run_offset, ext->length, GF_BITSTREAM_READ);
+					ext_e = meta_item_copy_extent(run_bs, item_bs, ext->length, nalu_size_length, use_annex_b);
+					gf_bs_del(run_bs);
+				}
+			} else {
+				gf_bs_seek(file->movieFileMap->bs, ext->offset);
+				ext_e = meta_item_copy_extent(file->movieFileMap->bs, item_bs, ext->length, nalu_size_length, use_annex_b);
+			}
+			if (ext_e) items[i].e = ext_e;
+		}
+		gf_bs_get_content_no_truncate(item_bs, &items[i].data, &items[i].size, &items[i].alloc_size);
+		gf_bs_del(item_bs);
+	}
+
+exit:
+	for (i=0; i<nb_runs; i++) {
+		if (runs[i].data) gf_free(runs[i].data);
+	}
+	if (runs) gf_free(runs);
+	if (sorted) gf_free(sorted);
+	if (extents) gf_free(extents);
+	gf_free(entries);
+	return e;
+}
+
 GF_EXPORT
 GF_Err gf_isom_extract_meta_item_get_cenc_info(GF_ISOFile *file, Bool root_meta, u32 track_num, u32 item_id, Bool *is_protected,
 	u32 *skip_byte_block, u32 *crypt_byte_block, const u8 **key_info, u32 *key_info_size, u32 *aux_info_type_param,
@@ -2091,7 +2310,8 @@ void gf_isom_meta_restore_items_ref(GF_ISOFile *movie, GF_MetaBox *meta)
 				GF_Err e;
 				u32 chunk, di, samp_size;
 				u64 samp_offset;
-				samp_size = stsz->sampleSize ? stsz->sampleSize : stsz->sizes[k];
+				samp_size = 0;
+				stbl_GetSampleSize(stsz, k+1, &samp_size);
 				if (samp_size != entry->extent_length)
 					continue;
 
@@ -500,6 +500,9 @@ GF_Err gf_isom_set_fragment_option(GF_ISOFile *movie, GF_ISOTrackID TrackID, GF_
 	case GF_ISOM_TFHD_FORCE_MOOF_BASE_OFFSET:
 		movie->force_moof_base_offset = Param;
 		break;
+	case GF_ISOM_MOOF_GENERIC_WRITE:
+		movie->moof_generic_write = Param ? GF_TRUE : GF_FALSE;
+		break;
 	case GF_ISOM_TRAF_USE_SAMPLE_DEPS_BOX:
 		traf = gf_isom_get_traf(movie, TrackID);
 		if (!traf) return GF_BAD_PARAM;
@@ -958,6 +961,239 @@ void flush_ref_samples(GF_ISOFile *movie, u64 *out_seg_size, Bool is_last_moof)
 
 GF_Err gf_bs_grow(GF_BitStream *bs, u32 addSize);
 
+/*fast moof serializer, used when the moof only contains mfhd and trafs made of tfhd, tfdt and truns, which is the case for
+most live and CMAF fragments. Box sizes are computed directly from the box flags, and the moof is written
+in a preallocated buffer. The output is identical to the generic box writer*/
+
+static Bool moof_fast_box_ok(GF_Box *a)
+{
+	if (gf_isom_box_is_disabled(a)) return GF_FALSE;
+	if (a->child_boxes && gf_list_count(a->child_boxes)) return GF_FALSE;
+	return GF_TRUE;
+}
+
+static Bool moof_fast_write_eligible(GF_ISOFile *movie)
+{
+	u32 i, j;
+	GF_Box *a;
+	GF_MovieFragmentBox *moof = movie->moof;
+	if (movie->moof_generic_write) return GF_FALSE;
+	if (gf_isom_box_is_disabled((GF_Box *)moof) || gf_list_count(moof->PSSHs)) return GF_FALSE;
+
+	i=0;
+	while ((a = (GF_Box *)gf_list_enum(moof->child_boxes, &i))) {
+		GF_TrackFragmentBox *traf = (GF_TrackFragmentBox *)a;
+		if (a->type == GF_ISOM_BOX_TYPE_MFHD) {
+			if (!moof_fast_box_ok(a)) return GF_FALSE;
+			continue;
+		}
+		if ((a->type != GF_ISOM_BOX_TYPE_TRAF) || gf_isom_box_is_disabled(a)) return GF_FALSE;
+		if (!traf->tfhd) return GF_FALSE;
+
+		j=0;
+		while ((a = (GF_Box *)gf_list_enum(traf->child_boxes, &j))) {
+			GF_TrackFragmentRunBox *trun = (GF_TrackFragmentRunBox *)a;
+			switch (a->type) {
+			case GF_ISOM_BOX_TYPE_TFHD:
+			case GF_ISOM_BOX_TYPE_TFDT:
+				if (!moof_fast_box_ok(a)) return GF_FALSE;
+				break;
+			case GF_ISOM_BOX_TYPE_TRUN:
+				if (!moof_fast_box_ok(a) || trun->sample_order) return GF_FALSE;
+#ifdef GF_ENABLE_CTRN
+				if (trun->use_ctrn) return GF_FALSE;
+#endif
+				break;
+			default:
+				return GF_FALSE;
+			}
+		}
+	}
+	return GF_TRUE;
+}
+
+static u32 moof_fast_tfhd_size(u32 flags)
+{
+	u32 size = 16;
+	if (flags & GF_ISOM_TRAF_BASE_OFFSET) size += 8;
+	if (flags & GF_ISOM_TRAF_SAMPLE_DESC) size += 4;
+	if (flags & GF_ISOM_TRAF_SAMPLE_DUR) size += 4;
+	if (flags & GF_ISOM_TRAF_SAMPLE_SIZE) size += 4;
+	if (flags & GF_ISOM_TRAF_SAMPLE_FLAGS) size += 4;
+	return size;
+}
+
+static u32 moof_fast_trun_size(u32 flags, u32 nb_samples)
+{
+	u32 size = 16, entry_size = 0;
+	if (flags & GF_ISOM_TRUN_DATA_OFFSET) size += 4;
+	if (flags & GF_ISOM_TRUN_FIRST_FLAG) size += 4;
+	if (flags & GF_ISOM_TRUN_DURATION) entry_size += 4;
+	if (flags & GF_ISOM_TRUN_SIZE) entry_size += 4;
+	if (flags & GF_ISOM_TRUN_FLAGS) entry_size += 4;
+	if (flags & GF_ISOM_TRUN_CTS_OFFSET) entry_size += 4;
+	return size + nb_samples * entry_size;
+}
+
+//same as gf_isom_box_size on the moof, including child reordering
+static void moof_fast_size(GF_ISOFile *movie)
+{
+	u32 i, j, pos;
+	GF_TrackFragmentBox *traf;
+	GF_MovieFragmentBox *moof = movie->moof;
+
+	pos = 0;
+	gf_isom_check_position((GF_Box *)moof, (GF_Box *)moof->mfhd, &pos);
+	gf_isom_check_position_list((GF_Box *)moof, moof->TrackList, &pos);
+
+	moof->size = 8;
+	if (moof->mfhd) {
+		moof->mfhd->size = 16;
+		moof->size += 16;
+	}
+	i=0;
+	while ((traf = (GF_TrackFragmentBox *)gf_list_enum(moof->TrackList, &i))) {
+		GF_TrackFragmentRunBox *trun;
+
+		pos = 0;
+		gf_isom_check_position((GF_Box *)traf, (GF_Box *)traf->tfhd, &pos);
+		gf_isom_check_position((GF_Box *)traf, (GF_Box *)traf->tfdt, &pos);
+		gf_isom_check_position_list((GF_Box *)traf, traf->TrackRuns, &pos);
+
+		traf->size = 8;
+		traf->tfhd->size = moof_fast_tfhd_size(traf->tfhd->flags);
+		traf->size += traf->tfhd->size;
+
+		if (traf->tfdt) {
+			if (!traf->tfdt->version && (traf->tfdt->baseMediaDecodeTime<=0xFFFFFFFF)) {
+				traf->tfdt->size = 16;
+			} else {
+				traf->tfdt->version = 1;
+				traf->tfdt->size = 20;
+			}
+			traf->size += traf->tfdt->size;
+		}
+		j=0;
+		while ((trun = (GF_TrackFragmentRunBox *)gf_list_enum(traf->TrackRuns, &j))) {
+			trun->size = moof_fast_trun_size(trun->flags, trun->nb_samples);
+			traf->size += trun->size;
+		}
+		moof->size += traf->size;
+	}
+}
+
+#define MOOF_PUT_U32(_v) { u32 __v = (u32) (_v); ptr[0] = (__v>>24) & 0xFF; ptr[1] = (__v>>16) & 0xFF; ptr[2] = (__v>>8) & 0xFF; ptr[3] = __v & 0xFF; ptr += 4; }
+#define MOOF_PUT_U64(_v) { MOOF_PUT_U32( ((u64)(_v))>>32 ); MOOF_PUT_U32( (_v) & 0xFFFFFFFF ); }
+#define MOOF_PUT_FULL_HDR(_b) { MOOF_PUT_U32((_b)->size); MOOF_PUT_U32((_b)->type); MOOF_PUT_U32( ((u32)(_b)->version<<24) | ((_b)->flags & 0x00FFFFFF) ); }
+
+//serializes the moof sized by moof_fast_size
+static GF_Err moof_fast_write(GF_ISOFile *movie, GF_BitStream *bs)
+{
+	u32 i, j, k;
+	u8 *ptr;
+	GF_Box *a;
+	GF_MovieFragmentBox *moof = movie->moof;
+
+	if (moof->size > movie->moof_buffer_alloc) {
+		u8 *buf = gf_realloc(movie->moof_buffer, (u32) moof->size);
+		if (!buf) return GF_OUT_OF_MEM;
+		movie->moof_buffer = buf;
+		movie->moof_buffer_alloc = (u32) moof->size;
+	}
+	ptr = movie->moof_buffer;
+	MOOF_PUT_U32(moof->size);
+	MOOF_PUT_U32(moof->type);
+
+	i=0;
+	while ((a = (GF_Box *)gf_list_enum(moof->child_boxes, &i))) {
+		GF_TrackFragmentBox *traf = (GF_TrackFragmentBox *)a;
+		if (a->type == GF_ISOM_BOX_TYPE_MFHD) {
+			MOOF_PUT_FULL_HDR(moof->mfhd);
+			MOOF_PUT_U32(moof->mfhd->sequence_number);
+			continue;
+		}
+		MOOF_PUT_U32(traf->size);
+		MOOF_PUT_U32(traf->type);
+
+		j=0;
+		while ((a = (GF_Box *)gf_list_enum(traf->child_boxes, &j))) {
+			if (a->type == GF_ISOM_BOX_TYPE_TFHD) {
+				GF_TrackFragmentHeaderBox *tfhd = (GF_TrackFragmentHeaderBox *)a;
+				MOOF_PUT_FULL_HDR(tfhd);
+				MOOF_PUT_U32(tfhd->trackID);
+				if (tfhd->flags & GF_ISOM_TRAF_BASE_OFFSET) MOOF_PUT_U64(tfhd->base_data_offset);
+				if (tfhd->flags & GF_ISOM_TRAF_SAMPLE_DESC) MOOF_PUT_U32(tfhd->sample_desc_index);
+				if (tfhd->flags & GF_ISOM_TRAF_SAMPLE_DUR) MOOF_PUT_U32(tfhd->def_sample_duration);
+				if (tfhd->flags & GF_ISOM_TRAF_SAMPLE_SIZE) MOOF_PUT_U32(tfhd->def_sample_size);
+				if (tfhd->flags & GF_ISOM_TRAF_SAMPLE_FLAGS) MOOF_PUT_U32(tfhd->def_sample_flags);
+			}
+			else if (a->type == GF_ISOM_BOX_TYPE_TFDT) {
+				GF_TFBaseMediaDecodeTimeBox *tfdt = (GF_TFBaseMediaDecodeTimeBox *)a;
+				MOOF_PUT_FULL_HDR(tfdt);
+				if (tfdt->version==1) {
+					MOOF_PUT_U64(tfdt->baseMediaDecodeTime);
+				} else {
+					MOOF_PUT_U32(tfdt->baseMediaDecodeTime);
+				}
+			}
+			else {
+				GF_TrackFragmentRunBox *trun = (GF_TrackFragmentRunBox *)a;
+				MOOF_PUT_FULL_HDR(trun);
+				MOOF_PUT_U32(trun->sample_count);
+				if (trun->flags & GF_ISOM_TRUN_DATA_OFFSET) MOOF_PUT_U32(trun->data_offset);
+				if (trun->flags & GF_ISOM_TRUN_FIRST_FLAG) MOOF_PUT_U32(trun->first_sample_flags);
+
+				switch (trun->flags & (GF_ISOM_TRUN_DURATION | GF_ISOM_TRUN_SIZE | GF_ISOM_TRUN_FLAGS | GF_ISOM_TRUN_CTS_OFFSET)) {
+				case 0:
+					break;
+				//most common layouts
+				case GF_ISOM_TRUN_SIZE:
+					for (k=0; k<trun->nb_samples; k++) {
+						MOOF_PUT_U32(trun->samples[k].size);
+					}
+					break;
+				case GF_ISOM_TRUN_SIZE | GF_ISOM_TRUN_CTS_OFFSET:
+					for (k=0; k<trun->nb_samples; k++) {
+						MOOF_PUT_U32(trun->samples[k].size);
+						MOOF_PUT_U32(trun->samples[k].CTS_Offset);
+					}
+					break;
+				default:
+					for (k=0; k<trun->nb_samples; k++) {
+						GF_TrunEntry *ent = &trun->samples[k];
+						if (trun->flags & GF_ISOM_TRUN_DURATION) MOOF_PUT_U32(ent->Duration);
+						if (trun->flags & GF_ISOM_TRUN_SIZE) MOOF_PUT_U32(ent->size);
+						if (trun->flags & GF_ISOM_TRUN_FLAGS) MOOF_PUT_U32(ent->flags);
+						if (trun->flags & GF_ISOM_TRUN_CTS_OFFSET) MOOF_PUT_U32(ent->CTS_Offset);
+					}
+					break;
+				}
+			}
+		}
+	}
+	if (ptr - movie->moof_buffer != moof->size) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Fast moof write wrote %u bytes but size is "LLU"\n", (u32) (ptr - movie->moof_buffer), moof->size));
+		return GF_SERVICE_ERROR;
+	}
+	if (gf_bs_write_data(bs, movie->moof_buffer, (u32) moof->size) != moof->size)
+		return GF_IO_ERR;
+	movie->nb_fast_moofs++;
+	return GF_OK;
+}
+
+static GF_Err moof_compute_size(GF_ISOFile *movie, Bool *use_fast)
+{
+	*use_fast = moof_fast_write_eligible(movie);
+	if (! *use_fast) return gf_isom_box_size((GF_Box *) movie->moof);
+	moof_fast_size(movie);
+	//large size not handled by fast writer
+	if (movie->moof->size > 0xFFFFFFFF) {
+		*use_fast = GF_FALSE;
+		return gf_isom_box_size((GF_Box *) movie->moof);
+	}
+	return GF_OK;
+}
+
 static GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_offset_diff, u32 *moof_size, Bool reassign_bs)
 {
 	GF_Err e;
@@ -968,6 +1204,7 @@ static GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_off
 	GF_TrackFragmentBox *traf;
 	GF_TrackFragmentRunBox *trun;
 	GF_BitStream *bs, *bs_orig;
+	Bool fast_write = GF_FALSE;
 	if (!movie->moof) return GF_OK;
 
 	bs = movie->editFileMap->bs;
@@ -1129,7 +1366,7 @@ static GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_off
 #ifndef USE_BASE_DATA_OFFSET
 	offset = 0;
 	if (movie->use_segments || movie->force_moof_base_offset) {
-		e = gf_isom_box_size((GF_Box *) movie->moof);
+		e = moof_compute_size(movie, &fast_write);
 		if (e) return e;
 		offset = (s32) movie->moof->size;
 		/*mdat size & type*/
@@ -1169,7 +1406,7 @@ static GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_off
 	}
 
 	//4- Write moof
-	e = gf_isom_box_size((GF_Box *) movie->moof);
+	e = moof_compute_size(movie, &fast_write);
 	if (e) return e;
 	/*moof first, update traf headers - THIS WILL IMPACT THE MOOF SIZE IF WE
 	DECIDE NOT TO USE THE DATA-OFFSET FLAG*/
@@ -1193,7 +1430,7 @@ static GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_off
 		if (offset != (movie->moof->size+8)) {
 			offset = (s32) (movie->moof->size + 8 - offset);
 			update_trun_offsets(movie, offset);
-			e = gf_isom_box_size((GF_Box *) movie->moof);
+			e = moof_compute_size(movie, &fast_write);
 			if (e) return e;
 		}
 	}
@@ -1266,6 +1503,8 @@ static GF_Err StoreFragment(GF_ISOFile *movie, Bool load_mdat_only, s32 data_off
 
 	if (movie->compress_mode>GF_ISOM_COMP_MOOV) {
 		e = gf_isom_write_compressed_box(movie, (GF_Box *) movie->moof, GF_4CC('!', 'm', 'o', 'f'), bs, moof_size);
+	} else if (fast_write) {
+		e = moof_fast_write(movie, bs);
 	} else {
 		e = gf_isom_box_write((GF_Box *) movie->moof, bs);
 	}
@@ -2930,6 +3169,7 @@ GF_Err gf_isom_fragment_add_sample_ex(GF_ISOFile *movie, GF_ISOTrackID TrackID,
 		sample = od_sample;
 	}
 
+	gf_isom_sample_hash_add(movie, traf->trex->track, sample->data, sample->dataLength, sample->nb_pack ? sample->nb_pack : 1);
 	ent.size = sample->dataLength;
 	trun->samples[trun->nb_samples] = ent;
 	trun->nb_samples ++;
@@ -3093,6 +3333,7 @@ GF_Err gf_isom_fragment_append_data_ex(GF_ISOFile *movie, GF_ISOTrackID TrackID,
 	degp = GF_ISOM_GET_FRAG_DEG(ent->flags);
 	ent->flags = GF_ISOM_FORMAT_FRAG_FLAGS(PaddingBits, rap, degp);
 
+	gf_isom_sample_hash_add(movie, traf->trex->track, data, data_size, 0);
 	//finally write the data
 	if (!traf->DataCache) {
 		if (movie->moof_first && movie->on_block_out && (ref || trun->sample_refs)) {
@@ -27,6 +27,286 @@
 
 #ifndef GPAC_DISABLE_ISOM
 
+typedef struct
+{
+	u32 first, count;
+	u64 *values;
+} GF_ISOLazyWindow;
+
+GF_ISOLazyTable *gf_isom_lazy_table_new(GF_BitStream *bs, u32 nb_entries, u32 nb_bits)
+{
+	GF_ISOLazyTable *lt;
+	u32 max_windows;
+	if (!(gf_bs_get_cookie(bs) & GF_ISOM_BS_COOKIE_LAZY_STBL)) return NULL;
+	//small tables are always loaded
+	if (nb_entries <= GF_ISOM_LAZY_WINDOW) return NULL;
+	max_windows = gf_opts_get_int("core", "isom-lazy");
+	if (!max_windows) return NULL;
+
+	GF_SAFEALLOC(lt, GF_ISOLazyTable);
+	if (!lt) return NULL;
+	lt->windows = gf_list_new();
+	if (!lt->windows) {
+		gf_free(lt);
+		return NULL;
+	}
+	lt->bs = bs;
+	lt->offset = gf_bs_get_position(bs);
+	lt->nb_bits = nb_bits;
+	lt->nb_entries = nb_entries;
+	lt->max_windows = max_windows;
+	return lt;
+}
+
+void gf_isom_lazy_table_del(GF_ISOLazyTable *lt)
+{
+	if (!lt) return;
+	while (gf_list_count(lt->windows)) {
+		GF_ISOLazyWindow *win = gf_list_pop_back(lt->windows);
+		gf_free(win->values);
+		gf_free(win);
+	}
+	gf_list_del(lt->windows);
+	gf_free(lt);
+}
+
+u64 gf_isom_lazy_table_get(GF_ISOLazyTable *lt, u32 entryIndex)
+{
+	u32 i, count;
+	u64 pos;
+	GF_ISOLazyWindow *win;
+	if (!lt || lt->error || (entryIndex >= lt->nb_entries)) return 0;
+
+	count = gf_list_count(lt->windows);
+	for (i=0; i<count; i++) {
+		win = gf_list_get(lt->windows, i);
+		if ((entryIndex >= win->first) && (entryIndex < win->first + win->count)) {
+			if (i) {
+				gf_list_rem(lt->windows, i);
+				gf_list_insert(lt->windows, win, 0);
+			}
+			return win->values[entryIndex - win->first];
+		}
+	}
+	//recycle least recently used window
+	if (count >= lt->max_windows) {
+		win = gf_list_pop_back(lt->windows);
+	} else {
+		GF_SAFEALLOC(win, GF_ISOLazyWindow);
+		if (!win) return 0;
+		win->values = gf_malloc(sizeof(u64) * GF_ISOM_LAZY_WINDOW);
+		if (!win->values) {
+			gf_free(win);
+			return 0;
+		}
+	}
+	win->first = entryIndex - (entryIndex % GF_ISOM_LAZY_WINDOW);
+	win->count = MIN(GF_ISOM_LAZY_WINDOW, lt->nb_entries - win->first);
+
+	//bitstream is shared with sample data and box parsing, restore position
+	pos = gf_bs_get_position(lt->bs);
+	gf_bs_seek(lt->bs, lt->offset + ((u64) win->first * lt->nb_bits) / 8);
+	for (i=0; i<win->count; i++) {
+		win->values[i] = gf_bs_read_long_int(lt->bs, lt->nb_bits);
+	}
+	//file truncated or modified since the table was parsed
+	if (gf_bs_is_overflow(lt->bs)) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[iso file] Failed to read sample table entries %u to %u from file, table is corrupted\n", win->first, win->first + win->count - 1));
+		lt->error = GF_ISOM_INVALID_FILE;
+		gf_free(win->values);
+		gf_free(win);
+		gf_bs_seek(lt->bs, pos);
+		return 0;
+	}
+	gf_bs_seek(lt->bs, pos);
+
+	gf_list_insert(lt->windows, win, 0);
+	return win->values[entryIndex - win->first];
+}
+
+GF_Err gf_isom_box_unlazy(GF_Box *a)
+{
+	u32 i;
+	if (!a) return GF_OK;
+	switch (a->type) {
+	case GF_ISOM_BOX_TYPE_STSZ:
+	case GF_ISOM_BOX_TYPE_STZ2:
+	{
+		GF_SampleSizeBox *stsz = (GF_SampleSizeBox *)a;
+		if (!stsz->lazy) return GF_OK;
+		stsz->sizes = gf_malloc(sizeof(u32) * stsz->sampleCount);
+		if (!stsz->sizes) return GF_OUT_OF_MEM;
+		stsz->alloc_size = stsz->sampleCount;
+		for (i=0; i<stsz->sampleCount; i++)
+			stsz->sizes[i] = (u32) gf_isom_lazy_table_get(stsz->lazy, i);
+		if (stsz->lazy->error) {
+			gf_free(stsz->sizes);
+			stsz->sizes = NULL;
+			stsz->alloc_size = 0;
+			return stsz->lazy->error;
+		}
+		gf_isom_lazy_table_del(stsz->lazy);
+		stsz->lazy = NULL;
+		return GF_OK;
+	}
+	case GF_ISOM_BOX_TYPE_STCO:
+	{
+		GF_ChunkOffsetBox *stco = (GF_ChunkOffsetBox *)a;
+		if (!stco->lazy) return GF_OK;
+		stco->offsets = gf_malloc(sizeof(u32) * stco->nb_entries);
+		if (!stco->offsets) return GF_OUT_OF_MEM;
+		stco->alloc_size = stco->nb_entries;
+		for (i=0; i<stco->nb_entries; i++)
+			stco->offsets[i] = (u32) gf_isom_lazy_table_get(stco->lazy, i);
+		if (stco->lazy->error) {
+			gf_free(stco->offsets);
+			stco->offsets = NULL;
+			stco->alloc_size = 0;
+			return stco->lazy->error;
+		}
+		gf_isom_lazy_table_del(stco->lazy);
+		stco->lazy = NULL;
+		return GF_OK;
+	}
+	case GF_ISOM_BOX_TYPE_CO64:
+	{
+		GF_ChunkLargeOffsetBox *co64 = (GF_ChunkLargeOffsetBox *)a;
+		if (!co64->lazy) return GF_OK;
+		co64->offsets = gf_malloc(sizeof(u64) * co64->nb_entries);
+		if (!co64->offsets) return GF_OUT_OF_MEM;
+		co64->alloc_size = co64->nb_entries;
+		for (i=0; i<co64->nb_entries; i++)
+			co64->offsets[i] = gf_isom_lazy_table_get(co64->lazy, i);
+		if (co64->lazy->error) {
+			gf_free(co64->offsets);
+			co64->offsets = NULL;
+			co64->alloc_size = 0;
+			return co64->lazy->error;
+		}
+		gf_isom_lazy_table_del(co64->lazy);
+		co64->lazy = NULL;
+		return GF_OK;
+	}
+	case GF_ISOM_BOX_TYPE_CTTS:
+	{
+		GF_CompositionOffsetBox *ctts = (GF_CompositionOffsetBox *)a;
+		if (!ctts->lazy) return GF_OK;
+		ctts->entries = gf_malloc(sizeof(GF_DttsEntry) * ctts->nb_entries);
+		if (!ctts->entries) return GF_OUT_OF_MEM;
+		ctts->alloc_size = ctts->nb_entries;
+		for (i=0; i<ctts->nb_entries; i++)
+			stbl_GetCompositionEntry(ctts, i, &ctts->entries[i].sampleCount, &ctts->entries[i].decodingOffset);
+		if (ctts->lazy->error) {
+			gf_free(ctts->entries);
+			ctts->entries = NULL;
+			ctts->alloc_size = 0;
+			return ctts->lazy->error;
+		}
+		gf_isom_lazy_table_del(ctts->lazy);
+		ctts->lazy = NULL;
+		return GF_OK;
+	}
+	}
+	return GF_OK;
+}
+
+GF_Err stbl_unlazy(GF_SampleTableBox *stbl)
+{
+	GF_Err e;
+	if (!stbl) return GF_OK;
+	e = gf_isom_box_unlazy((GF_Box *) stbl->SampleSize);
+	if (!e) e = gf_isom_box_unlazy(stbl->ChunkOffset);
+	if (!e) e = gf_isom_box_unlazy((GF_Box *) stbl->CompositionOffset);
+	return e;
+}
+
+GF_Err gf_isom_unlazy_tables(GF_ISOFile *mov)
+{
+	u32 i=0;
+	GF_TrackBox *trak;
+	if (!mov || !mov->moov) return GF_OK;
+	while ((trak = gf_list_enum(mov->moov->trackList, &i))) {
+		GF_Err e;
+		if (!trak->Media || !trak->Media->information) continue;
+		e = stbl_unlazy(trak->Media->information->sampleTable);
+		if (e) return e;
+	}
+	return GF_OK;
+}
+
+GF_Err stbl_GetChunkOffset(GF_Box *stco, u32 chunkNumber, u64 *offset)
+{
+	*offset = 0;
+	if (!stco || !chunkNumber) return GF_BAD_PARAM;
+	if (stco->type == GF_ISOM_BOX_TYPE_STCO) {
+		GF_ChunkOffsetBox *ptr = (GF_ChunkOffsetBox *)stco;
+		if (chunkNumber > ptr->nb_entries) return GF_BAD_PARAM;
+		if (ptr->lazy) {
+			*offset = gf_isom_lazy_table_get(ptr->lazy, chunkNumber-1);
+			return ptr->lazy->error;
+		}
+		if (ptr->offsets) *offset = ptr->offsets[chunkNumber-1];
+	} else {
+		GF_ChunkLargeOffsetBox *ptr = (GF_ChunkLargeOffsetBox *)stco;
+		if (chunkNumber > ptr->nb_entries) return GF_BAD_PARAM;
+		if (ptr->lazy) {
+			*offset = gf_isom_lazy_table_get(ptr->lazy, chunkNumber-1);
+			return ptr->lazy->error;
+		}
+		if (ptr->offsets) *offset = ptr->offsets[chunkNumber-1];
+	}
+	return GF_OK;
+}
+
+GF_Err stbl_GetCompositionEntry(GF_CompositionOffsetBox *ctts, u32 entryIndex, u32 *sampleCount, s32 *decodingOffset)
+{
+	if (!ctts->lazy) {
+		*sampleCount = ctts->entries[entryIndex].sampleCount;
+		*decodingOffset = ctts->entries[entryIndex].decodingOffset;
+		return GF_OK;
+	}
+	//lazy ctts stores sampleCount and decodingOffset as two 32 bit entries
+	*sampleCount = (u32) gf_isom_lazy_table_get(ctts->lazy, 2*entryIndex);
+	*decodingOffset = (s32) (u32) gf_isom_lazy_table_get(ctts->lazy, 2*entryIndex + 1);
+	//same fix as in ctts_box_read
+	if (!ctts->version && (*decodingOffset == INT_MIN))
+		*decodingOffset = 0;
+	return ctts->lazy->error;
+}
+
+//get last checkpoint before the given sample number, or before the given DTS if sample number is 0
+static GF_SttsCheckpoint *stts_get_checkpoint(GF_TimeToSampleBox *stts, u32 SampleNumber, u64 DTS)
+{
+	u32 low, high;
+	if (!stts->r_index_count || (stts->r_index_nb_entries != stts->nb_entries)) return NULL;
+
+	low = 0;
+	high = stts->r_index_count;
+	while (low < high) {
+		u32 mid = low + (high - low) / 2;
+		Bool before = SampleNumber ? (stts->r_index[mid].first_sample <= SampleNumber) : (stts->r_index[mid].dts < DTS);
+		if (before) low = mid + 1;
+		else high = mid;
+	}
+	return low ? &stts->r_index[low-1] : NULL;
+}
+
+//get last checkpoint before the given sample number
+static GF_StscCheckpoint *stsc_get_checkpoint(GF_SampleToChunkBox *stsc, u32 SampleNumber)
+{
+	u32 low, high;
+	if (!stsc->r_index_count || (stsc->r_index_nb_entries != stsc->nb_entries)) return NULL;
+
+	low = 0;
+	high = stsc->r_index_count;
+	while (low < high) {
+		u32 mid = low + (high - low) / 2;
+		if (stsc->r_index[mid].first_sample <= SampleNumber) low = mid + 1;
+		else high = mid;
+	}
+	return low ? &stsc->r_index[low-1] : NULL;
+}
+
 //Get the sample number
 GF_Err stbl_findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *sampleNumber, u32 *prevSampleNumber)
 {
@@ -34,6 +314,7 @@ GF_Err stbl_findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *s
 	s32 CTSOffset;
 	u64 curDTS;
 	GF_SttsEntry *ent;
+	GF_SttsCheckpoint *cp;
 	(*sampleNumber) = 0;
 	(*prevSampleNumber) = 0;
 
@@ -58,6 +339,13 @@ GF_Err stbl_findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *s
 		curSampNum = stbl->TimeToSample->r_FirstSampleInEntry = 1;
 		stbl->TimeToSample->r_currentEntryIndex = 0;
 	}
+	//jump to the closest checkpoint if after our cache
+	cp = stts_get_checkpoint(stbl->TimeToSample, 0, DTS);
+	if (cp && (cp->entry_index > i)) {
+		i = stbl->TimeToSample->r_currentEntryIndex = cp->entry_index;
+		curDTS = stbl->TimeToSample->r_CurrentDTS = cp->dts;
+		curSampNum = stbl->TimeToSample->r_FirstSampleInEntry = cp->first_sample;
+	}
 
 #if 0
 	//we need to validate our cache if we are using CTS because of B-frames and co...
@@ -96,10 +384,17 @@ GF_Err stbl_findEntryForTime(GF_SampleTableBox *stbl, u64 DTS, u8 useCTS, u32 *s
 		{
 			CTSOffset = 0;
 		}
-		for (j=0; j<ent->sampleCount; j++) {
+		if (ent->sampleCount) {
 			if (curDTS + CTSOffset >= DTS) goto entry_found;
-			curSampNum += 1;
-			curDTS += ent->sampleDelta;
+			//DTS in this entry, get the first sample at or after DTS
+			if (ent->sampleDelta && (curDTS + CTSOffset + (u64)ent->sampleDelta * (ent->sampleCount-1) >= DTS)) {
+				j = (u32) ((DTS - curDTS - CTSOffset + ent->sampleDelta - 1) / ent->sampleDelta);
+				curSampNum += j;
+				curDTS += (u64)j * ent->sampleDelta;
+				goto entry_found;
+			}
+			curSampNum += ent->sampleCount;
+			curDTS += (u64)ent->sampleCount * ent->sampleDelta;
 		}
 		//we're switching to the next entry, update the cache!
 		stbl->TimeToSample->r_CurrentDTS += (u64)ent->sampleCount * ent->sampleDelta;
@@ -138,6 +433,9 @@ GF_Err stbl_GetSampleSize(GF_SampleSizeBox *stsz, u32 SampleNumber, u32 *Size)
 		(*Size) = stsz->sampleSize;
 	} else if (stsz->sizes) {
 		(*Size) = stsz->sizes[SampleNumber - 1];
+	} else if (stsz->lazy) {
+		(*Size) = (u32) gf_isom_lazy_table_get(stsz->lazy, SampleNumber - 1);
+		return stsz->lazy->error;
 	} else {
 		(*Size) = 0;
 	}
@@ -162,6 +460,22 @@ GF_Err stbl_GetSampleCTS(GF_CompositionOffsetBox *ctts, u32 SampleNumber, s32 *C
 		ctts->r_currentEntryIndex = 0;
 		i = 0;
 	}
+	if (ctts->lazy) {
+		u32 count=0;
+		s32 offset=0;
+		for (; i< ctts->nb_entries; i++) {
+			GF_Err e = stbl_GetCompositionEntry(ctts, i, &count, &offset);
+			if (e) return e;
+			if (SampleNumber < ctts->r_FirstSampleInEntry + count) break;
+			ctts->r_currentEntryIndex += 1;
+			ctts->r_FirstSampleInEntry += count;
+		}
+		if (i==ctts->nb_entries) return GF_OK;
+		if (SampleNumber >= ctts->r_FirstSampleInEntry + count) return GF_OK;
+		(*CTSoffset) = offset;
+		return GF_OK;
+	}
+
 	for (; i< ctts->nb_entries; i++) {
 		if (SampleNumber < ctts->r_FirstSampleInEntry + ctts->entries[i].sampleCount) break;
 		//update our cache
@@ -181,6 +495,7 @@ GF_Err stbl_GetSampleDTS_and_Duration(GF_TimeToSampleBox *stts, u32 SampleNumber
 {
 	u32 i, j, count;
 	GF_SttsEntry *ent;
+	GF_SttsCheckpoint *cp;
 
 	(*DTS) = 0;
 	if (duration) {
@@ -202,6 +517,13 @@ GF_Err stbl_GetSampleDTS_and_Duration(GF_TimeToSampleBox *stts, u32 SampleNumber
 		stts->r_FirstSampleInEntry = 1;
 		stts->r_CurrentDTS = 0;
 	}
+	//jump to the closest checkpoint if after our cache
+	cp = stts_get_checkpoint(stts, SampleNumber, 0);
+	if (cp && (cp->entry_index > i)) {
+		i = stts->r_currentEntryIndex = cp->entry_index;
+		stts->r_FirstSampleInEntry = cp->first_sample;
+		stts->r_CurrentDTS = cp->dts;
+	}
 
 	for (; i < count; i++) {
 		ent = &stts->entries[i];
@@ -398,6 +720,71 @@ void GetGhostNum(GF_StscEntry *ent, u32 EntryIndex, u32 count, GF_SampleTableBox
 	stbl->SampleToChunk->ghostNumber = ghostNum;
 }
 
+GF_Err stbl_build_index(GF_SampleTableBox *stbl, u32 interval)
+{
+	u32 i, sample_num;
+	u64 dts;
+	GF_TimeToSampleBox *stts;
+	GF_SampleToChunkBox *stsc;
+	if (!stbl) return GF_OK;
+
+	stts = stbl->TimeToSample;
+	stsc = stbl->SampleToChunk;
+	if (stts) {
+		if (stts->r_index) gf_free(stts->r_index);
+		stts->r_index = NULL;
+		stts->r_index_count = stts->r_index_nb_entries = 0;
+	}
+	if (stsc) {
+		if (stsc->r_index) gf_free(stsc->r_index);
+		stsc->r_index = NULL;
+		stsc->r_index_count = stsc->r_index_nb_entries = 0;
+	}
+	if (!interval) return GF_OK;
+
+	if (stts && (stts->nb_entries > interval)) {
+		stts->r_index = gf_malloc(sizeof(GF_SttsCheckpoint) * (1 + (stts->nb_entries-1) / interval));
+		if (!stts->r_index) return GF_OUT_OF_MEM;
+		sample_num = 1;
+		dts = 0;
+		for (i=0; i<stts->nb_entries; i++) {
+			if (!(i % interval)) {
+				GF_SttsCheckpoint *cp = &stts->r_index[stts->r_index_count];
+				cp->entry_index = i;
+				cp->first_sample = sample_num;
+				cp->dts = dts;
+				stts->r_index_count++;
+			}
+			sample_num += stts->entries[i].sampleCount;
+			dts += (u64)stts->entries[i].sampleCount * stts->entries[i].sampleDelta;
+		}
+		stts->r_index_nb_entries = stts->nb_entries;
+	}
+
+	if (stsc && stbl->ChunkOffset && (stsc->nb_entries > interval)) {
+		//GetGhostNum updates the read cache
+		u32 ghost = stsc->ghostNumber;
+		stsc->r_index = gf_malloc(sizeof(GF_StscCheckpoint) * (1 + (stsc->nb_entries-1) / interval));
+		if (!stsc->r_index) return GF_OUT_OF_MEM;
+		sample_num = 1;
+		for (i=0; i<stsc->nb_entries; i++) {
+			if (!(i % interval)) {
+				GF_StscCheckpoint *cp = &stsc->r_index[stsc->r_index_count];
+				cp->entry_index = i;
+				cp->first_sample = sample_num;
+				stsc->r_index_count++;
+			}
+			if (i+1 < stsc->nb_entries) {
+				GetGhostNum(&stsc->entries[i], i, stsc->nb_entries, stbl);
+				sample_num += stsc->ghostNumber * stsc->entries[i].samplesPerChunk;
+			}
+		}
+		stsc->ghostNumber = ghost;
+		stsc->r_index_nb_entries = stsc->nb_entries;
+	}
+	return GF_OK;
+}
+
 //Get the offset, descIndex and chunkNumber of a sample...
 GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offset, u32 *chunkNumber, u32 *descIndex, GF_StscEntry **out_ent)
 {
@@ -406,6 +793,7 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 	GF_ChunkOffsetBox *stco;
 	GF_ChunkLargeOffsetBox *co64;
 	GF_StscEntry *ent;
+	GF_StscCheckpoint *cp;
 
 	(*offset) = 0;
 	(*chunkNumber) = (*descIndex) = 0;
@@ -421,18 +809,14 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 		if (out_ent) *out_ent = ent;
 		if (stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 			stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
-			if (!stco->offsets) return GF_ISOM_INVALID_FILE;
+			if (!stco->offsets && !stco->lazy) return GF_ISOM_INVALID_FILE;
 			if (stco->nb_entries < sampleNumber) return GF_ISOM_INVALID_FILE;
-
-			(*offset) = (u64) stco->offsets[sampleNumber - 1];
 		} else {
 			co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
-			if (!co64->offsets) return GF_ISOM_INVALID_FILE;
+			if (!co64->offsets && !co64->lazy) return GF_ISOM_INVALID_FILE;
 			if (co64->nb_entries < sampleNumber) return GF_ISOM_INVALID_FILE;
-
-			(*offset) = co64->offsets[sampleNumber - 1];
 		}
-		return GF_OK;
+		return stbl_GetChunkOffset(stbl->ChunkOffset, sampleNumber, offset);
 	}
 
 	//check our cache: if desired sample is at or above current cache entry, start from here
@@ -455,6 +839,16 @@ GF_Err stbl_GetSampleInfos(GF_SampleTableBox *stbl, u32 sampleNumber, u64 *offse
 		GetGhostNum(ent, 0, stbl->SampleToChunk->nb_entries, stbl);
 		k = stbl->SampleToChunk->currentChunk;
 	}
+	//jump to the closest checkpoint if after our cache
+	cp = stsc_get_checkpoint(stbl->SampleToChunk, sampleNumber);
+	if (cp && (cp->entry_index > i)) {
+		i = stbl->SampleToChunk->currentIndex = cp->entry_index;
+		stbl->SampleToChunk->currentChunk = 1;
+		stbl->SampleToChunk->firstSampleInCurrentChunk = cp->first_sample;
+		ent = &stbl->SampleToChunk->entries[i];
+		GetGhostNum(ent, i, stbl->SampleToChunk->nb_entries, stbl);
+		k = 1;
+	}
 
 	//first get the chunk
 	for (; i < stbl->SampleToChunk->nb_entries; i++) {
@@ -535,13 +929,13 @@ sample_found:
 	if ( stbl->ChunkOffset->type == GF_ISOM_BOX_TYPE_STCO) {
 		stco = (GF_ChunkOffsetBox *)stbl->ChunkOffset;
 		if (stco->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = (u64) stco->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
 	} else {
 		co64 = (GF_ChunkLargeOffsetBox *)stbl->ChunkOffset;
 		if (co64->nb_entries < (*chunkNumber) ) return GF_ISOM_INVALID_FILE;
-		(*offset) = co64->offsets[(*chunkNumber) - 1] + (u64) offsetInChunk;
 	}
-	return GF_OK;
+	e = stbl_GetChunkOffset(stbl->ChunkOffset, *chunkNumber, offset);
+	(*offset) += offsetInChunk;
+	return e;
 }
 
 
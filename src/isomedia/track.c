@@ -460,8 +460,53 @@ static u32 saio_get_index(GF_TrackFragmentBox *traf, u32 sample_idx)
 	return saio_idx;
 }
 
+static GF_Err frag_index_append(GF_TrackBox *trak, GF_ISOFragmentIndexEntry *fent)
+{
+	u32 i, lo, hi;
+	GF_ISOFragmentIndexEntry *last = trak->frag_index_count ? &trak->frag_index[trak->frag_index_count-1] : NULL;
+
+	//regular case, new fragment after the last one
+	if (!last || (last->tfdt < fent->tfdt)) {
+		if (trak->frag_index_count == trak->frag_index_alloc) {
+			u32 new_alloc = trak->frag_index_alloc ? 2*trak->frag_index_alloc : 32;
+			GF_ISOFragmentIndexEntry *new_idx = gf_realloc(trak->frag_index, sizeof(GF_ISOFragmentIndexEntry) * new_alloc);
+			if (!new_idx) return GF_OUT_OF_MEM;
+			trak->frag_index = new_idx;
+			trak->frag_index_alloc = new_alloc;
+		}
+		trak->frag_index[trak->frag_index_count] = *fent;
+		trak->frag_index_count++;
+		return GF_OK;
+	}
+	//fragment parsed again (seek, segment reload or representation switch), update entry
+	lo = 0;
+	hi = trak->frag_index_count;
+	while (lo < hi) {
+		i = (lo + hi) / 2;
+		if (trak->frag_index[i].tfdt < fent->tfdt) lo = i+1;
+		else hi = i;
+	}
+	if ((lo < trak->frag_index_count) && (trak->frag_index[lo].tfdt == fent->tfdt)) {
+		trak->frag_index[lo] = *fent;
+		return GF_OK;
+	}
+	//insert in the middle
+	if (trak->frag_index_count == trak->frag_index_alloc) {
+		u32 new_alloc = 2*trak->frag_index_alloc;
+		GF_ISOFragmentIndexEntry *new_idx = gf_realloc(trak->frag_index, sizeof(GF_ISOFragmentIndexEntry) * new_alloc);
+		if (!new_idx) return GF_OUT_OF_MEM;
+		trak->frag_index = new_idx;
+		trak->frag_index_alloc = new_alloc;
+	}
+	memmove(&trak->frag_index[lo+1], &trak->frag_index[lo], sizeof(GF_ISOFragmentIndexEntry) * (trak->frag_index_count - lo));
+	trak->frag_index[lo] = *fent;
+	trak->frag_index_count++;
+	return GF_OK;
+}
+
 GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragmentBox *moof_box, u64 moof_offset, s32 compressed_diff, u64 *cumulated_offset)
 {
+	GF_Err e;
 	u32 i, j, chunk_size, track_num;
 	u64 base_offset, data_offset, traf_duration, tfdt;
 	u32 def_duration, DescIndex, def_size, def_flags;
@@ -482,6 +527,7 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 #endif
 	Bool is_first_merge = !trak->first_traf_merged;
 	Bool patch_no_dur;
+	GF_ISOFragmentIndexEntry fent;
 
 	GF_Err stbl_AppendTime(GF_SampleTableBox *stbl, u32 duration, u32 nb_pack);
 	GF_Err stbl_AppendSize(GF_SampleTableBox *stbl, u32 size, u32 nb_pack);
@@ -589,6 +635,11 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 		trak->dts_at_seg_start = trak->dts_at_next_frag_start;
 	}
 
+	memset(&fent, 0, sizeof(GF_ISOFragmentIndexEntry));
+	fent.tfdt = (traf->tfdt || traf->tfxd) ? tfdt : trak->dts_at_next_frag_start;
+	fent.moof_start = moof_offset;
+	fent.segment_idx = trak->moov->mov->segment_idx;
+
 	if (traf->tfxd) {
 		trak->last_tfxd_value = traf->tfxd->absolute_time_in_track_timescale;
 		trak->last_tfxd_value += traf->tfxd->fragment_duration_in_track_timescale;
@@ -696,7 +747,6 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 
 		//merge the run
 		for (j=0; j<trun->sample_count; j++) {
-			GF_Err e;
 			s32 cts_offset=0;
 			if (j<trun->nb_samples) {
 				ent = &trun->samples[j];
@@ -856,6 +906,9 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 				moof_template_size = 0;
 			}
 			if (ent->nb_pack>1) {
+				if (!fent.nb_samples)
+					fent.first_is_sync = GF_TRUE;
+				fent.nb_samples += ent->nb_pack;
 				j+= ent->nb_pack-1;
 				traf_duration += ent->nb_pack*duration;
 				last_dts += (ent->nb_pack-1)*duration;
@@ -873,6 +926,9 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 			}
 			e = stbl_AppendRAP(trak->Media->information->sampleTable, sync);
 			if (e) return e;
+			if (!fent.nb_samples && sync)
+				fent.first_is_sync = GF_TRUE;
+			fent.nb_samples++;
 			pad = GF_ISOM_GET_FRAG_PAD(flags);
 			if (pad) {
 				e = stbl_AppendPadding(trak->Media->information->sampleTable, pad);
@@ -895,6 +951,13 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 	//remember target next dts - last_dts is the duration in media timescale, does not include tfdt
 	trak->dts_at_next_frag_start += last_dts;
 
+	if (fent.nb_samples) {
+		fent.duration = last_dts;
+		fent.data_end = max_end;
+		e = frag_index_append(trak, &fent);
+		if (e) return e;
+	}
+
 	if (traf_duration && trak->editBox && trak->editBox->editList) {
 		//append to last edit only, adding edits on the fly is not possible in isobmff
 		GF_EdtsEntry *edts_e = gf_list_last(trak->editBox->editList->entryList);
@@ -1114,7 +1177,6 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 			u32 nb_saio;
 			u32 aux_info_type;
 			u64 offset;
-			GF_Err e;
 			Bool is_encrypted;
 			GF_SampleAuxiliaryInfoOffsetBox *saio = NULL;
 			GF_SampleAuxiliaryInfoSizeBox *saiz = NULL;
@@ -1307,7 +1369,7 @@ GF_Err MergeTrack(GF_TrackBox *trak, GF_TrackFragmentBox *traf, GF_MovieFragment
 			gf_bs_read_data(trak->moov->mov->movieFileMap->bs, sai, size);
 			gf_bs_seek(trak->moov->mov->movieFileMap->bs, cur_position);
 
-			GF_Err e = gf_isom_add_sample_aux_info_internal(trak, NULL, samp_num, saiz->aux_info_type, saiz->aux_info_type_parameter, sai, size);
+			e = gf_isom_add_sample_aux_info_internal(trak, NULL, samp_num, saiz->aux_info_type, saiz->aux_info_type_parameter, sai, size);
 			if (e) {
 				GF_LOG(GF_LOG_ERROR, GF_LOG_CONTAINER, ("[isobmf] Failed to merge sai data: %s\n", gf_error_to_string(e) ));
 			}
@@ -0,0 +1,24 @@
+#include "isom_tests.h"
+
+u32 isom_test_new_track(GF_ISOFile *file, GF_ISOTrackID id, u32 media_type, u32 timescale)
+{
+	u32 track, di;
+	GF_GenericSampleDescription udesc;
+	track = gf_isom_new_track(file, id, media_type, timescale);
+	if (!track) return 0;
+	memset(&udesc, 0, sizeof(GF_GenericSampleDescription));
+	udesc.codec_tag = GF_4CC('t','e','s','t');
+	if (media_type==GF_ISOM_MEDIA_VISUAL) {
+		udesc.width = 320;
+		udesc.height = 240;
+	}
+	if (gf_isom_new_generic_sample_description(file, track, NULL, NULL, &udesc, &di) != GF_OK)
+		return 0;
+	return track;
+}
+
+const char *isom_test_path(char path[GF_MAX_PATH], const char *name)
+{
+	snprintf(path, GF_MAX_PATH, "%s/%s", gf_get_default_cache_directory(), name);
+	return path;
+}
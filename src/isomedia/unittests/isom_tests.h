@@ -0,0 +1,18 @@
+#pragma once
+
+#include <gpac/isomedia.h>
+#include "tests.h"
+
+//asserts that the call returns GF_OK, jumps to the exit label of the caller otherwise
+#define isom_test_ok(_call) \
+	do { \
+		GF_Err __e = (_call); \
+		assert_generic(__e == GF_OK, printf("\t%s returned %s\n", #_call, gf_error_to_string(__e))); \
+		if (__e) goto exit; \
+	} while (0)
+
+//creates a track with a generic 'test' sample description, 320x240 for visual tracks - returns the track number, 0 if error
+u32 isom_test_new_track(GF_ISOFile *file, GF_ISOTrackID id, u32 media_type, u32 timescale);
+
+//gets the path of a test file with the given name in the cache directory
+const char *isom_test_path(char path[GF_MAX_PATH], const char *name);
@@ -0,0 +1,130 @@
+#include <gpac/internal/isomedia_dev.h>
+#include "isom_tests.h"
+
+#define BOX_BENCH_FRAGMENTS	10000
+
+//CMAF-like file with one sample per fragment
+static Bool box_bench_make_file(const char *path)
+{
+	u32 i;
+	u8 data[16];
+	GF_Err e;
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return GF_FALSE;
+
+	assert_equal(isom_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 1000), 1, "%u");
+	isom_test_ok( gf_isom_set_brand_info(file, GF_ISOM_BRAND_ISO6, 0) );
+	isom_test_ok( gf_isom_modify_alternate_brand(file, GF_4CC('c','m','f','c'), GF_TRUE) );
+	isom_test_ok( gf_isom_setup_track_fragment(file, 1, 1, 40, 0, 1, 0, 0, GF_FALSE) );
+	isom_test_ok( gf_isom_finalize_for_fragment(file, 0, GF_TRUE) );
+
+	memset(data, 0xAB, sizeof(data));
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	samp.dataLength = sizeof(data);
+	samp.IsRAP = RAP;
+	for (i=0; i<BOX_BENCH_FRAGMENTS; i++) {
+		isom_test_ok( gf_isom_start_fragment(file, GF_ISOM_FRAG_MOOF_FIRST) );
+		isom_test_ok( gf_isom_set_traf_base_media_decode_time(file, 1, samp.DTS) );
+		isom_test_ok( gf_isom_fragment_add_sample(file, 1, &samp, 1, 40, 0, 0, 0) );
+		samp.DTS += 40;
+	}
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	return e ? GF_FALSE : GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+unittest(box_funcs_parse_fragments)
+{
+	GF_ISOFile *file;
+	char path[GF_MAX_PATH];
+	isom_test_path(path, "ut_box_bench.mp4");
+
+	assert_true(box_bench_make_file(path));
+
+	file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	assert_not_null(file);
+	if (file) {
+		assert_equal(gf_isom_get_sample_count(file, 1), BOX_BENCH_FRAGMENTS, "%u");
+		gf_isom_close(file);
+	}
+
+	gf_file_delete(path);
+}
+
+//returns type of box created for the given parent, GF_ISOM_BOX_TYPE_UNKNOWN if not allowed in parent
+static u32 box_reg_type_in_parent(u32 type, u32 parent_type)
+{
+	u32 res;
+	GF_Box *a = gf_isom_box_new_ex(type, parent_type, GF_TRUE, GF_FALSE, GF_FALSE);
+	if (!a) return 0;
+	res = a->type;
+	gf_isom_box_del(a);
+	return res;
+}
+
+static Bool box_reg_valid_in_parent(u32 type, const char *parent)
+{
+	Bool res;
+	GF_Box *a = gf_isom_box_new(type);
+	if (!a) return GF_FALSE;
+	res = gf_box_valid_in_parent(a, parent);
+	gf_isom_box_del(a);
+	return res;
+}
+
+unittest(box_funcs_registry_index)
+{
+	GF_Box *a;
+	//no-op if already built by gf_sys_init or a previous lookup
+	gf_isom_registry_init();
+	gf_isom_registry_init();
+
+	//lookup by type
+	a = gf_isom_box_new(GF_ISOM_BOX_TYPE_TRAK);
+	assert_not_null(a);
+	if (a) {
+		assert_equal(a->type, GF_ISOM_BOX_TYPE_TRAK, "%u");
+		gf_isom_box_del(a);
+	}
+	a = gf_isom_box_new(GF_4CC('z','z','z','z'));
+	assert_not_null(a);
+	if (a) {
+		assert_equal(a->type, GF_ISOM_BOX_TYPE_UNKNOWN, "%u");
+		assert_equal(((GF_UnknownBox *)a)->original_4cc, GF_4CC('z','z','z','z'), "%u");
+		gf_isom_box_del(a);
+	}
+
+	//declared parents
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_TKHD, "trak"));
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_MVHD, "moov"));
+	assert_false(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_MVHD, "trak"));
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_STSD, "stbl"));
+	assert_false(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_STSD, "moov"));
+	//last parent in list
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_AVCC, "dvav"));
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_AVCC, "avc1"));
+	//parent declared without trailing space
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_RELY, "rtp"));
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_RELY, "srtp"));
+	//sample format declared as "text_sample"
+	assert_true(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_STYL, "text"));
+	assert_false(box_reg_valid_in_parent(GF_ISOM_BOX_TYPE_STYL, "tx3g"));
+
+	//child lookup with parent check
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_TKHD, GF_ISOM_BOX_TYPE_TRAK), GF_ISOM_BOX_TYPE_TKHD, "%u");
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_TKHD, GF_ISOM_BOX_TYPE_MOOV), GF_ISOM_BOX_TYPE_UNKNOWN, "%u");
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_RELY, GF_4CC('r','t','p',' ')), GF_ISOM_BOX_TYPE_RELY, "%u");
+	//allowed in any sample entry: parent must be a box declared in stsd
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_BTRT, GF_ISOM_BOX_TYPE_AVC1), GF_ISOM_BOX_TYPE_BTRT, "%u");
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_BTRT, GF_ISOM_BOX_TYPE_MP4A), GF_ISOM_BOX_TYPE_BTRT, "%u");
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_BTRT, GF_ISOM_BOX_TYPE_MOOV), GF_ISOM_BOX_TYPE_UNKNOWN, "%u");
+	//allowed anywhere
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_FREE, GF_ISOM_BOX_TYPE_TRAK), GF_ISOM_BOX_TYPE_FREE, "%u");
+	assert_equal(box_reg_type_in_parent(GF_ISOM_BOX_TYPE_FREE, GF_ISOM_BOX_TYPE_MVHD), GF_ISOM_BOX_TYPE_FREE, "%u");
+}
@@ -0,0 +1,134 @@
+#include <gpac/internal/isomedia_dev.h>
+#include "isom_tests.h"
+
+#define STORE_TEST_SAMPLES	500
+
+//fast-start file with moov reserved space of given size
+static Bool store_test_make_file(const char *path, u32 moov_reserve)
+{
+	u32 i;
+	u8 data[200];
+	GF_Err e;
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return GF_FALSE;
+
+	isom_test_ok( gf_isom_set_storage_mode(file, GF_ISOM_STORE_FASTSTART) );
+	isom_test_ok( gf_isom_set_moov_reserve(file, moov_reserve) );
+	assert_equal(isom_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 1000), 1, "%u");
+
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	for (i=0; i<STORE_TEST_SAMPLES; i++) {
+		memset(data, (u8) i, sizeof(data));
+		samp.dataLength = 1 + (i*37) % sizeof(data);
+		samp.IsRAP = (i%25) ? RAP_NO : RAP;
+		isom_test_ok( gf_isom_add_sample(file, 1, 1, &samp) );
+		samp.DTS += 40;
+	}
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	return e ? GF_FALSE : GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+//gets the top-level box types and sizes of the file, returns number of boxes
+//the file ends with a free box carrying the GPAC copyright
+static u32 store_test_get_boxes(const char *path, u32 *types, u32 *sizes, u32 max_boxes)
+{
+	u32 nb_boxes = 0;
+	u64 size;
+	FILE *f = gf_fopen(path, "rb");
+	if (!f) return 0;
+	GF_BitStream *bs = gf_bs_from_file(f, GF_BITSTREAM_READ);
+	size = gf_bs_get_size(bs);
+	while ((nb_boxes < max_boxes) && (gf_bs_get_position(bs) + 8 <= size)) {
+		u64 pos = gf_bs_get_position(bs);
+		sizes[nb_boxes] = gf_bs_read_u32(bs);
+		types[nb_boxes] = gf_bs_read_u32(bs);
+		if (sizes[nb_boxes] < 8) break;
+		gf_bs_seek(bs, pos + sizes[nb_boxes]);
+		nb_boxes++;
+	}
+	gf_bs_del(bs);
+	gf_fclose(f);
+	return nb_boxes;
+}
+
+//all samples must be readable with their original data
+static Bool store_test_check_samples(const char *path)
+{
+	u32 i, j, di;
+	Bool ok = GF_TRUE;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	assert_not_null(file);
+	if (!file) return GF_FALSE;
+	assert_equal(gf_isom_get_sample_count(file, 1), STORE_TEST_SAMPLES, "%u");
+	for (i=0; i<STORE_TEST_SAMPLES; i++) {
+		GF_ISOSample *samp = gf_isom_get_sample(file, 1, i+1, &di);
+		if (!samp || (samp->dataLength != 1 + (i*37) % 200) || (samp->DTS != (u64) i*40)) {
+			ok = GF_FALSE;
+		} else {
+			for (j=0; j<samp->dataLength; j++) {
+				if (samp->data[j] != (u8) i) ok = GF_FALSE;
+			}
+		}
+		if (samp) gf_isom_sample_del(&samp);
+		if (!ok) break;
+	}
+	assert_true(ok);
+	gf_isom_close(file);
+	return ok;
+}
+
+unittest(isom_store_moov_reserve)
+{
+	u32 types[10], sizes[10], nb_boxes;
+	char path[GF_MAX_PATH];
+	isom_test_path(path, "ut_moov_reserve.mp4");
+
+	//moov fits, written in place followed by a free box
+	assert_true(store_test_make_file(path, 32000));
+	nb_boxes = store_test_get_boxes(path, types, sizes, 10);
+	assert_greater_equal(nb_boxes, 4, "%u");
+	assert_equal(types[0], GF_ISOM_BOX_TYPE_FTYP, "%u");
+	assert_equal(types[1], GF_ISOM_BOX_TYPE_MOOV, "%u");
+	assert_equal(types[2], GF_ISOM_BOX_TYPE_FREE, "%u");
+	assert_equal(sizes[1] + sizes[2], 32000, "%u");
+	assert_equal(types[3], GF_ISOM_BOX_TYPE_MDAT, "%u");
+	store_test_check_samples(path);
+
+	//moov too large, inserted before the reserved space
+	assert_true(store_test_make_file(path, 100));
+	nb_boxes = store_test_get_boxes(path, types, sizes, 10);
+	assert_greater_equal(nb_boxes, 4, "%u");
+	assert_equal(types[1], GF_ISOM_BOX_TYPE_MOOV, "%u");
+	assert_true(sizes[1] > 100);
+	assert_equal(types[2], GF_ISOM_BOX_TYPE_FREE, "%u");
+	assert_equal(sizes[2], 100, "%u");
+	assert_equal(types[3], GF_ISOM_BOX_TYPE_MDAT, "%u");
+	store_test_check_samples(path);
+
+	//moov size known, test exact fit and no room left for the free box header
+	u32 moov_size = sizes[1];
+	assert_true(store_test_make_file(path, moov_size));
+	nb_boxes = store_test_get_boxes(path, types, sizes, 10);
+	assert_greater_equal(nb_boxes, 3, "%u");
+	assert_equal(types[1], GF_ISOM_BOX_TYPE_MOOV, "%u");
+	assert_equal(sizes[1], moov_size, "%u");
+	assert_equal(types[2], GF_ISOM_BOX_TYPE_MDAT, "%u");
+	store_test_check_samples(path);
+
+	assert_true(store_test_make_file(path, moov_size+4));
+	nb_boxes = store_test_get_boxes(path, types, sizes, 10);
+	assert_greater_equal(nb_boxes, 4, "%u");
+	assert_equal(types[1], GF_ISOM_BOX_TYPE_MOOV, "%u");
+	assert_equal(types[2], GF_ISOM_BOX_TYPE_FREE, "%u");
+	assert_equal(sizes[2], moov_size+4, "%u");
+	store_test_check_samples(path);
+
+	gf_file_delete(path);
+}
@@ -0,0 +1,91 @@
+#include <gpac/constants.h>
+#include "isom_tests.h"
+
+#define META_TEST_ITEMS	12
+//larger than the max coalesced read, copied directly from file
+#define META_TEST_LARGE_SIZE	(5*1024*1024)
+
+static u32 meta_test_item_size(u32 i)
+{
+	if (i==META_TEST_ITEMS-1) return META_TEST_LARGE_SIZE;
+	return 100 + i*997;
+}
+
+static Bool meta_test_make_file(const char *path)
+{
+	u32 i;
+	GF_Err e;
+	u8 *data = NULL;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_WRITE_EDIT, NULL);
+	if (!file) return GF_FALSE;
+
+	isom_test_ok( gf_isom_set_meta_type(file, GF_TRUE, 0, GF_META_ITEM_TYPE_PICT) );
+	for (i=0; i<META_TEST_ITEMS; i++) {
+		u32 j, item_id = i+1;
+		u32 size = meta_test_item_size(i);
+		data = gf_malloc(size);
+		assert_not_null(data);
+		if (!data) goto exit;
+		for (j=0; j<size; j++) data[j] = (u8) (i*31 + j);
+		isom_test_ok( gf_isom_add_meta_item_memory(file, GF_TRUE, 0, NULL, &item_id, GF_4CC('t','e','s','t'), "application/test", NULL, NULL, data, size, NULL) );
+		gf_free(data);
+		data = NULL;
+	}
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	return e ? GF_FALSE : GF_TRUE;
+
+exit:
+	if (data) gf_free(data);
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+//batch extraction must give the same data as extracting items one by one
+unittest(meta_extract_items_batch)
+{
+	u32 i;
+	char path[GF_MAX_PATH];
+	GF_ISOItemData items[META_TEST_ITEMS+2];
+	GF_ISOFile *file;
+
+	isom_test_path(path, "ut_meta_items.heif");
+	assert_true(meta_test_make_file(path));
+
+	file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	assert_not_null(file);
+	if (!file) return;
+
+	//reverse order, one item requested twice and one unknown item
+	memset(items, 0, sizeof(items));
+	for (i=0; i<META_TEST_ITEMS; i++)
+		items[i].item_id = META_TEST_ITEMS - i;
+	items[META_TEST_ITEMS].item_id = 3;
+	items[META_TEST_ITEMS+1].item_id = 1000;
+
+	assert_equal(gf_isom_extract_meta_items_mem(file, GF_TRUE, 0, items, META_TEST_ITEMS+2, GF_FALSE), GF_OK, "%d");
+
+	for (i=0; i<META_TEST_ITEMS+1; i++) {
+		u8 *data = NULL;
+		u32 size = 0, alloc_size = 0;
+		assert_equal(items[i].e, GF_OK, "%d");
+		assert_equal(gf_isom_extract_meta_item_mem(file, GF_TRUE, 0, items[i].item_id, &data, &size, &alloc_size, NULL, GF_FALSE), GF_OK, "%d");
+		assert_equal(size, meta_test_item_size(items[i].item_id-1), "%u");
+		assert_equal(items[i].size, size, "%u");
+		if (data && (items[i].size == size)) {
+			assert_equal_mem(items[i].data, data, size);
+		}
+		if (data) gf_free(data);
+	}
+	assert_equal(items[META_TEST_ITEMS+1].e, GF_BAD_PARAM, "%d");
+
+	//existing buffers are reused
+	assert_equal(gf_isom_extract_meta_items_mem(file, GF_TRUE, 0, items, 2, GF_FALSE), GF_OK, "%d");
+	assert_equal(items[0].size, META_TEST_LARGE_SIZE, "%u");
+
+	for (i=0; i<META_TEST_ITEMS+2; i++) {
+		if (items[i].data) gf_free(items[i].data);
+	}
+	gf_isom_close(file);
+	gf_file_delete(path);
+}
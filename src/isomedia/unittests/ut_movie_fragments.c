@@ -0,0 +1,310 @@
+#include <gpac/internal/isomedia_dev.h>
+#include "isom_tests.h"
+
+#define FRAG_TEST_SAMPLES	300
+
+enum
+{
+	FRAG_TEST_CTS = 1,
+	FRAG_TEST_TWO_TRACKS = 1<<1,
+	FRAG_TEST_SEGMENTS = 1<<2,
+	FRAG_TEST_MOOF_FIRST = 1<<3,
+	FRAG_TEST_CONST_SIZE = 1<<4,
+	FRAG_TEST_LARGE_TFDT = 1<<5,
+};
+
+static u32 frag_test_new_track(GF_ISOFile *file, GF_ISOTrackID id, u32 type, u32 timescale)
+{
+	u32 track = isom_test_new_track(file, id, type, timescale);
+	if (track) gf_isom_set_track_creation_time(file, track, 0, 0);
+	return track;
+}
+
+//writes a fragmented file, and loads it in memory - nb_fast_moofs is set to the number of moofs written by the fast serializer
+static u8 *frag_test_make_file(const char *path, u32 cfg, Bool generic_write, u32 *size, u32 *nb_fast_moofs)
+{
+	u32 i, j;
+	u8 data[256];
+	GF_Err e;
+	GF_ISOSample samp;
+	u8 *file_data = NULL;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return NULL;
+
+	assert_equal(frag_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 25000), 1, "%u");
+	//moov is created with the first track
+	isom_test_ok( gf_isom_set_creation_time(file, 0, 0) );
+	isom_test_ok( gf_isom_setup_track_fragment(file, 1, 1, 1000, (cfg & FRAG_TEST_CONST_SIZE) ? 100 : 0, 0, 0, 0, GF_FALSE) );
+	if (cfg & FRAG_TEST_TWO_TRACKS) {
+		assert_equal(frag_test_new_track(file, 2, GF_ISOM_MEDIA_AUDIO, 48000), 2, "%u");
+		isom_test_ok( gf_isom_setup_track_fragment(file, 2, 1, 1024, 0, 1, 0, 0, GF_FALSE) );
+	}
+	isom_test_ok( gf_isom_finalize_for_fragment(file, (cfg & FRAG_TEST_SEGMENTS) ? 1 : 0, GF_TRUE) );
+	if (generic_write)
+		isom_test_ok( gf_isom_set_fragment_option(file, 0, GF_ISOM_MOOF_GENERIC_WRITE, 1) );
+
+	memset(data, 0x5A, sizeof(data));
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	for (i=0; i<FRAG_TEST_SAMPLES; i++) {
+		if (!(i%25)) {
+			if ((cfg & FRAG_TEST_SEGMENTS) && !(i%50)) {
+				if (i) isom_test_ok( gf_isom_close_segment(file, 1, 1, 0, 0, 0, GF_FALSE, GF_FALSE, GF_FALSE, GF_FALSE, 0, NULL, NULL, NULL) );
+				isom_test_ok( gf_isom_start_segment(file, NULL, GF_FALSE) );
+			}
+			isom_test_ok( gf_isom_start_fragment(file, (cfg & FRAG_TEST_MOOF_FIRST) ? GF_ISOM_FRAG_MOOF_FIRST : 0) );
+			isom_test_ok( gf_isom_set_traf_base_media_decode_time(file, 1, (u64) i * 1000) );
+			//traf options are set once the fragment is started
+			if (cfg & FRAG_TEST_LARGE_TFDT)
+				isom_test_ok( gf_isom_set_fragment_option(file, 1, GF_ISOM_TRAF_USE_LARGE_TFDT, 1) );
+			if (cfg & FRAG_TEST_TWO_TRACKS)
+				isom_test_ok( gf_isom_set_traf_base_media_decode_time(file, 2, (u64) i * 1920) );
+		}
+		samp.DTS = (u64) i * 1000;
+		samp.CTS_Offset = (cfg & FRAG_TEST_CTS) ? ((i%3) * 1000) : 0;
+		samp.dataLength = (cfg & FRAG_TEST_CONST_SIZE) ? 100 : 1 + (i*37) % 256;
+		samp.IsRAP = (i%25) ? RAP_NO : RAP;
+		isom_test_ok( gf_isom_fragment_add_sample(file, 1, &samp, 1, 1000, 0, 0, GF_FALSE) );
+
+		if (cfg & FRAG_TEST_TWO_TRACKS) {
+			GF_ISOSample asamp;
+			memset(&asamp, 0, sizeof(GF_ISOSample));
+			asamp.data = data;
+			asamp.IsRAP = RAP;
+			for (j=0; j<2; j++) {
+				asamp.DTS = (u64) (i*2+j) * 1024;
+				asamp.dataLength = 10 + (i+j) % 50;
+				isom_test_ok( gf_isom_fragment_add_sample(file, 2, &asamp, 1, 1024, 0, 0, GF_FALSE) );
+			}
+		}
+	}
+	if (cfg & FRAG_TEST_SEGMENTS)
+		isom_test_ok( gf_isom_close_segment(file, 1, 1, 0, 0, 0, GF_FALSE, GF_FALSE, GF_TRUE, GF_FALSE, 0, NULL, NULL, NULL) );
+	//without segments, the last moof is only written at close
+	if (nb_fast_moofs) *nb_fast_moofs = file->nb_fast_moofs;
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	if (e) return NULL;
+
+	e = gf_file_load_data(path, &file_data, size);
+	assert_equal(e, GF_OK, "%d");
+	gf_file_delete(path);
+	return file_data;
+
+exit:
+	gf_isom_delete(file);
+	return NULL;
+}
+
+//the fast moof serializer must produce the same bytes as the generic box writer
+unittest(movie_fragments_fast_moof_write)
+{
+	u32 i;
+	char path[GF_MAX_PATH];
+	u32 configs[] = {
+		0,
+		FRAG_TEST_CTS,
+		FRAG_TEST_CONST_SIZE,
+		FRAG_TEST_TWO_TRACKS | FRAG_TEST_CTS,
+		FRAG_TEST_SEGMENTS,
+		FRAG_TEST_SEGMENTS | FRAG_TEST_MOOF_FIRST | FRAG_TEST_TWO_TRACKS,
+		FRAG_TEST_MOOF_FIRST | FRAG_TEST_LARGE_TFDT | FRAG_TEST_CTS,
+	};
+	isom_test_path(path, "ut_frag_moof.mp4");
+
+	for (i=0; i<GF_ARRAY_LENGTH(configs); i++) {
+		u32 size_fast=0, size_generic=0, nb_fast=0, nb_fast_generic=0;
+		u8 *fast = frag_test_make_file(path, configs[i], GF_FALSE, &size_fast, &nb_fast);
+		u8 *generic = frag_test_make_file(path, configs[i], GF_TRUE, &size_generic, &nb_fast_generic);
+
+		assert_not_null(fast);
+		assert_not_null(generic);
+		//every moof goes through the fast serializer unless disabled
+		assert_equal(nb_fast, (configs[i] & FRAG_TEST_SEGMENTS) ? FRAG_TEST_SAMPLES/25 : FRAG_TEST_SAMPLES/25 - 1, "%u");
+		assert_equal(nb_fast_generic, 0, "%u");
+		assert_equal(size_fast, size_generic, "%u");
+		if (fast && generic && (size_fast == size_generic)) {
+			assert_equal_mem(fast, generic, size_fast);
+		}
+		if (fast) gf_free(fast);
+		if (generic) gf_free(generic);
+	}
+}
+
+#define FIDX_SEGS		4
+#define FIDX_FRAG_SAMPLES	25
+
+//init segment and FIDX_SEGS media segments of 2 fragments each, only the first fragment of a segment starts with a sync sample
+static Bool frag_index_make_segments(const char *init_path, const char *seg_fmt)
+{
+	u32 i, s, f;
+	u8 data[64];
+	char seg_path[GF_MAX_PATH];
+	GF_Err e;
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(init_path, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return GF_FALSE;
+
+	assert_equal(frag_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 25000), 1, "%u");
+	isom_test_ok( gf_isom_setup_track_fragment(file, 1, 1, 1000, 0, 0, 0, 0, GF_FALSE) );
+	isom_test_ok( gf_isom_finalize_for_fragment(file, 1, GF_TRUE) );
+
+	memset(data, 0x5A, sizeof(data));
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	for (s=0; s<FIDX_SEGS; s++) {
+		snprintf(seg_path, GF_MAX_PATH, seg_fmt, s);
+		isom_test_ok( gf_isom_start_segment(file, seg_path, GF_FALSE) );
+		for (f=0; f<2; f++) {
+			u64 dts = (u64) (s*2 + f) * FIDX_FRAG_SAMPLES * 1000;
+			isom_test_ok( gf_isom_start_fragment(file, GF_ISOM_FRAG_MOOF_FIRST) );
+			isom_test_ok( gf_isom_set_traf_base_media_decode_time(file, 1, dts) );
+			for (i=0; i<FIDX_FRAG_SAMPLES; i++) {
+				samp.DTS = dts + i*1000;
+				samp.dataLength = 1 + (i*7) % 64;
+				samp.IsRAP = (!f && !i) ? RAP : RAP_NO;
+				isom_test_ok( gf_isom_fragment_add_sample(file, 1, &samp, 1, 1000, 0, 0, GF_FALSE) );
+			}
+		}
+		isom_test_ok( gf_isom_close_segment(file, -1, 0, 0, 0, 0, GF_FALSE, GF_FALSE, (s+1==FIDX_SEGS) ? GF_TRUE : GF_FALSE, GF_TRUE, 0, NULL, NULL, NULL) );
+	}
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	return e ? GF_FALSE : GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+//the fragment index must survive segment release and table reset, and not duplicate fragments parsed twice
+unittest(movie_fragments_index)
+{
+	u32 s, idx;
+	u64 offset;
+	GF_ISOFragmentIndexEntry fent;
+	char init_path[GF_MAX_PATH], seg_fmt[GF_MAX_PATH], seg_path[GF_MAX_PATH];
+	GF_ISOFile *file;
+
+	isom_test_path(init_path, "ut_fidx_init.mp4");
+	isom_test_path(seg_fmt, "ut_fidx_%d.m4s");
+	assert_true(frag_index_make_segments(init_path, seg_fmt));
+
+	file = gf_isom_open(init_path, GF_ISOM_OPEN_READ, NULL);
+	assert_not_null(file);
+	if (!file) return;
+
+	for (s=0; s<FIDX_SEGS; s++) {
+		snprintf(seg_path, GF_MAX_PATH, seg_fmt, s);
+		assert_equal(gf_isom_open_segment(file, seg_path, 0, 0, 0), GF_OK, "%d");
+		assert_equal(gf_isom_get_sample_count(file, 1), 2*FIDX_FRAG_SAMPLES, "%u");
+		gf_isom_release_segment(file, GF_TRUE);
+		gf_isom_reset_tables(file, GF_TRUE);
+	}
+	assert_equal(gf_isom_get_fragment_index_count(file, 1), 2*FIDX_SEGS, "%u");
+
+	assert_equal(gf_isom_get_fragment_index_entry(file, 1, 4, &fent), GF_OK, "%d");
+	assert_equal(fent.tfdt, (u64) 3*FIDX_FRAG_SAMPLES*1000, LLU);
+	assert_equal(fent.duration, (u64) FIDX_FRAG_SAMPLES*1000, LLU);
+	assert_equal(fent.nb_samples, FIDX_FRAG_SAMPLES, "%u");
+	assert_equal(fent.segment_idx, 2, "%u");
+	assert_false(fent.first_is_sync);
+	assert_true(fent.data_end > fent.moof_start);
+
+	//middle of 4th fragment, starts at 3rd with sync
+	assert_equal(gf_isom_find_fragment_index(file, 1, 3*FIDX_FRAG_SAMPLES*1000 + 5000, GF_FALSE, &idx), GF_OK, "%d");
+	assert_equal(idx, 4, "%u");
+	assert_equal(gf_isom_find_fragment_index(file, 1, 3*FIDX_FRAG_SAMPLES*1000 + 5000, GF_TRUE, &idx), GF_OK, "%d");
+	assert_equal(idx, 3, "%u");
+	assert_equal(gf_isom_find_fragment_index(file, 1, 2*FIDX_SEGS*FIDX_FRAG_SAMPLES*1000, GF_FALSE, &idx), GF_NOT_FOUND, "%d");
+
+	//parse second segment again: no new entries, offsets only valid for this segment
+	snprintf(seg_path, GF_MAX_PATH, seg_fmt, 1);
+	assert_equal(gf_isom_open_segment(file, seg_path, 0, 0, GF_ISOM_SEGMENT_NO_ORDER_FLAG), GF_OK, "%d");
+	assert_equal(gf_isom_get_fragment_index_count(file, 1), 2*FIDX_SEGS, "%u");
+	gf_isom_get_fragment_index_entry(file, 1, 3, &fent);
+	assert_equal(fent.segment_idx, FIDX_SEGS+1, "%u");
+
+	assert_equal(gf_isom_get_fragment_offset_for_time(file, 3.5, &offset), GF_OK, "%d");
+	assert_equal(offset, fent.moof_start, LLU);
+	assert_equal(gf_isom_get_fragment_offset_for_time(file, 0.5, &offset), GF_NOT_FOUND, "%d");
+
+	gf_isom_close(file);
+	gf_file_delete(init_path);
+	for (s=0; s<FIDX_SEGS; s++) {
+		snprintf(seg_path, GF_MAX_PATH, seg_fmt, s);
+		gf_file_delete(seg_path);
+	}
+}
+
+//reads all sample infos of a fragmented file, with fragment boxes allocated in the box arena or not
+static u64 *frag_arena_read_samples(const char *path, Bool use_arena, u32 *nb_entries)
+{
+	u32 i, j, nb_tracks, count = 0;
+	u64 *infos = NULL;
+	GF_ISOFile *file;
+
+	gf_opts_set_key("core", "isom-arena", use_arena ? "yes" : NULL);
+	file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	gf_opts_set_key("core", "isom-arena", NULL);
+	if (!file) return NULL;
+
+	nb_tracks = gf_isom_get_track_count(file);
+	for (i=0; i<nb_tracks; i++)
+		count += gf_isom_get_sample_count(file, i+1);
+	infos = gf_malloc(sizeof(u64) * 4 * count);
+	count = 0;
+	for (i=0; i<nb_tracks; i++) {
+		for (j=0; j<gf_isom_get_sample_count(file, i+1); j++) {
+			GF_ISOSample samp;
+			u64 offset = 0;
+			memset(&samp, 0, sizeof(GF_ISOSample));
+			gf_isom_get_sample_info_ex(file, i+1, j+1, NULL, &offset, &samp);
+			infos[count++] = samp.DTS;
+			infos[count++] = (u64) samp.CTS_Offset;
+			infos[count++] = ((u64) samp.dataLength << 8) | samp.IsRAP;
+			infos[count++] = offset;
+		}
+	}
+	gf_isom_close(file);
+	*nb_entries = count;
+	return infos;
+}
+
+//fragments parsed with the box arena must give the same sample tables as with heap allocated boxes
+unittest(movie_fragments_box_arena)
+{
+	u32 i;
+	char path[GF_MAX_PATH];
+	u32 configs[] = {
+		FRAG_TEST_TWO_TRACKS | FRAG_TEST_CTS,
+		FRAG_TEST_SEGMENTS | FRAG_TEST_MOOF_FIRST | FRAG_TEST_CONST_SIZE,
+	};
+	isom_test_path(path, "ut_frag_arena.mp4");
+
+	for (i=0; i<GF_ARRAY_LENGTH(configs); i++) {
+		u32 size=0, nb_heap=0, nb_arena=0;
+		u64 *heap, *arena;
+		FILE *f;
+		u8 *data = frag_test_make_file(path, configs[i], GF_FALSE, &size, NULL);
+		assert_not_null(data);
+		if (!data) continue;
+		f = gf_fopen(path, "wb");
+		gf_fwrite(data, size, f);
+		gf_fclose(f);
+		gf_free(data);
+
+		heap = frag_arena_read_samples(path, GF_FALSE, &nb_heap);
+		arena = frag_arena_read_samples(path, GF_TRUE, &nb_arena);
+		assert_not_null(heap);
+		assert_not_null(arena);
+		assert_true(nb_heap > 0);
+		assert_equal(nb_heap, nb_arena, "%u");
+		if (heap && arena && (nb_heap == nb_arena)) {
+			assert_equal_mem(heap, arena, nb_heap * sizeof(u64));
+		}
+		if (heap) gf_free(heap);
+		if (arena) gf_free(arena);
+		gf_file_delete(path);
+	}
+}
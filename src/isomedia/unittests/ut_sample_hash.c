@@ -0,0 +1,131 @@
+#include "isom_tests.h"
+#include <gpac/filters.h>
+
+//about 10 MBytes, checksums are computed by groups of 4 MBytes
+#define HASH_TEST_SAMPLES	10000
+
+//writes an interleaved file with two tracks, with a sample hash index computed while writing
+static Bool hash_test_make_file(const char *path, const char *index_path)
+{
+	u32 i;
+	u8 data[1500];
+	GF_Err e;
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_WRITE_EDIT, NULL);
+	if (!file) return GF_FALSE;
+
+	isom_test_ok( gf_isom_set_sample_hash_index(file, index_path) );
+	assert_equal(isom_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 25000), 1, "%u");
+	assert_equal(isom_test_new_track(file, 2, GF_ISOM_MEDIA_AUDIO, 48000), 2, "%u");
+	assert_equal(isom_test_new_track(file, 3, GF_ISOM_MEDIA_AUDIO, 48000), 3, "%u");
+
+	for (i=0; i<sizeof(data); i++) data[i] = (u8) (i*7);
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	samp.dataLength = 100;
+	//first sample must have DTS 0, failed adds are not hashed
+	samp.DTS = 1000;
+	assert_true(gf_isom_add_sample(file, 2, 1, &samp) != GF_OK);
+	for (i=0; i<HASH_TEST_SAMPLES; i++) {
+		samp.DTS = (u64) i * 1000;
+		samp.dataLength = 500 + (i*37) % 1000;
+		samp.IsRAP = (i%25) ? RAP_NO : RAP;
+		isom_test_ok( gf_isom_add_sample(file, 1, 1, &samp) );
+		//sample data appended in two calls
+		if (i%10==0)
+			isom_test_ok( gf_isom_append_sample_data(file, 1, data+1, 100) );
+
+		samp.DTS = (u64) i * 1920;
+		samp.dataLength = 1 + (i*13) % 200;
+		samp.IsRAP = RAP;
+		isom_test_ok( gf_isom_add_sample(file, 2, 1, &samp) );
+		isom_test_ok( gf_isom_add_sample(file, 3, 1, &samp) );
+	}
+	//shadow of the last sample is added at the end and hashed
+	samp.DTS = (u64) (HASH_TEST_SAMPLES-1) * 1920;
+	isom_test_ok( gf_isom_add_sample_shadow(file, 2, &samp) );
+	//shadow inserted before the last sample, track is not indexed
+	samp.DTS = 1920;
+	isom_test_ok( gf_isom_add_sample_shadow(file, 3, &samp) );
+	isom_test_ok( gf_isom_make_interleave(file, 0.5) );
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	return e ? GF_FALSE : GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+static u64 hash_test_file_size(const char *path)
+{
+	u64 size;
+	FILE *f = gf_fopen(path, "rb");
+	if (!f) return 0;
+	size = gf_fsize(f);
+	gf_fclose(f);
+	return size;
+}
+
+unittest(sample_hash_index)
+{
+	u32 nb_errors;
+	u64 offset = 0;
+	u32 di;
+	u8 byte;
+	FILE *f;
+	GF_ISOSample *samp;
+	GF_ISOFile *file;
+	GF_FilterSession *fs;
+	char path[GF_MAX_PATH], w_idx[GF_MAX_PATH], r_idx[GF_MAX_PATH];
+
+	isom_test_path(path, "ut_sample_hash.mp4");
+	isom_test_path(w_idx, "ut_sample_hash_w.hidx");
+	isom_test_path(r_idx, "ut_sample_hash_r.hidx");
+	assert_true(hash_test_make_file(path, w_idx));
+
+	fs = gf_fs_new(3, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+	assert_not_null(fs);
+	if (!fs) goto exit;
+
+	//index computed while writing and index computed from file must both match file content
+	assert_equal(gf_isom_check_sample_hash_index(path, w_idx, NULL, 0, &nb_errors), GF_OK, "%d");
+	assert_equal(nb_errors, 0, "%u");
+	assert_equal(gf_isom_make_sample_hash_index(path, r_idx, fs, 3), GF_OK, "%d");
+	assert_equal(gf_isom_check_sample_hash_index(path, r_idx, fs, 0, &nb_errors), GF_OK, "%d");
+	assert_equal(nb_errors, 0, "%u");
+	//written index skips track 3
+	assert_true(hash_test_file_size(w_idx) < hash_test_file_size(r_idx));
+
+	//corrupt one byte of a sample
+	file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	assert_not_null(file);
+	if (!file) goto exit;
+	samp = gf_isom_get_sample_info(file, 1, 1000, &di, &offset);
+	gf_isom_sample_del(&samp);
+	gf_isom_close(file);
+	assert_true(offset != 0);
+
+	f = gf_fopen(path, "r+b");
+	assert_not_null(f);
+	if (!f) goto exit;
+	gf_fseek(f, offset+10, SEEK_SET);
+	byte = (u8) gf_fgetc(f);
+	gf_fseek(f, offset+10, SEEK_SET);
+	gf_fputc(byte ^ 0xFF, f);
+	gf_fclose(f);
+
+	assert_equal(gf_isom_check_sample_hash_index(path, w_idx, fs, 0, &nb_errors), GF_OK, "%d");
+	assert_equal(nb_errors, 1, "%u");
+	assert_equal(gf_isom_check_sample_hash_index(path, r_idx, fs, 2, &nb_errors), GF_OK, "%d");
+	assert_equal(nb_errors, 1, "%u");
+
+	//not an index
+	assert_true(gf_isom_check_sample_hash_index(path, path, NULL, 0, &nb_errors) != GF_OK);
+
+exit:
+	if (fs) gf_fs_del(fs);
+	gf_file_delete(path);
+	gf_file_delete(w_idx);
+	gf_file_delete(r_idx);
+}
@@ -0,0 +1,260 @@
+#include "isom_tests.h"
+
+#define STBL_BENCH_SAMPLES	100000
+#define STBL_BENCH_SEEKS	2000
+
+//one stts entry per sample and variable number of samples per chunk
+static Bool stbl_bench_make_file(const char *path)
+{
+	u32 i;
+	u8 data[64];
+	GF_Err e;
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return GF_FALSE;
+
+	assert_equal(isom_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 1000), 1, "%u");
+	isom_test_ok( gf_isom_hint_max_chunk_size(file, 1, 48) );
+
+	memset(data, 0xAB, sizeof(data));
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	for (i=0; i<STBL_BENCH_SAMPLES; i++) {
+		samp.dataLength = 1 + (i*37) % 64;
+		samp.IsRAP = (i%30) ? RAP_NO : RAP;
+		isom_test_ok( gf_isom_add_sample(file, 1, 1, &samp) );
+		samp.DTS += 39 + (i%3);
+	}
+	e = gf_isom_close(file);
+	assert_equal(e, GF_OK, "%d");
+	return e ? GF_FALSE : GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+//random seeks by sample number and by time, returns a hash of the results
+static u64 stbl_bench_seek(const char *path, u32 interval)
+{
+	u32 i, di, samp_num;
+	u64 hash = 0, offset;
+	GF_ISOSample *samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	if (!file) return 0;
+	if (interval) gf_isom_set_sample_index(file, interval);
+
+	for (i=0; i<STBL_BENCH_SEEKS; i++) {
+		samp_num = 1 + (u32) (((u64) i * 7919 * 31) % STBL_BENCH_SAMPLES);
+		samp = gf_isom_get_sample_info(file, 1, samp_num, &di, &offset);
+		if (!samp) continue;
+		hash = hash*31 + samp->DTS + samp->dataLength + offset;
+		gf_isom_sample_del(&samp);
+
+		samp_num = 0;
+		gf_isom_get_sample_for_media_time(file, 1, (u64) (i * 7727) % (STBL_BENCH_SAMPLES*40), &di, GF_ISOM_SEARCH_FORWARD, NULL, &samp_num, &offset);
+		hash = hash*31 + samp_num + offset;
+	}
+	gf_isom_close(file);
+	return hash;
+}
+
+unittest(stbl_read_seek_index)
+{
+	u64 h_linear, h_index;
+	char path[GF_MAX_PATH];
+	isom_test_path(path, "ut_stbl_bench.mp4");
+
+	assert_true(stbl_bench_make_file(path));
+
+	h_linear = stbl_bench_seek(path, 0);
+	h_index = stbl_bench_seek(path, 64);
+	assert_true(h_linear != 0);
+	assert_equal(h_index, h_linear, LLU);
+
+	gf_file_delete(path);
+}
+
+#define STBL_LAZY_SAMPLES	20000
+
+typedef struct
+{
+	u32 size;
+	s32 cts_offset;
+	u64 dts, offset;
+} StblLazyInfo;
+
+//sizes, chunk offsets and composition offsets larger than a lazy table window, moov before mdat
+static Bool stbl_lazy_make_file(const char *path)
+{
+	u32 i;
+	u8 data[64];
+	GF_ISOSample samp;
+	GF_ISOFile *file = gf_isom_open(path, GF_ISOM_OPEN_WRITE, NULL);
+	if (!file) return GF_FALSE;
+
+	assert_equal(isom_test_new_track(file, 1, GF_ISOM_MEDIA_VISUAL, 1000), 1, "%u");
+	isom_test_ok( gf_isom_hint_max_chunk_size(file, 1, 48) );
+	isom_test_ok( gf_isom_set_storage_mode(file, GF_ISOM_STORE_STREAMABLE) );
+
+	memset(data, 0xCD, sizeof(data));
+	memset(&samp, 0, sizeof(GF_ISOSample));
+	samp.data = data;
+	samp.IsRAP = RAP;
+	for (i=0; i<STBL_LAZY_SAMPLES; i++) {
+		samp.dataLength = 1 + (i*13) % 64;
+		samp.CTS_Offset = 40 * (i%4);
+		isom_test_ok( gf_isom_add_sample(file, 1, 1, &samp) );
+		samp.DTS += 40;
+	}
+	isom_test_ok( gf_isom_close(file) );
+	return GF_TRUE;
+
+exit:
+	gf_isom_delete(file);
+	return GF_FALSE;
+}
+
+static Bool stbl_lazy_read(const char *path, const char *lazy, StblLazyInfo *infos)
+{
+	u32 i, di;
+	GF_ISOFile *file;
+	gf_opts_set_key("core", "isom-lazy", lazy);
+	file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	gf_opts_set_key("core", "isom-lazy", NULL);
+	assert_not_null(file);
+	if (!file) return GF_FALSE;
+
+	assert_equal(gf_isom_get_sample_count(file, 1), STBL_LAZY_SAMPLES, "%u");
+	//backward to go through window reloads
+	for (i=STBL_LAZY_SAMPLES; i>0; i--) {
+		GF_ISOSample *samp = gf_isom_get_sample_info(file, 1, i, &di, &infos[i-1].offset);
+		assert_not_null(samp);
+		if (!samp) break;
+		infos[i-1].size = samp->dataLength;
+		infos[i-1].dts = samp->DTS;
+		infos[i-1].cts_offset = samp->CTS_Offset;
+		gf_isom_sample_del(&samp);
+	}
+	gf_isom_close(file);
+	return i ? GF_FALSE : GF_TRUE;
+}
+
+//lazy tables give the same sample infos as tables loaded in memory, and fail once the file is truncated
+unittest(stbl_read_lazy)
+{
+	u32 i, di, size, nb_ok;
+	u8 *data = NULL;
+	u64 offset;
+	FILE *f;
+	GF_ISOSample *samp;
+	GF_ISOFile *file;
+	StblLazyInfo *eager, *lazy;
+	char path[GF_MAX_PATH];
+	isom_test_path(path, "ut_stbl_lazy.mp4");
+
+	eager = gf_malloc(sizeof(StblLazyInfo) * STBL_LAZY_SAMPLES);
+	lazy = gf_malloc(sizeof(StblLazyInfo) * STBL_LAZY_SAMPLES);
+	memset(eager, 0, sizeof(StblLazyInfo) * STBL_LAZY_SAMPLES);
+	memset(lazy, 0, sizeof(StblLazyInfo) * STBL_LAZY_SAMPLES);
+	if (!stbl_lazy_make_file(path)) goto exit;
+
+	assert_true(stbl_lazy_read(path, NULL, eager));
+	assert_true(stbl_lazy_read(path, "2", lazy));
+	assert_equal_mem(lazy, eager, sizeof(StblLazyInfo) * STBL_LAZY_SAMPLES);
+	i = STBL_LAZY_SAMPLES-1;
+	size = 1 + (i*13) % 64;
+	assert_equal(eager[i].size, size, "%u");
+	size = 40 * (i%4);
+	assert_equal((u32) eager[i].cts_offset, size, "%u");
+
+	//truncate the file while open, in the middle of the sample size table
+	isom_test_ok( gf_file_load_data(path, &data, &size) );
+	gf_opts_set_key("core", "isom-lazy", "1");
+	file = gf_isom_open(path, GF_ISOM_OPEN_READ, NULL);
+	gf_opts_set_key("core", "isom-lazy", NULL);
+	assert_not_null(file);
+	if (!file) goto exit;
+	samp = gf_isom_get_sample_info(file, 1, 1, &di, &offset);
+	assert_not_null(samp);
+	if (samp) gf_isom_sample_del(&samp);
+
+	for (i=0; i+4<size; i++) {
+		if (!memcmp(data+i, "stsz", 4)) break;
+	}
+	assert_less(i+4, size, "%u");
+	f = gf_fopen(path, "wb");
+	assert_not_null(f);
+	if (f) {
+		//keep the first two windows of 4096 sizes
+		gf_fwrite(data, i + 16 + 4*8192, f);
+		gf_fclose(f);
+	}
+
+	nb_ok = 0;
+	for (i=1; i<=STBL_LAZY_SAMPLES; i++) {
+		samp = gf_isom_get_sample_info(file, 1, i, &di, &offset);
+		if (!samp) break;
+		gf_isom_sample_del(&samp);
+		nb_ok++;
+	}
+	assert_less(nb_ok, STBL_LAZY_SAMPLES, "%u");
+	assert_equal(gf_isom_last_error(file), GF_ISOM_INVALID_FILE, "%d");
+	//table is marked as corrupted, no more reads
+	samp = gf_isom_get_sample_info(file, 1, STBL_LAZY_SAMPLES, &di, &offset);
+	assert_true(samp == NULL);
+	if (samp) gf_isom_sample_del(&samp);
+	gf_isom_close(file);
+
+exit:
+	if (data) gf_free(data);
+	gf_free(eager);
+	gf_free(lazy);
+	gf_file_delete(path);
+}
+
+//mapped sample payloads must match copied ones, and stay valid after the file is closed while the mapping is referenced
+unittest(stbl_read_mapped)
+{
+	u32 i, di, nb_samples, last_size = 0;
+	u64 missing = 0;
+	u8 last_data[64];
+	const u8 *data = NULL;
+	GF_FileMap *fmap = NULL;
+	GF_ISOSample *samp, static_samp;
+	GF_ISOFile *file = NULL;
+	char path[GF_MAX_PATH];
+	isom_test_path(path, "ut_stbl_mapped.mp4");
+
+	assert_true(stbl_bench_make_file(path));
+	isom_test_ok( gf_isom_open_mapped(path, GF_FALSE, &file, &missing, NULL) );
+	nb_samples = gf_isom_get_sample_count(file, 1);
+	assert_equal(nb_samples, STBL_BENCH_SAMPLES, "%u");
+
+	memset(&static_samp, 0, sizeof(GF_ISOSample));
+	for (i=1; i<=nb_samples; i+=97) {
+		assert_not_null(gf_isom_get_sample_mapped(file, 1, i, &di, &static_samp, NULL, &data, &fmap));
+		assert_not_null(fmap);
+		samp = gf_isom_get_sample(file, 1, i, &di);
+		assert_not_null(samp);
+		if (!samp || !fmap) break;
+		assert_equal(static_samp.dataLength, samp->dataLength, "%u");
+		assert_equal(static_samp.DTS, samp->DTS, LLU);
+		assert_equal_mem(data, samp->data, samp->dataLength);
+		last_size = samp->dataLength;
+		memcpy(last_data, samp->data, last_size);
+		gf_isom_sample_del(&samp);
+	}
+	if (!fmap) goto exit;
+
+	gf_file_map_ref(fmap);
+	gf_isom_close(file);
+	file = NULL;
+	assert_equal_mem(data, last_data, last_size);
+	//last reference
+	assert_equal(gf_file_map_unref(fmap), 0, "%u");
+
+exit:
+	if (file) gf_isom_close(file);
+	gf_file_delete(path);
+}
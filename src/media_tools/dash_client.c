@@ -125,6 +125,8 @@ struct __dash_client
 	u32 reload_count, last_update_time;
 	/*signature of last MPD*/
 	u8 lastMPDSignature[GF_SHA1_DIGEST_SIZE];
+	/*segment timeline entries of the last replaced MPD, reused when parsing the next update*/
+	GF_List *stl_entry_pool;
 	/*mime type of media segments (m3u8)*/
 	char *mimeTypeForM3U8Segments;
 
@@ -232,6 +234,8 @@ struct __dash_client
 
 	//async manifest fetching
 	u32 manifest_pending;
+	//MPD patches failed to apply, always fetch the full MPD
+	Bool mpd_patch_disabled;
 	//manifest parsed but xlink at rep level
 	GF_MPD *pending_mpd;
 	Bool pending_has_reps_unchanged;
@@ -2541,6 +2545,95 @@ static void dash_check_chaining(GF_DashClient *dash, char *scheme_id, char **cha
 }
 
 
+static Bool gf_dash_can_patch_mpd(GF_DashClient *dash, GF_MPD *mpd)
+{
+	if (!mpd || !mpd->patch_location || (mpd->type != GF_MPD_TYPE_DYNAMIC)) return GF_FALSE;
+	if (dash->mpd_patch_disabled || dash->is_m3u8 || dash->is_smooth) return GF_FALSE;
+	//the client MPD no longer matches the server one
+	if (dash->split_adaptation_set || dash->ignore_xlink) return GF_FALSE;
+	//manifest is forwarded, full MPD needed
+	if (dash->dash_io->manifest_updated) return GF_FALSE;
+	return GF_TRUE;
+}
+
+/*fetches the MPD patch and applies it to the current MPD, timelines being modified in place
+returns GF_BAD_PARAM if the patch cannot be applied to the current MPD*/
+static GF_Err gf_dash_patch_manifest(GF_DashClient *dash)
+{
+	GF_Err e;
+	u32 i;
+	u64 fetch_time;
+	const char *local_url;
+	char *purl = gf_url_concatenate(dash->base_url, dash->mpd->patch_location);
+	if (!purl) return GF_OUT_OF_MEM;
+
+	if (!dash->mpd_dnload) {
+		if (!gf_file_exists(purl)) {
+			gf_free(purl);
+			return GF_BAD_PARAM;
+		}
+		local_url = purl;
+	} else {
+		e = gf_dash_download_resource(dash, &(dash->mpd_dnload), purl, 0, 0, 0, NULL);
+		if (e!=GF_OK) {
+			gf_free(purl);
+			if (e==GF_NOT_READY) {
+				dash->manifest_pending = 1;
+				return GF_NOT_READY;
+			}
+			dash->manifest_pending = 0;
+			return GF_BAD_PARAM;
+		}
+		dash->manifest_pending = 0;
+		local_url = dash->dash_io->get_cache_name(dash->dash_io, dash->mpd_dnload);
+	}
+	fetch_time = dash_get_fetch_time(dash);
+
+	//locate current segment of each group before modifying timelines
+	for (i=0; i<gf_list_count(dash->groups); i++) {
+		GF_DASH_Group *group = gf_list_get(dash->groups, i);
+		group->current_pto = 0;
+		group->current_start_time = gf_dash_get_segment_start_time_with_timescale(group, NULL, &group->current_timescale, &group->current_pto);
+	}
+
+	e = local_url ? gf_mpd_apply_patch(dash->mpd, local_url) : GF_IO_ERR;
+	gf_free(purl);
+	if (e==GF_EOS) {
+		dash->reload_count++;
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] MPD patch did not change for %d consecutive reloads\n", dash->reload_count));
+		dash->last_update_time = gf_sys_clock();
+		dash->mpd_fetch_time = fetch_time;
+		return GF_OK;
+	}
+	if (e) return e;
+	dash->reload_count = 0;
+
+	for (i=0; i<gf_list_count(dash->groups); i++) {
+		u32 timescale=0;
+		u64 duration;
+		Double seg_dur;
+		GF_MPD_SegmentTimeline *timeline = NULL;
+		GF_DASH_Group *group = gf_list_get(dash->groups, i);
+		GF_MPD_Representation *rep = gf_list_get(group->adaptation_set->representations, group->active_rep_index);
+#ifndef GPAC_DISABLE_LOG
+		s32 prev_idx = group->download_segment_index;
+#endif
+
+		gf_mpd_resolve_segment_duration(rep, group->adaptation_set, group->period, &duration, &timescale, NULL, &timeline);
+		if (!timeline) continue;
+		group->download_segment_index = gf_dash_get_index_in_timeline(timeline, group->current_start_time+group->current_pto, group->current_timescale, timescale ? timescale : group->current_timescale);
+		gf_dash_get_segment_duration(rep, group->adaptation_set, group->period, dash->mpd, &group->nb_segments_in_rep, &seg_dur);
+		group->last_mpd_change_time = gf_sys_clock();
+
+		GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] Patched SegmentTimeline: New segment number %d - old %d - start time "LLD" - %d segments\n", group->download_segment_index , prev_idx, group->current_start_time, group->nb_segments_in_rep));
+	}
+	GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] Manifest patched\n"));
+
+	dash->last_update_time = gf_sys_clock();
+	dash->mpd_fetch_time = fetch_time;
+	return GF_OK;
+}
+
 static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 {
 	GF_Err e;
@@ -2577,6 +2670,25 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		goto resume_mpd_parse;
 	}
 
+	//try patching the MPD, only fetching the full MPD if the patch does not apply to our version
+	if (!dash->in_error && gf_dash_can_patch_mpd(dash, dash->mpd)) {
+		Bool expired = GF_FALSE;
+		if (dash->mpd->patch_location_ttl && (dash_get_fetch_time(dash) > dash->mpd->publishTime + 1000 * (u64) dash->mpd->patch_location_ttl))
+			expired = GF_TRUE;
+
+		if (!expired) {
+			e = gf_dash_patch_manifest(dash);
+			if ((e==GF_OK) || (e==GF_NOT_READY)) return e;
+
+			if (e==GF_BAD_PARAM) {
+				GF_LOG(GF_LOG_INFO, GF_LOG_DASH, ("[DASH] MPD patch not applicable, fetching manifest\n"));
+			} else {
+				GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[DASH] Failed to apply MPD patch: %s - disabling MPD patches\n", gf_error_to_string(e) ));
+				dash->mpd_patch_disabled = GF_TRUE;
+			}
+		}
+	}
+
 	if (!dash->mpd_dnload) {
 		local_url = purl = NULL;
 		if (!gf_list_count(dash->mpd->locations)) {
@@ -2728,20 +2840,24 @@ static GF_Err gf_dash_update_manifest(GF_DashClient *dash)
 		}
 
 		/* It means we have to reparse the file ... */
-		/* parse the MPD */
-		mpd_parser = gf_xml_dom_new();
-		e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
-		if (e != GF_OK) {
-			gf_xml_dom_del(mpd_parser);
-			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in XML parsing %s\n", gf_error_to_string(e)));
-			return GF_NON_COMPLIANT_BITSTREAM;
-		}
 		new_mpd = gf_mpd_new();
-		if (dash->is_smooth)
+		if (dash->is_smooth) {
+			/* parse the MPD */
+			mpd_parser = gf_xml_dom_new();
+			e = gf_xml_dom_parse(mpd_parser, local_url, NULL, NULL);
+			if (e != GF_OK) {
+				gf_xml_dom_del(mpd_parser);
+				gf_mpd_del(new_mpd);
+				GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in XML parsing %s\n", gf_error_to_string(e)));
+				return GF_NON_COMPLIANT_BITSTREAM;
+			}
 			e = gf_mpd_init_smooth_from_dom(gf_xml_dom_get_root(mpd_parser), new_mpd, purl);
-		else
-			e = gf_mpd_init_from_dom(gf_xml_dom_get_root(mpd_parser), new_mpd, purl);
-		gf_xml_dom_del(mpd_parser);
+			gf_xml_dom_del(mpd_parser);
+		} else {
+			//timeline entries are created while parsing, reusing the ones from the previous update
+			if (!dash->stl_entry_pool) dash->stl_entry_pool = gf_list_new();
+			e = gf_mpd_init_from_file(new_mpd, local_url, purl, dash->stl_entry_pool);
+		}
 		if (e) {
 			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[DASH] Error - cannot update playlist: error in MPD creation %s\n", gf_error_to_string(e)));
 			gf_mpd_del(new_mpd);
@@ -3492,8 +3608,9 @@ process_m3u8_manifest:
 		gf_assert( gf_list_count(group->adaptation_set->representations) );
 
 		/*now that all possible SegmentXXX have been updated, purge them if needed: all segments ending before timeline_start_time
-		will be removed from MPD*/
-		if (timeline_start_time) {
+		will be removed from MPD
+		when patching, timelines must be kept identical to the server ones*/
+		if (timeline_start_time && !gf_dash_can_patch_mpd(dash, new_mpd)) {
 			u32 nb_segments_removed = gf_dash_purge_segment_timeline(group, timeline_start_time);
 			if (nb_segments_removed) {
 				GF_LOG(GF_LOG_DEBUG, GF_LOG_DASH, ("[DASH] AdaptationSet %d - removed %d segments from timeline (%d since start of the period)\n", group_idx+1, nb_segments_removed, group->nb_segments_purged));
@@ -3564,6 +3681,8 @@ exit:
 		if (dash->mpd) {
 			if (!new_mpd->minimum_update_period && (new_mpd->type==GF_MPD_TYPE_DYNAMIC))
 				new_mpd->minimum_update_period = dash->mpd->minimum_update_period;
+			if (dash->stl_entry_pool)
+				gf_mpd_recycle_timeline_entries(dash->mpd, dash->stl_entry_pool);
 			gf_mpd_del(dash->mpd);
 		}
 		dash->mpd = new_mpd;
@@ -9310,6 +9429,7 @@ void gf_dash_close(GF_DashClient *dash)
 		dash->pending_mpd = NULL;
 	}
 	dash->manifest_pending = 0;
+	dash->mpd_patch_disabled = GF_FALSE;
 	dash->pending_has_reps_unchanged = GF_FALSE;
 	dash->pending_nb_rep_unchanged = dash->pending_group_idx_plus_one = dash->pending_rep_idx_plus_one = 0;
 }
@@ -9454,6 +9574,13 @@ void gf_dash_del(GF_DashClient *dash)
 	if (dash->mimeTypeForM3U8Segments) gf_free(dash->mimeTypeForM3U8Segments);
 	if (dash->base_url) gf_free(dash->base_url);
 	if (dash->query_part) gf_free(dash->query_part);
+	if (dash->stl_entry_pool) {
+		while (gf_list_count(dash->stl_entry_pool)) {
+			GF_MPD_SegmentTimelineEntry *se = gf_list_pop_back(dash->stl_entry_pool);
+			gf_free(se);
+		}
+		gf_list_del(dash->stl_entry_pool);
+	}
 
 	gf_free(dash);
 }
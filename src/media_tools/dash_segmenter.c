@@ -1204,10 +1204,15 @@ GF_Err dash_state_check_timing(const char *dash_state, u64 *next_gen_ntp_ms, u32
 	if (!gf_file_exists(dash_state))
 		return GF_OK;
 
-	/* parse the MPD XML */
-	mpd_parser = gf_xml_dom_new();
-	e = gf_xml_dom_parse(mpd_parser, dash_state, NULL, NULL);
-	if (!e) {
+	//binary state, next generation time is in header
+	if (gf_mpd_is_binary_state(dash_state, &next_gen_ntp)) {
+		mpd_parser = NULL;
+	} else {
+		/* parse the MPD XML */
+		mpd_parser = gf_xml_dom_new();
+		e = gf_xml_dom_parse(mpd_parser, dash_state, NULL, NULL);
+	}
+	if (!e && mpd_parser) {
 		GF_XMLNode *root = gf_xml_dom_get_root(mpd_parser);
 		GF_XMLAttribute *att;
 		u32 i=0;
@@ -29,6 +29,7 @@
 #include <gpac/internal/m3u8.h>
 #include <gpac/network.h>
 #include <gpac/maths.h>
+#include <gpac/thread.h>
 
 #ifndef GPAC_DISABLE_MPD
 
@@ -365,6 +366,121 @@ static void gf_mpd_parse_segment_base_generic(GF_MPD *mpd, GF_MPD_SegmentBase *s
 	}
 }
 
+typedef struct
+{
+	GF_XMLNode *node;
+	GF_MPD_SegmentTimeline *tl;
+	u64 start_time;
+} MPD_SAXTimeline;
+
+typedef struct __mpd_sax_parse
+{
+	GF_DOMParser *dom;
+	//timelines in document order
+	GF_List *timelines;
+	u32 cursor;
+	//recycled entries, may be NULL
+	GF_List *entry_pool;
+	Bool alloc_error;
+} MPD_SAXParse;
+
+void gf_mpd_segment_timeline_free(void *_item);
+static void mpd_patch_state_del(struct __mpd_patch_state *ps);
+
+static Bool mpd_sax_same_ns(const char *ns1, const char *ns2)
+{
+	if (!ns1 || !ns2) return (ns1==ns2) ? GF_TRUE : GF_FALSE;
+	return strcmp(ns1, ns2) ? GF_FALSE : GF_TRUE;
+}
+
+/*parses t, d, r and k attributes of an S element*/
+static void gf_mpd_parse_segment_timeline_entry_att(GF_MPD_SegmentTimelineEntry *se, const GF_XMLAttribute *att)
+{
+	if (!strcmp(att->name, "t"))
+		se->start_time = gf_mpd_parse_long_int(att->value);
+	else if (!strcmp(att->name, "d"))
+		se->duration = gf_mpd_parse_int(att->value);
+	else if (!strcmp(att->name, "r")) {
+		se->repeat_count = gf_mpd_parse_int(att->value);
+		if (se->repeat_count == (u32)-1)
+			se->repeat_count--;
+	}
+	else if (!strcmp(att->name, "k"))
+		se->nb_parts = gf_mpd_parse_int(att->value);
+}
+
+/*updates start time of the next S element once all attributes of an S element are parsed*/
+static void gf_mpd_segment_timeline_entry_end(GF_MPD_SegmentTimelineEntry *se, u64 *curr_start_time)
+{
+	if (se->start_time)
+		*curr_start_time = se->start_time;
+	*curr_start_time += (u64) (se->duration * (se->repeat_count+1));
+}
+
+/*creates timeline entries from S elements while parsing, instead of building their DOM nodes*/
+static Bool mpd_sax_node_filter(void *udta, GF_XMLNode *parent, const char *node_name, const char *name_space, const GF_XMLAttribute *attributes, u32 nb_attributes)
+{
+	u32 i;
+	GF_XMLNode *root;
+	MPD_SAXTimeline *stl;
+	GF_MPD_SegmentTimelineEntry *se;
+	MPD_SAXParse *sp = (MPD_SAXParse *)udta;
+
+	if (!parent || strcmp(node_name, "S") || strcmp(parent->name, "SegmentTimeline")) return GF_FALSE;
+	//only for elements in the MPD namespace, other ones are ignored when parsing the DOM
+	root = gf_xml_dom_get_root(sp->dom);
+	if (!root || !mpd_sax_same_ns(name_space, root->ns) || !mpd_sax_same_ns(parent->ns, root->ns))
+		return GF_FALSE;
+
+	stl = gf_list_last(sp->timelines);
+	if (!stl || (stl->node != parent)) {
+		GF_SAFEALLOC(stl, MPD_SAXTimeline);
+		if (stl) stl->tl = gf_mpd_segmentimeline_new();
+		if (!stl || !stl->tl || gf_list_add(sp->timelines, stl)) {
+			if (stl && stl->tl) gf_mpd_segment_timeline_free(stl->tl);
+			if (stl) gf_free(stl);
+			sp->alloc_error = GF_TRUE;
+			return GF_TRUE;
+		}
+		stl->node = parent;
+	}
+	se = gf_list_pop_back(sp->entry_pool);
+	if (se) {
+		memset(se, 0, sizeof(GF_MPD_SegmentTimelineEntry));
+	} else {
+		GF_SAFEALLOC(se, GF_MPD_SegmentTimelineEntry);
+		if (!se) {
+			sp->alloc_error = GF_TRUE;
+			return GF_TRUE;
+		}
+	}
+	se->start_time = stl->start_time;
+	gf_list_add(stl->tl->entries, se);
+
+	for (i=0; i<nb_attributes; i++) {
+		gf_mpd_parse_segment_timeline_entry_att(se, &attributes[i]);
+	}
+	gf_mpd_segment_timeline_entry_end(se, &stl->start_time);
+	return GF_TRUE;
+}
+
+static GF_MPD_SegmentTimeline *mpd_sax_get_timeline(MPD_SAXParse *sp, GF_XMLNode *root)
+{
+	u32 i, count = gf_list_count(sp->timelines);
+	//timelines are usually requested in document order
+	for (i=0; i<count; i++) {
+		u32 idx = (sp->cursor + i) % count;
+		MPD_SAXTimeline *stl = gf_list_get(sp->timelines, idx);
+		if (stl->node == root) {
+			GF_MPD_SegmentTimeline *tl = stl->tl;
+			stl->tl = NULL;
+			sp->cursor = idx+1;
+			return tl;
+		}
+	}
+	return NULL;
+}
+
 static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XMLNode *root)
 {
 	u32 i, j;
@@ -372,6 +488,12 @@ static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XML
 	GF_XMLAttribute *att;
 	GF_XMLNode *child;
 	GF_MPD_SegmentTimeline *seg;
+
+	//entries already created while parsing the XML
+	if (mpd->sax_parse) {
+		seg = mpd_sax_get_timeline(mpd->sax_parse, root);
+		if (seg) return seg;
+	}
 	GF_SAFEALLOC(seg, GF_MPD_SegmentTimeline);
 	if (!seg) return NULL;
 	seg->entries = gf_list_new();
@@ -388,22 +510,9 @@ static GF_MPD_SegmentTimeline *gf_mpd_parse_segment_timeline(GF_MPD *mpd, GF_XML
 
 			j = 0;
 			while ( (att = gf_list_enum(child->attributes, &j)) ) {
-				if (!strcmp(att->name, "t"))
-					seg_tl_ent->start_time = gf_mpd_parse_long_int(att->value);
-				else if (!strcmp(att->name, "d"))
-					seg_tl_ent->duration = gf_mpd_parse_int(att->value);
-				else if (!strcmp(att->name, "r")) {
-					seg_tl_ent->repeat_count = gf_mpd_parse_int(att->value);
-					if (seg_tl_ent->repeat_count == (u32)-1)
-						seg_tl_ent->repeat_count--;
-				}
-				else if (!strcmp(att->name, "k"))
-					seg_tl_ent->nb_parts = gf_mpd_parse_int(att->value);
+				gf_mpd_parse_segment_timeline_entry_att(seg_tl_ent, att);
 			}
-			if (seg_tl_ent->start_time)
-				curr_start_time = seg_tl_ent->start_time;
-
-			curr_start_time += (u64) (seg_tl_ent->duration * (seg_tl_ent->repeat_count+1));
+			gf_mpd_segment_timeline_entry_end(seg_tl_ent, &curr_start_time);
 		}
 	}
 	return seg;
@@ -1254,10 +1363,50 @@ void gf_mpd_segment_entry_free(void *_item)
 {
 	gf_free(_item);
 }
+
+/*a run of timeline entries serialized as a single S element*/
+typedef struct
+{
+	//index of the first entry in the run
+	u32 first;
+	//offset of the run in the serialized text
+	u32 offset;
+	//timeline time before the run
+	u64 start_time;
+} MPD_STLRun;
+
+/*serialized S elements of a segment timeline, only closed runs (which cannot be extended by new entries) are kept across writes*/
+typedef struct __mpd_stl_cache
+{
+	char *text;
+	u32 size, alloc;
+	MPD_STLRun *runs;
+	u32 nb_runs, nb_alloc_runs;
+	//index of the entry following the last run, and timeline time at this entry
+	u32 next_entry;
+	u64 end_time;
+	//first serialized entry and indentation used for the cached text
+	u32 first_entry;
+	s32 indent;
+	//first entry modified since last serialization, in current entry indexing
+	u32 dirty;
+	//number of entries removed from head since last serialization
+	u32 nb_removed;
+	Bool head_modified;
+} MPD_STLCache;
+
+static void mpd_stl_cache_del(MPD_STLCache *c)
+{
+	if (c->text) gf_free(c->text);
+	if (c->runs) gf_free(c->runs);
+	gf_free(c);
+}
+
 void gf_mpd_segment_timeline_free(void *_item)
 {
 	GF_MPD_SegmentTimeline *ptr = (GF_MPD_SegmentTimeline *)_item;
 	gf_mpd_del_list(ptr->entries, gf_mpd_segment_entry_free, 0);
+	if (ptr->cache) mpd_stl_cache_del(ptr->cache);
 	gf_free(ptr);
 }
 
@@ -1501,6 +1650,8 @@ void gf_mpd_del(GF_MPD *mpd)
 	gf_mpd_del_list(mpd->program_infos, gf_mpd_prog_info_free, 0);
 	gf_mpd_del_list(mpd->base_URLs, gf_mpd_base_url_free, 0);
 	gf_mpd_del_list(mpd->locations, gf_mpd_string_free, 0);
+	if (mpd->patch_location) gf_free(mpd->patch_location);
+	if (mpd->patch_state) mpd_patch_state_del(mpd->patch_state);
 	gf_mpd_del_list(mpd->metrics, NULL/*TODO*/, 0);
 	gf_mpd_del_list(mpd->periods, gf_mpd_period_free, 0);
 	if (mpd->profiles) gf_free(mpd->profiles);
@@ -1616,6 +1767,14 @@ GF_Err gf_mpd_complete_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *defau
 		} else if (!strcmp(child->name, "Location")) {
 			char *str = gf_mpd_parse_text_content(child);
 			if (str) gf_list_add(mpd->locations, str);
+		} else if (!strcmp(child->name, "PatchLocation")) {
+			GF_XMLAttribute *ttl_att;
+			u32 j = 0;
+			if (mpd->patch_location) gf_free(mpd->patch_location);
+			mpd->patch_location = gf_mpd_parse_text_content(child);
+			while ((ttl_att = gf_list_enum(child->attributes, &j))) {
+				if (!strcmp(ttl_att->name, "ttl")) mpd->patch_location_ttl = gf_mpd_parse_int(ttl_att->value);
+			}
 		} else if (!strcmp(child->name, "PrePeriod") || !strcmp(child->name, "Period")) {
 			e = gf_mpd_parse_period(mpd, child);
 			if (e) return e;
@@ -1668,6 +1827,83 @@ GF_Err gf_mpd_init_from_dom(GF_XMLNode *root, GF_MPD *mpd, const char *default_b
 	return gf_mpd_complete_from_dom(root, mpd, default_base_url);
 }
 
+GF_EXPORT
+GF_Err gf_mpd_init_from_file(GF_MPD *mpd, const char *file, const char *default_base_url, GF_List *entry_pool)
+{
+	GF_Err e;
+	MPD_SAXParse sp;
+
+	memset(&sp, 0, sizeof(MPD_SAXParse));
+	sp.entry_pool = entry_pool;
+	sp.dom = gf_xml_dom_new();
+	sp.timelines = gf_list_new();
+	if (!sp.dom || !sp.timelines) {
+		e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	gf_xml_dom_set_node_filter(sp.dom, mpd_sax_node_filter, &sp);
+	e = gf_xml_dom_parse(sp.dom, file, NULL, NULL);
+	if (!e && sp.alloc_error) e = GF_OUT_OF_MEM;
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Cannot parse %s: %s\n", file, gf_xml_dom_get_error(sp.dom) ));
+		goto exit;
+	}
+
+	mpd->sax_parse = &sp;
+	e = gf_mpd_init_from_dom(gf_xml_dom_get_root(sp.dom), mpd, default_base_url);
+	mpd->sax_parse = NULL;
+
+exit:
+	//timelines not attached to the MPD
+	while (gf_list_count(sp.timelines)) {
+		MPD_SAXTimeline *stl = gf_list_pop_back(sp.timelines);
+		if (stl->tl) gf_mpd_segment_timeline_free(stl->tl);
+		gf_free(stl);
+	}
+	gf_list_del(sp.timelines);
+	gf_xml_dom_del(sp.dom);
+	return e;
+}
+
+static void mpd_recycle_timeline(GF_MPD_MultipleSegmentBase *ms, GF_List *entry_pool)
+{
+	u32 i, count;
+	if (!ms || !ms->segment_timeline) return;
+	count = gf_list_count(ms->segment_timeline->entries);
+	for (i=0; i<count; i++) {
+		GF_MPD_SegmentTimelineEntry *se = gf_list_get(ms->segment_timeline->entries, i);
+		if (gf_list_add(entry_pool, se))
+			gf_free(se);
+	}
+	gf_list_reset(ms->segment_timeline->entries);
+}
+
+GF_EXPORT
+void gf_mpd_recycle_timeline_entries(GF_MPD *mpd, GF_List *entry_pool)
+{
+	u32 i, j, k;
+	GF_MPD_Period *period;
+	GF_MPD_AdaptationSet *as;
+	GF_MPD_Representation *rep;
+	if (!mpd || !entry_pool) return;
+
+	i=0;
+	while ((period = (GF_MPD_Period *) gf_list_enum(mpd->periods, &i))) {
+		mpd_recycle_timeline((GF_MPD_MultipleSegmentBase *) period->segment_list, entry_pool);
+		mpd_recycle_timeline((GF_MPD_MultipleSegmentBase *) period->segment_template, entry_pool);
+		j=0;
+		while ((as = (GF_MPD_AdaptationSet *) gf_list_enum(period->adaptation_sets, &j))) {
+			mpd_recycle_timeline((GF_MPD_MultipleSegmentBase *) as->segment_list, entry_pool);
+			mpd_recycle_timeline((GF_MPD_MultipleSegmentBase *) as->segment_template, entry_pool);
+			k=0;
+			while ((rep = (GF_MPD_Representation *) gf_list_enum(as->representations, &k))) {
+				mpd_recycle_timeline((GF_MPD_MultipleSegmentBase *) rep->segment_list, entry_pool);
+				mpd_recycle_timeline((GF_MPD_MultipleSegmentBase *) rep->segment_template, entry_pool);
+			}
+		}
+	}
+}
+
 //locate codec in renditions and try to extract bandwidth (we can't really)
 static char *group_to_codecs(MasterPlaylist *pl, PlaylistElement *pe, u32 *bandwidth)
 {
@@ -2912,26 +3148,44 @@ static GFINLINE void gf_mpd_nl(FILE *out, s32 indent)
 	}
 }
 
+/*converts UTC time in seconds since 1970 to broken-down time, without using gmtime static storage
+so that playlists can be written from several threads*/
+static void mpd_utc_to_tm(u64 utc_sec, struct tm *t)
+{
+	s64 era, days = (s64) (utc_sec / 86400);
+	u32 doe, yoe, doy, mp, secs = (u32) (utc_sec % 86400);
+
+	memset(t, 0, sizeof(struct tm));
+	t->tm_hour = secs / 3600;
+	t->tm_min = (secs / 60) % 60;
+	t->tm_sec = secs % 60;
+
+	//civil from days, shifting year start to March 1st
+	days += 719468;
+	era = days / 146097;
+	doe = (u32) (days - era * 146097);
+	yoe = (doe - doe/1460 + doe/36524 - doe/146096) / 365;
+	doy = doe - (365*yoe + yoe/4 - yoe/100);
+	mp = (5*doy + 2)/153;
+	t->tm_mday = doy - (153*mp+2)/5 + 1;
+	t->tm_mon = (mp < 10) ? mp+2 : mp-10;
+	t->tm_year = (s32) (yoe + era * 400) + ((t->tm_mon <= 1) ? 1 : 0) - 1900;
+}
+
 /*time is given in ms*/
 void gf_mpd_print_date(FILE *out, char *name, u64 time)
 {
-	time_t gtime;
-	struct tm *t;
+	struct tm t;
 	u32 sec;
 	u32 ms;
-	gtime = time / 1000;
 	sec = (u32)(time / 1000);
 	ms = (u32)(time - ((u64)sec) * 1000);
 
 	if (name) {
 		gf_xml_dump_string(out, " ", name, "=\"");
 	}
-	t = gf_gmtime(&gtime);
-	sec = t->tm_sec;
-	//see issue #859, no clue how this happened...
-	if (sec > 60)
-		sec = 60;
-	gf_fprintf(out, "%d-%02d-%02dT%02d:%02d:%02d.%03dZ", 1900 + t->tm_year, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, sec, ms);
+	mpd_utc_to_tm(time / 1000, &t);
+	gf_fprintf(out, "%d-%02d-%02dT%02d:%02d:%02d.%03dZ", 1900 + t.tm_year, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, ms);
 
 	if (name) {
 		gf_fprintf(out, "\"");
@@ -3021,60 +3275,236 @@ static void gf_mpd_print_segment_base(FILE *out, GF_MPD_SegmentBase *s, s32 inde
 	gf_mpd_lf(out, indent);
 }
 
-static void gf_mpd_print_segment_timeline(FILE *out, GF_MPD_SegmentTimeline *tl, s32 indent, u32 tsb_first_entry)
+static void mpd_stl_printf(MPD_STLCache *c, const char *fmt, ...)
 {
-	u32 i, count, rcount;
-	u64 start_time=0;
-	GF_MPD_SegmentTimelineEntry *se, *prev;
-
-	gf_mpd_nl(out, indent);
-	gf_fprintf(out, "<SegmentTimeline>");
-	gf_mpd_lf(out, indent);
+	va_list vl;
+	while (1) {
+		s32 len;
+		u32 alloc, avail = c->alloc - c->size;
+		char *text;
+		va_start(vl, fmt);
+		len = vsnprintf(c->text ? c->text + c->size : NULL, avail, fmt, vl);
+		va_end(vl);
+		if (len<0) return;
+		if ((u32) len < avail) {
+			c->size += (u32) len;
+			return;
+		}
+		alloc = MAX(2*c->alloc, c->size + (u32) len + 1);
+		text = gf_realloc(c->text, alloc);
+		if (!text) return;
+		c->text = text;
+		c->alloc = alloc;
+	}
+}
 
-	prev = gf_list_get(tl->entries, tsb_first_entry);
-	count = gf_list_count(tl->entries);
-	if (!prev) goto done_tl;
+static void mpd_stl_close_run(MPD_STLCache *c, GF_MPD_SegmentTimelineEntry *se, u32 rcount, s32 indent)
+{
+	if (rcount) mpd_stl_printf(c, " r=\"%d\"", rcount);
+	if (se->nb_parts) mpd_stl_printf(c, " k=\"%d\"", se->nb_parts);
+	mpd_stl_printf(c, "/>");
+	if (indent>=0) mpd_stl_printf(c, "\n");
+}
 
-	gf_mpd_nl(out, indent+1);
-	gf_fprintf(out, "<S");
-	gf_fprintf(out, " t=\""LLD"\"", prev->start_time);
-	if (prev->duration) gf_fprintf(out, " d=\"%d\"", prev->duration);
-	rcount = prev->repeat_count;
-	start_time = prev->start_time + (prev->repeat_count+1) * prev->duration;
+/*serializes entries starting from first_entry, stopping when a new run would start at entry stop_entry
+returns GF_FALSE if entry stop_entry does not start a new run*/
+static Bool mpd_stl_write_runs(MPD_STLCache *c, GF_MPD_SegmentTimeline *tl, u32 first_entry, u32 stop_entry, Bool is_first, s32 indent, Bool record)
+{
+	u32 i, rcount=0, count = gf_list_count(tl->entries);
+	u64 start_time = c->end_time;
+	GF_MPD_SegmentTimelineEntry *se, *prev=NULL;
 
-	for (i = tsb_first_entry+1; i<count && prev; i++) {
+	for (i=first_entry; i<count; i++) {
 		se = gf_list_get(tl->entries, i);
 		//close entry if not contiguous
 		//if ll edge entry, stop so that we can announce subparts in already published entries
-		if ((se->start_time != start_time) || (prev->duration!=se->duration) || se->is_ll_edge) {
-			if (rcount) gf_fprintf(out, " r=\"%d\"", rcount);
-			if (prev->nb_parts) gf_fprintf(out, " k=\"%d\"", prev->nb_parts);
-			gf_fprintf(out, "/>");
-			gf_mpd_lf(out, indent);
+		if (prev && (se->start_time == start_time) && (prev->duration==se->duration) && !se->is_ll_edge) {
+			if (i==stop_entry) return GF_FALSE;
+			rcount++;
+		} else {
+			if (prev) mpd_stl_close_run(c, prev, rcount, indent);
+			if (i==stop_entry) {
+				prev = NULL;
+				break;
+			}
 			//start new one
-			gf_mpd_nl(out, indent+1);
-			gf_fprintf(out, "<S");
-			if (se->start_time != start_time) {
-				gf_fprintf(out, " t=\""LLD"\"", se->start_time);
+			if (record) {
+				if (c->nb_runs==c->nb_alloc_runs) {
+					u32 nb_alloc = c->nb_alloc_runs ? 2*c->nb_alloc_runs : 64;
+					MPD_STLRun *runs = gf_realloc(c->runs, sizeof(MPD_STLRun)*nb_alloc);
+					if (!runs) {
+						//runs are no longer valid, stop recording
+						c->nb_runs = 0;
+						record = GF_FALSE;
+					} else {
+						c->runs = runs;
+						c->nb_alloc_runs = nb_alloc;
+					}
+				}
+				if (record) {
+					c->runs[c->nb_runs].first = i;
+					c->runs[c->nb_runs].offset = c->size;
+					c->runs[c->nb_runs].start_time = start_time;
+					c->nb_runs++;
+				}
+			}
+			if (indent>0) mpd_stl_printf(c, "%*s", indent, "");
+			mpd_stl_printf(c, "<S");
+			if (is_first || (se->start_time != start_time)) {
+				mpd_stl_printf(c, " t=\""LLD"\"", se->start_time);
 				start_time = se->start_time;
+				is_first = GF_FALSE;
 			}
-			if (se->duration) gf_fprintf(out, " d=\"%d\"", se->duration);
+			if (se->duration) mpd_stl_printf(c, " d=\"%d\"", se->duration);
 			rcount=0;
-		} else {
-			rcount++;
 		}
 		start_time += (se->repeat_count+1) * se->duration;
 		rcount += se->repeat_count;
 		prev = se;
 	}
 	//close last entry
-	if (rcount) gf_fprintf(out, " r=\"%d\"", rcount);
-	if (prev->nb_parts) gf_fprintf(out, " k=\"%d\"", prev->nb_parts);
-	gf_fprintf(out, "/>");
+	if (prev) mpd_stl_close_run(c, prev, rcount, indent);
+	c->next_entry = i;
+	c->end_time = start_time;
+	return GF_TRUE;
+}
+
+static void mpd_stl_cache_reset(MPD_STLCache *c)
+{
+	c->nb_runs = 0;
+	c->size = 0;
+	c->end_time = 0;
+}
+
+/*drops cached runs that are no longer valid and serializes runs at the head of the timeline if needed*/
+static void mpd_stl_cache_update(MPD_STLCache *c, GF_MPD_SegmentTimeline *tl, u32 first_entry, s32 indent)
+{
+	u32 i, start, end, head_offset, tail_offset, min_first;
+	u32 count = gf_list_count(tl->entries);
+	MPD_STLCache head;
+
+	if (!c->nb_runs || (c->indent != indent)) {
+		mpd_stl_cache_reset(c);
+		return;
+	}
+	//first printed entry always has a start time, drop the cached head run if the head has changed
+	min_first = c->nb_removed + first_entry;
+	if (c->head_modified || (c->first_entry != first_entry)) min_first++;
+
+	start = 0;
+	while ((start < c->nb_runs) && (c->runs[start].first < min_first))
+		start++;
+	//keep runs followed by an unmodified entry, which was the one closing the run
+	end = start;
+	while (end < c->nb_runs) {
+		u32 next = (end+1 < c->nb_runs) ? c->runs[end+1].first : c->next_entry;
+		next -= c->nb_removed;
+		if ((next >= c->dirty) || (next >= count)) break;
+		end++;
+	}
+	if (start==end) {
+		mpd_stl_cache_reset(c);
+		return;
+	}
+
+	head_offset = c->runs[start].offset;
+	if (end < c->nb_runs) {
+		tail_offset = c->runs[end].offset;
+		c->next_entry = c->runs[end].first;
+		c->end_time = c->runs[end].start_time;
+	} else {
+		tail_offset = c->size;
+	}
+	c->next_entry -= c->nb_removed;
+	if (head_offset)
+		memmove(c->text, c->text + head_offset, tail_offset - head_offset);
+	c->size = tail_offset - head_offset;
+	for (i=start; i<end; i++) {
+		c->runs[i-start].first = c->runs[i].first - c->nb_removed;
+		c->runs[i-start].offset = c->runs[i].offset - head_offset;
+		c->runs[i-start].start_time = c->runs[i].start_time;
+	}
+	c->nb_runs = end - start;
+	if (c->runs[0].first == first_entry) return;
+
+	//serialize new head runs and insert them before cached ones
+	memset(&head, 0, sizeof(MPD_STLCache));
+	if (!mpd_stl_write_runs(&head, tl, first_entry, c->runs[0].first, GF_TRUE, indent, GF_TRUE)
+		|| (head.next_entry != c->runs[0].first) || (head.end_time != c->runs[0].start_time)
+	) {
+		goto head_fail;
+	}
+	if (c->size + head.size > c->alloc) {
+		char *text = gf_realloc(c->text, c->size + head.size);
+		if (!text) goto head_fail;
+		c->text = text;
+		c->alloc = c->size + head.size;
+	}
+	if (c->nb_runs + head.nb_runs > c->nb_alloc_runs) {
+		MPD_STLRun *runs = gf_realloc(c->runs, sizeof(MPD_STLRun) * (c->nb_runs + head.nb_runs));
+		if (!runs) goto head_fail;
+		c->runs = runs;
+		c->nb_alloc_runs = c->nb_runs + head.nb_runs;
+	}
+	memmove(c->text + head.size, c->text, c->size);
+	memcpy(c->text, head.text, head.size);
+	c->size += head.size;
+	memmove(c->runs + head.nb_runs, c->runs, sizeof(MPD_STLRun) * c->nb_runs);
+	for (i=head.nb_runs; i<head.nb_runs+c->nb_runs; i++)
+		c->runs[i].offset += head.size;
+	memcpy(c->runs, head.runs, sizeof(MPD_STLRun) * head.nb_runs);
+	c->nb_runs += head.nb_runs;
+	gf_free(head.text);
+	gf_free(head.runs);
+	return;
+
+head_fail:
+	//rebuild everything
+	if (head.text) gf_free(head.text);
+	if (head.runs) gf_free(head.runs);
+	mpd_stl_cache_reset(c);
+}
+
+static void gf_mpd_print_segment_timeline(FILE *out, GF_MPD_SegmentTimeline *tl, s32 indent, u32 tsb_first_entry)
+{
+	MPD_STLCache local;
+	MPD_STLCache *c = tl->cache;
+
+	gf_mpd_nl(out, indent);
+	gf_fprintf(out, "<SegmentTimeline>");
 	gf_mpd_lf(out, indent);
 
+	if (!c) {
+		memset(&local, 0, sizeof(MPD_STLCache));
+		c = &local;
+	} else {
+		mpd_stl_cache_update(c, tl, tsb_first_entry, indent+1);
+	}
+	//only serialize entries after the cached runs
+	if (c->nb_runs)
+		mpd_stl_write_runs(c, tl, c->next_entry, (u32) -1, GF_FALSE, indent+1, GF_TRUE);
+	else
+		mpd_stl_write_runs(c, tl, tsb_first_entry, (u32) -1, GF_TRUE, indent+1, (c==&local) ? GF_FALSE : GF_TRUE);
+
+	if (c->size) gf_fwrite(c->text, c->size, out);
+
+	if (c==&local) {
+		if (c->text) gf_free(c->text);
+	} else {
+		//the last run may be extended by new entries, only keep closed runs
+		if (c->nb_runs) {
+			c->nb_runs--;
+			c->size = c->runs[c->nb_runs].offset;
+			c->next_entry = c->runs[c->nb_runs].first;
+			c->end_time = c->runs[c->nb_runs].start_time;
+		}
+		c->first_entry = tsb_first_entry;
+		c->indent = indent+1;
+		c->dirty = (u32) -1;
+		c->nb_removed = 0;
+		c->head_modified = GF_FALSE;
+	}
 
-done_tl:
 	gf_mpd_nl(out, indent);
 	gf_fprintf(out, "</SegmentTimeline>");
 	gf_mpd_lf(out, indent);
@@ -3088,6 +3518,34 @@ GF_MPD_SegmentTimeline *gf_mpd_segmentimeline_new(void)
 	return seg_tl;
 }
 
+static MPD_STLCache *mpd_stl_get_cache(GF_MPD_SegmentTimeline *tl)
+{
+	if (!tl->cache) {
+		GF_SAFEALLOC(tl->cache, MPD_STLCache);
+		if (tl->cache) tl->cache->dirty = (u32) -1;
+	}
+	return tl->cache;
+}
+
+GF_EXPORT
+void gf_mpd_segment_timeline_modified(GF_MPD_SegmentTimeline *timeline, u32 first_entry)
+{
+	MPD_STLCache *c = timeline ? mpd_stl_get_cache(timeline) : NULL;
+	if (c && (first_entry < c->dirty))
+		c->dirty = first_entry;
+}
+
+GF_EXPORT
+void gf_mpd_segment_timeline_head_removed(GF_MPD_SegmentTimeline *timeline, u32 nb_removed)
+{
+	MPD_STLCache *c = timeline ? mpd_stl_get_cache(timeline) : NULL;
+	if (!c) return;
+	c->nb_removed += nb_removed;
+	c->head_modified = GF_TRUE;
+	if (c->dirty != (u32) -1)
+		c->dirty = (c->dirty > nb_removed) ? c->dirty - nb_removed : 0;
+}
+
 static u32 gf_mpd_print_multiple_segment_base(FILE *out, GF_MPD_MultipleSegmentBase *ms, s32 indent, Bool close_if_no_child)
 {
 	gf_mpd_print_segment_base_attr(out, (GF_MPD_SegmentBase *)ms);
@@ -4543,6 +5001,197 @@ static char *get_rep_variant_filename(GF_MPD const * const mpd, GF_MPD_Represent
 	return gf_strdup(name);
 }
 
+GF_EXPORT
+void gf_mpd_representation_m3u8_modified(GF_MPD_Representation *rep)
+{
+	if (!rep) return;
+	rep->m3u8_var_version++;
+	//0 means not tracked
+	if (!rep->m3u8_var_version) rep->m3u8_var_version = 1;
+}
+
+/*gets a signature of the MPD state used by variant playlists, or 0 if variant playlists must always be generated*/
+static u32 gf_mpd_m3u8_var_state(GF_MPD const * const mpd, GF_List *periods, GF_MPD_Period *period, u32 hls_version, Double max_part_dur_session, const char *force_base_url)
+{
+	u32 state;
+	GF_BitStream *bs;
+	u8 *data;
+	u32 size;
+
+	//only for temp files, and not when playlists depend on previous periods or event streams
+	if (mpd->create_m3u8_files || (gf_list_count(periods)>1) || gf_list_count(period->event_streams))
+		return 0;
+
+	bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	if (!bs) return 0;
+	gf_bs_write_u32(bs, mpd->type);
+	gf_bs_write_u32(bs, mpd->force_llhls_mode);
+	gf_bs_write_u32(bs, mpd->nb_past_discont);
+	gf_bs_write_u64(bs, mpd->availabilityStartTime);
+	gf_bs_write_u8(bs, mpd->m3u8_time);
+	gf_bs_write_u8(bs, mpd->llhls_preload);
+	gf_bs_write_double(bs, mpd->llhls_part_holdback);
+	gf_bs_write_u32(bs, hls_version);
+	gf_bs_write_double(bs, max_part_dur_session);
+	gf_bs_write_data(bs, (u8 *) &period, sizeof(period));
+	if (force_base_url) gf_bs_write_data(bs, force_base_url, (u32) strlen(force_base_url));
+	gf_bs_get_content(bs, &data, &size);
+	gf_bs_del(bs);
+	if (!data) return 0;
+	state = gf_crc_32(data, size);
+	gf_free(data);
+	return state ? state : 1;
+}
+
+/*writes variant playlist of a representation, appending previous periods if needed*/
+static GF_Err gf_mpd_write_m3u8_rep_playlist(GF_MPD const * const mpd, GF_List *periods, GF_MPD_Period *period, GF_MPD_Representation *rep, u32 hls_version, Double max_part_dur_session, const char *force_base_url, u32 var_state)
+{
+	GF_Err e;
+	u32 pass = (mpd->force_llhls_mode==2) ? 1 : 0;
+	char *name = rep->m3u8_name;
+	if (!name) {
+		name = gf_file_basename(rep->m3u8_var_name);
+	}
+
+	//representation and MPD state not modified since last generation, the variant playlist is not generated
+	if (var_state && rep->m3u8_var_version) {
+		if ((rep->m3u8_var_gen_version[pass] == rep->m3u8_var_version) && (rep->m3u8_var_gen_state[pass] == var_state))
+			return GF_OK;
+		rep->m3u8_var_gen_version[pass] = rep->m3u8_var_version;
+		rep->m3u8_var_gen_state[pass] = var_state;
+	}
+
+	//backtrack periods until non-discontinuity change or no segments within timeshift window
+	u32 m=gf_list_count(periods)-1;
+	u32 start_period_idx = m;
+	while (m>0 && !period->skip_serialize) {
+		GF_MPD_Period *prev_period = gf_list_get(periods, m-1);
+
+		// Find the representation
+		GF_MPD_Representation *prev_rep = NULL;
+		GF_MPD_AdaptationSet *prev_as;
+		u32 k=0;
+		while ( (prev_as = (GF_MPD_AdaptationSet *) gf_list_enum(prev_period->adaptation_sets, &k))) {
+			u32 l=0;
+			while ( (prev_rep = (GF_MPD_Representation *) gf_list_enum(prev_as->representations, &l))) {
+				if (prev_rep->discontinuity_id == rep->discontinuity_id)
+					break;
+			}
+			if (prev_rep) break;
+		}
+
+		// Couldn't find the same representation, continue with the current one
+		if (!prev_rep) break;
+
+		// Check if we still have segments in this representations
+		u32 segment_cnt = gf_list_count(prev_rep->state_seg_list);
+		if (segment_cnt == 0) break;
+
+		// It's safe to use this period
+		start_period_idx = --m;
+	}
+
+	//write all relevant periods
+	m=start_period_idx;
+	u32 period_count = gf_list_count(periods) - start_period_idx;
+	FILE* prev_file = NULL;
+	GF_MPD_Period *cur_period;
+	while ( (cur_period = (GF_MPD_Period *) gf_list_enum(periods, &m))) {
+		GF_MPD_Representation *cur_rep = NULL;
+		GF_MPD_AdaptationSet *cur_as = NULL;
+		u32 k=0;
+		while ( (cur_as = (GF_MPD_AdaptationSet *) gf_list_enum(cur_period->adaptation_sets, &k))) {
+			u32 l=0;
+			while ( (cur_rep = (GF_MPD_Representation *) gf_list_enum(cur_as->representations, &l))) {
+				if (cur_rep->discontinuity_id == rep->discontinuity_id)
+					break;
+			}
+			if (cur_rep) break;
+		}
+		if (!cur_as) continue;
+		if (!cur_rep) continue;
+
+		Bool last_period =(m==period_count) ? GF_TRUE : GF_FALSE;
+
+		e = gf_mpd_write_m3u8_playlist(mpd, cur_period, cur_as, cur_rep, name, hls_version, max_part_dur_session,
+			force_base_url, m-1!=start_period_idx, last_period, prev_file);
+		if (e) {
+			GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[M3U8] IO error while opening m3u8 files\n"));
+			return GF_IO_ERR;
+		}
+
+		if (m-1==start_period_idx && period_count>1) {
+			//keep the file handle to append next periods
+			if (cur_rep->m3u8_var_file) {
+				rep->m3u8_var_file = cur_rep->m3u8_var_file;
+				prev_file = rep->m3u8_var_file;
+				cur_rep->m3u8_var_file = NULL;
+			}
+		}
+	}
+	return GF_OK;
+}
+
+typedef struct
+{
+	GF_MPD const *mpd;
+	GF_List *periods;
+	GF_MPD_Period *period;
+	GF_List *reps;
+	u32 hls_version;
+	Double max_part_dur_session;
+	const char *force_base_url;
+	u32 var_state;
+} M3U8PlaylistJobs;
+
+static GF_Err gf_mpd_m3u8_playlist_job(void *udta, u32 job_idx)
+{
+	M3U8PlaylistJobs *jobs = (M3U8PlaylistJobs *)udta;
+	return gf_mpd_write_m3u8_rep_playlist(jobs->mpd, jobs->periods, jobs->period, gf_list_get(jobs->reps, job_idx), jobs->hls_version, jobs->max_part_dur_session, jobs->force_base_url, jobs->var_state);
+}
+
+//below this number of segments listed in variant playlists, threads are not worth using
+#define M3U8_MIN_SEGMENTS_PARALLEL	500
+
+/*writes variant playlists of all representations, using session worker threads if allowed*/
+static GF_Err gf_mpd_write_m3u8_rep_playlists(GF_MPD const * const mpd, GF_List *periods, GF_MPD_Period *period, GF_List *reps, u32 hls_version, Double max_part_dur_session, const char *force_base_url)
+{
+	u32 i, nb_segs=0, nb_reps, nb_threads = mpd->hls_nb_threads;
+	M3U8PlaylistJobs jobs;
+	u32 var_state = gf_mpd_m3u8_var_state(mpd, periods, period, hls_version, max_part_dur_session, force_base_url);
+
+	nb_reps = gf_list_count(reps);
+	for (i=0; i<nb_reps; i++) {
+		GF_MPD_Representation *rep = gf_list_get(reps, i);
+		GF_DASH_SegmentContext *sctx = gf_list_last(rep->state_seg_list);
+		nb_segs += gf_list_count(rep->state_seg_list) - rep->tsb_first_entry;
+		//LL-HLS rendition reports depend on other representations
+		if (sctx && sctx->llhls_mode && mpd->llhls_rendition_reports)
+			var_state = 0;
+	}
+	//event streams state and previous period playlists are shared between representations
+	if (!mpd->hls_filter || (gf_list_count(periods)>1) || gf_list_count(period->event_streams) || (nb_segs < M3U8_MIN_SEGMENTS_PARALLEL))
+		nb_threads = 0;
+
+	if (nb_threads<=1) {
+		for (i=0; i<nb_reps; i++) {
+			GF_Err e = gf_mpd_write_m3u8_rep_playlist(mpd, periods, period, gf_list_get(reps, i), hls_version, max_part_dur_session, force_base_url, var_state);
+			if (e) return e;
+		}
+		return GF_OK;
+	}
+
+	jobs.mpd = mpd;
+	jobs.periods = periods;
+	jobs.period = period;
+	jobs.reps = reps;
+	jobs.hls_version = hls_version;
+	jobs.max_part_dur_session = max_part_dur_session;
+	jobs.force_base_url = force_base_url;
+	jobs.var_state = var_state;
+	return gf_filter_run_jobs(mpd->hls_filter, nb_reps, nb_threads, gf_mpd_m3u8_playlist_job, &jobs);
+}
+
 GF_Err gf_mpd_write_m3u8_master_playlist(GF_MPD const * const mpd, FILE *out, const char* m3u8_name, GF_List *periods, GF_M3U8WriteMode mode)
 {
 	u32 i, j, x, hls_version;
@@ -4734,90 +5383,27 @@ GF_Err gf_mpd_write_m3u8_master_playlist(GF_MPD const * const mpd, FILE *out, co
 	}
 
 	//second pass, generate all subplaylists
-	i=0;
-	while ( (as = (GF_MPD_AdaptationSet *) gf_list_enum(period->adaptation_sets, &i))) {
-		j=0;
-		while ( (rep = (GF_MPD_Representation *) gf_list_enum(as->representations, &j))) {
-			if (!mpd->allow_empty_reps && (!rep->state_seg_list || !gf_list_count(rep->state_seg_list) )) {
-				GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[M3U8] No segment state in representation, MPD cannot be translated to M3U8, ignoring representation\n"));
-				continue;
-			}
-			if (mode==GF_M3U8_WRITE_MASTER) break;
-
-			char *name = rep->m3u8_name;
-			if (!name) {
-				name = gf_file_basename(rep->m3u8_var_name);
-			}
-
-			//backtrack periods until non-discontinuity change or no segments within timeshift window
-			u32 m=gf_list_count(periods)-1;
-			u32 start_period_idx = m;
-			while (m>0 && !period->skip_serialize) {
-				GF_MPD_Period *prev_period = gf_list_get(periods, m-1);
-
-				// Find the representation
-				GF_MPD_Representation *prev_rep = NULL;
-				GF_MPD_AdaptationSet *prev_as;
-				u32 k=0;
-				while ( (prev_as = (GF_MPD_AdaptationSet *) gf_list_enum(prev_period->adaptation_sets, &k))) {
-					u32 l=0;
-					while ( (prev_rep = (GF_MPD_Representation *) gf_list_enum(prev_as->representations, &l))) {
-						if (prev_rep->discontinuity_id == rep->discontinuity_id)
-							break;
-					}
-					if (prev_rep) break;
-				}
-
-				// Couldn't find the same representation, continue with the current one
-				if (!prev_rep) break;
-
-				// Check if we still have segments in this representations
-				u32 segment_cnt = gf_list_count(prev_rep->state_seg_list);
-				if (segment_cnt == 0) break;
-
-				// It's safe to use this period
-				start_period_idx = --m;
-			}
-
-			//write all relevant periods
-			m=start_period_idx;
-			u32 period_count = gf_list_count(periods) - start_period_idx;
-			FILE* prev_file = NULL;
-			GF_MPD_Period *cur_period;
-			while ( (cur_period = (GF_MPD_Period *) gf_list_enum(periods, &m))) {
-				GF_MPD_Representation *cur_rep = NULL;
-				GF_MPD_AdaptationSet *cur_as = NULL;
-				u32 k=0;
-				while ( (cur_as = (GF_MPD_AdaptationSet *) gf_list_enum(cur_period->adaptation_sets, &k))) {
-					u32 l=0;
-					while ( (cur_rep = (GF_MPD_Representation *) gf_list_enum(cur_as->representations, &l))) {
-						if (cur_rep->discontinuity_id == rep->discontinuity_id)
-							break;
-					}
-					if (cur_rep) break;
-				}
-				if (!cur_as) continue;
-				if (!cur_rep) continue;
-
-				Bool last_period =(m==period_count) ? GF_TRUE : GF_FALSE;
-
-				e = gf_mpd_write_m3u8_playlist(mpd, cur_period, cur_as, cur_rep, name, hls_version, max_part_dur_session,
-					((mpd->hls_abs_url==GF_DASH_ABS_URL_VARIANT) || (mpd->hls_abs_url==GF_DASH_ABS_URL_BOTH)) ? force_base_url : NULL, m-1!=start_period_idx, last_period, prev_file);
-				if (e) {
-					GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[M3U8] IO error while opening m3u8 files\n"));
-					return GF_IO_ERR;
-				}
-
-				if (m-1==start_period_idx && period_count>1) {
-					//keep the file handle to append next periods
-					if (cur_rep->m3u8_var_file) {
-						rep->m3u8_var_file = cur_rep->m3u8_var_file;
-						prev_file = rep->m3u8_var_file;
-						cur_rep->m3u8_var_file = NULL;
-					}
+	if (mode!=GF_M3U8_WRITE_MASTER) {
+		GF_List *reps = gf_list_new();
+		i=0;
+		while ( (as = (GF_MPD_AdaptationSet *) gf_list_enum(period->adaptation_sets, &i))) {
+			j=0;
+			while ( (rep = (GF_MPD_Representation *) gf_list_enum(as->representations, &j))) {
+				if (!mpd->allow_empty_reps && (!rep->state_seg_list || !gf_list_count(rep->state_seg_list) )) {
+					GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[M3U8] No segment state in representation, MPD cannot be translated to M3U8, ignoring representation\n"));
+					continue;
 				}
+				gf_list_add(reps, rep);
 			}
 		}
+		e = gf_mpd_write_m3u8_rep_playlists(mpd, periods, period, reps, hls_version, max_part_dur_session,
+			((mpd->hls_abs_url==GF_DASH_ABS_URL_VARIANT) || (mpd->hls_abs_url==GF_DASH_ABS_URL_BOTH)) ? force_base_url : NULL);
+		gf_list_del(reps);
+		if (e) {
+			gf_free(m3u8_name_rad);
+			gf_free(szVariantName);
+			return e;
+		}
 	}
 
 	//no muxed comp, no video, the audio is the main media we will list, force nb_audio=0 for gf_mpd_write_m3u8_playlist_tags
@@ -5089,6 +5675,16 @@ GF_Err gf_mpd_write(GF_MPD const * const mpd, FILE *out, Bool compact)
 		gf_xml_dump_string(out, "<Location>", text, "</Location>");
 		gf_mpd_lf(out, indent);
 	}
+	//patches only apply to dynamic MPDs
+	if (mpd->patch_location && (mpd->type==GF_MPD_TYPE_DYNAMIC)) {
+		gf_mpd_extensible_print_nodes(out, mpd->x_children, indent, &child_idx, GF_FALSE);
+		gf_mpd_nl(out, indent+1);
+		gf_fprintf(out, "<PatchLocation");
+		if (mpd->patch_location_ttl)
+			gf_fprintf(out, " ttl=\"%u\"", mpd->patch_location_ttl);
+		gf_xml_dump_string(out, ">", mpd->patch_location, "</PatchLocation>");
+		gf_mpd_lf(out, indent);
+	}
 
 	if (mpd->inject_service_desc) {
 		gf_mpd_extensible_print_nodes(out, mpd->x_children, indent, &child_idx, GF_FALSE);
@@ -5171,6 +5767,1266 @@ GF_Err gf_mpd_write_file(GF_MPD const * const mpd, const char *file_name)
 	return e;
 }
 
+/*binary state file: header, binary section holding timelines and segment states, then the MPD context without these
+header is magic, version (8 bits), reserved (24 bits), next generation time (64 bits) and binary section size (32 bits)*/
+#define MPD_STATE_MAGIC	GF_4CC('G','M','S','B')
+#define MPD_STATE_VERSION	1
+#define MPD_STATE_HDR_SIZE	20
+
+enum
+{
+	MPD_BIN_WRITE = 0,
+	MPD_BIN_DETACH,
+	MPD_BIN_READ,
+};
+
+typedef struct
+{
+	GF_List **slot;
+	GF_List *list;
+	MPD_STLCache *cache;
+	GF_MPD_SegmentTimeline *tl;
+} MPD_BinDetached;
+
+typedef struct
+{
+	GF_BitStream *bs;
+	u32 mode;
+	GF_List *detached;
+	GF_Err e;
+} MPD_BinState;
+
+static void mpd_bin_check_tag(MPD_BinState *st, u8 tag)
+{
+	if (st->e) return;
+	if (st->mode==MPD_BIN_WRITE) gf_bs_write_u8(st->bs, tag);
+	else if (st->mode==MPD_BIN_READ) {
+		if (gf_bs_read_u8(st->bs) != tag) st->e = GF_NON_COMPLIANT_BITSTREAM;
+	}
+}
+
+static void mpd_bin_detach(MPD_BinState *st, GF_List **slot, GF_MPD_SegmentTimeline *tl)
+{
+	MPD_BinDetached *d;
+	if (!*slot) return;
+	GF_SAFEALLOC(d, MPD_BinDetached);
+	if (!d || gf_list_add(st->detached, d)) {
+		if (d) gf_free(d);
+		st->e = GF_OUT_OF_MEM;
+		return;
+	}
+	d->slot = slot;
+	d->list = *slot;
+	*slot = NULL;
+	//the serialized timeline cache must not be used for an empty timeline
+	if (tl) {
+		d->tl = tl;
+		d->cache = tl->cache;
+		tl->cache = NULL;
+	}
+}
+
+static void mpd_bin_restore(GF_List *detached)
+{
+	while (gf_list_count(detached)) {
+		MPD_BinDetached *d = gf_list_pop_back(detached);
+		*d->slot = d->list;
+		if (d->tl) d->tl->cache = d->cache;
+		gf_free(d);
+	}
+}
+
+static void mpd_bin_write_str(GF_BitStream *bs, const char *str)
+{
+	u32 len = str ? (u32) strlen(str) : 0;
+	gf_bs_write_u32(bs, str ? len+1 : 0);
+	if (len) gf_bs_write_data(bs, (const u8 *) str, len);
+}
+
+static char *mpd_bin_read_str(MPD_BinState *st)
+{
+	char *str;
+	u32 len = gf_bs_read_u32(st->bs);
+	if (!len) return NULL;
+	len--;
+	if (len > gf_bs_available(st->bs)) {
+		st->e = GF_NON_COMPLIANT_BITSTREAM;
+		return NULL;
+	}
+	str = gf_malloc(len+1);
+	if (!str) {
+		st->e = GF_OUT_OF_MEM;
+		return NULL;
+	}
+	gf_bs_read_data(st->bs, (u8 *) str, len);
+	str[len] = 0;
+	return str;
+}
+
+/*timeline entries are stored as merged runs, as done when serializing to XML*/
+static u32 mpd_bin_write_runs(GF_BitStream *bs, GF_MPD_SegmentTimeline *tl, u32 first_entry)
+{
+	u32 i, nb_runs=0, count = gf_list_count(tl->entries);
+	u64 start_time = 0;
+	GF_MPD_SegmentTimelineEntry run, *se, *prev=NULL;
+	memset(&run, 0, sizeof(GF_MPD_SegmentTimelineEntry));
+
+	for (i=first_entry; i<count; i++) {
+		se = gf_list_get(tl->entries, i);
+		if (prev && (se->start_time == start_time) && (prev->duration==se->duration) && !se->is_ll_edge) {
+			run.repeat_count++;
+		} else {
+			if (prev && bs) {
+				gf_bs_write_u64(bs, run.start_time);
+				gf_bs_write_u32(bs, run.duration);
+				gf_bs_write_u32(bs, run.repeat_count);
+				gf_bs_write_u32(bs, prev->nb_parts);
+			}
+			nb_runs++;
+			run.start_time = start_time = se->start_time;
+			run.duration = se->duration;
+			run.repeat_count = 0;
+		}
+		start_time += (se->repeat_count+1) * se->duration;
+		run.repeat_count += se->repeat_count;
+		prev = se;
+	}
+	if (prev && bs) {
+		gf_bs_write_u64(bs, run.start_time);
+		gf_bs_write_u32(bs, run.duration);
+		gf_bs_write_u32(bs, run.repeat_count);
+		gf_bs_write_u32(bs, prev->nb_parts);
+	}
+	return nb_runs;
+}
+
+static void mpd_bin_timeline(MPD_BinState *st, GF_MPD_MultipleSegmentBase *ms)
+{
+	u32 i, count;
+	GF_MPD_SegmentTimeline *tl = ms ? ms->segment_timeline : NULL;
+	if (st->e) return;
+
+	if (st->mode==MPD_BIN_DETACH) {
+		if (tl) mpd_bin_detach(st, &tl->entries, tl);
+		return;
+	}
+	if (st->mode==MPD_BIN_WRITE) {
+		gf_bs_write_u8(st->bs, tl ? 'T' : 0);
+		if (!tl) return;
+		gf_bs_write_u32(st->bs, mpd_bin_write_runs(NULL, tl, ms->tsb_first_entry));
+		mpd_bin_write_runs(st->bs, tl, ms->tsb_first_entry);
+		return;
+	}
+
+	if (gf_bs_read_u8(st->bs) != (tl ? 'T' : 0)) {
+		st->e = GF_NON_COMPLIANT_BITSTREAM;
+		return;
+	}
+	if (!tl) return;
+	count = gf_bs_read_u32(st->bs);
+	if ((u64) count*20 > gf_bs_available(st->bs)) {
+		st->e = GF_NON_COMPLIANT_BITSTREAM;
+		return;
+	}
+	if (!tl->entries) tl->entries = gf_list_new();
+	for (i=0; i<count; i++) {
+		GF_MPD_SegmentTimelineEntry *se;
+		GF_SAFEALLOC(se, GF_MPD_SegmentTimelineEntry);
+		if (!se || gf_list_add(tl->entries, se)) {
+			if (se) gf_free(se);
+			st->e = GF_OUT_OF_MEM;
+			return;
+		}
+		se->start_time = gf_bs_read_u64(st->bs);
+		se->duration = gf_bs_read_u32(st->bs);
+		se->repeat_count = gf_bs_read_u32(st->bs);
+		se->nb_parts = gf_bs_read_u32(st->bs);
+	}
+}
+
+static void mpd_bin_segments(MPD_BinState *st, GF_MPD_Representation *rep)
+{
+	u32 i, count;
+	u8 tag;
+	if (st->e) return;
+
+	if (st->mode==MPD_BIN_DETACH) {
+		mpd_bin_detach(st, &rep->state_seg_list, NULL);
+		return;
+	}
+	if (st->mode==MPD_BIN_WRITE) {
+		count = gf_list_count(rep->state_seg_list);
+		gf_bs_write_u8(st->bs, count ? 'S' : 0);
+		if (!count) return;
+		gf_bs_write_u32(st->bs, count);
+		for (i=0; i<count; i++) {
+			GF_DASH_SegmentContext *sctx = gf_list_get(rep->state_seg_list, i);
+			gf_bs_write_u64(st->bs, sctx->time);
+			gf_bs_write_u64(st->bs, sctx->dur);
+			gf_bs_write_u32(st->bs, sctx->seg_num);
+			gf_bs_write_u32(st->bs, sctx->file_size);
+			gf_bs_write_u64(st->bs, sctx->file_offset);
+			gf_bs_write_u32(st->bs, sctx->index_size);
+			gf_bs_write_u64(st->bs, sctx->index_offset);
+			mpd_bin_write_str(st->bs, sctx->filename);
+			mpd_bin_write_str(st->bs, sctx->filepath);
+		}
+		return;
+	}
+
+	tag = gf_bs_read_u8(st->bs);
+	if (!tag) return;
+	//segment states are never in the XML part
+	if ((tag != 'S') || rep->state_seg_list) {
+		st->e = GF_NON_COMPLIANT_BITSTREAM;
+		return;
+	}
+	count = gf_bs_read_u32(st->bs);
+	if ((u64) count*52 > gf_bs_available(st->bs)) {
+		st->e = GF_NON_COMPLIANT_BITSTREAM;
+		return;
+	}
+	rep->state_seg_list = gf_list_new();
+	for (i=0; i<count; i++) {
+		GF_DASH_SegmentContext *sctx;
+		GF_SAFEALLOC(sctx, GF_DASH_SegmentContext);
+		if (!sctx || gf_list_add(rep->state_seg_list, sctx)) {
+			if (sctx) gf_free(sctx);
+			st->e = GF_OUT_OF_MEM;
+			return;
+		}
+		sctx->time = gf_bs_read_u64(st->bs);
+		sctx->dur = gf_bs_read_u64(st->bs);
+		sctx->seg_num = gf_bs_read_u32(st->bs);
+		sctx->file_size = gf_bs_read_u32(st->bs);
+		sctx->file_offset = gf_bs_read_u64(st->bs);
+		sctx->index_size = gf_bs_read_u32(st->bs);
+		sctx->index_offset = gf_bs_read_u64(st->bs);
+		sctx->filename = mpd_bin_read_str(st);
+		sctx->filepath = mpd_bin_read_str(st);
+		if (st->e) return;
+	}
+}
+
+/*walks periods, adaptation sets and representations in serialization order*/
+static void mpd_bin_walk(GF_MPD *mpd, MPD_BinState *st)
+{
+	u32 i, j, k, c, nb_copies;
+	GF_MPD_Period *period;
+	GF_MPD_AdaptationSet *as;
+	GF_MPD_Representation *rep;
+
+	i=0;
+	while ((period = (GF_MPD_Period *) gf_list_enum(mpd->periods, &i))) {
+		if (period->skip_serialize) break;
+		mpd_bin_check_tag(st, 'P');
+		mpd_bin_timeline(st, (GF_MPD_MultipleSegmentBase *) period->segment_list);
+		mpd_bin_timeline(st, (GF_MPD_MultipleSegmentBase *) period->segment_template);
+
+		j=0;
+		while ((as = (GF_MPD_AdaptationSet *) gf_list_enum(period->adaptation_sets, &j))) {
+			//adaptation sets are serialized once per alternate MPEG-H profile
+			nb_copies = as->nb_alt_mha_profiles;
+			if (!as->alt_mha_profiles_only || !nb_copies) nb_copies++;
+			//representations are shared between copies, only detach once
+			if (st->mode==MPD_BIN_DETACH) nb_copies = 1;
+
+			for (c=0; c<nb_copies; c++) {
+				mpd_bin_check_tag(st, 'A');
+				mpd_bin_timeline(st, (GF_MPD_MultipleSegmentBase *) as->segment_list);
+				mpd_bin_timeline(st, (GF_MPD_MultipleSegmentBase *) as->segment_template);
+
+				k=0;
+				while ((rep = (GF_MPD_Representation *) gf_list_enum(as->representations, &k))) {
+					mpd_bin_check_tag(st, 'R');
+					mpd_bin_segments(st, rep);
+					mpd_bin_timeline(st, (GF_MPD_MultipleSegmentBase *) rep->segment_list);
+					mpd_bin_timeline(st, (GF_MPD_MultipleSegmentBase *) rep->segment_template);
+				}
+			}
+		}
+	}
+	mpd_bin_check_tag(st, 'E');
+	if (!st->e && (st->mode==MPD_BIN_READ) && gf_bs_is_overflow(st->bs))
+		st->e = GF_NON_COMPLIANT_BITSTREAM;
+}
+
+GF_EXPORT
+GF_Err gf_mpd_write_binary_state(GF_MPD *mpd, FILE *out, Bool compact)
+{
+	u8 hdr[MPD_STATE_HDR_SIZE];
+	u8 *data = NULL;
+	u32 size = 0;
+	Bool write_context;
+	GF_BitStream *bs;
+	MPD_BinState st;
+
+	if (mpd_skip_serialization(mpd))
+		return GF_NOT_READY;
+
+	memset(&st, 0, sizeof(MPD_BinState));
+	st.bs = gf_bs_new(NULL, 0, GF_BITSTREAM_WRITE);
+	st.detached = gf_list_new();
+	if (!st.bs || !st.detached) {
+		st.e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	st.mode = MPD_BIN_WRITE;
+	mpd_bin_walk(mpd, &st);
+	if (st.e) goto exit;
+	gf_bs_get_content(st.bs, &data, &size);
+	if (!data) {
+		st.e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+
+	bs = gf_bs_new(hdr, MPD_STATE_HDR_SIZE, GF_BITSTREAM_WRITE);
+	if (!bs) {
+		st.e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	gf_bs_write_u32(bs, MPD_STATE_MAGIC);
+	gf_bs_write_u8(bs, MPD_STATE_VERSION);
+	gf_bs_write_int(bs, 0, 24);
+	gf_bs_write_u64(bs, mpd->gpac_next_ntp_ms);
+	gf_bs_write_u32(bs, size);
+	gf_bs_del(bs);
+
+	if ((gf_fwrite(hdr, MPD_STATE_HDR_SIZE, out) != MPD_STATE_HDR_SIZE) || (gf_fwrite(data, size, out) != size)) {
+		st.e = GF_IO_ERR;
+		goto exit;
+	}
+
+	//write context without timelines and segment states
+	st.mode = MPD_BIN_DETACH;
+	mpd_bin_walk(mpd, &st);
+	if (!st.e) {
+		write_context = mpd->write_context;
+		mpd->write_context = GF_TRUE;
+		st.e = gf_mpd_write(mpd, out, compact);
+		mpd->write_context = write_context;
+	}
+
+exit:
+	if (data) gf_free(data);
+	if (st.bs) gf_bs_del(st.bs);
+	if (st.detached) {
+		mpd_bin_restore(st.detached);
+		gf_list_del(st.detached);
+	}
+	return st.e;
+}
+
+GF_EXPORT
+Bool gf_mpd_is_binary_state(const char *file_name, u64 *next_gen_ntp_ms)
+{
+	u8 hdr[MPD_STATE_HDR_SIZE];
+	Bool res = GF_FALSE;
+	FILE *f = gf_fopen(file_name, "rb");
+	if (!f) return GF_FALSE;
+
+	if (gf_fread(hdr, MPD_STATE_HDR_SIZE, f) == MPD_STATE_HDR_SIZE) {
+		GF_BitStream *bs = gf_bs_new(hdr, MPD_STATE_HDR_SIZE, GF_BITSTREAM_READ);
+		if (bs && (gf_bs_read_u32(bs) == MPD_STATE_MAGIC)) {
+			res = GF_TRUE;
+			gf_bs_skip_bytes(bs, 4);
+			if (next_gen_ntp_ms) *next_gen_ntp_ms = gf_bs_read_u64(bs);
+		}
+		if (bs) gf_bs_del(bs);
+	}
+	gf_fclose(f);
+	return res;
+}
+
+GF_EXPORT
+GF_Err gf_mpd_load_binary_state(GF_MPD *mpd, const char *file_name)
+{
+	u8 *data;
+	u32 size, bin_size;
+	GF_DOMParser *parser;
+	MPD_BinState st;
+
+	memset(&st, 0, sizeof(MPD_BinState));
+	st.e = gf_file_load_data(file_name, &data, &size);
+	if (st.e) return st.e;
+
+	if (size < MPD_STATE_HDR_SIZE) {
+		st.e = GF_NON_COMPLIANT_BITSTREAM;
+		goto exit;
+	}
+	st.bs = gf_bs_new(data, MPD_STATE_HDR_SIZE, GF_BITSTREAM_READ);
+	if (!st.bs) {
+		st.e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	if ((gf_bs_read_u32(st.bs) != MPD_STATE_MAGIC) || (gf_bs_read_u8(st.bs) != MPD_STATE_VERSION)) {
+		st.e = GF_NOT_SUPPORTED;
+		goto exit;
+	}
+	gf_bs_skip_bytes(st.bs, 11);
+	bin_size = gf_bs_read_u32(st.bs);
+	gf_bs_del(st.bs);
+	st.bs = NULL;
+	if (bin_size > size - MPD_STATE_HDR_SIZE) {
+		st.e = GF_NON_COMPLIANT_BITSTREAM;
+		goto exit;
+	}
+
+	//file data is 0-terminated
+	parser = gf_xml_dom_new();
+	if (!parser) {
+		st.e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	st.e = gf_xml_dom_parse_string(parser, (char *) data + MPD_STATE_HDR_SIZE + bin_size);
+	if (st.e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Cannot parse state %s: %s\n", file_name, gf_xml_dom_get_error(parser) ));
+	} else {
+		st.e = gf_mpd_init_from_dom(gf_xml_dom_get_root(parser), mpd, file_name);
+	}
+	gf_xml_dom_del(parser);
+	if (st.e) goto exit;
+
+	st.bs = gf_bs_new(data + MPD_STATE_HDR_SIZE, bin_size, GF_BITSTREAM_READ);
+	if (!st.bs) {
+		st.e = GF_OUT_OF_MEM;
+		goto exit;
+	}
+	st.mode = MPD_BIN_READ;
+	mpd_bin_walk(mpd, &st);
+
+exit:
+	if (st.bs) gf_bs_del(st.bs);
+	gf_free(data);
+	return st.e;
+}
+
+/*MPD patch: the runs of each timeline published in the last patch are kept, the next patch replaces, removes or adds
+S elements at the head and tail of each timeline around the runs left unchanged
+any other change in the MPD produces a patch without operation, forcing clients to reload the full MPD*/
+#define MPD_PATCH_NS	"urn:mpeg:dash:schema:mpd-patch:2020"
+#define MPD_PATCH_OPS_NS	"urn:ietf:params:xml:schema:patch-ops"
+
+typedef struct
+{
+	u64 t;
+	u32 d, r, k;
+} MPD_PatchRun;
+
+typedef struct
+{
+	MPD_PatchRun *runs;
+	u32 nb_runs, nb_alloc;
+} MPD_PatchRuns;
+
+typedef struct
+{
+	//runs in last patch and current runs
+	MPD_PatchRuns pub, cur;
+} MPD_PatchTimeline;
+
+typedef struct __mpd_patch_state
+{
+	Bool has_base;
+	u64 publish_time;
+	//signature of the MPD without timelines and publish time
+	u8 signature[GF_SHA1_DIGEST_SIZE];
+	//timelines in document order
+	MPD_PatchTimeline *timelines;
+	u32 nb_timelines, nb_alloc_timelines;
+} MPD_PatchState;
+
+typedef struct
+{
+	GF_MPD_SegmentTimeline *tl;
+	u32 first_entry;
+	char *path;
+} MPD_PatchTarget;
+
+static void mpd_patch_state_del(MPD_PatchState *ps)
+{
+	u32 i;
+	for (i=0; i<ps->nb_alloc_timelines; i++) {
+		if (ps->timelines[i].pub.runs) gf_free(ps->timelines[i].pub.runs);
+		if (ps->timelines[i].cur.runs) gf_free(ps->timelines[i].cur.runs);
+	}
+	if (ps->timelines) gf_free(ps->timelines);
+	gf_free(ps);
+}
+
+/*merges timeline entries into runs as done when serializing S elements*/
+static GF_Err mpd_patch_get_runs(GF_MPD_SegmentTimeline *tl, u32 first_entry, MPD_PatchRuns *pr)
+{
+	u32 i, count = gf_list_count(tl->entries);
+	u64 start_time = 0;
+	GF_MPD_SegmentTimelineEntry *se, *prev=NULL;
+	MPD_PatchRun *run = NULL;
+
+	pr->nb_runs = 0;
+	for (i=first_entry; i<count; i++) {
+		se = gf_list_get(tl->entries, i);
+		if (prev && (se->start_time == start_time) && (prev->duration==se->duration) && !se->is_ll_edge) {
+			run->r++;
+		} else {
+			if (pr->nb_runs == pr->nb_alloc) {
+				u32 nb_alloc = pr->nb_alloc ? 2*pr->nb_alloc : 16;
+				MPD_PatchRun *runs = gf_realloc(pr->runs, sizeof(MPD_PatchRun) * nb_alloc);
+				if (!runs) {
+					pr->nb_runs = 0;
+					return GF_OUT_OF_MEM;
+				}
+				pr->runs = runs;
+				pr->nb_alloc = nb_alloc;
+			}
+			run = &pr->runs[pr->nb_runs];
+			pr->nb_runs++;
+			run->t = start_time = se->start_time;
+			run->d = se->duration;
+			run->r = 0;
+		}
+		start_time += (se->repeat_count+1) * se->duration;
+		run->r += se->repeat_count;
+		run->k = se->nb_parts;
+		prev = se;
+	}
+	return GF_OK;
+}
+
+static Bool mpd_patch_same_run(MPD_PatchRun *r1, MPD_PatchRun *r2)
+{
+	return ((r1->t==r2->t) && (r1->d==r2->d) && (r1->r==r2->r) && (r1->k==r2->k)) ? GF_TRUE : GF_FALSE;
+}
+
+/*appends a selector step, using the id of the element if any and safe for XPath, its position otherwise*/
+static char *mpd_patch_path(const char *parent, const char *name, const char *id, u32 pos)
+{
+	char szPred[50];
+	char *path = gf_strdup(parent);
+	gf_dynstrcat(&path, name, "/");
+	if (id && !strpbrk(id, "'\"&<>[]")) {
+		gf_dynstrcat(&path, "[@id='", NULL);
+		gf_dynstrcat(&path, id, NULL);
+		gf_dynstrcat(&path, "']", NULL);
+	} else if (pos) {
+		sprintf(szPred, "[%u]", pos);
+		gf_dynstrcat(&path, szPred, NULL);
+	}
+	return path;
+}
+
+static GF_Err mpd_patch_add_target(GF_List *targets, GF_MPD_MultipleSegmentBase *ms, const char *parent, const char *name)
+{
+	MPD_PatchTarget *pt;
+	char *path;
+	if (!ms || !ms->segment_timeline) return GF_OK;
+
+	path = mpd_patch_path(parent, name, NULL, 0);
+	gf_dynstrcat(&path, "SegmentTimeline", "/");
+	GF_SAFEALLOC(pt, MPD_PatchTarget);
+	if (!path || !pt || gf_list_add(targets, pt)) {
+		if (path) gf_free(path);
+		if (pt) gf_free(pt);
+		return GF_OUT_OF_MEM;
+	}
+	pt->tl = ms->segment_timeline;
+	pt->first_entry = ms->tsb_first_entry;
+	pt->path = path;
+	return GF_OK;
+}
+
+/*collects timelines in document order, returns GF_NOT_SUPPORTED if timelines cannot be addressed*/
+static GF_Err mpd_patch_collect(GF_MPD *mpd, GF_List *targets)
+{
+	u32 i, j, k;
+	GF_Err e = GF_OK;
+	GF_MPD_Period *period;
+	GF_MPD_AdaptationSet *as;
+	GF_MPD_Representation *rep;
+
+	i=0;
+	while (!e && (period = (GF_MPD_Period *) gf_list_enum(mpd->periods, &i))) {
+		char *p_path, *as_path, *rep_path;
+		if (period->skip_serialize) break;
+		p_path = mpd_patch_path("/MPD", "Period", period->ID, i);
+		if (!p_path) return GF_OUT_OF_MEM;
+		e = mpd_patch_add_target(targets, (GF_MPD_MultipleSegmentBase *) period->segment_list, p_path, "SegmentList");
+		if (!e) e = mpd_patch_add_target(targets, (GF_MPD_MultipleSegmentBase *) period->segment_template, p_path, "SegmentTemplate");
+
+		j=0;
+		while (!e && (as = (GF_MPD_AdaptationSet *) gf_list_enum(period->adaptation_sets, &j))) {
+			char szID[20];
+			//adaptation sets serialized several times cannot be addressed
+			if (as->nb_alt_mha_profiles) {
+				e = GF_NOT_SUPPORTED;
+				break;
+			}
+			sprintf(szID, "%d", as->id);
+			as_path = mpd_patch_path(p_path, "AdaptationSet", (as->id>=0) ? szID : NULL, j);
+			if (!as_path) {
+				e = GF_OUT_OF_MEM;
+				break;
+			}
+			e = mpd_patch_add_target(targets, (GF_MPD_MultipleSegmentBase *) as->segment_list, as_path, "SegmentList");
+			if (!e) e = mpd_patch_add_target(targets, (GF_MPD_MultipleSegmentBase *) as->segment_template, as_path, "SegmentTemplate");
+
+			k=0;
+			while (!e && (rep = (GF_MPD_Representation *) gf_list_enum(as->representations, &k))) {
+				//clients may reorder representations, they are only addressed by ID
+				if (!rep->id) {
+					e = GF_NOT_SUPPORTED;
+					break;
+				}
+				rep_path = mpd_patch_path(as_path, "Representation", rep->id, 0);
+				if (!rep_path) {
+					e = GF_OUT_OF_MEM;
+					break;
+				}
+				e = mpd_patch_add_target(targets, (GF_MPD_MultipleSegmentBase *) rep->segment_list, rep_path, "SegmentList");
+				if (!e) e = mpd_patch_add_target(targets, (GF_MPD_MultipleSegmentBase *) rep->segment_template, rep_path, "SegmentTemplate");
+				gf_free(rep_path);
+			}
+			gf_free(as_path);
+		}
+		gf_free(p_path);
+	}
+	return e;
+}
+
+/*computes the signature of the MPD without its timelines and publish time*/
+static GF_Err mpd_patch_signature(GF_MPD *mpd, u8 signature[GF_SHA1_DIGEST_SIZE])
+{
+	u64 publish_time = mpd->publishTime;
+	MPD_BinState st;
+	FILE *tmp = gf_file_temp(NULL);
+	if (!tmp) return GF_IO_ERR;
+
+	memset(&st, 0, sizeof(MPD_BinState));
+	st.detached = gf_list_new();
+	if (!st.detached) {
+		gf_fclose(tmp);
+		return GF_OUT_OF_MEM;
+	}
+	st.mode = MPD_BIN_DETACH;
+	mpd_bin_walk(mpd, &st);
+	if (!st.e) {
+		mpd->publishTime = 0;
+		st.e = gf_mpd_write(mpd, tmp, GF_TRUE);
+		mpd->publishTime = publish_time;
+	}
+	mpd_bin_restore(st.detached);
+	gf_list_del(st.detached);
+	if (!st.e) st.e = gf_sha1_file_ptr(tmp, signature);
+	gf_fclose(tmp);
+	return st.e;
+}
+
+static void mpd_patch_print_op(FILE *out, const char *op, const char *path, u32 s_pos, const char *pos, MPD_PatchRun *runs, u32 nb_runs, s32 indent)
+{
+	u32 i;
+	gf_mpd_nl(out, indent);
+	gf_fprintf(out, "<p:%s sel=\"%s", op, path);
+	if (s_pos) gf_fprintf(out, "/S[%u]", s_pos);
+	gf_fprintf(out, "\"");
+	if (pos) gf_fprintf(out, " pos=\"%s\"", pos);
+	if (!nb_runs) {
+		gf_fprintf(out, "/>");
+		gf_mpd_lf(out, indent);
+		return;
+	}
+	gf_fprintf(out, ">");
+	gf_mpd_lf(out, indent);
+	for (i=0; i<nb_runs; i++) {
+		gf_mpd_nl(out, indent+1);
+		gf_fprintf(out, "<S t=\""LLU"\" d=\"%u\"", runs[i].t, runs[i].d);
+		if (runs[i].r) gf_fprintf(out, " r=\"%d\"", runs[i].r);
+		if (runs[i].k) gf_fprintf(out, " k=\"%u\"", runs[i].k);
+		gf_fprintf(out, "/>");
+		gf_mpd_lf(out, indent);
+	}
+	gf_mpd_nl(out, indent);
+	gf_fprintf(out, "</p:%s>", op);
+	gf_mpd_lf(out, indent);
+}
+
+static void mpd_patch_diff(FILE *out, const char *path, MPD_PatchRuns *pub, MPD_PatchRuns *cur, s32 indent)
+{
+	u32 i, p=0, c, nb_common=0, nb_head, nb_tail_pub, nb_tail_cur, nb_rep;
+
+	//locate the first run left unchanged, runs are sorted by time
+	for (c=0; c<cur->nb_runs; c++) {
+		while ((p<pub->nb_runs) && (pub->runs[p].t < cur->runs[c].t))
+			p++;
+		if (p==pub->nb_runs) break;
+		if (mpd_patch_same_run(&pub->runs[p], &cur->runs[c])) break;
+	}
+	if ((p<pub->nb_runs) && (c<cur->nb_runs)) {
+		while ((p+nb_common < pub->nb_runs) && (c+nb_common < cur->nb_runs)
+			&& mpd_patch_same_run(&pub->runs[p+nb_common], &cur->runs[c+nb_common])
+		) {
+			nb_common++;
+		}
+	}
+	if (!nb_common) {
+		if (!pub->nb_runs && !cur->nb_runs) return;
+		//nothing in common, replace the timeline
+		gf_mpd_nl(out, indent);
+		gf_fprintf(out, "<p:replace sel=\"%s\">", path);
+		gf_mpd_lf(out, indent);
+		gf_mpd_nl(out, indent+1);
+		gf_fprintf(out, "<SegmentTimeline>");
+		gf_mpd_lf(out, indent);
+		for (i=0; i<cur->nb_runs; i++) {
+			gf_mpd_nl(out, indent+2);
+			gf_fprintf(out, "<S t=\""LLU"\" d=\"%u\"", cur->runs[i].t, cur->runs[i].d);
+			if (cur->runs[i].r) gf_fprintf(out, " r=\"%d\"", cur->runs[i].r);
+			if (cur->runs[i].k) gf_fprintf(out, " k=\"%u\"", cur->runs[i].k);
+			gf_fprintf(out, "/>");
+			gf_mpd_lf(out, indent);
+		}
+		gf_mpd_nl(out, indent+1);
+		gf_fprintf(out, "</SegmentTimeline>");
+		gf_mpd_lf(out, indent);
+		gf_mpd_nl(out, indent);
+		gf_fprintf(out, "</p:replace>");
+		gf_mpd_lf(out, indent);
+		return;
+	}
+
+	//head: p published runs before the common ones, c current runs
+	nb_rep = MIN(p, c);
+	for (i=0; i<nb_rep; i++)
+		mpd_patch_print_op(out, "replace", path, i+1, NULL, &cur->runs[i], 1, indent);
+	for (i=nb_rep; i<p; i++)
+		mpd_patch_print_op(out, "remove", path, nb_rep+1, NULL, NULL, 0, indent);
+	if (c > nb_rep) {
+		if (nb_rep)
+			mpd_patch_print_op(out, "add", path, nb_rep, "after", &cur->runs[nb_rep], c - nb_rep, indent);
+		else
+			mpd_patch_print_op(out, "add", path, 1, "before", cur->runs, c, indent);
+	}
+
+	//tail: S elements before the tail are the c head runs and the common ones
+	nb_head = c + nb_common;
+	nb_tail_pub = pub->nb_runs - p - nb_common;
+	nb_tail_cur = cur->nb_runs - c - nb_common;
+	nb_rep = MIN(nb_tail_pub, nb_tail_cur);
+	for (i=0; i<nb_rep; i++)
+		mpd_patch_print_op(out, "replace", path, nb_head+i+1, NULL, &cur->runs[nb_head+i], 1, indent);
+	for (i=nb_rep; i<nb_tail_pub; i++)
+		mpd_patch_print_op(out, "remove", path, nb_head+nb_rep+1, NULL, NULL, 0, indent);
+	if (nb_tail_cur > nb_rep)
+		mpd_patch_print_op(out, "add", path, 0, NULL, &cur->runs[nb_head+nb_rep], nb_tail_cur - nb_rep, indent);
+}
+
+GF_EXPORT
+GF_Err gf_mpd_write_patch(GF_MPD *mpd, FILE *out, Bool compact)
+{
+	u8 signature[GF_SHA1_DIGEST_SIZE];
+	u32 i, count;
+	s32 indent = compact ? GF_INT_MIN : 0;
+	Bool do_diff;
+	GF_Err e, collect_err;
+	GF_List *targets;
+	MPD_PatchState *ps;
+
+	if (!mpd || !out || !mpd->ID) return GF_BAD_PARAM;
+	if (mpd_skip_serialization(mpd))
+		return GF_NOT_READY;
+
+	if (!mpd->patch_state) {
+		GF_SAFEALLOC(mpd->patch_state, MPD_PatchState);
+		if (!mpd->patch_state) return GF_OUT_OF_MEM;
+	}
+	ps = mpd->patch_state;
+
+	e = mpd_patch_signature(mpd, signature);
+	if (e) return e;
+
+	targets = gf_list_new();
+	if (!targets) return GF_OUT_OF_MEM;
+	collect_err = mpd_patch_collect(mpd, targets);
+	if (collect_err && (collect_err != GF_NOT_SUPPORTED)) {
+		e = collect_err;
+		goto exit;
+	}
+	count = gf_list_count(targets);
+	if (count > ps->nb_alloc_timelines) {
+		//keep previous timelines and their runs on failure, they are destroyed with the state
+		MPD_PatchTimeline *timelines = gf_realloc(ps->timelines, sizeof(MPD_PatchTimeline) * count);
+		if (!timelines) {
+			ps->has_base = GF_FALSE;
+			e = GF_OUT_OF_MEM;
+			goto exit;
+		}
+		memset(timelines + ps->nb_alloc_timelines, 0, sizeof(MPD_PatchTimeline) * (count - ps->nb_alloc_timelines));
+		ps->timelines = timelines;
+		ps->nb_alloc_timelines = count;
+	}
+	for (i=0; i<count; i++) {
+		MPD_PatchTarget *pt = gf_list_get(targets, i);
+		e = mpd_patch_get_runs(pt->tl, pt->first_entry, &ps->timelines[i].cur);
+		if (e) {
+			ps->has_base = GF_FALSE;
+			goto exit;
+		}
+	}
+	do_diff = GF_FALSE;
+	if (!collect_err && ps->has_base && (count==ps->nb_timelines) && !memcmp(signature, ps->signature, GF_SHA1_DIGEST_SIZE))
+		do_diff = GF_TRUE;
+
+	gf_fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>");
+	gf_mpd_lf(out, indent);
+	gf_fprintf(out, "<Patch xmlns=\"%s\" xmlns:p=\"%s\"", MPD_PATCH_NS, MPD_PATCH_OPS_NS);
+	gf_xml_dump_string(out, " mpdId=\"", mpd->ID, "\"");
+	gf_mpd_print_date(out, "originalPublishTime", do_diff ? ps->publish_time : mpd->publishTime);
+	gf_mpd_print_date(out, "publishTime", mpd->publishTime);
+	gf_fprintf(out, ">");
+	gf_mpd_lf(out, indent);
+
+	if (do_diff) {
+		gf_mpd_nl(out, indent+1);
+		gf_fprintf(out, "<p:replace sel=\"/MPD/@publishTime\">");
+		gf_mpd_print_date(out, NULL, mpd->publishTime);
+		gf_fprintf(out, "</p:replace>");
+		gf_mpd_lf(out, indent);
+
+		for (i=0; i<count; i++) {
+			MPD_PatchTarget *pt = gf_list_get(targets, i);
+			mpd_patch_diff(out, pt->path, &ps->timelines[i].pub, &ps->timelines[i].cur, indent+1);
+		}
+	}
+	gf_fprintf(out, "</Patch>");
+	gf_mpd_lf(out, indent);
+
+	//current runs are now the published ones
+	for (i=0; i<count; i++) {
+		MPD_PatchRuns swap = ps->timelines[i].pub;
+		ps->timelines[i].pub = ps->timelines[i].cur;
+		ps->timelines[i].cur = swap;
+	}
+	ps->nb_timelines = count;
+	ps->publish_time = mpd->publishTime;
+	memcpy(ps->signature, signature, GF_SHA1_DIGEST_SIZE);
+	ps->has_base = collect_err ? GF_FALSE : GF_TRUE;
+
+exit:
+	while (gf_list_count(targets)) {
+		MPD_PatchTarget *pt = gf_list_pop_back(targets);
+		gf_free(pt->path);
+		gf_free(pt);
+	}
+	gf_list_del(targets);
+	return e;
+}
+
+/*selector target: MPD attribute, SegmentTimeline or S element*/
+typedef struct
+{
+	char att_name[64];
+	GF_MPD_SegmentTimeline *tl;
+	//1-based position of the S element, 0 for the SegmentTimeline element
+	u32 s_pos;
+} MPD_PatchSel;
+
+typedef struct
+{
+	GF_MPD_SegmentTimeline *tl;
+	GF_List *entries;
+} MPD_PatchStage;
+
+typedef struct
+{
+	//staged timelines entries, swapped once all operations are applied
+	GF_List *stages;
+	//entries created and removed by the patch
+	GF_List *created, *removed;
+	//staged MPD attributes
+	u64 media_presentation_duration;
+	u32 minimum_update_period, time_shift_buffer_depth, suggested_presentation_delay, max_segment_duration, min_buffer_time;
+} MPD_PatchApply;
+
+/*checks predicate of a selector step, either [position] or [@id='value']*/
+static Bool mpd_patch_match(const char *pred, const char *id, u32 pos, u32 count)
+{
+	size_t len;
+	if (!pred) return (count==1) ? GF_TRUE : GF_FALSE;
+	if ((pred[0]>='0') && (pred[0]<='9'))
+		return ((u32) atoi(pred) == pos) ? GF_TRUE : GF_FALSE;
+	if (strncmp(pred, "@id=", 4) || !id) return GF_FALSE;
+	pred += 4;
+	if ((pred[0]!='\'') && (pred[0]!='"')) return GF_FALSE;
+	len = strlen(pred);
+	if ((len<2) || (pred[len-1] != pred[0])) return GF_FALSE;
+	if (strlen(id) != len-2) return GF_FALSE;
+	return strncmp(pred+1, id, len-2) ? GF_FALSE : GF_TRUE;
+}
+
+static GF_Err mpd_patch_resolve(GF_MPD *mpd, const char *sel, MPD_PatchSel *res)
+{
+	char *buf, *step;
+	u32 i, count;
+	GF_Err e = GF_OK;
+	GF_MPD_Period *period = NULL;
+	GF_MPD_AdaptationSet *as = NULL;
+	GF_MPD_Representation *rep = NULL;
+	GF_MPD_MultipleSegmentBase *ms = NULL;
+	Bool is_root = GF_TRUE;
+
+	memset(res, 0, sizeof(MPD_PatchSel));
+	if (!sel || (sel[0] != '/')) return GF_NOT_SUPPORTED;
+	buf = gf_strdup(sel+1);
+	if (!buf) return GF_OUT_OF_MEM;
+
+	step = buf;
+	while (step && !e) {
+		char *name, *pred, *sep, *next;
+		//locate end of step, ignoring separators in predicates
+		next = step;
+		while (next[0] && (next[0] != '/')) {
+			if (next[0]=='[') {
+				sep = strchr(next, ']');
+				if (!sep) break;
+				next = sep;
+			}
+			next++;
+		}
+		if (next[0]=='/') {
+			next[0] = 0;
+			next++;
+		} else {
+			next = NULL;
+		}
+		pred = strchr(step, '[');
+		if (pred) {
+			pred[0] = 0;
+			pred++;
+			sep = strrchr(pred, ']');
+			if (!sep) {
+				e = GF_NON_COMPLIANT_BITSTREAM;
+				break;
+			}
+			sep[0] = 0;
+		}
+		//ignore namespace prefixes
+		name = strchr(step, ':');
+		name = name ? name+1 : step;
+
+		if (is_root) {
+			if (strcmp(name, "MPD") || pred) e = GF_NOT_SUPPORTED;
+			is_root = GF_FALSE;
+		} else if (res->tl) {
+			if (res->s_pos || strcmp(name, "S") || !pred || (pred[0]<'1') || (pred[0]>'9')) {
+				e = GF_NOT_SUPPORTED;
+			} else {
+				res->s_pos = atoi(pred);
+			}
+		} else if (ms) {
+			if (strcmp(name, "SegmentTimeline") || pred || !ms->segment_timeline) e = GF_NOT_SUPPORTED;
+			else res->tl = ms->segment_timeline;
+		} else if ((name[0]=='@') && !period) {
+			if (next || (strlen(name) >= sizeof(res->att_name))) e = GF_NOT_SUPPORTED;
+			else gf_strcpy(res->att_name, name+1);
+		} else if (!strcmp(name, "Period") && !period) {
+			count = gf_list_count(mpd->periods);
+			for (i=0; i<count; i++) {
+				period = gf_list_get(mpd->periods, i);
+				if (mpd_patch_match(pred, period->ID, i+1, count)) break;
+				period = NULL;
+			}
+			if (!period) e = GF_NOT_FOUND;
+		} else if (!strcmp(name, "AdaptationSet") && period && !as) {
+			count = gf_list_count(period->adaptation_sets);
+			for (i=0; i<count; i++) {
+				char szID[20];
+				as = gf_list_get(period->adaptation_sets, i);
+				sprintf(szID, "%d", as->id);
+				if (mpd_patch_match(pred, (as->id>=0) ? szID : NULL, i+1, count)) break;
+				as = NULL;
+			}
+			if (!as) e = GF_NOT_FOUND;
+		} else if (!strcmp(name, "Representation") && as && !rep) {
+			//representations may be reordered, only match by ID
+			if (!pred || (pred[0]!='@')) {
+				e = GF_NOT_SUPPORTED;
+				break;
+			}
+			count = gf_list_count(as->representations);
+			for (i=0; i<count; i++) {
+				rep = gf_list_get(as->representations, i);
+				if (mpd_patch_match(pred, rep->id, i+1, count)) break;
+				rep = NULL;
+			}
+			if (!rep) e = GF_NOT_FOUND;
+		} else if (period && !pred && !strcmp(name, "SegmentTemplate")) {
+			if (rep) ms = (GF_MPD_MultipleSegmentBase *) rep->segment_template;
+			else if (as) ms = (GF_MPD_MultipleSegmentBase *) as->segment_template;
+			else ms = (GF_MPD_MultipleSegmentBase *) period->segment_template;
+			if (!ms) e = GF_NOT_FOUND;
+		} else if (period && !pred && !strcmp(name, "SegmentList")) {
+			if (rep) ms = (GF_MPD_MultipleSegmentBase *) rep->segment_list;
+			else if (as) ms = (GF_MPD_MultipleSegmentBase *) as->segment_list;
+			else ms = (GF_MPD_MultipleSegmentBase *) period->segment_list;
+			if (!ms) e = GF_NOT_FOUND;
+		} else {
+			e = GF_NOT_SUPPORTED;
+		}
+		step = next;
+	}
+	gf_free(buf);
+	if (!e && !res->tl && !res->att_name[0]) e = GF_NOT_SUPPORTED;
+	return e;
+}
+
+static GF_List *mpd_patch_get_stage(MPD_PatchApply *pa, GF_MPD_SegmentTimeline *tl)
+{
+	u32 i, count = gf_list_count(pa->stages);
+	MPD_PatchStage *stage;
+	for (i=0; i<count; i++) {
+		stage = gf_list_get(pa->stages, i);
+		if (stage->tl == tl) return stage->entries;
+	}
+	GF_SAFEALLOC(stage, MPD_PatchStage);
+	if (!stage) return NULL;
+	stage->tl = tl;
+	stage->entries = gf_list_clone(tl->entries);
+	if (!stage->entries || gf_list_add(pa->stages, stage)) {
+		if (stage->entries) gf_list_del(stage->entries);
+		gf_free(stage);
+		return NULL;
+	}
+	return stage->entries;
+}
+
+static GF_Err mpd_patch_remove_entry(MPD_PatchApply *pa, GF_List *entries, u32 idx)
+{
+	GF_MPD_SegmentTimelineEntry *se = gf_list_get(entries, idx);
+	if (!se) return GF_NOT_FOUND;
+	gf_list_rem(entries, idx);
+	return gf_list_add(pa->removed, se);
+}
+
+/*inserts S elements children of node at the given position, S elements without start time follow the previous entry*/
+static GF_Err mpd_patch_insert_entries(MPD_PatchApply *pa, GF_XMLNode *node, GF_List *entries, u32 idx, u32 max_entries)
+{
+	u32 i, j, nb_added=0;
+	GF_XMLNode *child;
+	GF_XMLAttribute *att;
+
+	i=0;
+	while ((child = gf_list_enum(node->content, &i))) {
+		GF_MPD_SegmentTimelineEntry *se, *prev;
+		if (child->type != GF_XML_NODE_TYPE) continue;
+		if (strcmp(child->name, "S") || (nb_added==max_entries)) return GF_NOT_SUPPORTED;
+
+		GF_SAFEALLOC(se, GF_MPD_SegmentTimelineEntry);
+		if (!se) return GF_OUT_OF_MEM;
+		if (gf_list_add(pa->created, se)) {
+			gf_free(se);
+			return GF_OUT_OF_MEM;
+		}
+		prev = idx ? gf_list_get(entries, idx-1) : NULL;
+		if (prev) se->start_time = prev->start_time + (u64) prev->duration * (prev->repeat_count+1);
+
+		j=0;
+		while ((att = gf_list_enum(child->attributes, &j))) {
+			if (!strcmp(att->name, "t"))
+				se->start_time = gf_mpd_parse_long_int(att->value);
+			else if (!strcmp(att->name, "d"))
+				se->duration = gf_mpd_parse_int(att->value);
+			else if (!strcmp(att->name, "r")) {
+				se->repeat_count = gf_mpd_parse_int(att->value);
+				if (se->repeat_count == (u32)-1)
+					se->repeat_count--;
+			}
+			else if (!strcmp(att->name, "k"))
+				se->nb_parts = gf_mpd_parse_int(att->value);
+		}
+		if (gf_list_insert(entries, se, idx)) return GF_OUT_OF_MEM;
+		idx++;
+		nb_added++;
+	}
+	return nb_added ? GF_OK : GF_NON_COMPLIANT_BITSTREAM;
+}
+
+static GF_Err mpd_patch_set_attribute(MPD_PatchApply *pa, const char *name, const char *value)
+{
+	if (!value) return GF_NON_COMPLIANT_BITSTREAM;
+	//publishTime is set from the patch publishTime
+	if (!strcmp(name, "publishTime")) return GF_OK;
+	if (!strcmp(name, "mediaPresentationDuration")) pa->media_presentation_duration = gf_mpd_parse_duration(value);
+	else if (!strcmp(name, "minimumUpdatePeriod")) pa->minimum_update_period = gf_mpd_parse_duration_u32(value);
+	else if (!strcmp(name, "timeShiftBufferDepth")) pa->time_shift_buffer_depth = gf_mpd_parse_duration_u32(value);
+	else if (!strcmp(name, "suggestedPresentationDelay")) pa->suggested_presentation_delay = gf_mpd_parse_duration_u32(value);
+	else if (!strcmp(name, "maxSegmentDuration")) pa->max_segment_duration = gf_mpd_parse_duration_u32(value);
+	else if (!strcmp(name, "minBufferTime")) pa->min_buffer_time = gf_mpd_parse_duration_u32(value);
+	else return GF_NOT_SUPPORTED;
+	return GF_OK;
+}
+
+static GF_Err mpd_patch_apply_op(GF_MPD *mpd, MPD_PatchApply *pa, GF_XMLNode *op)
+{
+	u32 i, count;
+	const char *sel=NULL, *pos=NULL;
+	GF_XMLAttribute *att;
+	GF_XMLNode *child;
+	GF_List *entries;
+	MPD_PatchSel res;
+	GF_Err e;
+
+	i=0;
+	while ((att = gf_list_enum(op->attributes, &i))) {
+		if (!strcmp(att->name, "sel")) sel = att->value;
+		else if (!strcmp(att->name, "pos")) pos = att->value;
+		//attribute and namespace additions
+		else if (!strcmp(att->name, "type")) return GF_NOT_SUPPORTED;
+	}
+	e = mpd_patch_resolve(mpd, sel, &res);
+	if (e) return e;
+
+	if (res.att_name[0]) {
+		if (!strcmp(op->name, "replace")) {
+			char *value = gf_mpd_parse_text_content(op);
+			e = mpd_patch_set_attribute(pa, res.att_name, value);
+			if (value) gf_free(value);
+			return e;
+		}
+		return GF_NOT_SUPPORTED;
+	}
+
+	entries = mpd_patch_get_stage(pa, res.tl);
+	if (!entries) return GF_OUT_OF_MEM;
+	count = gf_list_count(entries);
+	if (res.s_pos > count) return GF_NOT_FOUND;
+
+	if (!strcmp(op->name, "add")) {
+		if (!res.s_pos) {
+			if (!pos) return mpd_patch_insert_entries(pa, op, entries, count, (u32) -1);
+			if (!strcmp(pos, "prepend")) return mpd_patch_insert_entries(pa, op, entries, 0, (u32) -1);
+			return GF_NOT_SUPPORTED;
+		}
+		if (pos && !strcmp(pos, "before")) return mpd_patch_insert_entries(pa, op, entries, res.s_pos-1, (u32) -1);
+		if (pos && !strcmp(pos, "after")) return mpd_patch_insert_entries(pa, op, entries, res.s_pos, (u32) -1);
+		return GF_NOT_SUPPORTED;
+	}
+	if (!strcmp(op->name, "remove")) {
+		if (!res.s_pos) return GF_NOT_SUPPORTED;
+		return mpd_patch_remove_entry(pa, entries, res.s_pos-1);
+	}
+	if (strcmp(op->name, "replace")) return GF_NOT_SUPPORTED;
+
+	if (res.s_pos) {
+		e = mpd_patch_remove_entry(pa, entries, res.s_pos-1);
+		if (!e) e = mpd_patch_insert_entries(pa, op, entries, res.s_pos-1, 1);
+		return e;
+	}
+	//replace the whole timeline
+	i=0;
+	while ((child = gf_list_enum(op->content, &i))) {
+		if (child->type != GF_XML_NODE_TYPE) continue;
+		if (strcmp(child->name, "SegmentTimeline")) return GF_NOT_SUPPORTED;
+		while (gf_list_count(entries)) {
+			e = mpd_patch_remove_entry(pa, entries, 0);
+			if (e) return e;
+		}
+		//empty timeline is fine
+		e = mpd_patch_insert_entries(pa, child, entries, 0, (u32) -1);
+		return (e==GF_NON_COMPLIANT_BITSTREAM) ? GF_OK : e;
+	}
+	return GF_NON_COMPLIANT_BITSTREAM;
+}
+
+static GF_Err mpd_patch_apply(GF_MPD *mpd, GF_XMLNode *root)
+{
+	u32 i;
+	u64 publish_time=0, original_publish_time=0;
+	const char *mpd_id=NULL;
+	GF_XMLAttribute *att;
+	GF_XMLNode *op;
+	MPD_PatchApply pa;
+	GF_Err e = GF_OK;
+
+	if (!root || strcmp(root->name, "Patch")) return GF_NON_COMPLIANT_BITSTREAM;
+	i=0;
+	while ((att = gf_list_enum(root->attributes, &i))) {
+		if (!strcmp(att->name, "mpdId")) mpd_id = att->value;
+		else if (!strcmp(att->name, "publishTime")) publish_time = gf_mpd_parse_date(att->value);
+		else if (!strcmp(att->name, "originalPublishTime")) original_publish_time = gf_mpd_parse_date(att->value);
+	}
+	if (!mpd_id || !publish_time || !original_publish_time) return GF_NON_COMPLIANT_BITSTREAM;
+	if (!mpd->ID || strcmp(mpd->ID, mpd_id)) return GF_BAD_PARAM;
+	//already applied
+	if (publish_time == mpd->publishTime) return GF_EOS;
+	//not based on our version of the MPD
+	if (original_publish_time != mpd->publishTime) return GF_BAD_PARAM;
+
+	memset(&pa, 0, sizeof(MPD_PatchApply));
+	pa.media_presentation_duration = mpd->media_presentation_duration;
+	pa.minimum_update_period = mpd->minimum_update_period;
+	pa.time_shift_buffer_depth = mpd->time_shift_buffer_depth;
+	pa.suggested_presentation_delay = mpd->suggested_presentation_delay;
+	pa.max_segment_duration = mpd->max_segment_duration;
+	pa.min_buffer_time = mpd->min_buffer_time;
+	pa.stages = gf_list_new();
+	pa.created = gf_list_new();
+	pa.removed = gf_list_new();
+	if (!pa.stages || !pa.created || !pa.removed) e = GF_OUT_OF_MEM;
+
+	//operations are applied on copies of the timeline entry lists, so that the MPD is unchanged if an operation fails
+	i=0;
+	while (!e && (op = gf_list_enum(root->content, &i))) {
+		if (op->type != GF_XML_NODE_TYPE) continue;
+		e = mpd_patch_apply_op(mpd, &pa, op);
+		if (e) {
+			GF_LOG(GF_LOG_WARNING, GF_LOG_DASH, ("[MPD] Cannot apply patch operation %s: %s\n", op->name, gf_error_to_string(e) ));
+		}
+	}
+
+	while (gf_list_count(pa.stages)) {
+		MPD_PatchStage *stage = gf_list_pop_back(pa.stages);
+		if (!e) {
+			GF_List *old_entries = stage->tl->entries;
+			stage->tl->entries = stage->entries;
+			stage->entries = old_entries;
+			if (stage->tl->cache) gf_mpd_segment_timeline_modified(stage->tl, 0);
+		}
+		gf_list_del(stage->entries);
+		gf_free(stage);
+	}
+	gf_list_del(pa.stages);
+	//on success free removed entries, otherwise free created ones
+	gf_mpd_del_list(e ? pa.created : pa.removed, gf_mpd_segment_entry_free, 0);
+	gf_list_del(e ? pa.removed : pa.created);
+	if (e) return e;
+
+	mpd->publishTime = publish_time;
+	mpd->media_presentation_duration = pa.media_presentation_duration;
+	mpd->minimum_update_period = pa.minimum_update_period;
+	mpd->time_shift_buffer_depth = pa.time_shift_buffer_depth;
+	mpd->suggested_presentation_delay = pa.suggested_presentation_delay;
+	mpd->max_segment_duration = pa.max_segment_duration;
+	mpd->min_buffer_time = pa.min_buffer_time;
+	return GF_OK;
+}
+
+GF_EXPORT
+GF_Err gf_mpd_apply_patch(GF_MPD *mpd, const char *patch_file)
+{
+	GF_Err e;
+	GF_DOMParser *parser;
+	if (!mpd || !patch_file) return GF_BAD_PARAM;
+
+	parser = gf_xml_dom_new();
+	if (!parser) return GF_OUT_OF_MEM;
+	e = gf_xml_dom_parse(parser, patch_file, NULL, NULL);
+	if (e) {
+		GF_LOG(GF_LOG_ERROR, GF_LOG_DASH, ("[MPD] Cannot parse patch %s: %s\n", patch_file, gf_xml_dom_get_error(parser) ));
+	} else {
+		e = mpd_patch_apply(mpd, gf_xml_dom_get_root(parser));
+	}
+	gf_xml_dom_del(parser);
+	return e;
+}
+
 
 GF_EXPORT
 u32 gf_mpd_get_base_url_count(GF_MPD *mpd, GF_MPD_Period *period, GF_MPD_AdaptationSet *set, GF_MPD_Representation *rep)
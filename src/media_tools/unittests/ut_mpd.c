@@ -3,7 +3,11 @@
 
 // functions used by mpd.c, needed for linking
 #include "../m3u8.c"
-void gf_xml_dump_string(FILE* file, const char *before, const char *str, const char *after) {}
+//no escaping, only used with plain strings in tests
+void gf_xml_dump_string(FILE* file, const char *before, const char *str, const char *after)
+{
+	gf_fprintf(file, "%s%s%s", before ? before : "", str ? str : "", after ? after : "");
+}
 
 unittest(mpd_event_streams)
 {
@@ -54,3 +58,610 @@ unittest(mpd_event_streams)
 	gf_xml_dom_del(dom);
 	gf_mpd_del(mpd);
 }
+
+static char *stl_test_print(GF_MPD_SegmentTimeline *tl, s32 indent, u32 first_entry, Bool use_cache)
+{
+	u32 size;
+	char *res;
+	struct __mpd_stl_cache *cache = tl->cache;
+	FILE *f = gf_file_temp(NULL);
+	if (!f) return NULL;
+	if (!use_cache) tl->cache = NULL;
+	gf_mpd_print_segment_timeline(f, tl, indent, first_entry);
+	tl->cache = cache;
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	res = gf_malloc(size+1);
+	if (res) {
+		res[gf_fread(res, size, f)] = 0;
+	}
+	gf_fclose(f);
+	return res;
+}
+
+static void stl_test_add(GF_MPD_SegmentTimeline *tl, u64 start, u32 dur, Bool is_ll_edge)
+{
+	GF_MPD_SegmentTimelineEntry *s, *last = gf_list_last(tl->entries);
+	u32 nb_ent = gf_list_count(tl->entries);
+	gf_mpd_segment_timeline_modified(tl, (nb_ent>2) ? nb_ent-2 : 0);
+	if (last && !is_ll_edge && !last->is_ll_edge && (last->duration==dur) && (last->start_time + (last->repeat_count+1)*dur == start)) {
+		last->repeat_count++;
+		return;
+	}
+	GF_SAFEALLOC(s, GF_MPD_SegmentTimelineEntry);
+	if (!s) return;
+	s->start_time = start;
+	s->duration = dur;
+	s->is_ll_edge = is_ll_edge;
+	gf_list_add(tl->entries, s);
+}
+
+static void stl_test_purge(GF_MPD_SegmentTimeline *tl)
+{
+	GF_MPD_SegmentTimelineEntry *s = gf_list_get(tl->entries, 0);
+	if (!s) return;
+	if (s->repeat_count) {
+		s->repeat_count--;
+		s->start_time += s->duration;
+		gf_mpd_segment_timeline_head_removed(tl, 0);
+	} else {
+		gf_list_rem(tl->entries, 0);
+		gf_free(s);
+		gf_mpd_segment_timeline_head_removed(tl, 1);
+	}
+}
+
+//cached serialization of a timeline must match full serialization
+unittest(mpd_segment_timeline_cache)
+{
+	u32 i, first_entry = 0;
+	u64 time = 1000;
+	GF_MPD_SegmentTimeline *tl = gf_mpd_segmentimeline_new();
+	assert_not_null(tl);
+	if (!tl) return;
+
+	for (i=0; i<600; i++) {
+		char *ref, *res;
+		//variable durations with runs of identical ones
+		u32 dur = ((i/7) % 3) ? 2000 : 1000 + (i%5)*10;
+		s32 indent = (i%97 == 50) ? 0 : 2;
+
+		//discontinuity
+		if (i%53 == 20) time += 5000;
+
+		if (i%11 == 3) {
+			//low latency edge entry, removed before adding the next one
+			stl_test_add(tl, time, dur, GF_TRUE);
+			ref = stl_test_print(tl, indent, first_entry, GF_FALSE);
+			res = stl_test_print(tl, indent, first_entry, GF_TRUE);
+			assert_equal_str(res, ref);
+			gf_free(ref);
+			gf_free(res);
+			gf_mpd_segment_timeline_modified(tl, gf_list_count(tl->entries)-1);
+			gf_free(gf_list_pop_back(tl->entries));
+		}
+		stl_test_add(tl, time, dur, GF_FALSE);
+		time += dur;
+
+		//timeshift buffer
+		if (i>=200) stl_test_purge(tl);
+		if ((i>=300) && (i%13 == 0)) stl_test_purge(tl);
+		//context start index
+		if (i==400) first_entry = 2;
+		if (i==450) first_entry = 0;
+
+		ref = stl_test_print(tl, indent, first_entry, GF_FALSE);
+		res = stl_test_print(tl, indent, first_entry, GF_TRUE);
+		assert_equal_str(res, ref);
+		//second write without modification
+		gf_free(res);
+		res = stl_test_print(tl, indent, first_entry, GF_TRUE);
+		assert_equal_str(res, ref);
+		gf_free(ref);
+		gf_free(res);
+	}
+	assert_not_null(tl->cache);
+	gf_mpd_segment_timeline_free(tl);
+}
+
+//date conversion used for playlists must match gmtime
+unittest(mpd_utc_to_tm)
+{
+	u32 i;
+	u64 utc = 0;
+	for (i=0; i<20000; i++) {
+		struct tm t, *ref;
+		time_t gtime = (time_t) utc;
+		ref = gmtime(&gtime);
+		mpd_utc_to_tm(utc, &t);
+		assert_equal(t.tm_year, ref->tm_year, "%d");
+		assert_equal(t.tm_mon, ref->tm_mon, "%d");
+		assert_equal(t.tm_mday, ref->tm_mday, "%d");
+		assert_equal(t.tm_hour, ref->tm_hour, "%d");
+		assert_equal(t.tm_min, ref->tm_min, "%d");
+		assert_equal(t.tm_sec, ref->tm_sec, "%d");
+		//spans leap years and century rules up to year 2100+
+		utc += 86400*7 + 3607 + i;
+	}
+}
+
+static char *state_test_print(GF_MPD *mpd)
+{
+	u32 size;
+	char *res;
+	FILE *f = gf_file_temp(NULL);
+	if (!f) return NULL;
+	mpd->write_context = GF_TRUE;
+	gf_mpd_write(mpd, f, GF_FALSE);
+	mpd->write_context = GF_FALSE;
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	res = gf_malloc(size+1);
+	if (res) {
+		res[gf_fread(res, size, f)] = 0;
+	}
+	gf_fclose(f);
+	return res;
+}
+
+static GF_MPD *state_test_make_mpd(u32 nb_segs)
+{
+	u32 i, j;
+	u64 time = 0;
+	GF_MPD *mpd = gf_mpd_new();
+	GF_MPD_Period *period = gf_mpd_period_new();
+	GF_MPD_AdaptationSet *as = gf_mpd_adaptation_set_new();
+	if (!mpd || !period || !as) return mpd;
+	mpd->periods = gf_list_new();
+	mpd->xml_namespace = "urn:mpeg:dash:schema:mpd:2011";
+	mpd->type = GF_MPD_TYPE_DYNAMIC;
+	mpd->gpac_next_ntp_ms = 1234567;
+	mpd->availabilityStartTime = 1700000000000;
+	period->ID = gf_strdup("P1");
+	gf_list_add(mpd->periods, period);
+	gf_list_add(period->adaptation_sets, as);
+
+	for (i=0; i<2; i++) {
+		char szName[100];
+		GF_MPD_Representation *rep = gf_mpd_representation_new();
+		GF_MPD_SegmentTimeline *tl = gf_mpd_segmentimeline_new();
+		sprintf(szName, "rep%d", i+1);
+		rep->id = gf_strdup(szName);
+		rep->mime_type = gf_strdup("video/mp4");
+		rep->bandwidth = 1000000 * (i+1);
+		GF_SAFEALLOC(rep->segment_template, GF_MPD_SegmentTemplate);
+		rep->segment_template->media = gf_strdup("seg_$Number$.m4s");
+		rep->segment_template->timescale = 1000;
+		rep->segment_template->start_number = 1;
+		rep->segment_template->segment_timeline = tl;
+		rep->state_seg_list = gf_list_new();
+		gf_list_add(as->representations, rep);
+
+		time = 1000;
+		for (j=0; j<nb_segs; j++) {
+			GF_DASH_SegmentContext *sctx;
+			u32 dur = ((j/7) % 3) ? 2000 : 1000 + (j%5)*10;
+			if (j%53 == 20) time += 5000;
+			stl_test_add(tl, time, dur, (j%11 == 3) ? GF_TRUE : GF_FALSE);
+
+			GF_SAFEALLOC(sctx, GF_DASH_SegmentContext);
+			if (!sctx) continue;
+			sctx->time = time;
+			sctx->dur = dur;
+			sctx->seg_num = j+1;
+			sprintf(szName, "seg_%d.m4s", j+1);
+			sctx->filename = gf_strdup(szName);
+			if (j%2) sctx->filepath = gf_strdup(szName);
+			sctx->file_size = 1000 + j;
+			sctx->file_offset = j*10;
+			gf_list_add(rep->state_seg_list, sctx);
+			time += dur;
+		}
+		//context start index
+		if (i) rep->segment_template->tsb_first_entry = 5;
+	}
+	return mpd;
+}
+
+static void state_test_drop_segments(GF_MPD *mpd)
+{
+	u32 i;
+	GF_MPD_Period *period = gf_list_get(mpd->periods, 0);
+	GF_MPD_AdaptationSet *as = gf_list_get(period->adaptation_sets, 0);
+	for (i=0; i<2; i++) {
+		GF_MPD_Representation *rep = gf_list_get(as->representations, i);
+		while (gf_list_count(rep->state_seg_list)) {
+			GF_DASH_SegmentContext *sctx = gf_list_pop_back(rep->state_seg_list);
+			if (sctx->filename) gf_free(sctx->filename);
+			if (sctx->filepath) gf_free(sctx->filepath);
+			gf_free(sctx);
+		}
+	}
+}
+
+typedef struct
+{
+	GF_MPD *mpd;
+	GF_Err e;
+} HLSTestWrite;
+
+static char *hls_test_read(FILE *f)
+{
+	u32 size;
+	char *res;
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	res = gf_malloc(size+1);
+	if (res) res[gf_fread(res, size, f)] = 0;
+	return res;
+}
+
+static Bool hls_test_write_task(GF_FilterSession *fsess, void *callback, u32 *reschedule_ms)
+{
+	HLSTestWrite *hw = (HLSTestWrite *)callback;
+	FILE *f = gf_file_temp(NULL);
+	hw->e = f ? gf_mpd_write_m3u8_master_playlist(hw->mpd, f, "live.m3u8", hw->mpd->periods, GF_M3U8_WRITE_ALL) : GF_IO_ERR;
+	if (f) gf_fclose(f);
+	return GF_FALSE;
+}
+
+//variant playlists generated on session threads must be identical to the ones generated in the calling thread
+unittest(mpd_hls_parallel_variants)
+{
+	u32 i, k;
+	char *ref[2];
+	HLSTestWrite hw;
+	GF_MPD_Period *period;
+	GF_MPD_AdaptationSet *as;
+
+	memset(ref, 0, sizeof(ref));
+	hw.mpd = state_test_make_mpd(400);
+	hw.mpd->type = GF_MPD_TYPE_STATIC;
+	period = gf_list_get(hw.mpd->periods, 0);
+	//2 variants of 400 segments, enough to use several threads
+	as = gf_list_get(period->adaptation_sets, 0);
+	//variant playlists are matched across periods by discontinuity ID
+	for (i=0; i<gf_list_count(as->representations); i++) {
+		GF_MPD_Representation *rep = gf_list_get(as->representations, i);
+		rep->discontinuity_id = i+1;
+	}
+
+	for (k=0; k<2; k++) {
+		GF_FilterSession *fs = NULL;
+		hw.e = GF_NOT_READY;
+		if (k) {
+			GF_Err e;
+			fs = gf_fs_new(4, GF_FS_SCHEDULER_LOCK_FREE, 0, NULL);
+			assert_not_null(fs);
+			if (!fs) break;
+			hw.mpd->hls_filter = gf_fs_load_filter(fs, "reframer", &e);
+			assert_not_null(hw.mpd->hls_filter);
+			hw.mpd->hls_nb_threads = 4;
+			assert_equal(gf_fs_post_user_task(fs, hls_test_write_task, &hw, "hls_test"), GF_OK, "%d");
+			gf_fs_run(fs);
+		} else {
+			hls_test_write_task(NULL, &hw, NULL);
+		}
+		assert_equal(hw.e, GF_OK, "%d");
+
+		for (i=0; i<gf_list_count(as->representations); i++) {
+			GF_MPD_Representation *rep = gf_list_get(as->representations, i);
+			char *res;
+			assert_not_null(rep->m3u8_var_file);
+			if (!rep->m3u8_var_file) continue;
+			res = hls_test_read(rep->m3u8_var_file);
+			assert_not_null(res);
+			if (!k) {
+				assert_not_null(strstr(res, "seg_400.m4s"));
+				ref[i] = res;
+			} else if (res) {
+				if (ref[i]) assert_equal_str(res, ref[i]);
+				gf_free(res);
+			}
+		}
+		hw.mpd->hls_filter = NULL;
+		if (fs) gf_fs_del(fs);
+	}
+	for (i=0; i<2; i++) {
+		if (ref[i]) gf_free(ref[i]);
+	}
+	gf_mpd_del(hw.mpd);
+}
+
+//reloading a binary state must give the same context as reloading the XML one
+unittest(mpd_binary_state)
+{
+	GF_DOMParser *dom;
+	char *xml_ref;
+	u64 next_gen = 0;
+	u32 size, bin_size;
+	u8 *data;
+	char *ref, *res;
+	char path[GF_MAX_PATH];
+	FILE *f;
+	GF_MPD *reload, *mpd = state_test_make_mpd(300);
+
+	snprintf(path, GF_MAX_PATH, "%s/ut_mpd_state.bin", gf_get_default_cache_directory());
+	ref = state_test_print(mpd);
+	assert_not_null(ref);
+	if (!ref) return;
+	dom = gf_xml_dom_new();
+	assert_equal(gf_xml_dom_parse_string(dom, ref), GF_OK, "%d");
+	reload = gf_mpd_new();
+	assert_equal(gf_mpd_init_from_dom(gf_xml_dom_get_root(dom), reload, NULL), GF_OK, "%d");
+	xml_ref = state_test_print(reload);
+	gf_mpd_del(reload);
+	gf_xml_dom_del(dom);
+
+	f = gf_fopen(path, "wb");
+	assert_not_null(f);
+	if (!f) return;
+	assert_equal(gf_mpd_write_binary_state(mpd, f, GF_FALSE), GF_OK, "%d");
+	gf_fclose(f);
+
+	//source MPD is unchanged
+	res = state_test_print(mpd);
+	assert_equal_str(res, ref);
+	gf_free(res);
+
+	assert_true(gf_mpd_is_binary_state(path, &next_gen));
+	assert_equal(next_gen, (u64) 1234567, LLU);
+
+	//XML part only holds the context skeleton
+	assert_equal(gf_file_load_data(path, &data, &size), GF_OK, "%d");
+	assert_true(size > MPD_STATE_HDR_SIZE);
+	bin_size = GF_4CC(data[16], data[17], data[18], data[19]);
+	assert_true(bin_size + MPD_STATE_HDR_SIZE < size);
+	assert_true(strstr((char *) data + MPD_STATE_HDR_SIZE + bin_size, "segmentInfo") == NULL);
+	assert_true(strstr((char *) data + MPD_STATE_HDR_SIZE + bin_size, "<S ") == NULL);
+
+	reload = gf_mpd_new();
+	assert_equal(gf_mpd_load_binary_state(reload, path), GF_OK, "%d");
+	res = state_test_print(reload);
+	assert_equal_str(res, xml_ref);
+	gf_free(res);
+	gf_mpd_del(reload);
+
+	//truncated binary part
+	f = gf_fopen(path, "wb");
+	if (f) {
+		gf_fwrite(data, MPD_STATE_HDR_SIZE+100, f);
+		gf_fclose(f);
+	}
+	reload = gf_mpd_new();
+	assert_true(gf_mpd_load_binary_state(reload, path) != GF_OK);
+	gf_mpd_del(reload);
+
+	gf_free(data);
+	gf_free(ref);
+	gf_free(xml_ref);
+	gf_mpd_del(mpd);
+	gf_file_delete(path);
+}
+
+//parsing with timeline entries created from SAX events must give the same MPD as parsing the DOM
+unittest(mpd_parse_sax_timeline)
+{
+	u32 i, nb_pool;
+	char *ref, *res;
+	char path[GF_MAX_PATH];
+	GF_DOMParser *dom;
+	GF_List *pool;
+	GF_MPD *reload, *mpd = state_test_make_mpd(20000);
+
+	snprintf(path, GF_MAX_PATH, "%s/ut_mpd_sax.mpd", gf_get_default_cache_directory());
+	//no segment states in a regular MPD
+	state_test_drop_segments(mpd);
+	assert_equal(gf_mpd_write_file(mpd, path), GF_OK, "%d");
+	gf_mpd_del(mpd);
+
+	dom = gf_xml_dom_new();
+	assert_equal(gf_xml_dom_parse(dom, path, NULL, NULL), GF_OK, "%d");
+	reload = gf_mpd_new();
+	assert_equal(gf_mpd_init_from_dom(gf_xml_dom_get_root(dom), reload, path), GF_OK, "%d");
+	gf_xml_dom_del(dom);
+	ref = state_test_print(reload);
+	assert_not_null(ref);
+	if (!ref) return;
+
+	//first parse allocates entries, second one reuses them
+	pool = gf_list_new();
+	for (i=0; i<2; i++) {
+		mpd = gf_mpd_new();
+		assert_equal(gf_mpd_init_from_file(mpd, path, path, pool), GF_OK, "%d");
+		res = state_test_print(mpd);
+		assert_equal_str(res, ref);
+		gf_free(res);
+
+		assert_equal(gf_list_count(pool), 0, "%u");
+		gf_mpd_recycle_timeline_entries(mpd, pool);
+		gf_mpd_del(mpd);
+		nb_pool = gf_list_count(pool);
+		assert_true(nb_pool > 0);
+	}
+	while (gf_list_count(pool)) gf_free(gf_list_pop_back(pool));
+	gf_list_del(pool);
+
+	//recycled entries from the DOM-parsed MPD
+	pool = gf_list_new();
+	gf_mpd_recycle_timeline_entries(reload, pool);
+	assert_equal(gf_list_count(pool), nb_pool, "%u");
+	while (gf_list_count(pool)) gf_free(gf_list_pop_back(pool));
+	gf_list_del(pool);
+	gf_mpd_del(reload);
+
+	//not an XML file
+	mpd = gf_mpd_new();
+	assert_true(gf_mpd_init_from_file(mpd, "ut_mpd_sax_does_not_exist.mpd", NULL, NULL) != GF_OK);
+	gf_mpd_del(mpd);
+
+	gf_free(ref);
+	gf_file_delete(path);
+}
+
+static char *patch_test_print(GF_MPD *mpd)
+{
+	u32 size;
+	char *res;
+	FILE *f = gf_file_temp(NULL);
+	if (!f) return NULL;
+	gf_mpd_write(mpd, f, GF_TRUE);
+	size = (u32) gf_ftell(f);
+	gf_fseek(f, 0, SEEK_SET);
+	res = gf_malloc(size+1);
+	if (res) {
+		res[gf_fread(res, size, f)] = 0;
+	}
+	gf_fclose(f);
+	return res;
+}
+
+static GF_MPD *patch_test_load(const char *path)
+{
+	GF_MPD *mpd = gf_mpd_new();
+	if (gf_mpd_init_from_file(mpd, path, path, NULL) != GF_OK) {
+		gf_mpd_del(mpd);
+		return NULL;
+	}
+	return mpd;
+}
+
+//prints the MPD as fetched by a client
+static char *patch_test_fetch(GF_MPD *mpd, const char *path)
+{
+	char *res;
+	GF_MPD *fetched;
+	if (gf_mpd_write_file(mpd, path) != GF_OK) return NULL;
+	fetched = patch_test_load(path);
+	if (!fetched) return NULL;
+	res = patch_test_print(fetched);
+	gf_mpd_del(fetched);
+	return res;
+}
+
+static GF_Err patch_test_write(GF_MPD *mpd, const char *path)
+{
+	GF_Err e;
+	FILE *f = gf_fopen(path, "wb");
+	if (!f) return GF_IO_ERR;
+	e = gf_mpd_write_patch(mpd, f, GF_FALSE);
+	gf_fclose(f);
+	return e;
+}
+
+//applying patches to a client copy of the MPD must give the same MPD as fetching the server one
+unittest(mpd_patch)
+{
+	u32 i, j;
+	char *ref, *res;
+	char path[GF_MAX_PATH], patch_path[GF_MAX_PATH];
+	GF_MPD_SegmentTimeline *tl[2];
+	u64 next_time[2];
+	FILE *f;
+	GF_MPD *client, *mpd = state_test_make_mpd(40);
+	GF_MPD_Period *period = gf_list_get(mpd->periods, 0);
+	GF_MPD_AdaptationSet *as = gf_list_get(period->adaptation_sets, 0);
+
+	snprintf(path, GF_MAX_PATH, "%s/ut_mpd_patch.mpd", gf_get_default_cache_directory());
+	snprintf(patch_path, GF_MAX_PATH, "%s/ut_mpd_patch.mpp", gf_get_default_cache_directory());
+	mpd->ID = gf_strdup("ut_patch");
+	mpd->publishTime = 1700000100000;
+	mpd->minimum_update_period = 2000;
+	state_test_drop_segments(mpd);
+	for (i=0; i<2; i++) {
+		GF_MPD_Representation *rep = gf_list_get(as->representations, i);
+		GF_MPD_SegmentTimelineEntry *last;
+		tl[i] = rep->segment_template->segment_timeline;
+		last = gf_list_last(tl[i]->entries);
+		next_time[i] = last->start_time + (u64) last->duration * (last->repeat_count+1);
+	}
+	//missing MPD ID
+	f = gf_file_temp(NULL);
+	client = gf_mpd_new();
+	assert_equal(gf_mpd_write_patch(client, f, GF_FALSE), GF_BAD_PARAM, "%d");
+	gf_mpd_del(client);
+	gf_fclose(f);
+
+	//first patch has no base and is already applied on the MPD fetched by the client
+	assert_equal(gf_mpd_write_file(mpd, path), GF_OK, "%d");
+	assert_equal(patch_test_write(mpd, patch_path), GF_OK, "%d");
+	client = patch_test_load(path);
+	assert_not_null(client);
+	if (!client) return;
+	assert_equal(gf_mpd_apply_patch(client, patch_path), GF_EOS, "%d");
+
+	for (i=0; i<20; i++) {
+		//new segments, regular or with a discontinuity, and low latency edges
+		for (j=0; j<2; j++) {
+			u32 dur = (i%4==1) ? 1500 : 2000;
+			if (i%7==3) next_time[j] += 3000;
+			stl_test_add(tl[j], next_time[j], dur, (i%5==2) ? GF_TRUE : GF_FALSE);
+			next_time[j] += dur;
+		}
+		//time shift buffer purge
+		if (i%3==0) stl_test_purge(tl[0]);
+		if (i%4==0) stl_test_purge(tl[1]);
+		mpd->publishTime += 2000;
+
+		assert_equal(patch_test_write(mpd, patch_path), GF_OK, "%d");
+		assert_equal(gf_mpd_apply_patch(client, patch_path), GF_OK, "%d");
+		ref = patch_test_fetch(mpd, path);
+		res = patch_test_print(client);
+		assert_equal_str(res, ref);
+		gf_free(ref);
+		gf_free(res);
+	}
+	//patch already applied
+	assert_equal(gf_mpd_apply_patch(client, patch_path), GF_EOS, "%d");
+
+	//any other change gives a patch without operation, client must fetch the MPD
+	mpd->minimum_update_period = 4000;
+	mpd->publishTime += 2000;
+	stl_test_add(tl[0], next_time[0], 2000, GF_FALSE);
+	assert_equal(patch_test_write(mpd, patch_path), GF_OK, "%d");
+	assert_equal(gf_mpd_apply_patch(client, patch_path), GF_BAD_PARAM, "%d");
+	gf_mpd_del(client);
+	assert_equal(gf_mpd_write_file(mpd, path), GF_OK, "%d");
+	client = patch_test_load(path);
+	assert_not_null(client);
+	if (!client) return;
+
+	//patching resumes from the new base
+	stl_test_add(tl[1], next_time[1], 2000, GF_FALSE);
+	mpd->publishTime += 2000;
+	assert_equal(patch_test_write(mpd, patch_path), GF_OK, "%d");
+	assert_equal(gf_mpd_apply_patch(client, patch_path), GF_OK, "%d");
+	ref = patch_test_fetch(mpd, path);
+	res = patch_test_print(client);
+	assert_equal_str(res, ref);
+	gf_free(res);
+
+	//patch for another MPD
+	f = gf_fopen(patch_path, "wb");
+	if (f) {
+		gf_fprintf(f, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" mpdId=\"other\" originalPublishTime=\"2023-11-14T22:15:10Z\" publishTime=\"2023-11-14T22:15:12Z\"/>");
+		gf_fclose(f);
+	}
+	assert_equal(gf_mpd_apply_patch(client, patch_path), GF_BAD_PARAM, "%d");
+
+	//unsupported operation after a valid one leaves the MPD unchanged
+	f = gf_fopen(patch_path, "wb");
+	if (f) {
+		gf_fprintf(f, "<Patch xmlns=\"urn:mpeg:dash:schema:mpd-patch:2020\" xmlns:p=\"urn:ietf:params:xml:schema:patch-ops\" mpdId=\"ut_patch\"");
+		gf_mpd_print_date(f, "originalPublishTime", client->publishTime);
+		gf_mpd_print_date(f, "publishTime", client->publishTime+2000);
+		gf_fprintf(f, "><p:remove sel=\"/MPD/Period[@id='P1']/AdaptationSet[1]/Representation[@id='rep1']/SegmentTemplate/SegmentTimeline/S[1]\"/>");
+		gf_fprintf(f, "<p:add sel=\"/MPD/Period[1]\"><AdaptationSet/></p:add></Patch>");
+		gf_fclose(f);
+	}
+	assert_equal(gf_mpd_apply_patch(client, patch_path), GF_NOT_SUPPORTED, "%d");
+	res = patch_test_print(client);
+	assert_equal_str(res, ref);
+	gf_free(res);
+	gf_free(ref);
+
+	gf_mpd_del(client);
+	gf_mpd_del(mpd);
+	gf_file_delete(path);
+	gf_file_delete(patch_path);
+}
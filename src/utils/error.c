@@ -1305,9 +1305,15 @@ static const u32 gf_crc_table[256] = {
 GF_EXPORT
 u32 gf_crc_32(const u8 *data, u32 len)
 {
-	register u32 i;
-	u32 crc = 0xffffffff;
 	if (!data) return 0;
+	return gf_crc_32_update(0xffffffff, data, len);
+}
+
+GF_EXPORT
+u32 gf_crc_32_update(u32 crc, const u8 *data, u32 len)
+{
+	register u32 i;
+	if (!data) return crc;
 	for (i=0; i<len; i++)
 		crc = (crc << 8) ^ gf_crc_table[((crc >> 24) ^ *data++) & 0xff];
 
@@ -1634,7 +1634,8 @@ GF_GPACArg GPAC_Args[] = {
 		"- lock: mutexes for queues when several threads (default on arm64/aarch64)\n"
 		"- freex: lock-free queues including for task lists (experimental)\n"
 		"- flock: mutexes for queues even when no thread (debug mode)\n"
-		"- direct: no threads and direct dispatch of tasks whenever possible (debug mode)", GPAC_SCHED_DEFAULT, "free|lock|flock|freex|direct", GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+		"- direct: no threads and direct dispatch of tasks whenever possible (debug mode)\n"
+		"- steal: lock-free queues and per-thread task queues with work stealing, keeping tasks of a filter on the thread that last processed it", GPAC_SCHED_DEFAULT, "free|lock|flock|freex|direct|steal", GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("max-chain", NULL, "set maximum chain length when resolving filter links. Default value covers for __[ in -> ] dmx -> reframe -> decode -> encode -> reframe -> mx [ -> out]__. Filter chains loaded for adaptation (e.g. pixel format change) are loaded after the link resolution. Setting the value to 0 disables dynamic link resolution. You will have to specify the entire chain manually", "6", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("max-sleep", NULL, "set maximum sleep time slot in milliseconds when regulation is enabled", "50", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("step-link", NULL, "load filters one by one when solvink a link instead of loading all filters for the solved path", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
@@ -1645,6 +1646,19 @@ GF_GPACArg GPAC_Args[] = {
  GF_DEF_ARG("blacklist", NULL, "blacklist the filters listed in the given string (comma-separated list). If first character is '-', this is a whitelist, i.e. only filters listed in the given string will be allowed", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("no-graph-cache", NULL, "disable internal caching of filter graph connections. If disabled, the graph will be recomputed at each link resolution (lower memory usage but slower)", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("no-reservoir", NULL, "disable memory recycling for packets and properties. This uses much less memory but stresses the system memory allocator much more", NULL, NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("pck-pool", NULL, "use a session-wide size-class pool of given size in MB for packet payloads, shared by all filters with per-thread caches. 0 uses per-filter packet reservoirs", "0", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("fq-ring", NULL, "use a bounded ring buffer of given number of slots for lock-free queues of packets, tasks and reservoirs. When a ring is full, the queue switches to the default linked list mode until both ring and list are empty. This only targets sessions with few threads (up to 4); with more threads contending on the same queue, the ring is slower than the linked list. 0 disables ring mode", "0", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("link-cache", NULL, "store the filter registry graph and resolved filter chains in the cache directory and reuse them in later sessions with the same filters", "false", NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("lat-hist", NULL, "collect per-filter histograms of process() duration and input packet queue wait time, shown in session stats", "false", NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("lat-dump", NULL, "periodically write per-filter latency histograms as JSON to the given file (enables [-lat-hist]())", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("lat-period", NULL, "period in milliseconds of [-lat-dump]()", "1000", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("th-cpus", NULL, "bind session threads to the given CPU list (eg `0-3,8`), one CPU per thread in round-robin. The main thread is not bound", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("th-numa", NULL, "enable NUMA-aware session threads: packet pool blocks are kept per node of the allocating thread, work-stealing scheduler steals from threads of the same node first, and threads are bound to CPUs of each node in round-robin if [-th-cpus]() is not set", "false", NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("trace", NULL, "write scheduling trace of the session (tasks, packet send/drop, blocking state, thread waits) to the given file in Chrome trace-event JSON format", NULL, NULL, GF_ARG_STRING, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("trace-size", NULL, "size in events of per-thread trace buffers for [-trace](), oldest events are overwritten", "65536", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_FILTERS),
+ GF_DEF_ARG("isom-index", NULL, "build a sparse random access index on ISOBMFF time to sample and sample to chunk tables when reading, with one checkpoint every given number of entries. 0 disables the index", "0", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_CORE),
+ GF_DEF_ARG("isom-lazy", NULL, "decode large ISOBMFF sample size, chunk offset and composition offset tables on demand when reading, keeping at most the given number of windows of 4096 entries per table in memory. 0 loads full tables", "0", NULL, GF_ARG_INT, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_CORE),
+ GF_DEF_ARG("isom-arena", NULL, "allocate ISOBMFF fragment boxes (moof, traf, trun, ...) and their sample entries in per-file memory blocks recycled after each fragment when reading", "false", NULL, GF_ARG_BOOL, GF_ARG_HINT_EXPERT|GF_ARG_SUBSYS_CORE),
  GF_DEF_ARG("buffer-gen", NULL, "default buffer size in microseconds for generic pids", "1000", NULL, GF_ARG_INT, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("buffer-dec", NULL, "default buffer size in microseconds for decoder input pids", "1000000", NULL, GF_ARG_INT, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
  GF_DEF_ARG("buffer-units", NULL, "default buffer size in frames when timing is not available", "1", NULL, GF_ARG_INT, GF_ARG_HINT_ADVANCED|GF_ARG_SUBSYS_FILTERS),
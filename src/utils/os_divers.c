@@ -1545,6 +1545,11 @@ GF_Err gf_sys_init(GF_MemTrackerType mem_tracker_type, const char *profile)
 #endif
 		gf_rand_init(GF_FALSE);
 
+#ifndef GPAC_DISABLE_ISOM
+		void gf_isom_registry_init();
+		gf_isom_registry_init();
+#endif
+
 		gf_init_global_config(profile);
 
 		gf_sys_refresh_cache();
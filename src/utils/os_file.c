@@ -25,6 +25,7 @@
 
 #include <gpac/tools.h>
 #include <gpac/utf.h>
+#include <gpac/thread.h>
 
 #if defined(_WIN32_WCE)
 
@@ -1765,6 +1766,112 @@ s32 gf_fd_open(const char *file_name, u32 oflags, u32 uflags)
 	return -1;
 }
 
+#if defined(WIN32) && !defined(_WIN32_WCE)
+#define GF_FILE_MAP_WIN
+#elif defined(GPAC_HAS_FD) && !defined(WIN32) && !defined(GPAC_CONFIG_EMSCRIPTEN)
+#define GF_FILE_MAP_POSIX
+#include <sys/mman.h>
+#endif
+
+struct __gf_file_map
+{
+	u8 *data;
+	u64 size;
+	volatile u32 nb_refs;
+#if defined(GF_FILE_MAP_WIN)
+	HANDLE file_h, map_h;
+#endif
+};
+
+GF_EXPORT
+GF_FileMap *gf_file_map_new(const char *file_name)
+{
+	GF_FileMap *fmap;
+	if (!file_name || !strncmp(file_name, "gfio://", 7)) return NULL;
+
+	GF_SAFEALLOC(fmap, GF_FileMap);
+	if (!fmap) return NULL;
+
+#if defined(GF_FILE_MAP_WIN)
+	wchar_t *wname = gf_utf8_to_wcs(file_name);
+	if (!wname) {
+		gf_free(fmap);
+		return NULL;
+	}
+	fmap->file_h = CreateFileW(wname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY | FILE_FLAG_RANDOM_ACCESS, NULL);
+	gf_free(wname);
+	if (fmap->file_h != INVALID_HANDLE_VALUE) {
+		LARGE_INTEGER fsize;
+		if (GetFileSizeEx(fmap->file_h, &fsize))
+			fmap->size = (u64) fsize.QuadPart;
+		if (fmap->size)
+			fmap->map_h = CreateFileMapping(fmap->file_h, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (fmap->map_h)
+			fmap->data = MapViewOfFile(fmap->map_h, FILE_MAP_READ, 0, 0, 0);
+	}
+	if (!fmap->data) {
+		if (fmap->map_h) CloseHandle(fmap->map_h);
+		if (fmap->file_h != INVALID_HANDLE_VALUE) CloseHandle(fmap->file_h);
+		gf_free(fmap);
+		return NULL;
+	}
+#elif defined(GF_FILE_MAP_POSIX)
+	s32 fd = gf_fd_open(file_name, O_RDONLY | O_BINARY, S_IRUSR | S_IWUSR);
+	if (fd>=0) {
+		fmap->size = gf_fd_fsize(fd);
+		if (fmap->size && (fmap->size <= (u64) SIZE_MAX)) {
+			void *data = mmap(NULL, (size_t) fmap->size, PROT_READ, MAP_SHARED, fd, 0);
+			if (data != MAP_FAILED) fmap->data = data;
+		}
+		//mapping stays valid after close
+		close(fd);
+	}
+	if (!fmap->data) {
+		gf_free(fmap);
+		return NULL;
+	}
+#else
+	gf_free(fmap);
+	return NULL;
+#endif
+	fmap->nb_refs = 1;
+	GF_LOG(GF_LOG_DEBUG, GF_LOG_CORE, ("[Core] file \"%s\" mapped in memory ("LLU" bytes)\n", file_name, fmap->size));
+	return fmap;
+}
+
+GF_EXPORT
+void gf_file_map_ref(GF_FileMap *fmap)
+{
+	if (fmap) safe_int_inc(&fmap->nb_refs);
+}
+
+GF_EXPORT
+u32 gf_file_map_unref(GF_FileMap *fmap)
+{
+	u32 nb_refs;
+	if (!fmap) return 0;
+	nb_refs = safe_int_dec(&fmap->nb_refs);
+	if (nb_refs) return nb_refs;
+
+#if defined(GF_FILE_MAP_WIN)
+	UnmapViewOfFile(fmap->data);
+	CloseHandle(fmap->map_h);
+	CloseHandle(fmap->file_h);
+#elif defined(GF_FILE_MAP_POSIX)
+	munmap(fmap->data, (size_t) fmap->size);
+#endif
+	gf_free(fmap);
+	return 0;
+}
+
+GF_EXPORT
+const u8 *gf_file_map_get_data(GF_FileMap *fmap, u64 *size)
+{
+	if (!fmap) return NULL;
+	if (size) *size = fmap->size;
+	return fmap->data;
+}
+
 GF_EXPORT
 FILE *gf_fopen(const char *file_name, const char *mode)
 {
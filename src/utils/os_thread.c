@@ -46,6 +46,13 @@ typedef HANDLE TH_HANDLE;
 #include <errno.h>
 typedef pthread_t TH_HANDLE ;
 
+#if defined(__linux__) && !defined(GPAC_CONFIG_ANDROID) && !defined(GPAC_CONFIG_EMSCRIPTEN)
+//CPU affinity through system calls, the pthread and sched wrappers require _GNU_SOURCE
+#define GPAC_LINUX_AFFINITY
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
 #endif
 
 
@@ -68,6 +75,11 @@ struct __tag_thread
 
 	Bool no_kill;
 
+#ifdef GPAC_LINUX_AFFINITY
+	//kernel thread ID, set once the thread runs
+	s32 sys_tid;
+#endif
+
 #ifndef GPAC_DISABLE_LOG
 	u32 id;
 	char *log_name;
@@ -217,6 +229,9 @@ void * RunThread(void *ptr)
 	if (pthread_once(&currentThreadInfoKey_once, &currentThreadInfoKey_alloc) || pthread_setspecific(currentThreadInfoKey, t))
 		GF_LOG(GF_LOG_ERROR, GF_LOG_MUTEX, ("[Mutex] Couldn't run thread %s, ID %u\n", t->log_name, t->id));
 #endif /* GPAC_CONFIG_ANDROID */
+#ifdef GPAC_LINUX_AFFINITY
+	t->sys_tid = (s32) syscall(SYS_gettid);
+#endif
 	t->status = GF_THREAD_STATUS_RUN;
 
 	if (t->blocking)
@@ -480,6 +495,110 @@ void gf_th_set_priority(GF_Thread *t, s32 priority)
 #endif
 }
 
+GF_EXPORT
+GF_Err gf_th_set_cpu_affinity(GF_Thread *t, const u32 *cpus, u32 nb_cpus)
+{
+	u32 i;
+	if (!cpus || !nb_cpus) return GF_BAD_PARAM;
+#if defined(WIN32) && !defined(_WIN32_WCE)
+	DWORD_PTR mask = 0;
+	for (i=0; i<nb_cpus; i++) {
+		if (cpus[i] < sizeof(DWORD_PTR)*8) mask |= ((DWORD_PTR)1) << cpus[i];
+	}
+	if (!mask) return GF_BAD_PARAM;
+	if (!SetThreadAffinityMask(t ? t->threadH : GetCurrentThread(), mask)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MUTEX, ("[Thread %s] Couldn't set CPU affinity, error %d\n", t ? t->log_name : "current", GetLastError()));
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+#elif defined(GPAC_LINUX_AFFINITY)
+	u32 nb_set = 0;
+	unsigned long mask[1024 / (8*sizeof(unsigned long))];
+	memset(mask, 0, sizeof(mask));
+	for (i=0; i<nb_cpus; i++) {
+		if (cpus[i] >= 1024) continue;
+		mask[cpus[i] / (8*sizeof(unsigned long))] |= 1UL << (cpus[i] % (8*sizeof(unsigned long)));
+		nb_set++;
+	}
+	if (!nb_set) return GF_BAD_PARAM;
+	//thread ID 0 is the calling thread
+	if (t && !t->sys_tid) return GF_BAD_PARAM;
+	if (syscall(SYS_sched_setaffinity, t ? t->sys_tid : 0, sizeof(mask), mask)) {
+		GF_LOG(GF_LOG_WARNING, GF_LOG_MUTEX, ("[Thread %s] Couldn't set CPU affinity\n", t ? t->log_name : "current"));
+		return GF_IO_ERR;
+	}
+	return GF_OK;
+#else
+	return GF_NOT_SUPPORTED;
+#endif
+}
+
+GF_EXPORT
+s32 gf_th_current_cpu()
+{
+#if defined(GPAC_LINUX_AFFINITY)
+	unsigned int cpu = 0;
+	if (syscall(SYS_getcpu, &cpu, NULL, NULL)) return -1;
+	return (s32) cpu;
+#elif defined(WIN32) && !defined(_WIN32_WCE)
+	return (s32) GetCurrentProcessorNumber();
+#else
+	return -1;
+#endif
+}
+
+GF_EXPORT
+u32 gf_th_parse_cpu_list(const char *list, u32 *cpus, u32 max_cpus)
+{
+	u32 nb_cpus = 0;
+	while (list && list[0]) {
+		u32 start, end;
+		char *sep;
+		while (list[0] && strchr(" ,\t\r\n", list[0])) list++;
+		if (!list[0]) break;
+		start = end = (u32) strtoul(list, &sep, 10);
+		if (sep == list) return 0;
+		if (sep[0]=='-') {
+			list = sep+1;
+			end = (u32) strtoul(list, &sep, 10);
+			if ((sep == list) || (end<start)) return 0;
+		}
+		while ((start<=end) && (nb_cpus<max_cpus)) {
+			cpus[nb_cpus++] = start++;
+		}
+		list = sep;
+	}
+	return nb_cpus;
+}
+
+GF_EXPORT
+u32 gf_th_get_numa_cpus(u32 node, u32 *cpus, u32 max_cpus)
+{
+	u32 i, nb_cores;
+	GF_SystemRTInfo rti;
+#if defined(__linux__) && !defined(GPAC_CONFIG_ANDROID)
+	char szPath[100];
+	sprintf(szPath, "/sys/devices/system/node/node%u/cpulist", node);
+	FILE *f = gf_fopen(szPath, "r");
+	if (f) {
+		char szList[1024];
+		u32 len = (u32) gf_fread(szList, sizeof(szList)-1, f);
+		gf_fclose(f);
+		szList[len] = 0;
+		return gf_th_parse_cpu_list(szList, cpus, max_cpus);
+	}
+	if (gf_dir_exists("/sys/devices/system/node/node0")) return 0;
+#endif
+	//no NUMA information, single node with all cores
+	if (node) return 0;
+	memset(&rti, 0, sizeof(GF_SystemRTInfo));
+	gf_sys_get_rti(0, &rti, 0);
+	nb_cores = rti.nb_cores ? rti.nb_cores : 1;
+	for (i=0; (i<nb_cores) && (i<max_cpus); i++)
+		cpus[i] = i;
+	return i;
+}
+
 GF_EXPORT
 u32 gf_th_status(GF_Thread *t)
 {
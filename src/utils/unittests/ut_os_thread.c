@@ -0,0 +1,87 @@
+#include <gpac/thread.h>
+#include "tests.h"
+
+unittest(gf_th_parse_cpu_list)
+{
+    u32 cpus[16];
+
+    assert_equal(gf_th_parse_cpu_list("0-3,8,10-11", cpus, 16), 7, "%u");
+    assert_equal(cpus[0], 0, "%u");
+    assert_equal(cpus[3], 3, "%u");
+    assert_equal(cpus[4], 8, "%u");
+    assert_equal(cpus[6], 11, "%u");
+
+    // spaces and trailing separators are ignored
+    assert_equal(gf_th_parse_cpu_list(" 2, 5 ,", cpus, 16), 2, "%u");
+    assert_equal(cpus[1], 5, "%u");
+
+    // sysfs format
+    assert_equal(gf_th_parse_cpu_list("0-1\n", cpus, 16), 2, "%u");
+
+    // truncated to max entries
+    assert_equal(gf_th_parse_cpu_list("0-31", cpus, 16), 16, "%u");
+    assert_equal(cpus[15], 15, "%u");
+
+    // invalid lists
+    assert_equal(gf_th_parse_cpu_list("a-b", cpus, 16), 0, "%u");
+    assert_equal(gf_th_parse_cpu_list("4-2", cpus, 16), 0, "%u");
+    assert_equal(gf_th_parse_cpu_list("", cpus, 16), 0, "%u");
+}
+
+unittest(gf_th_get_numa_cpus)
+{
+    u32 cpus[1024];
+
+    // node 0 always exists
+    assert_true(gf_th_get_numa_cpus(0, cpus, 1024) > 0);
+    assert_equal(gf_th_get_numa_cpus(63, cpus, 1024), 0, "%u");
+}
+
+typedef struct
+{
+    volatile u32 step;
+    s32 cpu;
+} AffinityTest;
+
+static u32 affinity_test_run(void *par)
+{
+    AffinityTest *at = par;
+    while (!at->step) gf_sleep(1);
+    at->cpu = gf_th_current_cpu();
+    at->step = 2;
+    return 0;
+}
+
+unittest(gf_th_set_cpu_affinity)
+{
+    u32 cpus[1024];
+    GF_Err e;
+    AffinityTest at;
+    GF_Thread *th;
+    u32 nb_cpus = gf_th_get_numa_cpus(0, cpus, 1024);
+    assert_true(nb_cpus > 0);
+
+    memset(&at, 0, sizeof(AffinityTest));
+    th = gf_th_new("affinity");
+    assert_not_null(th);
+    if (!th) return;
+    //not running
+    e = gf_th_set_cpu_affinity(th, cpus, 1);
+    assert_true(e != GF_OK);
+
+    gf_th_run(th, affinity_test_run, &at);
+    while (gf_th_status(th) != GF_THREAD_STATUS_RUN) gf_sleep(1);
+    e = gf_th_set_cpu_affinity(th, &cpus[nb_cpus-1], 1);
+    if (e == GF_NOT_SUPPORTED) {
+        at.step = 1;
+        gf_th_del(th);
+        return;
+    }
+    assert_equal(e, GF_OK, "%d");
+    at.step = 1;
+    while (at.step != 2) gf_sleep(1);
+    if (!e) {
+        assert_equal(at.cpu, (s32) cpus[nb_cpus-1], "%d");
+    }
+    gf_th_del(th);
+}
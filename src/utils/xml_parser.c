@@ -1682,6 +1682,10 @@ struct _tag_dom_parser
 	Bool keep_valid;
 	void (*OnProgress)(void *cbck, u64 done, u64 tot);
 	void *cbk;
+	//elements consumed by the filter are not added to the tree
+	gf_xml_dom_node_filter node_filter;
+	void *filter_udta;
+	u32 skip_depth;
 };
 
 
@@ -1732,6 +1736,16 @@ static void on_dom_node_start(void *cbk, const char *name, const char *ns, const
 		par->parser->suspended = GF_TRUE;
 		return;
 	}
+	if (par->skip_depth) {
+		par->skip_depth++;
+		return;
+	}
+	if (par->node_filter && par->root
+		&& par->node_filter(par->filter_udta, gf_list_last(par->stack), name, ns, attributes, nb_attributes)
+	) {
+		par->skip_depth = 1;
+		return;
+	}
 
 	GF_SAFEALLOC(node, GF_XMLNode);
 	if (!node) {
@@ -1779,7 +1793,12 @@ static void on_dom_node_start(void *cbk, const char *name, const char *ns, const
 static void on_dom_node_end(void *cbk, const char *name, const char *ns)
 {
 	GF_DOMParser *par = (GF_DOMParser *)cbk;
-	GF_XMLNode *last = (GF_XMLNode *)gf_list_last(par->stack);
+	GF_XMLNode *last;
+	if (par->skip_depth) {
+		par->skip_depth--;
+		return;
+	}
+	last = (GF_XMLNode *)gf_list_last(par->stack);
 	gf_list_rem_last(par->stack);
 
 	if (!last || (strlen(last->name)!=strlen(name)) || strcmp(last->name, name) || (!ns && last->ns) || (ns && !last->ns) || (ns && strcmp(last->ns, ns) ) ) {
@@ -1809,7 +1828,7 @@ static void on_dom_text_content(void *cbk, const char *content, Bool is_cdata)
 	GF_DOMParser *par = (GF_DOMParser *)cbk;
 	GF_XMLNode *node;
 	GF_XMLNode *last = (GF_XMLNode *)gf_list_last(par->stack);
-	if (!last) return;
+	if (!last || par->skip_depth) return;
 	if (!last->content)
 		last->content = gf_list_new();
 
@@ -1901,6 +1920,7 @@ GF_Err gf_xml_dom_parse(GF_DOMParser *dom, const char *file, gf_xml_sax_progress
 	GF_Err e;
 	gf_xml_dom_reset(dom, GF_TRUE);
 	dom->stack = gf_list_new();
+	dom->skip_depth = 0;
 	dom->parser = gf_xml_sax_new(on_dom_node_start, on_dom_node_end, on_dom_text_content, dom);
 	dom->OnProgress = OnProgress;
 	dom->cbk = cbk;
@@ -1915,6 +1935,7 @@ GF_Err gf_xml_dom_parse_string(GF_DOMParser *dom, char *string)
 	GF_Err e;
 	gf_xml_dom_reset(dom, GF_TRUE);
 	dom->stack = gf_list_new();
+	dom->skip_depth = 0;
 	dom->parser = gf_xml_sax_new(on_dom_node_start, on_dom_node_end, on_dom_text_content, dom);
 	e = gf_xml_sax_init(dom->parser, (unsigned char *) string);
 	gf_xml_dom_reset(dom, GF_FALSE);
@@ -1929,6 +1950,15 @@ GF_Err gf_xml_dom_enable_passthrough(GF_DOMParser *dom)
 	return GF_OK;
 }
 
+GF_EXPORT
+GF_Err gf_xml_dom_set_node_filter(GF_DOMParser *dom, gf_xml_dom_node_filter node_filter, void *udta)
+{
+	if (!dom) return GF_BAD_PARAM;
+	dom->node_filter = node_filter;
+	dom->filter_udta = udta;
+	return GF_OK;
+}
+
 #if 0 //unused
 GF_XMLNode *gf_xml_dom_create_root(GF_DOMParser *parser, const char* name) {
 	GF_XMLNode * root;
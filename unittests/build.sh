@@ -18,7 +18,7 @@ int main(int argc, char *argv[])
 {'
 
 
-calls=$(cd "$scriptDir/.." && find . -path "*/unittests/*.c" -not -path "./unittests/*" | grep -v bin | xargs grep unittest | cut -d ":" -f 2)
+calls=$(cd "$scriptDir/.." && find . -path "*/unittests/*.c" -not -path "./unittests/*" | grep -v bin | xargs grep "^unittest(" | cut -d ":" -f 2)
 for call in $calls; do
     echo "  $call;"
 done
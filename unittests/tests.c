@@ -37,6 +37,9 @@ int run_tests(int argc, char *argv[])
 {
 #ifdef GPAC_MEMORY_TRACKING
   gf_sys_init(GF_MemTrackerSimple, NULL);
+#else
+  //tests may change core options
+  gf_sys_init(GF_MemTrackerNone, NULL);
 #endif
 
   unsigned selected_tests = -1; // all